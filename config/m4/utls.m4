@@ -95,6 +95,17 @@ AS_IF([test "$prj_cv_utls" -ne 0],
          [prj_cv_utls_aes256=1])
     ])
 
+prj_cv_utls_chacha20=0
+AS_IF([test "$prj_cv_utls" -ne 0],
+    [
+    AC_LINK_IFELSE([AC_LANG_PROGRAM([[#include <linux/tls.h>]],
+         [[struct tls12_crypto_info_chacha20_poly1305 crypto_info;
+           char arr[TLS_CIPHER_CHACHA20_POLY1305_KEY_SIZE];
+           crypto_info.info.cipher_type = TLS_CIPHER_CHACHA20_POLY1305;
+           (void)crypto_info; (void)arr;]])],
+         [prj_cv_utls_chacha20=1])
+    ])
+
 AC_CHECK_HEADER(
     [openssl/evp.h], [],
     # Currently, we don't support TX without RX, so disable UTLS completely
@@ -112,6 +123,15 @@ if test "$prj_cv_utls" -ne 0; then
     else
         AC_MSG_RESULT([no])
     fi
+
+    AC_MSG_CHECKING([for utls ChaCha20-Poly1305 support])
+    if test "$prj_cv_utls_chacha20" -ne 0; then
+        AC_DEFINE_UNQUOTED([DEFINED_UTLS_CHACHA20], [1],
+            [Define to 1 to enable UTLS ChaCha20-Poly1305])
+        AC_MSG_RESULT([yes])
+    else
+        AC_MSG_RESULT([no])
+    fi
 else
     AS_IF([test "x$enable_utls" == xyes],
         [AC_MSG_ERROR([utls support requested but kTLS or openssl not found])],
@@ -30,7 +30,9 @@
  * SOFTWARE.
  */
 
+#include <algorithm>
 #include <mutex>
+#include <vector>
 #include "buffer_pool.h"
 
 #include <stdlib.h>
@@ -56,6 +58,10 @@ buffer_pool *g_buffer_pool_rx_ptr = NULL;
 // Each such descriptor points into a portion of a buffer of a g_buffer_pool_rx_rwqe descriptor.
 buffer_pool *g_buffer_pool_rx_stride = NULL;
 
+// This buffer-pool holds small buffers which receive a copy of a short stride packet
+// when RWQE buffers are pinned by strides. See XLIO_STRQ_COPYBREAK.
+buffer_pool *g_buffer_pool_rx_copybreak = NULL;
+
 // This buffer-pool holds the actual buffers for receive WQEs.
 buffer_pool *g_buffer_pool_rx_rwqe = NULL;
 
@@ -66,6 +72,11 @@ buffer_pool *g_buffer_pool_tx = NULL;
 // These buffer descriptors do not actually own a buffer.
 buffer_pool *g_buffer_pool_zc = NULL;
 
+// Pools over SO_XLIO_RING_USER_MEMORY memory. The application can hold zero-copy buffers after
+// the owner ring is destroyed, so returned buffers find their pool by the descriptor address.
+static lock_spin s_user_pools_lock("buffer_pool:user_pools");
+static std::vector<buffer_pool *> s_user_pools;
+
 buffer_pool_area::buffer_pool_area(size_t buffer_nr)
 {
     m_ptr = malloc(sizeof(mem_buf_desc_t) * buffer_nr + MCE_ALIGNMENT);
@@ -91,8 +102,22 @@ inline void buffer_pool::put_buffer_helper(mem_buf_desc_t *buff)
     if (buff->lwip_pbuf.pbuf.desc.attr == PBUF_DESC_STRIDE) {
         mem_buf_desc_t *rwqe = reinterpret_cast<mem_buf_desc_t *>(buff->lwip_pbuf.pbuf.desc.mdesc);
         if (buff->rx.strides_num == rwqe->add_ref_count(-buff->rx.strides_num)) { // Is last stride.
+            g_buffer_pool_rx_rwqe->unpin_buffer(rwqe);
             g_buffer_pool_rx_rwqe->put_buffers_thread_safe(rwqe);
         }
+    } else if (unlikely(buff->m_flags & mem_buf_desc_t::COPYBREAK) &&
+               this != g_buffer_pool_rx_copybreak) {
+        // Copybreak buffers are returned through the strides pool by the upper layers.
+        g_buffer_pool_rx_copybreak->put_buffers_thread_safe(&buff, 1U);
+        return;
+    } else if (unlikely(buff->m_flags & mem_buf_desc_t::USER_MEM) &&
+               !(m_b_user_memory && is_own_buffer(buff))) {
+        // User memory buffers always return to the pool which owns the memory.
+        buffer_pool *user_pool = get_user_pool(buff);
+        if (likely(user_pool)) {
+            user_pool->put_buffers_thread_safe(&buff, 1U);
+        }
+        return;
     }
 
     buff->p_next_desc = m_p_head;
@@ -126,6 +151,9 @@ void buffer_pool::expand(size_t count, void *data, size_t buf_size,
             : PBUF_RAM;
         desc = new (ptr_desc) mem_buf_desc_t(ptr_data, buf_size, type, custom_free_function);
         put_buffer_helper(desc);
+        if (m_b_user_memory) {
+            desc->m_flags |= mem_buf_desc_t::USER_MEM;
+        }
         ptr_desc += sizeof(mem_buf_desc_t);
         if (ptr_data != NULL) {
             ptr_data += buf_size;
@@ -151,8 +179,11 @@ void buffer_pool::free_tx_lwip_pbuf_custom(struct pbuf *p_buff)
 
 buffer_pool::buffer_pool(size_t buffer_count, size_t buf_size,
                          pbuf_free_custom_fn custom_free_function, alloc_t alloc_func,
-                         free_t free_func)
+                         free_t free_func, void *user_memory)
     : m_lock("buffer_pool")
+    , m_buf_size(0)
+    , m_b_user_memory(user_memory != NULL)
+    , m_b_released(false)
     , m_n_buffers(0)
     , m_n_buffers_created(0)
     , m_p_head(NULL)
@@ -165,6 +196,7 @@ buffer_pool::buffer_pool(size_t buffer_count, size_t buf_size,
     __log_info_func("count = %d", buffer_count);
 
     m_custom_free_function = custom_free_function;
+    atomic_set(&m_n_pinned, 0);
     m_p_bpool_stat = &m_bpool_stat_static;
     memset(m_p_bpool_stat, 0, sizeof(*m_p_bpool_stat));
     xlio_stats_instance_create_bpool_block(m_p_bpool_stat);
@@ -178,7 +210,8 @@ buffer_pool::buffer_pool(size_t buffer_count, size_t buf_size,
         m_size = buf_size;
     }
 
-    data_block = m_size ? m_allocator.alloc_and_reg_mr(m_size, NULL) : NULL;
+    m_buf_size = sz_aligned_element;
+    data_block = m_size ? m_allocator.alloc_and_reg_mr(m_size, NULL, user_memory) : NULL;
     assert(m_size == 0 || data_block != NULL);
 
     if (!buffer_count) {
@@ -192,6 +225,11 @@ buffer_pool::buffer_pool(size_t buffer_count, size_t buf_size,
 
     expand(buffer_count, ptr_data, sz_aligned_element, custom_free_function);
 
+    if (m_b_user_memory) {
+        std::lock_guard<decltype(s_user_pools_lock)> lock(s_user_pools_lock);
+        s_user_pools.push_back(this);
+    }
+
     print_val_tbl();
 
     __log_info_func("done");
@@ -204,6 +242,11 @@ buffer_pool::~buffer_pool()
 
 void buffer_pool::free_bpool_resources()
 {
+    if (m_b_user_memory) {
+        std::lock_guard<decltype(s_user_pools_lock)> lock(s_user_pools_lock);
+        s_user_pools.erase(std::find(s_user_pools.begin(), s_user_pools.end(), this));
+    }
+
     if (m_n_buffers == m_n_buffers_created) {
         __log_info_func("count %lu, missing %lu", m_n_buffers, m_n_buffers_created - m_n_buffers);
     } else {
@@ -221,6 +264,46 @@ void buffer_pool::free_bpool_resources()
     __log_info_func("done");
 }
 
+void buffer_pool::release()
+{
+    bool unused;
+
+    {
+        std::lock_guard<decltype(m_lock)> lock(m_lock);
+        m_b_released = true;
+        unused = (m_n_buffers == m_n_buffers_created);
+        if (!unused) {
+            __log_info_dbg("pool %p is released with %zu buffers held by the application", this,
+                           m_n_buffers_created - m_n_buffers);
+        }
+    }
+    if (unused) {
+        delete this;
+    }
+}
+
+bool buffer_pool::is_own_buffer(const mem_buf_desc_t *buff) const
+{
+    // User memory pools are never expanded, all the descriptors are in the first area.
+    const mem_buf_desc_t *descs = reinterpret_cast<mem_buf_desc_t *>(m_areas.front()->m_area);
+
+    return buff >= descs && buff < descs + m_areas.front()->m_n_buffers;
+}
+
+buffer_pool *buffer_pool::get_user_pool(const mem_buf_desc_t *buff)
+{
+    std::lock_guard<decltype(s_user_pools_lock)> lock(s_user_pools_lock);
+
+    for (buffer_pool *pool : s_user_pools) {
+        if (pool->is_own_buffer(buff)) {
+            return pool;
+        }
+    }
+    // The owner is unknown, so the buffer is leaked rather than mixed with XLIO buffers.
+    __log_info_err("Buffer %p doesn't belong to any user memory pool, dropping it", buff);
+    return NULL;
+}
+
 void buffer_pool::register_memory(ib_ctx_handler *p_ib_ctx_h)
 {
     m_allocator.register_memory(m_size, p_ib_ctx_h, XLIO_IBV_ACCESS_LOCAL_WRITE);
@@ -406,6 +489,17 @@ void buffer_pool::buffersPanic()
 #pragma BullseyeCoverage on
 #endif
 
+inline void buffer_pool::unlock_and_destroy_released()
+{
+    // Once released by its ring, the pool is destroyed by the last returned buffer.
+    bool destroy = unlikely(m_b_released) && m_n_buffers == m_n_buffers_created;
+
+    m_lock.unlock();
+    if (unlikely(destroy)) {
+        delete this;
+    }
+}
+
 inline void buffer_pool::put_buffers(mem_buf_desc_t *buff_list)
 {
     mem_buf_desc_t *next;
@@ -437,14 +531,16 @@ inline void buffer_pool::put_buffers(mem_buf_desc_t **buff_vec, size_t count)
 
 void buffer_pool::put_buffers_thread_safe(mem_buf_desc_t *buff_list)
 {
-    std::lock_guard<decltype(m_lock)> lock(m_lock);
+    m_lock.lock();
     put_buffers(buff_list);
+    unlock_and_destroy_released();
 }
 
 void buffer_pool::put_buffers_thread_safe(mem_buf_desc_t **buff_vec, size_t count)
 {
-    std::lock_guard<decltype(m_lock)> lock(m_lock);
+    m_lock.lock();
     put_buffers(buff_vec, count);
+    unlock_and_destroy_released();
 }
 
 void buffer_pool::put_buffers(descq_t *buffers, size_t count)
@@ -468,8 +564,9 @@ void buffer_pool::put_buffers(descq_t *buffers, size_t count)
 
 void buffer_pool::put_buffers_thread_safe(descq_t *buffers, size_t count)
 {
-    std::lock_guard<decltype(m_lock)> lock(m_lock);
+    m_lock.lock();
     put_buffers(buffers, count);
+    unlock_and_destroy_released();
 }
 
 void buffer_pool::put_buffers_after_deref_thread_safe(descq_t *pDeque)
@@ -504,3 +601,17 @@ void buffer_pool::set_RX_TX_for_stats(bool rx)
         m_p_bpool_stat->is_tx = true;
     }
 }
+
+void buffer_pool::pin_buffer(const mem_buf_desc_t *buff)
+{
+    int pinned = atomic_fetch_and_inc(&m_n_pinned) + 1;
+    m_p_bpool_stat->n_buffer_pool_pinned = pinned;
+    m_p_bpool_stat->n_buffer_pool_pinned_bytes = static_cast<uint64_t>(pinned) * buff->sz_buffer;
+}
+
+void buffer_pool::unpin_buffer(const mem_buf_desc_t *buff)
+{
+    int pinned = atomic_fetch_and_dec(&m_n_pinned) - 1;
+    m_p_bpool_stat->n_buffer_pool_pinned = pinned;
+    m_p_bpool_stat->n_buffer_pool_pinned_bytes = static_cast<uint64_t>(pinned) * buff->sz_buffer;
+}
@@ -34,6 +34,7 @@
 #define BUFFER_POOL_H
 
 #include "utils/lock_wrapper.h"
+#include "utils/atomic.h"
 #include "util/xlio_stats.h"
 #include "proto/mem_buf_desc.h"
 #include "dev/allocator.h"
@@ -88,10 +89,21 @@ typedef xlio_list_t<buffer_pool_area, buffer_pool_area::node_offset> buffer_pool
  */
 class buffer_pool {
 public:
+    /**
+     * @param user_memory When not NULL, buffers are carved from this application
+     *        provided memory instead of being allocated. The descriptors are marked
+     *        with mem_buf_desc_t::USER_MEM and always return to this pool.
+     */
     buffer_pool(size_t buffer_count, size_t size, pbuf_free_custom_fn custom_free_function,
-                alloc_t alloc_func = NULL, free_t free_func = NULL);
+                alloc_t alloc_func = NULL, free_t free_func = NULL, void *user_memory = NULL);
     ~buffer_pool();
 
+    /**
+     * Drop the owner reference of a user memory pool instead of deleting it.
+     * The pool is destroyed when the last buffer held by the application returns.
+     */
+    void release();
+
     void register_memory(ib_ctx_handler *p_ib_ctx_h);
     void print_val_tbl();
 
@@ -131,15 +143,37 @@ public:
 
     void set_RX_TX_for_stats(bool rx);
 
+    inline size_t get_buffer_size() const { return m_buf_size; }
+
+    /**
+     * Account a buffer which was completed by HW but is still referenced
+     * by strides held in the upper layers. Can be called without the pool lock.
+     */
+    void pin_buffer(const mem_buf_desc_t *buff);
+    void unpin_buffer(const mem_buf_desc_t *buff);
+
+    /**
+     * @return True if more buffers are pinned by strides than left free in the pool.
+     */
+    inline bool is_pinned_pressure() const
+    {
+        return atomic_read(&m_n_pinned) > 0 &&
+            static_cast<uint32_t>(atomic_read(&m_n_pinned)) >= m_p_bpool_stat->n_buffer_pool_size;
+    }
+
 private:
     lock_spin m_lock;
     // XXX-dummy buffer list head and count
     // to be replaced with a bucket-sorted array
 
     size_t m_size; /* pool size in bytes */
+    size_t m_buf_size; /* size of a single buffer in bytes */
+    bool m_b_user_memory;
+    bool m_b_released;
     size_t m_n_buffers;
     size_t m_n_buffers_created;
     mem_buf_desc_t *m_p_head;
+    atomic_t m_n_pinned;
 
     bpool_stats_t *m_p_bpool_stat;
     bpool_stats_t m_bpool_stat_static;
@@ -151,6 +185,9 @@ private:
      * Add a buffer to the pool
      */
     inline void put_buffer_helper(mem_buf_desc_t *buff);
+    inline void unlock_and_destroy_released();
+    bool is_own_buffer(const mem_buf_desc_t *buff) const;
+    buffer_pool *get_user_pool(const mem_buf_desc_t *buff);
     void expand(size_t count, void *data, size_t buf_size,
                 pbuf_free_custom_fn custom_free_function);
 
@@ -167,6 +204,7 @@ private:
 
 extern buffer_pool *g_buffer_pool_rx_ptr;
 extern buffer_pool *g_buffer_pool_rx_stride;
+extern buffer_pool *g_buffer_pool_rx_copybreak;
 extern buffer_pool *g_buffer_pool_rx_rwqe;
 extern buffer_pool *g_buffer_pool_tx;
 extern buffer_pool *g_buffer_pool_zc;
@@ -95,7 +95,9 @@ cq_mgr::cq_mgr(ring_simple *p_ring, ib_ctx_handler *p_ib_ctx_handler, int cq_siz
     , m_comp_event_channel(p_comp_event_channel)
     , m_b_notification_armed(false)
     , m_n_sysvar_qp_compensation_level(safe_mce_sys().qp_compensation_level)
-    , m_rx_lkey(g_buffer_pool_rx_rwqe->find_lkey_by_ib_ctx_thread_safe(m_p_ib_ctx_handler))
+    , m_rx_buffer_pool(p_ring->get_rx_user_pool() ? p_ring->get_rx_user_pool()
+                                                  : g_buffer_pool_rx_rwqe)
+    , m_rx_lkey(m_rx_buffer_pool->find_lkey_by_ib_ctx_thread_safe(m_p_ib_ctx_handler))
     , m_b_sysvar_cq_keep_qp_full(safe_mce_sys().cq_keep_qp_full)
     , m_n_out_of_free_bufs_warning(0)
 {
@@ -212,10 +214,10 @@ cq_mgr::~cq_mgr()
         cq_logdbg("Returning %lu buffers to global Rx pool (ready queue %lu, free pool %lu))",
                   m_rx_queue.size() + m_rx_pool.size(), m_rx_queue.size(), m_rx_pool.size());
 
-        g_buffer_pool_rx_rwqe->put_buffers_thread_safe(&m_rx_queue, m_rx_queue.size());
+        m_rx_buffer_pool->put_buffers_thread_safe(&m_rx_queue, m_rx_queue.size());
         m_p_cq_stat->n_rx_sw_queue_len = m_rx_queue.size();
 
-        g_buffer_pool_rx_rwqe->put_buffers_thread_safe(&m_rx_pool, m_rx_pool.size());
+        m_rx_buffer_pool->put_buffers_thread_safe(&m_rx_pool, m_rx_pool.size());
         m_p_cq_stat->n_buffer_pool_len = m_rx_pool.size();
     }
 
@@ -275,7 +277,7 @@ void cq_mgr::add_qp_rx(qp_mgr *qp)
         if (n_num_mem_bufs > qp_rx_wr_num) {
             n_num_mem_bufs = qp_rx_wr_num;
         }
-        bool res = g_buffer_pool_rx_rwqe->get_buffers_thread_safe(temp_desc_list, m_p_ring,
+        bool res = m_rx_buffer_pool->get_buffers_thread_safe(temp_desc_list, m_p_ring,
                                                                   n_num_mem_bufs, m_rx_lkey);
         if (!res) {
             VLOG_PRINTF_INFO_ONCE_THEN_ALWAYS(
@@ -292,7 +294,7 @@ void cq_mgr::add_qp_rx(qp_mgr *qp)
         if (!temp_desc_list.empty()) {
             cq_logdbg("qp post recv is already full (push=%d, planned=%d)",
                       qp->get_rx_max_wr_num() - qp_rx_wr_num, qp->get_rx_max_wr_num());
-            g_buffer_pool_rx_rwqe->put_buffers_thread_safe(&temp_desc_list, temp_desc_list.size());
+            m_rx_buffer_pool->put_buffers_thread_safe(&temp_desc_list, temp_desc_list.size());
             break;
         }
         qp_rx_wr_num -= n_num_mem_bufs;
@@ -348,7 +350,7 @@ bool cq_mgr::request_more_buffers()
 
     // Assume locked!
     // Add an additional free buffer descs to RX cq mgr
-    bool res = g_buffer_pool_rx_rwqe->get_buffers_thread_safe(
+    bool res = m_rx_buffer_pool->get_buffers_thread_safe(
         m_rx_pool, m_p_ring, m_n_sysvar_qp_compensation_level, m_rx_lkey);
     if (!res) {
         cq_logfunc("Out of mem_buf_desc from RX free pool for internal object pool");
@@ -367,7 +369,7 @@ void cq_mgr::return_extra_buffers()
     int buff_to_rel = m_rx_pool.size() - m_n_sysvar_qp_compensation_level;
 
     cq_logfunc("releasing %d buffers to global rx pool", buff_to_rel);
-    g_buffer_pool_rx_rwqe->put_buffers_thread_safe(&m_rx_pool, buff_to_rel);
+    m_rx_buffer_pool->put_buffers_thread_safe(&m_rx_pool, buff_to_rel);
     m_p_cq_stat->n_buffer_pool_len = m_rx_pool.size();
 }
 
@@ -58,6 +58,7 @@ class net_device_mgr;
 class ring;
 class qp_mgr;
 class ring_simple;
+class buffer_pool;
 
 #define LOCAL_IF_INFO_INVALID                                                                      \
     (local_if_info_t) { 0, 0 }
@@ -241,6 +242,7 @@ private:
     struct ibv_comp_channel *m_comp_event_channel;
     bool m_b_notification_armed;
     const uint32_t m_n_sysvar_qp_compensation_level;
+    buffer_pool *const m_rx_buffer_pool; // Source of RX WQE buffers of the ring
     const uint32_t m_rx_lkey;
     const bool m_b_sysvar_cq_keep_qp_full;
     int32_t m_n_out_of_free_bufs_warning;
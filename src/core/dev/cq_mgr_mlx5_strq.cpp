@@ -44,6 +44,9 @@
 
 #define MODULE_NAME "cq_mgr_mlx5_strq"
 
+// Number of copybreak buffers a CQ takes from the global pool at once.
+#define STRQ_COPYBREAK_CACHE_BATCH 64U
+
 #define cq_logfunc    __log_info_func
 #define cq_logdbg     __log_info_dbg
 #define cq_logerr     __log_info_err
@@ -66,6 +69,7 @@ cq_mgr_mlx5_strq::cq_mgr_mlx5_strq(ring_simple *p_ring, ib_ctx_handler *p_ib_ctx
     , _stride_size_bytes(stride_size_bytes)
     , _strides_num(strides_num)
     , _wqe_buff_size_bytes(strides_num * stride_size_bytes)
+    , _copybreak_max(g_buffer_pool_rx_copybreak ? safe_mce_sys().strq_copybreak : 0U)
 {
     cq_logfunc("");
     m_n_sysvar_rx_prefetch_bytes_before_poll =
@@ -99,6 +103,11 @@ cq_mgr_mlx5_strq::~cq_mgr_mlx5_strq()
     }
 
     g_buffer_pool_rx_stride->put_buffers_thread_safe(&_stride_cache, _stride_cache.size());
+
+    if (_copybreak_cache.size()) {
+        g_buffer_pool_rx_copybreak->put_buffers_thread_safe(&_copybreak_cache,
+                                                            _copybreak_cache.size());
+    }
 }
 
 mem_buf_desc_t *cq_mgr_mlx5_strq::next_stride()
@@ -127,6 +136,39 @@ void cq_mgr_mlx5_strq::return_stride(mem_buf_desc_t *desc)
     }
 }
 
+mem_buf_desc_t *cq_mgr_mlx5_strq::copybreak_stride(mem_buf_desc_t *stride)
+{
+    if (unlikely(_copybreak_cache.empty())) {
+        if (!g_buffer_pool_rx_copybreak->get_buffers_thread_safe(
+                _copybreak_cache, _owner_ring, STRQ_COPYBREAK_CACHE_BATCH, 0U)) {
+            // Leave the packet in the RWQE buffer.
+            return stride;
+        }
+    }
+
+    mem_buf_desc_t *desc = _copybreak_cache.get_and_pop_back();
+    memcpy(desc->p_buffer, stride->p_buffer, stride->sz_data);
+    desc->sz_data = stride->sz_data;
+    desc->rx = stride->rx;
+    desc->m_flags |= mem_buf_desc_t::COPYBREAK;
+    ++m_p_cq_stat->n_rx_copybreak_packets;
+
+    // The stride is released right away, so it doesn't hold the RWQE buffer.
+    reclaim_recv_buffer_helper(stride);
+
+    return desc;
+}
+
+void cq_mgr_mlx5_strq::return_copybreak(mem_buf_desc_t *desc)
+{
+    _copybreak_cache.push_back(desc);
+
+    if (unlikely(_copybreak_cache.size() >= STRQ_COPYBREAK_CACHE_BATCH * 2U)) {
+        g_buffer_pool_rx_copybreak->put_buffers_thread_safe(
+            &_copybreak_cache, _copybreak_cache.size() - STRQ_COPYBREAK_CACHE_BATCH);
+    }
+}
+
 uint32_t cq_mgr_mlx5_strq::clean_cq()
 {
     uint32_t ret_total = 0;
@@ -219,6 +261,8 @@ mem_buf_desc_t *cq_mgr_mlx5_strq::poll(enum buff_status_e &status, mem_buf_desc_
             ++m_qp->m_mlx5_qp.rq.tail;
             buff = m_rx_hot_buffer;
             m_rx_hot_buffer = NULL;
+            // The RWQE buffer stays pinned until the last stride is reclaimed.
+            g_buffer_pool_rx_rwqe->pin_buffer(buff);
             if (likely(status == BS_OK)) {
                 ++m_p_cq_stat->n_rx_consumed_rwqe_count;
             }
@@ -231,6 +275,11 @@ mem_buf_desc_t *cq_mgr_mlx5_strq::poll(enum buff_status_e &status, mem_buf_desc_
                 m_p_cq_stat->n_rx_max_stirde_per_packet, _hot_buffer_stride->rx.strides_num);
             buff_stride = _hot_buffer_stride;
             _hot_buffer_stride = nullptr;
+            if (unlikely(_copybreak_max) && status == BS_OK &&
+                buff_stride->sz_data <= _copybreak_max &&
+                g_buffer_pool_rx_rwqe->is_pinned_pressure()) {
+                buff_stride = copybreak_stride(buff_stride);
+            }
         } else if (status != BS_CQE_INVALID) {
             reclaim_recv_buffer_helper(_hot_buffer_stride);
             _hot_buffer_stride = nullptr;
@@ -612,6 +661,7 @@ void cq_mgr_mlx5_strq::statistics_print()
     cq_logdbg_no_funcname("Strides count: %12" PRIu64, m_p_cq_stat->n_rx_stride_count);
     cq_logdbg_no_funcname("LRO packet count: %12" PRIu64, m_p_cq_stat->n_rx_lro_packets);
     cq_logdbg_no_funcname("LRO bytes: %12" PRIu64, m_p_cq_stat->n_rx_lro_bytes);
+    cq_logdbg_no_funcname("Copybreak packets: %12" PRIu64, m_p_cq_stat->n_rx_copybreak_packets);
 }
 
 void cq_mgr_mlx5_strq::reclaim_recv_buffer_helper(mem_buf_desc_t *buff)
@@ -620,17 +670,21 @@ void cq_mgr_mlx5_strq::reclaim_recv_buffer_helper(mem_buf_desc_t *buff)
         if (likely(buff->p_desc_owner == m_p_ring)) {
             mem_buf_desc_t *temp = nullptr;
             while (buff) {
-                if (unlikely(buff->lwip_pbuf.pbuf.desc.attr != PBUF_DESC_STRIDE)) {
-                    __log_info_err("CQ STRQ reclaim_recv_buffer_helper with incompatible "
-                                   "mem_buf_desc_t object");
-                    continue;
-                }
-
-                mem_buf_desc_t *rwqe =
-                    reinterpret_cast<mem_buf_desc_t *>(buff->lwip_pbuf.pbuf.desc.mdesc);
-                if (buff->rx.strides_num == rwqe->add_ref_count(-buff->rx.strides_num)) {
-                    // Is last stride.
-                    cq_mgr::reclaim_recv_buffer_helper(rwqe);
+                bool is_copybreak = (buff->m_flags & mem_buf_desc_t::COPYBREAK);
+                if (likely(!is_copybreak)) {
+                    if (unlikely(buff->lwip_pbuf.pbuf.desc.attr != PBUF_DESC_STRIDE)) {
+                        __log_info_err("CQ STRQ reclaim_recv_buffer_helper with incompatible "
+                                       "mem_buf_desc_t object");
+                        continue;
+                    }
+
+                    mem_buf_desc_t *rwqe =
+                        reinterpret_cast<mem_buf_desc_t *>(buff->lwip_pbuf.pbuf.desc.mdesc);
+                    if (buff->rx.strides_num == rwqe->add_ref_count(-buff->rx.strides_num)) {
+                        // Is last stride.
+                        g_buffer_pool_rx_rwqe->unpin_buffer(rwqe);
+                        cq_mgr::reclaim_recv_buffer_helper(rwqe);
+                    }
                 }
 
                 VLIST_DEBUG_CQ_MGR_PRINT_ERROR_IS_MEMBER;
@@ -642,7 +696,11 @@ void cq_mgr_mlx5_strq::reclaim_recv_buffer_helper(mem_buf_desc_t *buff)
                 temp->p_prev_desc = nullptr;
                 temp->reset_ref_count();
                 free_lwip_pbuf(&temp->lwip_pbuf);
-                return_stride(temp);
+                if (unlikely(is_copybreak)) {
+                    return_copybreak(temp);
+                } else {
+                    return_stride(temp);
+                }
             }
 
             m_p_cq_stat->n_buffer_pool_len = m_rx_pool.size();
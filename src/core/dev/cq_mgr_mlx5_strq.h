@@ -63,6 +63,8 @@ protected:
 private:
     mem_buf_desc_t *next_stride();
     void return_stride(mem_buf_desc_t *desc);
+    mem_buf_desc_t *copybreak_stride(mem_buf_desc_t *stride);
+    void return_copybreak(mem_buf_desc_t *desc);
 
     inline bool set_current_hot_buffer();
     inline bool strq_cqe_to_mem_buff_desc(struct xlio_mlx5_cqe *cqe, enum buff_status_e &status,
@@ -75,11 +77,13 @@ private:
                                                enum buff_status_e status);
 
     descq_t _stride_cache;
+    descq_t _copybreak_cache;
     ring_slave *_owner_ring = nullptr;
     mem_buf_desc_t *_hot_buffer_stride = nullptr;
     const uint32_t _stride_size_bytes;
     const uint32_t _strides_num;
     const uint32_t _wqe_buff_size_bytes;
+    const uint32_t _copybreak_max;
     uint32_t _current_wqe_consumed_bytes = 0U;
 };
 
@@ -564,11 +564,25 @@ void net_device_table_mgr::global_ring_adapt_cq_moderation()
     }
 }
 
+void net_device_table_mgr::global_ring_flush_tx_db()
+{
+    ndtm_logfuncall("");
+
+    net_device_map_index_t::iterator net_dev_iter;
+    for (net_dev_iter = m_net_device_map_index.begin();
+         m_net_device_map_index.end() != net_dev_iter; net_dev_iter++) {
+        net_dev_iter->second->ring_flush_tx_db();
+    }
+}
+
 void net_device_table_mgr::handle_timer_expired(void *user_data)
 {
     int timer_type = (uint64_t)user_data;
     switch (timer_type) {
     case RING_PROGRESS_ENGINE_TIMER:
+        if (tx_db_defer_enabled()) {
+            global_ring_flush_tx_db();
+        }
         global_ring_drain_and_procces();
         break;
     case RING_ADAPT_CQ_MODERATION_TIMER:
@@ -45,6 +45,7 @@
 #include "infra/cache_subject_observer.h"
 #include "net_device_val.h"
 #include "net_device_entry.h"
+#include "ring.h"
 
 typedef std::unordered_map<ip_address, net_device_val *> net_device_map_addr;
 typedef std::unordered_map<int, net_device_val *> net_device_map_index_t;
@@ -97,6 +98,12 @@ public:
 
     void global_ring_adapt_cq_moderation();
 
+    /**
+     * Ring the doorbell of all the rings which have WQEs posted in deferred
+     * doorbell mode (XLIO_TX_DB_DEFER_MAX).
+     */
+    void global_ring_flush_tx_db();
+
     void global_ring_wakeup();
 
     int global_ring_epfd_get();
@@ -131,4 +138,44 @@ private:
 
 extern net_device_table_mgr *g_p_net_device_table_mgr;
 
+/* Event loop boundaries of the calling thread for the deferred TX doorbell mode.
+ * The window is opened when an iomux call returns to the application and closed on the next
+ * iomux entry, so all the doorbells postponed by the application are rung at once.
+ */
+static inline bool tx_db_defer_enabled()
+{
+    // MPW packing happens inside the window only, so XLIO_TX_MPW_INLINE_MAX doesn't open it
+    return safe_mce_sys().tx_db_defer_max;
+}
+
+static inline void tx_db_defer_window_open()
+{
+    g_b_tx_db_defer_window = tx_db_defer_enabled();
+}
+
+static inline void tx_db_defer_window_close()
+{
+    g_b_tx_db_defer_window = false;
+    if (unlikely(g_b_tx_db_pending)) {
+        tx_db_pending_flush();
+    }
+}
+
+/* Burst of sends issued inside the library, such as sendmmsg() or TCP ACKs generated by RX
+ * processing. Opens the window for the burst duration if the caller is not inside one.
+ */
+static inline bool tx_db_defer_burst_begin()
+{
+    bool was_open = g_b_tx_db_defer_window;
+    g_b_tx_db_defer_window = tx_db_defer_enabled();
+    return was_open;
+}
+
+static inline void tx_db_defer_burst_end(bool was_open)
+{
+    if (!was_open) {
+        tx_db_defer_window_close();
+    }
+}
+
 #endif
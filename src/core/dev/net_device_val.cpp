@@ -1275,6 +1275,17 @@ void net_device_val::ring_adapt_cq_moderation()
     }
 }
 
+void net_device_val::ring_flush_tx_db()
+{
+    nd_logfuncall();
+
+    std::lock_guard<decltype(m_lock)> lock(m_lock);
+    rings_hash_map_t::iterator ring_iter;
+    for (ring_iter = m_h_ring_map.begin(); ring_iter != m_h_ring_map.end(); ring_iter++) {
+        THE_RING->flush_tx_db();
+    }
+}
+
 void net_device_val::register_to_ibverbs_events(event_handler_ibverbs *handler)
 {
     for (size_t i = 0; i < m_slaves.size(); i++) {
@@ -1410,13 +1421,17 @@ out:
 ring *net_device_val_eth::create_ring(resource_allocation_key *key)
 {
     ring *ring = NULL;
+    iovec *rx_user_mem = key->get_memory_descriptor();
 
-    NOT_IN_USE(key);
+    if (rx_user_mem->iov_len && m_bond != NO_BOND) {
+        nd_logwarn("RX user memory is not supported for bonding devices, using XLIO buffers");
+    }
 
     try {
         switch (m_bond) {
         case NO_BOND:
-            ring = new ring_eth(get_if_idx());
+            ring = new ring_eth(get_if_idx(), NULL, RING_ETH, true,
+                                rx_user_mem->iov_len ? rx_user_mem : NULL);
             break;
         case ACTIVE_BACKUP:
         case LAG_8023ad:
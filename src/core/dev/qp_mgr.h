@@ -277,6 +277,8 @@ public:
         return true;
     }
     virtual void credits_return(unsigned credits) { NOT_IN_USE(credits); }
+    /* Ring the doorbell for WQEs posted with XLIO_TX_PACKET_DB_DEFER. */
+    virtual void flush_tx_db() {}
     inline unsigned credits_calculate(xlio_ibv_send_wr *p_send_wqe)
     {
         /* Credit is a logical value which is opaque for users. Only qp_mgr can interpret the
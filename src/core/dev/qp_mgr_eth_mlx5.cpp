@@ -51,6 +51,16 @@
 #define OCTOWORD 16
 #define WQEBB    64
 
+#if !defined(MLX5_OPCODE_ENHANCED_MPSW)
+#define MLX5_OPCODE_ENHANCED_MPSW 0x29
+#endif
+
+/* Enhanced MPW session limits: DS field of the control segment is 6 bits wide and
+ * the number of packets per session is limited to keep completion latency low.
+ */
+#define MLX5_MPW_MAX_DS   63
+#define MLX5_MPW_MAX_PKTS 32
+
 //#define DBG_DUMP_WQE	1
 
 #ifdef DBG_DUMP_WQE
@@ -132,6 +142,11 @@ qp_mgr_eth_mlx5::qp_mgr_eth_mlx5(struct qp_mgr_desc *desc, const uint32_t tx_num
     , m_sq_wqe_hot_index(0)
     , m_sq_wqe_counter(0)
     , m_b_fence_needed(false)
+    , m_b_db_defer(false)
+    , m_db_defer_max(safe_mce_sys().tx_db_defer_max)
+    , m_db_pending_wqes(0)
+    , m_db_pending_ctrl(NULL)
+    , m_mpw_inline_max(0)
     , m_dm_enabled(false)
 {
     // Check device capabilities for dummy send support
@@ -146,7 +161,22 @@ qp_mgr_eth_mlx5::qp_mgr_eth_mlx5(struct qp_mgr_desc *desc, const uint32_t tx_num
         (is_bf(((ib_ctx_handler *)desc->slave->p_ib_ctx)->get_ibv_context()) ? MLX5_DB_METHOD_BF
                                                                              : MLX5_DB_METHOD_DB);
 
-    qp_logdbg("m_db_method=%d", m_db_method);
+    memset(&m_mpw, 0, sizeof(m_mpw));
+    if (safe_mce_sys().tx_mpw_inline_max) {
+        struct mlx5dv_context attr_out;
+
+        memset(&attr_out, 0, sizeof(attr_out));
+        if (!m_db_defer_max) {
+            qp_logdbg("Enhanced MPW requires the deferred TX doorbell");
+        } else if (!mlx5dv_query_device(desc->slave->p_ib_ctx->get_ibv_context(), &attr_out) &&
+            (attr_out.flags & MLX5DV_CONTEXT_FLAGS_ENHANCED_MPW)) {
+            m_mpw_inline_max = safe_mce_sys().tx_mpw_inline_max;
+        } else {
+            qp_logdbg("Enhanced MPW is not supported by the device");
+        }
+    }
+
+    qp_logdbg("m_db_method=%d m_mpw_inline_max=%u", m_db_method, m_mpw_inline_max);
 }
 
 void qp_mgr_eth_mlx5::init_qp()
@@ -160,6 +190,9 @@ void qp_mgr_eth_mlx5::init_qp()
     m_sq_wqes_end =
         (uint8_t *)((uintptr_t)m_mlx5_qp.sq.buf + m_mlx5_qp.sq.wqe_cnt * m_mlx5_qp.sq.stride);
     m_sq_wqe_counter = 0;
+    m_db_pending_wqes = 0;
+    m_db_pending_ctrl = NULL;
+    m_mpw.ctrl = NULL;
 
     m_sq_wqe_hot_index = 0;
 
@@ -237,6 +270,8 @@ void qp_mgr_eth_mlx5::up()
 
 void qp_mgr_eth_mlx5::down()
 {
+    flush_tx_db();
+
     if (m_dm_enabled) {
         m_dm_mgr.release_resources();
     }
@@ -407,6 +442,20 @@ inline void qp_mgr_eth_mlx5::ring_doorbell(int db_method, int num_wqebb, int num
     wmb();
     *m_mlx5_qp.sq.dbrec = htonl(m_sq_wqe_counter);
 
+    if (m_b_db_defer) {
+        // The WQE is visible to HW via the DB record, postpone the MMIO write
+        m_db_pending_ctrl = src;
+        ++m_p_ring->m_p_ring_stat->simple.n_tx_db_deferred;
+        if (++m_db_pending_wqes < m_db_defer_max) {
+            return;
+        }
+        db_method = MLX5_DB_METHOD_DB;
+    } else if (unlikely(m_db_pending_wqes)) {
+        // The doorbell covers all the pending WQEs, BF copy of a single WQE is not enough
+        db_method = MLX5_DB_METHOD_DB;
+    }
+    m_db_pending_wqes = 0;
+
     // This wc_wmb ensures ordering between DB record and BF copy
     wc_wmb();
     if (likely(db_method == MLX5_DB_METHOD_BF)) {
@@ -434,6 +483,104 @@ inline void qp_mgr_eth_mlx5::ring_doorbell(int db_method, int num_wqebb, int num
     m_mlx5_qp.bf.offset ^= m_mlx5_qp.bf.size;
 }
 
+void qp_mgr_eth_mlx5::ring_pending_doorbell()
+{
+    uint64_t *dst = (uint64_t *)((uint8_t *)m_mlx5_qp.bf.reg + m_mlx5_qp.bf.offset);
+
+    // DB record has been updated in ring_doorbell() already
+    wc_wmb();
+    *dst = *m_db_pending_ctrl;
+    wc_wmb();
+    m_mlx5_qp.bf.offset ^= m_mlx5_qp.bf.size;
+
+    m_db_pending_wqes = 0;
+    ++m_p_ring->m_p_ring_stat->simple.n_tx_db_flushes;
+}
+
+//! Append a small packet to the enhanced MPW session as an inline data segment
+inline bool qp_mgr_eth_mlx5::mpw_send(xlio_ibv_send_wr *p_send_wqe, uint8_t cs_flags,
+                                      unsigned credits)
+{
+    sg_array sga(p_send_wqe->sg_list, p_send_wqe->num_sge);
+    int data_len = sga.length();
+
+    if (xlio_send_wr_opcode(*p_send_wqe) != XLIO_IBV_WR_SEND || data_len > (int)m_mpw_inline_max) {
+        return false;
+    }
+
+    int seg_size = align_to_octoword_up(data_len + 4);
+    if (m_mpw.ctrl &&
+        (m_mpw.cs_flags != cs_flags || m_mpw.pkts >= MLX5_MPW_MAX_PKTS ||
+         m_mpw.ds + seg_size / OCTOWORD > MLX5_MPW_MAX_DS || m_mpw.cur + seg_size > m_sq_wqes_end)) {
+        mpw_close(true);
+    }
+
+    if (!m_mpw.ctrl) {
+        uint8_t *cur_seg = (uint8_t *)m_sq_wqe_hot + sizeof(struct mlx5_wqe_ctrl_seg) + OCTOWORD;
+        struct mlx5_wqe_eth_seg *eseg;
+
+        // Session doesn't wrap around, such a packet goes through the regular path
+        if (cur_seg + seg_size > m_sq_wqes_end) {
+            return false;
+        }
+
+        m_mpw.ctrl = (struct xlio_mlx5_wqe_ctrl_seg *)m_sq_wqe_hot;
+        m_mpw.ctrl->opmod_idx_opcode =
+            htonl(((m_sq_wqe_counter & 0xffff) << 8) | MLX5_OPCODE_ENHANCED_MPSW);
+        m_sq_wqe_hot->ctrl.data[2] = 0;
+        m_mpw.ctrl->fm_ce_se = 0;
+        m_mpw.ctrl->tis_tir_num = 0;
+
+        // Packets carry their own L2 headers, nothing is inlined into ETH segment
+        eseg = (struct mlx5_wqe_eth_seg *)((uint8_t *)m_sq_wqe_hot + sizeof(*m_mpw.ctrl));
+        *((uint64_t *)eseg) = 0;
+        eseg->rsvd2 = 0;
+        eseg->cs_flags = cs_flags;
+        eseg->inline_hdr_sz = 0;
+
+        m_mpw.cur = cur_seg;
+        m_mpw.ds = (sizeof(struct mlx5_wqe_ctrl_seg) + OCTOWORD) / OCTOWORD;
+        m_mpw.pkts = 0;
+        m_mpw.cs_flags = cs_flags;
+        store_current_wqe_prop(NULL, 0, NULL);
+    }
+
+    *(uint32_t *)m_mpw.cur = htonl(MLX5_INLINE_SEG | data_len);
+    uint8_t *data = m_mpw.cur + 4;
+    for (int i = 0; i < p_send_wqe->num_sge; ++i) {
+        memcpy(data, (void *)(uintptr_t)p_send_wqe->sg_list[i].addr,
+               p_send_wqe->sg_list[i].length);
+        data += p_send_wqe->sg_list[i].length;
+    }
+    m_mpw.cur += seg_size;
+    m_mpw.ds += seg_size / OCTOWORD;
+    ++m_mpw.pkts;
+
+    // Credits are returned with the session completion, the inlined buffer is not needed anymore
+    m_sq_wqe_idx_to_prop[m_sq_wqe_hot_index].credits += credits;
+    mem_buf_desc_t *buf = reinterpret_cast<mem_buf_desc_t *>(p_send_wqe->wr_id);
+    if (buf) {
+        m_p_ring->mem_buf_desc_return_single_locked(buf);
+    }
+    ++m_p_ring->m_p_ring_stat->simple.n_tx_mpw_packets;
+
+    return true;
+}
+
+void qp_mgr_eth_mlx5::mpw_close(bool defer)
+{
+    int wqebbs = align_to_WQEBB_up(m_mpw.ds) / 4;
+
+    m_mpw.ctrl->qpn_ds = htonl((m_mlx5_qp.qpn << 8) | m_mpw.ds);
+    m_mpw.ctrl = NULL;
+    ++m_p_ring->m_p_ring_stat->simple.n_tx_mpw_wqes;
+
+    m_b_db_defer = defer && m_db_defer_max;
+    ring_doorbell(MLX5_DB_METHOD_DB, wqebbs);
+    m_b_db_defer = false;
+    update_next_wqe_hot();
+}
+
 inline int qp_mgr_eth_mlx5::fill_inl_segment(sg_array &sga, uint8_t *cur_seg, uint8_t *data_addr,
                                              int max_inline_len, int inline_len)
 {
@@ -720,6 +867,18 @@ int qp_mgr_eth_mlx5::send_to_wire(xlio_ibv_send_wr *p_send_wqe, xlio_wr_tx_packe
     struct xlio_mlx5_wqe_ctrl_seg *ctrl = NULL;
     struct mlx5_wqe_eth_seg *eseg = NULL;
     uint32_t tisn = tis ? tis->get_tisn() : 0;
+    uint8_t cs_flags = (uint8_t)(attr & (XLIO_TX_PACKET_L3_CSUM | XLIO_TX_PACKET_L4_CSUM) & 0xff);
+
+    if (m_mpw_inline_max && !request_comp && !tis &&
+        (attr & (XLIO_TX_PACKET_MPW | XLIO_TX_PACKET_DB_DEFER)) ==
+            (XLIO_TX_PACKET_MPW | XLIO_TX_PACKET_DB_DEFER)) {
+        if (mpw_send(p_send_wqe, cs_flags, credits)) {
+            return 0;
+        }
+    }
+    if (unlikely(m_mpw.ctrl)) {
+        mpw_close(is_set(attr, XLIO_TX_PACKET_DB_DEFER));
+    }
 
     ctrl = (struct xlio_mlx5_wqe_ctrl_seg *)m_sq_wqe_hot;
     eseg = (struct mlx5_wqe_eth_seg *)((uint8_t *)m_sq_wqe_hot + sizeof(*ctrl));
@@ -739,13 +898,15 @@ int qp_mgr_eth_mlx5::send_to_wire(xlio_ibv_send_wr *p_send_wqe, xlio_wr_tx_packe
      */
     *((uint64_t *)eseg) = 0;
     eseg->rsvd2 = 0;
-    eseg->cs_flags = (uint8_t)(attr & (XLIO_TX_PACKET_L3_CSUM | XLIO_TX_PACKET_L4_CSUM) & 0xff);
+    eseg->cs_flags = cs_flags;
 
     /* Store buffer descriptor */
     store_current_wqe_prop(reinterpret_cast<mem_buf_desc_t *>(p_send_wqe->wr_id), credits, tis);
 
     /* Complete WQE */
+    m_b_db_defer = m_db_defer_max && (attr & XLIO_TX_PACKET_DB_DEFER);
     int wqebbs = fill_wqe(p_send_wqe);
+    m_b_db_defer = false;
     assert(wqebbs > 0 && (unsigned)wqebbs <= credits);
     NOT_IN_USE(wqebbs);
 
@@ -998,6 +1159,8 @@ inline void qp_mgr_eth_mlx5::tls_post_static_params_wqe(xlio_ti *ti,
                                                         uint32_t resync_tcp_sn, bool fence,
                                                         bool is_tx)
 {
+    mpw_flush();
+
     struct mlx5_set_tls_static_params_wqe *wqe =
         reinterpret_cast<struct mlx5_set_tls_static_params_wqe *>(m_sq_wqe_hot);
     struct xlio_mlx5_wqe_ctrl_seg *cseg = &wqe->ctrl.ctrl;
@@ -1105,6 +1268,8 @@ inline void qp_mgr_eth_mlx5::tls_post_progress_params_wqe(xlio_ti *ti, uint32_t
                                                           uint32_t next_record_tcp_sn, bool fence,
                                                           bool is_tx)
 {
+    mpw_flush();
+
     uint16_t num_wqebbs = TLS_SET_PROGRESS_PARAMS_WQEBBS;
 
     struct mlx5_set_tls_progress_params_wqe *wqe =
@@ -1136,6 +1301,8 @@ inline void qp_mgr_eth_mlx5::tls_post_progress_params_wqe(xlio_ti *ti, uint32_t
 inline void qp_mgr_eth_mlx5::tls_get_progress_params_wqe(xlio_ti *ti, uint32_t tirn, void *buf,
                                                          uint32_t lkey)
 {
+    mpw_flush();
+
     uint16_t num_wqebbs = TLS_GET_PROGRESS_WQEBBS;
 
     struct mlx5_get_tls_progress_params_wqe *wqe =
@@ -1297,6 +1464,8 @@ static inline void nvme_fill_progress_wqe(mlx5e_set_nvmeotcp_progress_params_wqe
 
 void qp_mgr_eth_mlx5::nvme_set_static_context(xlio_tis *tis, uint32_t config)
 {
+    mpw_flush();
+
     auto *cseg = wqebb_get<xlio_mlx5_wqe_ctrl_seg *>(0U);
     auto *ucseg = wqebb_get<xlio_mlx5_wqe_umr_ctrl_seg *>(0U, sizeof(*cseg));
 
@@ -1313,6 +1482,8 @@ void qp_mgr_eth_mlx5::nvme_set_static_context(xlio_tis *tis, uint32_t config)
 
 void qp_mgr_eth_mlx5::nvme_set_progress_context(xlio_tis *tis, uint32_t tcp_seqno)
 {
+    mpw_flush();
+
     auto *wqe = reinterpret_cast<mlx5e_set_nvmeotcp_progress_params_wqe *>(m_sq_wqe_hot);
     nvme_fill_progress_wqe(wqe, m_sq_wqe_counter, m_mlx5_qp.qpn, tis->get_tisn(), tcp_seqno,
                            MLX5_FENCE_MODE_INITIATOR_SMALL);
@@ -1354,6 +1525,8 @@ void qp_mgr_eth_mlx5::put_tls_tir_in_cache(xlio_tir *tir)
 
 void qp_mgr_eth_mlx5::post_nop_fence(void)
 {
+    mpw_flush();
+
     struct mlx5_wqe *wqe = reinterpret_cast<struct mlx5_wqe *>(m_sq_wqe_hot);
     struct xlio_mlx5_wqe_ctrl_seg *cseg = &wqe->ctrl;
 
@@ -1373,6 +1546,8 @@ void qp_mgr_eth_mlx5::post_nop_fence(void)
 void qp_mgr_eth_mlx5::post_dump_wqe(xlio_tis *tis, void *addr, uint32_t len, uint32_t lkey,
                                     bool is_first)
 {
+    mpw_flush();
+
     struct mlx5_dump_wqe *wqe = reinterpret_cast<struct mlx5_dump_wqe *>(m_sq_wqe_hot);
     struct xlio_mlx5_wqe_ctrl_seg *cseg = &wqe->ctrl.ctrl;
     struct mlx5_wqe_data_seg *dseg = &wqe->data;
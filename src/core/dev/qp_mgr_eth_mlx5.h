@@ -128,6 +128,13 @@ public:
         return false;
     }
     void credits_return(unsigned credits) override { m_sq_free_credits += credits; }
+    void flush_tx_db() override
+    {
+        mpw_flush();
+        if (m_db_pending_wqes) {
+            ring_pending_doorbell();
+        }
+    }
 
 protected:
     void post_recv_buffer_rq(mem_buf_desc_t *p_mem_buf_desc);
@@ -198,6 +205,15 @@ private:
     inline int fill_wqe_lso(xlio_ibv_send_wr *pswr);
     inline void ring_doorbell(int db_method, int num_wqebb, int num_wqebb_top = 0,
                               bool skip_comp = false);
+    void ring_pending_doorbell();
+    inline bool mpw_send(xlio_ibv_send_wr *p_send_wqe, uint8_t cs_flags, unsigned credits);
+    void mpw_close(bool defer);
+    inline void mpw_flush()
+    {
+        if (unlikely(m_mpw.ctrl)) {
+            mpw_close(false);
+        }
+    }
     inline int fill_inl_segment(sg_array &sga, uint8_t *cur_seg, uint8_t *data_addr,
                                 int max_inline_len, int inline_len);
 
@@ -211,6 +227,29 @@ private:
 
     bool m_b_fence_needed;
 
+    /* Deferred doorbell state, see XLIO_TX_DB_DEFER_MAX.
+     * m_b_db_defer is set by send_to_wire() for the WQE being posted, the doorbell record
+     * is always updated, but the MMIO write is postponed until m_db_defer_max WQEs are
+     * pending or flush_tx_db() is called. m_db_pending_ctrl points to the last posted WQE.
+     */
+    bool m_b_db_defer;
+    uint32_t m_db_defer_max;
+    uint32_t m_db_pending_wqes;
+    uint64_t *m_db_pending_ctrl;
+
+    /* Open enhanced multi-packet send session, see XLIO_TX_MPW_INLINE_MAX.
+     * The session occupies m_sq_wqe_hot and small packets are appended as inline data segments
+     * while the doorbell is deferred. The session is closed before any other WQE is posted.
+     */
+    struct {
+        struct xlio_mlx5_wqe_ctrl_seg *ctrl; // NULL if there is no open session
+        uint8_t *cur; // Next data segment
+        uint16_t ds; // Session size in OCTOWORDs
+        uint16_t pkts;
+        uint8_t cs_flags;
+    } m_mpw;
+    uint32_t m_mpw_inline_max;
+
     bool m_dm_enabled;
     dm_mgr m_dm_mgr;
     /*
@@ -31,13 +31,51 @@
  */
 
 #include "ring.h"
+#include "dev/net_device_table_mgr.h"
 #include "proto/route_table_mgr.h"
+#include "util/epoch_reclaim.h"
 
 #undef MODULE_NAME
 #define MODULE_NAME "ring"
 #undef MODULE_HDR
 #define MODULE_HDR MODULE_NAME "%d:%s() "
 
+__thread bool g_b_tx_db_defer_window = false;
+__thread bool g_b_tx_db_pending = false;
+__thread struct tx_db_pending_rings g_tx_db_pending_rings;
+std::atomic<uint64_t> g_tx_db_ring_gen(0);
+
+void tx_db_pending_flush()
+{
+    struct tx_db_pending_rings *pending = &g_tx_db_pending_rings;
+
+    g_b_tx_db_pending = false;
+
+    // The read section keeps the rings alive, see tx_db_pending_ring_destroy()
+    epoch_reclaim::read_lock();
+    if (likely(pending->gen == g_tx_db_ring_gen.load(std::memory_order_relaxed))) {
+        for (uint32_t i = 0; i < pending->nr; ++i) {
+            pending->rings[i]->flush_tx_db();
+        }
+        epoch_reclaim::read_unlock();
+        return;
+    }
+    epoch_reclaim::read_unlock();
+
+    if (g_p_net_device_table_mgr) {
+        g_p_net_device_table_mgr->global_ring_flush_tx_db();
+    }
+}
+
+void tx_db_pending_ring_destroy()
+{
+    /* Flushers which enter the read section after the update fall back to the global flush,
+     * the ones which are already inside are waited for.
+     */
+    g_tx_db_ring_gen.fetch_add(1, std::memory_order_seq_cst);
+    epoch_reclaim::synchronize();
+}
+
 ring::ring()
     : m_p_n_rx_channel_fds(NULL)
     , m_parent(NULL)
@@ -33,6 +33,7 @@
 #ifndef RING_H
 #define RING_H
 
+#include <atomic>
 #include <memory>
 #include "ib/base/verbs_extra.h"
 #include "proto/flow_tuple.h"
@@ -58,6 +59,57 @@ typedef enum { CQT_RX, CQT_TX } cq_type_t;
 
 typedef size_t ring_user_id_t;
 
+/* Deferred TX doorbell state of the calling thread, see XLIO_TX_DB_DEFER_MAX.
+ * g_b_tx_db_defer_window is set while the thread runs application code between two event
+ * loop iterations. g_b_tx_db_pending is set once the thread has postponed a doorbell.
+ */
+extern __thread bool g_b_tx_db_defer_window;
+extern __thread bool g_b_tx_db_pending;
+
+class ring;
+
+/* Rings on which the calling thread has postponed doorbells, valid while g_b_tx_db_pending is
+ * set. tx_db_pending_flush() rings only their doorbells, unless the list has overflowed or a
+ * ring has been destroyed since the first postponed doorbell (g_tx_db_ring_gen has changed).
+ * Then all the rings are flushed.
+ */
+#define TX_DB_PENDING_RINGS_MAX 4
+
+struct tx_db_pending_rings {
+    ring *rings[TX_DB_PENDING_RINGS_MAX];
+    uint32_t nr;
+    uint64_t gen;
+};
+
+extern __thread struct tx_db_pending_rings g_tx_db_pending_rings;
+extern std::atomic<uint64_t> g_tx_db_ring_gen;
+
+static inline void tx_db_pending_add(ring *p_ring)
+{
+    struct tx_db_pending_rings *pending = &g_tx_db_pending_rings;
+
+    if (!g_b_tx_db_pending) {
+        g_b_tx_db_pending = true;
+        pending->nr = 0;
+        // The ring is referenced by the sending socket and can't be destroyed yet
+        pending->gen = g_tx_db_ring_gen.load(std::memory_order_relaxed);
+    }
+    for (uint32_t i = 0; i < pending->nr; ++i) {
+        if (pending->rings[i] == p_ring) {
+            return;
+        }
+    }
+    if (likely(pending->nr < TX_DB_PENDING_RINGS_MAX)) {
+        pending->rings[pending->nr++] = p_ring;
+    } else {
+        pending->gen = UINT64_MAX;
+    }
+}
+
+void tx_db_pending_flush();
+// Called by a ring which can be in the list of another thread before it's destroyed
+void tx_db_pending_ring_destroy();
+
 /* Ring event completion */
 struct ring_ec {
     struct list_head list;
@@ -142,6 +194,12 @@ public:
     virtual uint16_t get_max_header_sz(void) = 0;
     virtual uint32_t get_tx_lkey(ring_user_id_t id) = 0;
     virtual bool is_tso(void) = 0;
+    /* Whether the ring computes TX checksums in software instead of the NIC. */
+    virtual bool is_tx_sw_csum(ring_user_id_t id)
+    {
+        NOT_IN_USE(id);
+        return false;
+    }
     virtual ib_ctx_handler *get_ctx(ring_user_id_t id) = 0;
 
     virtual int socketxtreme_poll(struct xlio_socketxtreme_completion_t *xlio_completions,
@@ -260,6 +318,7 @@ public:
         return false;
     }
     virtual void credits_return(unsigned credits) { NOT_IN_USE(credits); }
+    virtual void flush_tx_db() {}
 
     struct tcp_seg *get_tcp_segs(uint32_t num);
     void put_tcp_segs(struct tcp_seg *seg);
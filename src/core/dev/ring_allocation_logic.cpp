@@ -55,6 +55,8 @@ ring_allocation_logic::ring_allocation_logic()
     , m_migration_candidate(0)
     , m_active(true)
     , m_res_key()
+    , m_traffic_aware(false)
+    , m_traffic()
 {
     m_type = "";
 }
@@ -66,6 +68,8 @@ ring_allocation_logic::ring_allocation_logic(ring_logic_t allocation_logic,
     , m_ring_migration_ratio(ring_migration_ratio)
     , m_source(source)
     , m_migration_try_count(ring_migration_ratio)
+    , m_traffic_aware(safe_mce_sys().ring_migration_by_traffic)
+    , m_traffic(ring_migration_ratio)
 {
     m_type = "";
 
@@ -150,6 +154,16 @@ bool ring_allocation_logic::should_migrate_ring()
         return false;
     }
 
+    if (m_traffic_aware) {
+        uint64_t new_id = calc_res_key_by_logic();
+        if (!m_traffic.should_migrate(new_id)) {
+            return false;
+        }
+        ral_logdbg("traffic moved from ring of id=%s to ring of id=%lu",
+                   m_res_key.to_str().c_str(), new_id);
+        return true;
+    }
+
     int count_max = m_ring_migration_ratio;
     if (m_migration_candidate) {
         count_max = CANDIDATE_STABILITY_ROUNDS;
@@ -188,6 +202,23 @@ bool ring_allocation_logic::should_migrate_ring()
     return true;
 }
 
+/*
+ * Traffic based migration, see ring_traffic_vote.
+ * The internal thread doesn't vote: it moves data of every socket and its key is never a ring
+ * the socket should follow.
+ */
+void ring_allocation_logic::account_traffic_slow(size_t bytes)
+{
+    if (pthread_equal(pthread_self(), g_n_internal_thread_id)) {
+        return;
+    }
+
+    if (m_traffic.account(calc_res_key_by_logic(), m_res_key.get_user_id_key(), bytes)) {
+        ral_logfunc("traffic window closed, candidate id=%lu wins=%d", m_traffic.get_candidate(),
+                    m_traffic.get_wins());
+    }
+}
+
 const std::string ring_allocation_logic::to_str() const
 {
     std::stringstream ss;
@@ -40,6 +40,8 @@
 #include "xlio_extra.h"
 
 #define CANDIDATE_STABILITY_ROUNDS 20
+// Traffic based migration: windows in a row the candidate must carry twice the owner traffic
+#define TRAFFIC_STABILITY_WINDOWS 2
 #define RAL_STR_MAX_LENGTH         100
 
 #define MAX_CPU CPU_SETSIZE
@@ -62,6 +64,85 @@ public:
     }
 };
 
+/*
+ * Traffic based migration vote (XLIO_RING_MIGRATION_BY_TRAFFIC).
+ * Every access which moves data is weighted by its bytes. A single candidate is tracked with
+ * a majority vote: bytes of the current ring owner are summed apart, bytes of other keys vote
+ * for or against the candidate. At the end of each window of m_window accesses the candidate
+ * wins the window if it carried at least twice the owner traffic. Migration is recommended
+ * after TRAFFIC_STABILITY_WINDOWS wins in a row.
+ */
+class ring_traffic_vote {
+public:
+    ring_traffic_vote(int window = 0)
+        : m_window(window)
+        , m_count(0)
+        , m_wins(0)
+        , m_migrate(false)
+        , m_candidate(0)
+        , m_traffic_own(0)
+        , m_traffic_candidate(0)
+    {
+    }
+
+    // Returns true when the access closes a window
+    bool account(uint64_t key, uint64_t own_key, size_t bytes)
+    {
+        if (key == own_key) {
+            m_traffic_own += bytes;
+        } else if (key == m_candidate) {
+            m_traffic_candidate += bytes;
+        } else if (m_traffic_candidate > bytes) {
+            m_traffic_candidate -= bytes;
+        } else {
+            m_candidate = key;
+            m_traffic_candidate = bytes - m_traffic_candidate;
+        }
+
+        if (++m_count < m_window) {
+            return false;
+        }
+
+        if (m_candidate != own_key && m_traffic_candidate > 0 &&
+            m_traffic_candidate >= 2 * m_traffic_own) {
+            if (++m_wins >= TRAFFIC_STABILITY_WINDOWS) {
+                m_migrate = true;
+            }
+        } else {
+            m_wins = 0;
+            m_migrate = false;
+        }
+        m_count = 0;
+        m_traffic_own = 0;
+        m_traffic_candidate = 0;
+        return true;
+    }
+
+    // Migration is done from the candidate context only, the new key is calculated by the caller
+    bool should_migrate(uint64_t key)
+    {
+        if (!m_migrate || key != m_candidate) {
+            return false;
+        }
+        m_migrate = false;
+        m_wins = 0;
+        m_candidate = 0;
+        return true;
+    }
+
+    uint64_t get_candidate() const { return m_candidate; }
+    int get_wins() const { return m_wins; }
+
+private:
+    int m_window;
+    int m_count;
+    int m_wins;
+    bool m_migrate;
+    uint64_t m_candidate;
+    uint64_t m_traffic_own;
+    uint64_t m_traffic_candidate;
+};
+
 /**
  * this class is responsible for the AL (allocation logic).
  * i gets the AL from the socket\environment variable and return
@@ -82,6 +163,13 @@ public:
     resource_allocation_key *get_key() { return &m_res_key; }
 
     bool should_migrate_ring();
+    // Account bytes consumed or sent by the calling thread (XLIO_RING_MIGRATION_BY_TRAFFIC)
+    inline void account_traffic(size_t bytes)
+    {
+        if (m_traffic_aware && m_active && is_logic_support_migration()) {
+            account_traffic_slow(bytes);
+        }
+    }
     bool is_logic_support_migration()
     {
         return m_res_key.get_ring_alloc_logic() >= RING_LOGIC_PER_THREAD &&
@@ -96,12 +184,17 @@ protected:
     const void *m_owner;
 
 private:
+    void account_traffic_slow(size_t bytes);
+
     int m_ring_migration_ratio;
     source_t m_source;
     int m_migration_try_count;
     uint64_t m_migration_candidate;
     bool m_active;
     resource_allocation_key m_res_key;
+
+    bool m_traffic_aware;
+    ring_traffic_vote m_traffic;
 };
 
 class ring_allocation_logic_rx : public ring_allocation_logic {
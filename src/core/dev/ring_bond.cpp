@@ -359,6 +359,15 @@ void ring_bond::adapt_cq_moderation()
     m_lock_ring_rx.unlock();
 }
 
+void ring_bond::flush_tx_db()
+{
+    std::lock_guard<decltype(m_lock_ring_tx)> lock(m_lock_ring_tx);
+
+    for (uint32_t i = 0; i < m_bond_rings.size(); i++) {
+        m_bond_rings[i]->flush_tx_db();
+    }
+}
+
 mem_buf_desc_t *ring_bond::mem_buf_tx_get(ring_user_id_t id, bool b_block, pbuf_type type,
                                           int n_num_mem_bufs /* default = 1 */)
 {
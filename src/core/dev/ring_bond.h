@@ -62,6 +62,7 @@ public:
     virtual int poll_and_process_element_rx(uint64_t *p_cq_poll_sn, void *pv_fd_ready_array = NULL);
     virtual int poll_and_process_element_tx(uint64_t *p_cq_poll_sn);
     virtual void adapt_cq_moderation();
+    virtual void flush_tx_db();
     virtual bool reclaim_recv_buffers(descq_t *rx_reuse);
     virtual bool reclaim_recv_buffers(mem_buf_desc_t *rx_reuse_lst);
     virtual void mem_buf_rx_release(mem_buf_desc_t *p_mem_buf_desc);
@@ -105,6 +106,7 @@ public:
     virtual uint16_t get_max_header_sz(void);
     virtual uint32_t get_tx_lkey(ring_user_id_t id) { return m_xmit_rings[id]->get_tx_lkey(id); }
     virtual bool is_tso(void);
+    virtual bool is_tx_sw_csum(ring_user_id_t id) { return m_xmit_rings[id]->is_tx_sw_csum(id); }
     int socketxtreme_poll(struct xlio_socketxtreme_completion_t *xlio_completions,
                           unsigned int ncompletions, int flags);
     virtual void slave_create(int if_index) = 0;
@@ -36,6 +36,7 @@
 #include "util/valgrind.h"
 #include "util/sg_array.h"
 #include "sock/fd_collection.h"
+#include "sock/sockinfo_ulp.h"
 #if defined(DEFINED_DIRECT_VERBS)
 #include "dev/qp_mgr_eth_mlx5.h"
 #include "dev/qp_mgr_eth_mlx5_dpcp.h"
@@ -62,6 +63,19 @@
         errno = EAGAIN;                                                                            \
     }
 
+/* Software TLS RX records of the poll are decrypted as a batch before the RX lock is released. */
+template <typename T> static inline int rx_poll_batched(T poll)
+{
+#ifdef DEFINED_UTLS
+    if (tls_rx_batch_begin()) {
+        int ret = poll();
+        tls_rx_batch_end();
+        return ret;
+    }
+#endif /* DEFINED_UTLS */
+    return poll();
+}
+
 /**/
 /** inlining functions can only help if they are implemented before their usage **/
 /**/
@@ -145,6 +159,7 @@ ring_simple::ring_simple(int if_index, ring *parent, ring_type_t type)
     memset(&m_tls, 0, sizeof(m_tls));
 #endif /* DEFINED_UTLS */
     memset(&m_lro, 0, sizeof(m_lro));
+    memset(&m_rx_user_mem, 0, sizeof(m_rx_user_mem));
 
     INIT_LIST_HEAD(&m_socketxtreme.ec_list);
     m_socketxtreme.completion = NULL;
@@ -154,6 +169,10 @@ ring_simple::~ring_simple()
 {
     ring_logdbg("delete ring_simple()");
 
+    if (tx_db_defer_enabled()) {
+        tx_db_pending_ring_destroy();
+    }
+
     // Go over all hash and for each flow: 1.Detach from qp 2.Delete related rfs object 3.Remove
     // flow from hash
     m_lock_ring_rx.lock();
@@ -172,6 +191,12 @@ ring_simple::~ring_simple()
         m_p_qp_mgr = NULL;
     }
 
+    if (m_p_rx_user_pool) {
+        // The application may still hold zero-copy buffers from the pool
+        m_p_rx_user_pool->release();
+        m_p_rx_user_pool = NULL;
+    }
+
     /* coverity[double_lock] TODO: RM#1049980 */
     m_lock_ring_rx.lock();
     m_lock_ring_tx.lock();
@@ -380,6 +405,9 @@ void ring_simple::create_resources()
         g_p_fd_collection->add_cq_channel_fd(m_p_tx_comp_event_channel->fd, this);
     }
 
+    // CQ takes RX buffers from the user memory pool if it exists
+    create_rx_user_pool();
+
     struct qp_mgr_desc desc;
     memset(&desc, 0, sizeof(desc));
     desc.ring = this;
@@ -415,6 +443,37 @@ void ring_simple::create_resources()
     ring_logdbg("new ring_simple() completed");
 }
 
+void ring_simple::create_rx_user_pool()
+{
+    if (!m_rx_user_mem.iov_base || !m_rx_user_mem.iov_len) {
+        return;
+    }
+
+    if (safe_mce_sys().enable_striding_rq) {
+        ring_logwarn("RX user memory is not supported with Striding RQ, using XLIO buffers");
+        return;
+    }
+
+    size_t buf_size = g_buffer_pool_rx_rwqe->get_buffer_size();
+    size_t count = m_rx_user_mem.iov_len / buf_size;
+
+    // Leave room for the alignment of the first buffer
+    count = (count > 1U ? count - 1U : 0U);
+    if (count == 0U) {
+        ring_logwarn("RX user memory %p length %zu is too small for %zu bytes buffers",
+                     m_rx_user_mem.iov_base, m_rx_user_mem.iov_len, buf_size);
+        return;
+    }
+
+    m_p_rx_user_pool =
+        new buffer_pool(count, buf_size, buffer_pool::free_rx_lwip_pbuf_custom, NULL, NULL,
+                        m_rx_user_mem.iov_base);
+    m_p_rx_user_pool->set_RX_TX_for_stats(true);
+
+    ring_logdbg("RX user memory %p length %zu: %zu buffers of %zu bytes", m_rx_user_mem.iov_base,
+                m_rx_user_mem.iov_len, count, buf_size);
+}
+
 int ring_simple::request_notification(cq_type_t cq_type, uint64_t poll_sn)
 {
     int ret = 1;
@@ -434,9 +493,10 @@ int ring_simple::poll_and_process_element_rx(uint64_t *p_cq_poll_sn,
                                              void *pv_fd_ready_array /*NULL*/)
 {
     int ret = 0;
-    RING_TRY_LOCK_RUN_AND_UPDATE_RET(
-        m_lock_ring_rx,
-        m_p_cq_mgr_rx->poll_and_process_element_rx(p_cq_poll_sn, pv_fd_ready_array));
+    RING_TRY_LOCK_RUN_AND_UPDATE_RET(m_lock_ring_rx, rx_poll_batched([&]() {
+                                         return m_p_cq_mgr_rx->poll_and_process_element_rx(
+                                             p_cq_poll_sn, pv_fd_ready_array);
+                                     }));
     return ret;
 }
 
@@ -592,7 +652,9 @@ void ring_simple::mem_buf_desc_return_single_locked(mem_buf_desc_t *buff)
 int ring_simple::drain_and_proccess()
 {
     int ret = 0;
-    RING_TRY_LOCK_RUN_AND_UPDATE_RET(m_lock_ring_rx, m_p_cq_mgr_rx->drain_and_proccess());
+    RING_TRY_LOCK_RUN_AND_UPDATE_RET(m_lock_ring_rx, rx_poll_batched([&]() {
+                                         return m_p_cq_mgr_rx->drain_and_proccess();
+                                     }));
     return ret;
 }
 
@@ -748,6 +810,11 @@ inline int ring_simple::send_buffer(xlio_ibv_send_wr *p_send_wqe, xlio_wr_tx_pac
     int ret = 0;
     unsigned credits = m_p_qp_mgr->credits_calculate(p_send_wqe);
 
+    if (g_b_tx_db_defer_window) {
+        attr = (xlio_wr_tx_packet_attr)(attr | XLIO_TX_PACKET_DB_DEFER);
+        tx_db_pending_add(this);
+    }
+
     if (likely(m_p_qp_mgr->credits_get(credits)) ||
         is_available_qp_wr(is_set(attr, XLIO_TX_PACKET_BLOCK), credits)) {
         ret = m_p_qp_mgr->send(p_send_wqe, attr, tis, credits);
@@ -805,6 +872,9 @@ bool ring_simple::is_available_qp_wr(bool b_block, unsigned credits)
 
     // TODO credits_get() does TX polling. Call current method only for bocking mode?
 
+    // Deferred WQEs are not completed until the doorbell is rung
+    m_p_qp_mgr->flush_tx_db();
+
     do {
         // Try to poll once in the hope that we get space in SQ
         ret = m_p_cq_mgr_tx->poll_and_process_element_tx(&poll_sn);
@@ -285,6 +285,12 @@ public:
         m_p_qp_mgr->credits_return(credits);
     }
 
+    void flush_tx_db() override
+    {
+        std::lock_guard<decltype(m_lock_ring_tx)> lock(m_lock_ring_tx);
+        m_p_qp_mgr->flush_tx_db();
+    }
+
     friend class cq_mgr;
     friend class cq_mgr_mlx5;
     friend class cq_mgr_mlx5_strq;
@@ -300,6 +306,7 @@ public:
 protected:
     virtual qp_mgr *create_qp_mgr(struct qp_mgr_desc *desc) = 0;
     void create_resources();
+    void create_rx_user_pool();
     virtual void init_tx_buffers(uint32_t count);
     void inc_cq_moderation_stats(size_t sz_data) override;
     inline void set_tx_num_wr(uint32_t num_wr) { m_tx_num_wr = num_wr; }
@@ -312,6 +319,7 @@ protected:
     cq_mgr *m_p_cq_mgr_rx;
     cq_mgr *m_p_cq_mgr_tx;
     std::unordered_map<void *, uint32_t> m_user_lkey_map;
+    iovec m_rx_user_mem; // Memory for RX WQE buffers provided by SO_XLIO_RING_USER_MEMORY
 
 private:
     bool is_socketxtreme(void) override { return safe_mce_sys().enable_socketxtreme; }
@@ -449,9 +457,13 @@ private:
 class ring_eth : public ring_simple {
 public:
     ring_eth(int if_index, ring *parent = NULL, ring_type_t type = RING_ETH,
-             bool call_create_res = true)
+             bool call_create_res = true, const iovec *rx_user_mem = NULL)
         : ring_simple(if_index, parent, type)
     {
+        if (rx_user_mem) {
+            m_rx_user_mem = *rx_user_mem;
+        }
+
         net_device_val_eth *p_ndev = dynamic_cast<net_device_val_eth *>(
             g_p_net_device_table_mgr->get_net_device_val(m_parent->get_if_index()));
         if (p_ndev) {
@@ -54,6 +54,7 @@ ring_slave::ring_slave(int if_index, ring *parent, ring_type_t type)
     , m_lock_ring_rx(MULTILOCK_RECURSIVE, "ring_slave:lock_rx")
     , m_lock_ring_tx(MULTILOCK_RECURSIVE, "ring_slave:lock_tx")
     , m_p_ring_stat(new ring_stats_t)
+    , m_p_rx_user_pool(NULL)
     , m_partition(0)
     , m_flow_tag_enabled(false)
     , m_b_sysvar_eth_mc_l2_only_rules(safe_mce_sys().eth_mc_l2_only_rules)
@@ -239,6 +239,7 @@ struct counter_and_ibv_flows {
 typedef std::unordered_map<sock_addr, struct counter_and_ibv_flows> rule_filter_map_t;
 
 class ring_slave;
+class buffer_pool;
 
 template <typename KEY4T, typename KEY2T, typename HDR> class steering_handler {
 public:
@@ -304,6 +305,9 @@ public:
     transport_type_t get_transport_type() const { return m_transport_type; }
     inline ring_type_t get_type() const { return m_type; }
 
+    /* Pool of RX buffers in user memory (SO_XLIO_RING_USER_MEMORY) or NULL */
+    inline buffer_pool *get_rx_user_pool() const { return m_p_rx_user_pool; }
+
     bool m_active; /* State indicator */
 
 protected:
@@ -328,6 +332,7 @@ protected:
     descq_t m_zc_pool;
     transport_type_t m_transport_type; /* transport ETH/IB */
     std::unique_ptr<ring_stats_t> m_p_ring_stat;
+    buffer_pool *m_p_rx_user_pool;
     uint16_t m_partition;
     bool m_flow_tag_enabled;
     const bool m_b_sysvar_eth_mc_l2_only_rules;
@@ -121,6 +121,11 @@ public:
         return 0;
     }
     virtual bool is_tso(void) { return false; }
+    virtual bool is_tx_sw_csum(ring_user_id_t id)
+    {
+        NOT_IN_USE(id);
+        return true;
+    }
 
     inline void set_tap_data_available() { m_tap_data_available = true; }
     inline void set_vf_ring(ring_slave *p_ring) { m_vf_ring = p_ring; }
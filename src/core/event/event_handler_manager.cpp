@@ -257,7 +257,13 @@ event_handler_manager::event_handler_manager()
     m_event_handler_tid = 0;
 
     wakeup_set_epoll_fd(m_epfd);
-    going_to_sleep();
+    // The internal thread is always considered sleeping, it can't work without the wakeup fd
+    BULLSEYE_EXCLUDE_BLOCK_START
+    if (!going_to_sleep()) {
+        free_evh_resources();
+        throw_xlio_exception("wakeup eventfd create failed for the internal thread");
+    }
+    BULLSEYE_EXCLUDE_BLOCK_END
 
     return;
 }
@@ -821,6 +827,9 @@ void event_handler_manager::statistics_print(dump_type_t dump_type, int fd, vlog
         case DUMP_NEIGH:
             // Not implemented yet
             break;
+        case DUMP_LOCKS:
+            lock_profile_dump(log_level);
+            break;
         default:
             evh_logdbg("Impossible statistics dump request (type=%d).", dump_type);
         }
@@ -955,6 +964,11 @@ void *event_handler_manager::thread_loop()
             finit_instrumentation(safe_mce_sys().xlio_time_measure_filename);
 #endif
 
+        // Sockets closed during concurrent lookups are destroyed here, not in the lookups
+        if (g_p_fd_collection) {
+            g_p_fd_collection->reclaim_sockfds();
+        }
+
         // update timer and get timeout
         timeout_msec = m_timer.update_timeout();
         if (timeout_msec == 0) {
@@ -1012,7 +1026,6 @@ void *event_handler_manager::thread_loop()
                 m_p_reg_action_q_to_push_to = m_p_reg_action_q_to_pop_from;
                 m_p_reg_action_q_to_pop_from = temp;
                 return_from_sleep();
-                remove_wakeup_fd();
                 going_to_sleep();
                 m_reg_action_q_lock.unlock();
 
@@ -1043,7 +1056,7 @@ void *event_handler_manager::thread_loop()
 
             evh_logfunc("Processing fd %d", fd);
 
-            if (is_wakeup_fd(fd)) { // the pipe was already handled
+            if (is_wakeup_fd(fd)) { // the wakeup was already handled
                 continue;
             }
 
@@ -36,7 +36,12 @@
 #define MODULE_NAME "epfd_info:"
 
 #define SUPPORTED_EPOLL_EVENTS                                                                     \
-    (EPOLLIN | EPOLLOUT | EPOLLERR | EPOLLHUP | EPOLLRDHUP | EPOLLONESHOT | EPOLLET)
+    (EPOLLIN | EPOLLOUT | EPOLLERR | EPOLLHUP | EPOLLRDHUP | EPOLLONESHOT | EPOLLET |              \
+     EPOLLEXCLUSIVE)
+
+/* Flags which may be combined with EPOLLEXCLUSIVE, see epoll_ctl(2) */
+#define EPOLLEXCLUSIVE_OK_BITS                                                                     \
+    (EPOLLIN | EPOLLOUT | EPOLLERR | EPOLLHUP | EPOLLWAKEUP | EPOLLET | EPOLLEXCLUSIVE)
 
 #define NUM_LOG_INVALID_EVENTS 10
 #define EPFD_MAX_OFFLOADED_STR 150
@@ -62,6 +67,7 @@ epfd_info::epfd_info(int epfd, int size)
     , m_lock_poll_os(MULTILOCK_NON_RECURSIVE, "epfd_lock_poll_os")
     , m_sysvar_thread_mode(safe_mce_sys().thread_mode)
     , m_b_os_data_available(false)
+    , m_pending_fds(NULL)
 {
     __log_funcall("");
     int max_sys_fd = get_sys_max_fd_num();
@@ -105,11 +111,6 @@ epfd_info::~epfd_info()
 
     lock();
 
-    while (!m_ready_fds.empty()) {
-        sock_fd = m_ready_fds.get_and_pop_front();
-        sock_fd->m_epoll_event_flags = 0;
-    }
-
     while (!m_fd_offloaded_list.empty()) {
         sock_fd = m_fd_offloaded_list.get_and_pop_front();
         sock_fd->m_fd_rec.reset();
@@ -133,6 +134,19 @@ epfd_info::~epfd_info()
         BULLSEYE_EXCLUDE_BLOCK_END
     }
 
+    // No socket can notify this epfd anymore, so the pending stack is final
+    sock_fd = m_pending_fds.exchange(NULL, std::memory_order_acquire);
+    while (sock_fd) {
+        socket_fd_api *next = sock_fd->m_ep_pending_next;
+        sock_fd->m_epoll_pending_events.store(0, std::memory_order_relaxed);
+        sock_fd = next;
+    }
+
+    while (!m_ready_fds.empty()) {
+        sock_fd = m_ready_fds.get_and_pop_front();
+        sock_fd->m_epoll_event_flags = 0;
+    }
+
     g_p_event_handler_manager->update_epfd(m_epfd, EPOLL_CTL_DEL,
                                            EPOLLIN | EPOLLPRI | EPOLLONESHOT);
 
@@ -207,6 +221,13 @@ int epfd_info::add_fd(int fd, epoll_event *event)
 
     __log_funcall("fd=%d", fd);
 
+    if ((event->events & EPOLLEXCLUSIVE) &&
+        ((event->events & ~EPOLLEXCLUSIVE_OK_BITS) || fd_collection_get_epfd(fd))) {
+        __log_dbg("invalid EPOLLEXCLUSIVE event mask 0x%x for fd=%d", event->events, fd);
+        errno = EINVAL;
+        return -1;
+    }
+
     socket_fd_api *temp_sock_fd_api = fd_collection_get_sockfd(fd);
     if (temp_sock_fd_api && temp_sock_fd_api->get_type() == FD_TYPE_SOCKET) {
         is_offloaded = true;
@@ -272,9 +293,24 @@ int epfd_info::add_fd(int fd, epoll_event *event)
                           fd, m_epfd, errno);
                 break;
             case ENOMEM:
-                __log_dbg("epoll_ctl: fd=%d is already registered with another epoll instance %d, "
-                          "cannot register to epoll %d (errno=%d %m)",
-                          fd, temp_sock_fd_api->get_epoll_context_fd(), m_epfd, errno);
+                /* EPOLLEXCLUSIVE is meant to balance a socket between several epoll instances.
+                 * An offloaded socket has a single epoll context, so this is not supported.
+                 */
+                if (event->events & EPOLLEXCLUSIVE) {
+                    VLOG_PRINTF_ONCE_THEN_ALWAYS(
+                        VLOG_WARNING, VLOG_DEBUG,
+                        "epoll_ctl: EPOLLEXCLUSIVE is not supported for offloaded fd=%d which is "
+                        "already registered with epoll instance %d, cannot register to epoll %d",
+                        fd, temp_sock_fd_api->get_epoll_context_fd(), m_epfd);
+                    errno = EINVAL;
+                    break;
+                }
+                // E.g. a listen socket shared by workers which own an epfd each
+                VLOG_PRINTF_ONCE_THEN_ALWAYS(
+                    VLOG_WARNING, VLOG_DEBUG,
+                    "epoll_ctl: offloaded fd=%d is already registered with epoll instance %d, "
+                    "cannot register to epoll %d (errno=%d %m)",
+                    fd, temp_sock_fd_api->get_epoll_context_fd(), m_epfd, errno);
                 break;
             default:
                 __log_dbg("epoll_ctl: failed to add fd=%d to epoll epfd=%d (errno=%d %m)", fd,
@@ -428,6 +464,9 @@ int epfd_info::del_fd(int fd, bool passthrough)
         m_ring_map_lock.unlock();
         lock();
 
+        // The socket can still be in the pending stack, flush it before removal
+        drain_pending_events();
+
         m_fd_offloaded_list.erase(temp_sock_fd_api);
         if (passthrough) {
             // In case the socket is not offloaded we must copy it to the non offloaded sockets map.
@@ -485,6 +524,13 @@ int epfd_info::mod_fd(int fd, epoll_event *event)
         return -1;
     }
 
+    // EPOLLEXCLUSIVE is allowed only with EPOLL_CTL_ADD and such fd cannot be modified
+    if ((event->events | fd_rec->events) & EPOLLEXCLUSIVE) {
+        __log_dbg("cannot modify fd=%d with EPOLLEXCLUSIVE", fd);
+        errno = EINVAL;
+        return -1;
+    }
+
     socket_fd_api *temp_sock_fd_api = fd_collection_get_sockfd(fd);
     // check if fd is offloaded that new event mask is OK
     if (temp_sock_fd_api && temp_sock_fd_api->m_fd_rec.offloaded_index > 0) {
@@ -577,15 +623,70 @@ void epfd_info::fd_closed(int fd, bool passthrough)
 
 void epfd_info::insert_epoll_event_cb(socket_fd_api *sock_fd, uint32_t event_flags)
 {
-    lock();
-    // EPOLLHUP | EPOLLERR are reported without user request
-    if (event_flags & (sock_fd->m_fd_rec.events | EPOLLHUP | EPOLLERR)) {
-        insert_epoll_event(sock_fd, event_flags);
+    /* Called by a socket on state change. The events are OR-ed into the socket and the socket is
+     * pushed to the lock-free pending stack on the first event since the last harvest, so the
+     * socket does not contend with epoll_wait() threads on the epfd lock. The harvesting thread
+     * merges the pending stack into m_ready_fds with drain_pending_events().
+     */
+
+    // EPOLLHUP | EPOLLERR are reported without user request unless EPOLLONESHOT fd is disarmed
+    if (sock_fd->m_fd_rec.is_disarmed() ||
+        !(event_flags & (sock_fd->m_fd_rec.events | EPOLLHUP | EPOLLERR))) {
+        return;
+    }
+
+    if (sock_fd->m_epoll_pending_events.fetch_or(event_flags, std::memory_order_acq_rel) == 0) {
+        socket_fd_api *head = m_pending_fds.load(std::memory_order_relaxed);
+        do {
+            sock_fd->m_ep_pending_next = head;
+        } while (!m_pending_fds.compare_exchange_weak(head, sock_fd, std::memory_order_release,
+                                                      std::memory_order_relaxed));
+    }
+
+    // Pairs with epoll_wait_call::_wait(): either we see the sleeper or it sees the event
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (m_is_sleeping) {
+        lock();
+        if (sock_fd->m_fd_rec.events & EPOLLEXCLUSIVE) {
+            do_wakeup_one();
+        } else {
+            do_wakeup();
+        }
+        unlock();
     }
-    unlock();
 }
 
-void epfd_info::insert_epoll_event(socket_fd_api *sock_fd, uint32_t event_flags)
+void epfd_info::drain_pending_events()
+{
+    // assumed lock
+    socket_fd_api *sock_fd = m_pending_fds.exchange(NULL, std::memory_order_acquire);
+    socket_fd_api *fifo = NULL;
+
+    // The stack is LIFO, reverse it to keep the ready list in arrival order
+    while (sock_fd) {
+        socket_fd_api *next = sock_fd->m_ep_pending_next;
+        sock_fd->m_ep_pending_next = fifo;
+        fifo = sock_fd;
+        sock_fd = next;
+    }
+
+    while (fifo) {
+        sock_fd = fifo;
+        // Read the link before clearing the events, the socket can be pushed again afterwards
+        fifo = sock_fd->m_ep_pending_next;
+        uint32_t event_flags =
+            sock_fd->m_epoll_pending_events.exchange(0, std::memory_order_acq_rel);
+
+        if (sock_fd->get_epoll_context_fd() != m_epfd || sock_fd->m_fd_rec.is_disarmed()) {
+            continue;
+        }
+        if (event_flags & (sock_fd->m_fd_rec.events | EPOLLHUP | EPOLLERR)) {
+            insert_ready_fd(sock_fd, event_flags);
+        }
+    }
+}
+
+void epfd_info::insert_ready_fd(socket_fd_api *sock_fd, uint32_t event_flags)
 {
     // assumed lock
     if (sock_fd->ep_ready_fd_node.is_list_member()) {
@@ -594,8 +695,18 @@ void epfd_info::insert_epoll_event(socket_fd_api *sock_fd, uint32_t event_flags)
         sock_fd->m_epoll_event_flags = event_flags;
         m_ready_fds.push_back(sock_fd);
     }
+}
+
+void epfd_info::insert_epoll_event(socket_fd_api *sock_fd, uint32_t event_flags)
+{
+    // assumed lock
+    insert_ready_fd(sock_fd, event_flags);
 
-    do_wakeup();
+    if (sock_fd->m_fd_rec.events & EPOLLEXCLUSIVE) {
+        do_wakeup_one();
+    } else {
+        do_wakeup();
+    }
 }
 
 void epfd_info::remove_epoll_event(socket_fd_api *sock_fd, uint32_t event_flags)
@@ -842,6 +953,14 @@ void epfd_info::statistics_print(vlog_levels_t log_level /* = VLOG_DEBUG */)
                         temp_iomux_stats.n_iomux_poll_miss, temp_iomux_stats.n_iomux_poll_hit,
                         iomux_poll_hit_percentage);
 
+            if (temp_iomux_stats.n_iomux_spin_usec + temp_iomux_stats.n_iomux_sleep_usec) {
+                vlog_printf(log_level, "Spin / Sleep [usec] : %" PRIu64 " / %" PRIu64 "\n",
+                            temp_iomux_stats.n_iomux_spin_usec,
+                            temp_iomux_stats.n_iomux_sleep_usec);
+                vlog_printf(log_level, "Poll budget : %u usec\n",
+                            temp_iomux_stats.n_iomux_poll_budget);
+            }
+
             if (temp_iomux_stats.n_iomux_timeouts) {
                 vlog_printf(log_level, "Timeouts : %u\n", temp_iomux_stats.n_iomux_timeouts);
             }
@@ -33,7 +33,8 @@
 #ifndef _EPFD_INFO_H
 #define _EPFD_INFO_H
 
-#include <util/wakeup_pipe.h>
+#include <atomic>
+#include <util/wakeup_eventfd.h>
 #include <sock/cleanable_obj.h>
 #include <sock/sockinfo.h>
 
@@ -43,7 +44,7 @@ typedef std::unordered_map<int, epoll_fd_rec> fd_info_map_t;
 typedef std::unordered_map<ring *, int /*ref count*/> ring_map_t;
 typedef std::deque<int> ready_cq_fd_q_t;
 
-class epfd_info : public lock_mutex_recursive, public cleanable_obj, public wakeup_pipe {
+class epfd_info : public lock_mutex_recursive, public cleanable_obj, public wakeup_eventfd {
 public:
     epfd_info(int epfd, int size);
     ~epfd_info();
@@ -84,6 +85,20 @@ public:
 
     ep_ready_fd_list_t m_ready_fds;
 
+    /**
+     * Move events published by sockets with insert_epoll_event_cb() to m_ready_fds.
+     * Must be called under the epfd lock.
+     */
+    void drain_pending_events();
+
+    /**
+     * Lockless check whether there are ready or published events.
+     */
+    inline bool has_ready_fds()
+    {
+        return !m_ready_fds.empty() || m_pending_fds.load(std::memory_order_acquire);
+    }
+
     /**
      * @return Pointer to statistics block for this group
      */
@@ -135,6 +150,8 @@ private:
     epoll_stats_t *m_stats;
     int m_log_invalid_events;
     bool m_b_os_data_available; // true when non offloaded data is available
+    // Lock-free MPSC stack of sockets with published events, consumed by drain_pending_events()
+    std::atomic<socket_fd_api *> m_pending_fds;
 
     int add_fd(int fd, epoll_event *event);
     int del_fd(int fd, bool passthrough = false);
@@ -147,6 +164,7 @@ public:
     inline size_t get_fd_offloaded_size() { return m_fd_offloaded_list.size(); }
     void insert_epoll_event_cb(socket_fd_api *sock_fd, uint32_t event_flags);
     void insert_epoll_event(socket_fd_api *sock_fd, uint32_t event_flags);
+    void insert_ready_fd(socket_fd_api *sock_fd, uint32_t event_flags);
     void remove_epoll_event(socket_fd_api *sock_fd, uint32_t event_flags);
     void increase_ring_ref_count(ring *ring);
     void decrease_ring_ref_count(ring *ring);
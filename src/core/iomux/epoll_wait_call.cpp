@@ -38,6 +38,7 @@
 #include <sock/sock-redirect.h>
 #include <sock/socket_fd_api.h>
 #include <sock/fd_collection.h>
+#include <dev/net_device_table_mgr.h>
 
 #include "epfd_info.h"
 
@@ -81,12 +82,13 @@ void epoll_wait_call::init_offloaded_fds()
 
 int epoll_wait_call::get_current_events()
 {
-    if (m_epfd_info->m_ready_fds.empty()) {
+    if (!m_epfd_info->has_ready_fds()) {
         return m_n_all_ready_fds;
     }
 
     xlio_list_t<socket_fd_api, socket_fd_api::socket_fd_list_node_offset> socket_fd_list;
     lock();
+    m_epfd_info->drain_pending_events();
     int i, ready_rfds = 0, ready_wfds = 0;
     i = m_n_all_ready_fds;
     socket_fd_api *p_socket_object;
@@ -110,9 +112,31 @@ int epoll_wait_call::get_current_events()
             mutual_events &= ~EPOLLOUT;
         }
 
+        if (p_socket_object->m_fd_rec.events & EPOLLET) {
+            /* Edge triggered events are cached by the socket at the point of state change, so
+             * they are reported as is without querying the socket.
+             */
+            m_epfd_info->remove_epoll_event(p_socket_object,
+                                            p_socket_object->m_epoll_event_flags);
+            if (mutual_events) {
+                m_events[i].data = p_socket_object->m_fd_rec.epdata;
+                m_events[i].events = mutual_events;
+                ready_rfds += !!(mutual_events & EPOLLIN);
+                ready_wfds += !!(mutual_events & EPOLLOUT);
+                got_event = true;
+            }
+            mutual_events = 0;
+        }
+
+        /* Level triggered events which the socket keeps in m_epoll_level_events are reported
+         * without a call to the socket. The others are verified, the fd leaves the ready list
+         * when they are not ready anymore.
+         */
+        uint32_t level = p_socket_object->m_epoll_level_events.load(std::memory_order_relaxed);
+
         if (mutual_events & EPOLLIN) {
-            if (handle_epoll_event(p_socket_object->is_readable(NULL), EPOLLIN, p_socket_object,
-                                   i)) {
+            if (handle_epoll_event((level & EPOLLIN) || p_socket_object->is_readable(NULL),
+                                   EPOLLIN, p_socket_object, i)) {
                 ready_rfds++;
                 got_event = true;
             }
@@ -120,7 +144,8 @@ int epoll_wait_call::get_current_events()
         }
 
         if (mutual_events & EPOLLOUT) {
-            if (handle_epoll_event(p_socket_object->is_writeable(), EPOLLOUT, p_socket_object, i)) {
+            if (handle_epoll_event((level & EPOLLOUT) || p_socket_object->is_writeable(), EPOLLOUT,
+                                   p_socket_object, i)) {
                 ready_wfds++;
                 got_event = true;
             }
@@ -130,8 +155,8 @@ int epoll_wait_call::get_current_events()
         // handle zcopy notification mechanism
         if (mutual_events & EPOLLERR) {
             int unused;
-            if (handle_epoll_event(p_socket_object->is_errorable(&unused), EPOLLERR,
-                                   p_socket_object, i)) {
+            if (handle_epoll_event((level & EPOLLERR) || p_socket_object->is_errorable(&unused),
+                                   EPOLLERR, p_socket_object, i)) {
                 got_event = true;
             }
             mutual_events &= ~EPOLLERR;
@@ -144,6 +169,14 @@ int epoll_wait_call::get_current_events()
         }
 
         if (got_event) {
+            if (p_socket_object->m_fd_rec.events & EPOLLONESHOT) {
+                // Like the kernel, disarm the whole fd after reporting it once
+                p_socket_object->m_fd_rec.disarm();
+                if (p_socket_object->ep_ready_fd_node.is_list_member()) {
+                    m_epfd_info->remove_epoll_event(p_socket_object,
+                                                    p_socket_object->m_epoll_event_flags);
+                }
+            }
             socket_fd_list.push_back(p_socket_object);
             ++i;
         }
@@ -191,10 +224,16 @@ bool epoll_wait_call::_wait(int timeout)
 
     if (timeout) {
         lock();
-        if (m_epfd_info->m_ready_fds.empty()) {
-            m_epfd_info->going_to_sleep();
-        } else {
+        if (!m_epfd_info->going_to_sleep()) {
+            // Nothing can wake us up, keep polling
             timeout = 0;
+        } else {
+            // Pairs with epfd_info::insert_epoll_event_cb() which publishes events without the lock
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (m_epfd_info->has_ready_fds()) {
+                m_epfd_info->return_from_sleep();
+                timeout = 0;
+            }
         }
         unlock();
     }
@@ -223,9 +262,6 @@ bool epoll_wait_call::_wait(int timeout)
 
         // wakeup event
         if (m_epfd_info->is_wakeup_fd(fd)) {
-            lock();
-            m_epfd_info->remove_wakeup_fd();
-            unlock();
             continue;
         }
 
@@ -352,10 +388,6 @@ bool epoll_wait_call::handle_epoll_event(bool is_ready, uint32_t events,
         m_events[index].data = fd_rec.epdata;
         m_events[index].events |= events;
 
-        if (fd_rec.events & EPOLLONESHOT) {
-            // Clear events for this fd
-            fd_rec.events &= ~events;
-        }
         if (fd_rec.events & EPOLLET) {
             m_epfd_info->remove_epoll_event(socket_object, events);
         }
@@ -405,7 +437,10 @@ bool epoll_wait_call::handle_os_countdown(int &poll_os_countdown)
 
 int epoll_wait_call::ring_poll_and_process_element()
 {
-    return m_epfd_info->ring_poll_and_process_element(&m_poll_sn, NULL);
+    bool was_open = tx_db_defer_burst_begin();
+    int ret = m_epfd_info->ring_poll_and_process_element(&m_poll_sn, NULL);
+    tx_db_defer_burst_end(was_open);
+    return ret;
 }
 
 int epoll_wait_call::ring_request_notification()
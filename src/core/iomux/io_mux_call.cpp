@@ -36,6 +36,7 @@
 #include "vlogger/vlogger.h"
 #include <util/sys_vars.h>
 #include <sock/fd_collection.h>
+#include <sock/sockinfo_tcp.h>
 #include <dev/net_device_table_mgr.h>
 #include "util/instrumentation.h"
 
@@ -50,6 +51,12 @@ uint64_t g_polling_time_usec = 0; // polling time in the last second in usec
 timeval g_last_zero_polling_time; // the last time g_polling_time_usec was zeroed
 int g_n_last_checked_index = 0; // save the last fd index we checked in check_offloaded_rsockets()
 
+// Moving average of the time to the next event of this thread, used by poll_budget()
+static __thread uint32_t g_iomux_event_gap_usec = 0;
+#define IOMUX_EVENT_GAP_EWMA_SHIFT 3
+// Samples are capped to recover quickly from idle periods
+#define IOMUX_EVENT_GAP_MAX_FACTOR 4
+
 #define MODULE_NAME "io_mux_call:"
 
 int io_mux_call::m_n_skip_os_count = 0;
@@ -84,6 +91,44 @@ inline void io_mux_call::check_rfd_ready_array(fd_array_t *fd_ready_array)
     // return false;
 }
 
+inline int32_t io_mux_call::poll_budget()
+{
+    if (!m_b_sysvar_select_poll_adaptive || m_n_sysvar_select_poll_num <= 0 ||
+        !g_iomux_event_gap_usec) {
+        return m_n_sysvar_select_poll_num;
+    }
+
+    if (g_iomux_event_gap_usec > (uint32_t)m_n_sysvar_select_poll_num) {
+        // Events are rarer than the polling budget - arm and block right away
+        return 0;
+    }
+
+    // Spin twice the expected gap to absorb jitter
+    return (int32_t)std::min<uint32_t>(g_iomux_event_gap_usec * 2, m_n_sysvar_select_poll_num);
+}
+
+inline void io_mux_call::poll_budget_update(int64_t spin_usec)
+{
+    timer_update();
+    int64_t total_usec = tv_to_usec(&m_elapsed);
+    int64_t max_usec = (int64_t)m_n_sysvar_select_poll_num * IOMUX_EVENT_GAP_MAX_FACTOR;
+    uint32_t sample = (uint32_t)std::min(total_usec, max_usec);
+
+    /* A call without events only tells that the gap is at least the elapsed time,
+     * e.g. a zero timeout call must not pull the average down.
+     */
+    if (m_n_all_ready_fds || sample > g_iomux_event_gap_usec) {
+        g_iomux_event_gap_usec = g_iomux_event_gap_usec -
+            (g_iomux_event_gap_usec >> IOMUX_EVENT_GAP_EWMA_SHIFT) +
+            (sample >> IOMUX_EVENT_GAP_EWMA_SHIFT);
+    }
+
+    spin_usec = std::min(spin_usec, total_usec);
+    m_p_stats->n_iomux_spin_usec += (uint64_t)spin_usec;
+    m_p_stats->n_iomux_sleep_usec += (uint64_t)(total_usec - spin_usec);
+    m_p_stats->n_iomux_poll_budget = (uint32_t)poll_budget();
+}
+
 inline void io_mux_call::check_offloaded_wsockets()
 {
     for (int offloaded_index = 0; offloaded_index < *m_p_num_all_offloaded_fds; ++offloaded_index) {
@@ -173,6 +218,7 @@ io_mux_call::io_mux_call(int *off_fds_buffer, offloaded_mode_t *off_modes_buffer
     , m_n_sysvar_select_poll_num(safe_mce_sys().select_poll_num)
     , m_b_sysvar_select_poll_os_force(safe_mce_sys().select_poll_os_force)
     , m_b_sysvar_select_handle_cpu_usage_stats(safe_mce_sys().select_handle_cpu_usage_stats)
+    , m_b_sysvar_select_poll_adaptive(safe_mce_sys().select_poll_adaptive)
     , m_p_all_offloaded_fds(off_fds_buffer)
     , m_p_offloaded_modes(off_modes_buffer)
     , m_num_all_offloaded_fds(0)
@@ -198,6 +244,13 @@ io_mux_call::io_mux_call(int *off_fds_buffer, offloaded_mode_t *off_modes_buffer
 
     m_fd_ready_array.fd_max = FD_ARRAY_MAX;
     m_fd_ready_array.fd_count = 0;
+
+    tx_db_defer_window_close();
+}
+
+io_mux_call::~io_mux_call()
+{
+    tx_db_defer_window_open();
 }
 
 void io_mux_call::check_offloaded_rsockets()
@@ -297,13 +350,15 @@ void io_mux_call::polling_loops()
     ZERO_POLL_COUNT;
 #endif
 
+    int32_t poll_num = poll_budget();
+
     poll_counter = 0;
-    finite_polling = m_n_sysvar_select_poll_num != -1;
-    multiple_polling_loops = m_n_sysvar_select_poll_num != 0;
+    finite_polling = poll_num != -1;
+    multiple_polling_loops = poll_num != 0;
 
     timeval poll_duration;
     tv_clear(&poll_duration);
-    poll_duration.tv_usec = m_n_sysvar_select_poll_num;
+    poll_duration.tv_usec = poll_num;
 
     __if_dbg("2nd scenario start");
 
@@ -480,8 +535,17 @@ int io_mux_call::call()
 {
     // TODO: need stats adjustments for write...
 
+    int64_t spin_usec = 0;
+
     __log_funcall("");
 
+    thread_tcp_timers_progress();
+
+    if (m_b_sysvar_select_poll_adaptive) {
+        // Start the timer to measure the time to the next event
+        timer_update();
+    }
+
     if (!m_b_sysvar_select_poll_os_force // TODO: evaluate/consider this logic
         && (*m_p_num_all_offloaded_fds == 0)) {
         // 1st scenario
@@ -512,6 +576,11 @@ int io_mux_call::call()
     // 2nd scenario
     polling_loops();
 
+    if (m_b_sysvar_select_poll_adaptive) {
+        timer_update();
+        spin_usec = tv_to_usec(&m_elapsed);
+    }
+
     // 3rd scenario
     if (!m_n_all_ready_fds && !is_timeout(m_elapsed)) {
         blocking_loops();
@@ -519,6 +588,10 @@ int io_mux_call::call()
 
 done:
 
+    if (m_b_sysvar_select_poll_adaptive) {
+        poll_budget_update(spin_usec);
+    }
+
     if (m_n_all_ready_fds == 0) { // TODO: check
         // An error throws an exception
         ++m_p_stats->n_iomux_timeouts;
@@ -560,7 +633,10 @@ bool io_mux_call::immidiate_return(int &poll_os_countdown)
 int io_mux_call::ring_poll_and_process_element()
 {
     // TODO: (select, poll) this access all CQs, it is better to check only relevant ones
-    return g_p_net_device_table_mgr->global_ring_poll_and_process_element(&m_poll_sn, NULL);
+    bool was_open = tx_db_defer_burst_begin();
+    int ret = g_p_net_device_table_mgr->global_ring_poll_and_process_element(&m_poll_sn, NULL);
+    tx_db_defer_burst_end(was_open);
+    return ret;
 }
 
 int io_mux_call::ring_request_notification()
@@ -78,7 +78,7 @@ public:
      */
     io_mux_call(int *off_fds_buffer, offloaded_mode_t *off_modes_buffer, int num_fds = 0,
                 const sigset_t *sigmask = NULL); // = 0 is only temp
-    virtual ~io_mux_call() {};
+    virtual ~io_mux_call();
 
     /**
      * Sets an offloaded file descriptor as ready.
@@ -216,6 +216,21 @@ private:
      */
     inline void zero_polling_cpu(timeval current);
 
+    /**
+     * Adaptive polling governor (XLIO_SELECT_POLL_ADAPTIVE).
+     * Choose the polling duration of this call from the per thread average time to the next
+     * event: poll a bit longer than the expected gap, or block right away if events are rarer
+     * than XLIO_SELECT_POLL.
+     * @return Polling duration in usec, the same semantics as XLIO_SELECT_POLL.
+     */
+    inline int32_t poll_budget();
+
+    /**
+     * Feed the time spent in this call back to the governor and update spin/sleep statistics.
+     * @param spin_usec Time spent in the polling loops.
+     */
+    inline void poll_budget_update(int64_t spin_usec);
+
     /**
      * Go over fd_ready_array and set all fd's in it as ready.
      * @return Whether anything was found in the array.
@@ -237,6 +252,7 @@ private:
     const int32_t m_n_sysvar_select_poll_num;
     const bool m_b_sysvar_select_poll_os_force;
     const bool m_b_sysvar_select_handle_cpu_usage_stats;
+    const bool m_b_sysvar_select_poll_adaptive;
 
 public:
 protected:
@@ -32,6 +32,7 @@
 
 #include "poll_call.h"
 
+#include <vector>
 #include <vlogger/vlogger.h>
 #include <util/vtypes.h>
 #include <sock/socket_fd_api.h>
@@ -43,6 +44,24 @@
 
 iomux_func_stats_t g_poll_stats;
 
+/*
+ * Per-thread classification of the last pollfd array. Applications usually call poll() with
+ * the same array in a loop, so the lookup of every fd in fd_collection is done only when the
+ * fds/events or the fd_collection generation change.
+ */
+struct poll_sig_cache {
+    uint64_t sockfd_gen;
+    std::vector<uint64_t> signature; // (fd << 32 | events) per pollfd entry
+    std::vector<nfds_t> offloaded_idx; // Entries of offloaded sockets with read/write events
+};
+
+static thread_local poll_sig_cache t_poll_cache;
+
+static inline uint64_t pollfd_signature(const pollfd &pfd)
+{
+    return ((uint64_t)(uint32_t)pfd.fd << 32) | (uint16_t)pfd.events;
+}
+
 poll_call::poll_call(int *off_rfds_buffer, offloaded_mode_t *off_modes_buffer, int *lookup_buffer,
                      pollfd *working_fds_arr, pollfd *fds, nfds_t nfds, int timeout,
                      const sigset_t *__sigmask /* = NULL */)
@@ -52,65 +71,43 @@ poll_call::poll_call(int *off_rfds_buffer, offloaded_mode_t *off_modes_buffer, i
     , m_lookup_buffer(lookup_buffer)
     , m_orig_fds(fds)
 {
+    poll_sig_cache &cache = t_poll_cache;
+    uint64_t sockfd_gen = fd_collection_get_sockfd_gen();
+    bool cache_hit = (cache.sockfd_gen == sockfd_gen && cache.signature.size() == m_nfds);
     nfds_t i;
-    int fd;
+
     m_fds = NULL;
 
     // create stats
     m_p_stats = &g_poll_stats;
     xlio_stats_instance_get_poll_block(m_p_stats);
 
-    // Collect offloaded fds and remove all tcp (skip_os) sockets from m_fds
+    // Very important to initialize revents to 0 it is not done be default
     for (i = 0; i < m_nfds; ++i) {
-        // Very important to initialize this to 0 it is not done be default
         m_orig_fds[i].revents = 0;
+        cache_hit = cache_hit && cache.signature[i] == pollfd_signature(m_orig_fds[i]);
+    }
 
-        // We need to initialize m_fds[i].revents in case we already copied it from m_orig_fds
-        if (m_fds) {
-            m_fds[i].revents = 0;
-        }
-
-        fd = m_orig_fds[i].fd;
-        socket_fd_api *temp_sock_fd_api = fd_collection_get_sockfd(fd);
-        if (temp_sock_fd_api && (temp_sock_fd_api->get_type() == FD_TYPE_SOCKET)) {
-            offloaded_mode_t off_mode = OFF_NONE;
-            if (m_orig_fds[i].events & (POLLIN | POLLERR | POLLHUP)) {
-                off_mode = (offloaded_mode_t)(off_mode | OFF_READ);
+    if (cache_hit) {
+        for (nfds_t idx : cache.offloaded_idx) {
+            socket_fd_api *temp_sock_fd_api = fd_collection_get_sockfd(m_orig_fds[idx].fd);
+            if (likely(temp_sock_fd_api)) {
+                add_offloaded_fd(idx, temp_sock_fd_api, working_fds_arr);
             }
-            if (m_orig_fds[i].events & POLLOUT) {
-                off_mode = (offloaded_mode_t)(off_mode | OFF_WRITE);
-            }
-
-            if (off_mode) {
-                __log_func("---> fd=%d IS SET for read or write!", fd);
-                m_lookup_buffer[m_num_all_offloaded_fds] = i;
-                m_p_all_offloaded_fds[m_num_all_offloaded_fds] = fd;
-                m_p_offloaded_modes[m_num_all_offloaded_fds] = off_mode;
-                ++m_num_all_offloaded_fds;
-
-                // We will do copy only in case we have at least one offloaded socket
-                if (!m_fds) {
-                    m_fds = working_fds_arr;
-                    // m_fds will be working array and m_orig_fds is the pointer to user fds - we
-                    // cannot modify it
-                    memcpy(m_fds, m_orig_fds, m_nfds * sizeof(fds[0]));
-                }
-
-                if (temp_sock_fd_api->skip_os_select()) {
-                    __log_func("fd=%d must be skipped from os r poll()", fd);
-                    m_fds[i].fd = -1;
-                } else if (m_orig_fds[i].events & POLLIN) {
-                    if (temp_sock_fd_api->is_readable(NULL)) {
-                        io_mux_call::update_fd_array(&m_fd_ready_array, fd);
-                        m_n_ready_rfds++;
-                        m_n_all_ready_fds++;
-                    } else {
-                        // Instructing the socket to sample the OS immediately to prevent hitting
-                        // EAGAIN on recvfrom(), after iomux returned a shadow fd as ready (only for
-                        // non-blocking sockets)
-                        temp_sock_fd_api->set_immediate_os_sample();
-                    }
-                }
+        }
+    } else {
+        cache.sockfd_gen = sockfd_gen;
+        cache.signature.resize(m_nfds);
+        cache.offloaded_idx.clear();
+
+        // Collect offloaded fds and remove all tcp (skip_os) sockets from m_fds
+        for (i = 0; i < m_nfds; ++i) {
+            cache.signature[i] = pollfd_signature(m_orig_fds[i]);
+
+            socket_fd_api *temp_sock_fd_api = fd_collection_get_sockfd(m_orig_fds[i].fd);
+            if (temp_sock_fd_api && (temp_sock_fd_api->get_type() == FD_TYPE_SOCKET) &&
+                add_offloaded_fd(i, temp_sock_fd_api, working_fds_arr)) {
+                cache.offloaded_idx.push_back(i);
             }
         }
     }
@@ -119,7 +116,56 @@ poll_call::poll_call(int *off_rfds_buffer, offloaded_mode_t *off_modes_buffer, i
     if (!m_num_all_offloaded_fds) {
         m_fds = m_orig_fds;
     }
-    __log_func("num all offloaded_fds=%d", m_num_all_offloaded_fds);
+    __log_func("num all offloaded_fds=%d%s", m_num_all_offloaded_fds,
+               cache_hit ? " (cached)" : "");
+}
+
+bool poll_call::add_offloaded_fd(nfds_t i, socket_fd_api *temp_sock_fd_api,
+                                 pollfd *working_fds_arr)
+{
+    int fd = m_orig_fds[i].fd;
+    offloaded_mode_t off_mode = OFF_NONE;
+
+    if (m_orig_fds[i].events & (POLLIN | POLLERR | POLLHUP)) {
+        off_mode = (offloaded_mode_t)(off_mode | OFF_READ);
+    }
+    if (m_orig_fds[i].events & POLLOUT) {
+        off_mode = (offloaded_mode_t)(off_mode | OFF_WRITE);
+    }
+    if (!off_mode) {
+        return false;
+    }
+
+    __log_func("---> fd=%d IS SET for read or write!", fd);
+    m_lookup_buffer[m_num_all_offloaded_fds] = i;
+    m_p_all_offloaded_fds[m_num_all_offloaded_fds] = fd;
+    m_p_offloaded_modes[m_num_all_offloaded_fds] = off_mode;
+    ++m_num_all_offloaded_fds;
+
+    // We will do copy only in case we have at least one offloaded socket
+    if (!m_fds) {
+        m_fds = working_fds_arr;
+        // m_fds will be working array and m_orig_fds is the pointer to user fds - we
+        // cannot modify it
+        memcpy(m_fds, m_orig_fds, m_nfds * sizeof(m_orig_fds[0]));
+    }
+
+    if (temp_sock_fd_api->skip_os_select()) {
+        __log_func("fd=%d must be skipped from os r poll()", fd);
+        m_fds[i].fd = -1;
+    } else if (m_orig_fds[i].events & POLLIN) {
+        if (temp_sock_fd_api->is_readable(NULL)) {
+            io_mux_call::update_fd_array(&m_fd_ready_array, fd);
+            m_n_ready_rfds++;
+            m_n_all_ready_fds++;
+        } else {
+            // Instructing the socket to sample the OS immediately to prevent hitting
+            // EAGAIN on recvfrom(), after iomux returned a shadow fd as ready (only for
+            // non-blocking sockets)
+            temp_sock_fd_api->set_immediate_os_sample();
+        }
+    }
+    return true;
 }
 
 void poll_call::prepare_to_block()
@@ -37,6 +37,8 @@
 
 #include "io_mux_call.h"
 
+class socket_fd_api;
+
 /**
  * @class poll_call
  * Functor for poll()
@@ -92,6 +94,7 @@ private:
     pollfd *const m_orig_fds;
 
     void copy_to_orig_fds();
+    bool add_offloaded_fd(nfds_t i, socket_fd_api *temp_sock_fd_api, pollfd *working_fds_arr);
 };
 
 #endif
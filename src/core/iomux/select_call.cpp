@@ -32,6 +32,7 @@
 
 #include "select_call.h"
 
+#include <vector>
 #include "utils/bullseye.h"
 #include "vlogger/vlogger.h"
 #include <util/vtypes.h>
@@ -48,6 +49,20 @@
 #define FD_ZERO(__fddst, __nfds) memset(__FDS_BITS(__fddst), 0, ((__nfds) + 7) >> 3)
 iomux_func_stats_t g_select_stats;
 
+/*
+ * Per-thread classification of the last select() sets. The offloaded fds are looked up in
+ * fd_collection again only when the sets or the fd_collection generation change.
+ */
+struct select_sig_cache {
+    uint64_t sockfd_gen;
+    int nfds;
+    __fd_mask rbits[FD_SETSIZE / NFDBITS];
+    __fd_mask wbits[FD_SETSIZE / NFDBITS];
+    std::vector<int> offloaded_fds;
+};
+
+static thread_local select_sig_cache t_select_cache;
+
 select_call::select_call(int *off_fds_buffer, offloaded_mode_t *off_modes_buffer, int nfds,
                          fd_set *readfds, fd_set *writefds, fd_set *exceptfds, timeval *timeout,
                          const sigset_t *__sigmask /* = NULL */)
@@ -76,8 +91,12 @@ select_call::select_call(int *off_fds_buffer, offloaded_mode_t *off_modes_buffer
     bool offloaded_write = !!m_writefds;
 
     if (offloaded_read || offloaded_write) {
-        FD_ZERO(&m_os_rfds, m_nfds);
-        FD_ZERO(&m_os_wfds, m_nfds);
+        select_sig_cache &cache = t_select_cache;
+        uint64_t sockfd_gen = fd_collection_get_sockfd_gen();
+        bool cache_hit = (cache.sockfd_gen == sockfd_gen && cache.nfds == m_nfds);
+        const int nwords = (m_nfds + NFDBITS - 1) / NFDBITS;
+        __fd_mask *os_rbits = __FDS_BITS(&m_os_rfds);
+        __fd_mask *os_wbits = __FDS_BITS(&m_os_wfds);
 
         // covers the case of select(readfds = NULL)
         if (!m_readfds) {
@@ -85,64 +104,92 @@ select_call::select_call(int *off_fds_buffer, offloaded_mode_t *off_modes_buffer
             m_readfds = &m_cq_rfds;
         }
 
-        // get offloaded fds in read set
-        for (fd = 0; fd < m_nfds; ++fd) {
-
-            bool check_read = offloaded_read && FD_ISSET(fd, m_readfds);
-            bool check_write = offloaded_write && FD_ISSET(fd, m_writefds);
-
-            socket_fd_api *psock = fd_collection_get_sockfd(fd);
-
-            if (psock && psock->get_type() == FD_TYPE_SOCKET) {
+        // Start with all the requested fds in the os sets, offloaded fds are adjusted below.
+        // Word at a time, so the compiler can vectorize it.
+        for (int w = 0; w < nwords; ++w) {
+            __fd_mask mask = (w == nwords - 1 && m_nfds % NFDBITS)
+                ? (((__fd_mask)1 << (m_nfds % NFDBITS)) - 1)
+                : ~(__fd_mask)0;
+            __fd_mask rbits = offloaded_read ? __FDS_BITS(m_readfds)[w] & mask : 0;
+            __fd_mask wbits = offloaded_write ? __FDS_BITS(m_writefds)[w] & mask : 0;
+
+            os_rbits[w] = rbits;
+            os_wbits[w] = wbits;
+            cache_hit = cache_hit && cache.rbits[w] == rbits && cache.wbits[w] == wbits;
+            cache.rbits[w] = rbits;
+            cache.wbits[w] = wbits;
+        }
 
-                offloaded_mode_t off_mode = OFF_NONE;
-                if (check_read) {
-                    off_mode = (offloaded_mode_t)(off_mode | OFF_READ);
-                }
-                if (check_write) {
-                    off_mode = (offloaded_mode_t)(off_mode | OFF_WRITE);
+        if (cache_hit) {
+            for (int cached_fd : cache.offloaded_fds) {
+                socket_fd_api *psock = fd_collection_get_sockfd(cached_fd);
+                if (likely(psock)) {
+                    add_offloaded_fd(cached_fd, psock);
                 }
-
-                if (off_mode) {
-                    __log_func("---> fd=%d IS SET for read or write!", fd);
-
-                    m_p_all_offloaded_fds[m_num_all_offloaded_fds] = fd;
-                    m_p_offloaded_modes[m_num_all_offloaded_fds] = off_mode;
-                    m_num_all_offloaded_fds++;
-                    if (!psock->skip_os_select()) {
-                        if (check_read) {
-                            FD_SET(fd, &m_os_rfds);
-                            if (psock->is_readable(NULL)) {
-                                io_mux_call::update_fd_array(&m_fd_ready_array, fd);
-                                m_n_ready_rfds++;
-                                m_n_all_ready_fds++;
-                            } else {
-                                // Instructing the socket to sample the OS immediately to prevent
-                                // hitting EAGAIN on recvfrom(), after iomux returned a shadow fd as
-                                // ready (only for non-blocking sockets)
-                                psock->set_immediate_os_sample();
-                            }
-                        }
-                        if (check_write) {
-                            FD_SET(fd, &m_os_wfds);
-                        }
-                    } else {
-                        __log_func("fd=%d must be skipped from os r select()", fd);
+            }
+        } else {
+            cache.sockfd_gen = sockfd_gen;
+            cache.nfds = m_nfds;
+            cache.offloaded_fds.clear();
+
+            // get offloaded fds in read and write sets, visit only the set bits
+            for (int w = 0; w < nwords; ++w) {
+                __fd_mask bits = os_rbits[w] | os_wbits[w];
+
+                while (bits) {
+                    fd = w * NFDBITS + __builtin_ctzl(bits);
+                    bits &= bits - 1;
+
+                    socket_fd_api *psock = fd_collection_get_sockfd(fd);
+                    if (psock && psock->get_type() == FD_TYPE_SOCKET) {
+                        add_offloaded_fd(fd, psock);
+                        cache.offloaded_fds.push_back(fd);
                     }
                 }
-            } else {
-                if (check_read) {
-                    FD_SET(fd, &m_os_rfds);
-                }
-                if (check_write) {
-                    FD_SET(fd, &m_os_wfds);
-                }
             }
         }
     }
     __log_func("num all offloaded_fds=%d", m_num_all_offloaded_fds);
 }
 
+void select_call::add_offloaded_fd(int fd, socket_fd_api *psock)
+{
+    bool check_read = FD_ISSET(fd, &m_os_rfds);
+    bool check_write = FD_ISSET(fd, &m_os_wfds);
+    offloaded_mode_t off_mode = OFF_NONE;
+
+    if (check_read) {
+        off_mode = (offloaded_mode_t)(off_mode | OFF_READ);
+    }
+    if (check_write) {
+        off_mode = (offloaded_mode_t)(off_mode | OFF_WRITE);
+    }
+
+    __log_func("---> fd=%d IS SET for read or write!", fd);
+
+    m_p_all_offloaded_fds[m_num_all_offloaded_fds] = fd;
+    m_p_offloaded_modes[m_num_all_offloaded_fds] = off_mode;
+    m_num_all_offloaded_fds++;
+    if (!psock->skip_os_select()) {
+        if (check_read) {
+            if (psock->is_readable(NULL)) {
+                io_mux_call::update_fd_array(&m_fd_ready_array, fd);
+                m_n_ready_rfds++;
+                m_n_all_ready_fds++;
+            } else {
+                // Instructing the socket to sample the OS immediately to prevent
+                // hitting EAGAIN on recvfrom(), after iomux returned a shadow fd as
+                // ready (only for non-blocking sockets)
+                psock->set_immediate_os_sample();
+            }
+        }
+    } else {
+        __log_func("fd=%d must be skipped from os r select()", fd);
+        FD_CLR(fd, &m_os_rfds);
+        FD_CLR(fd, &m_os_wfds);
+    }
+}
+
 void select_call::prepare_to_poll()
 {
     /*
@@ -37,6 +37,8 @@
 
 #include "io_mux_call.h"
 
+class socket_fd_api;
+
 /**
  * @class poll_call
  * Functor for poll()
@@ -99,6 +101,8 @@ private:
     fd_set m_os_wfds;
 
     fd_set m_cq_rfds;
+
+    void add_offloaded_fd(int fd, socket_fd_api *psock);
 };
 
 #endif
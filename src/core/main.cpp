@@ -50,6 +50,7 @@
 #include "utils/rdtsc.h"
 #include "util/xlio_stats.h"
 #include "util/utils.h"
+#include "util/epoch_reclaim.h"
 #include "event/event_handler_manager.h"
 #include "event/vlogger_timer_handler.h"
 #include "dev/buffer_pool.h"
@@ -140,6 +141,7 @@ static int free_libxlio_resources()
     if (g_p_fd_collection_temp) {
         delete g_p_fd_collection_temp;
     }
+    thread_tcp_timers::destroy_all();
 
     if (g_p_lwip) {
         delete g_p_lwip;
@@ -192,6 +194,11 @@ static int free_libxlio_resources()
     }
     g_buffer_pool_rx_stride = NULL;
 
+    if (g_buffer_pool_rx_copybreak) {
+        delete g_buffer_pool_rx_copybreak;
+    }
+    g_buffer_pool_rx_copybreak = NULL;
+
     if (g_buffer_pool_rx_rwqe) {
         delete g_buffer_pool_rx_rwqe;
     }
@@ -507,6 +514,9 @@ void print_xlio_global_settings()
                       SYS_VAR_RING_MIGRATION_RATIO_TX);
     VLOG_PARAM_NUMBER("Ring migration ratio RX", safe_mce_sys().ring_migration_ratio_rx,
                       MCE_DEFAULT_RING_MIGRATION_RATIO_RX, SYS_VAR_RING_MIGRATION_RATIO_RX);
+    VLOG_PARAM_STRING("Ring migration by traffic", safe_mce_sys().ring_migration_by_traffic,
+                      MCE_DEFAULT_RING_MIGRATION_TRAFFIC, SYS_VAR_RING_MIGRATION_TRAFFIC,
+                      safe_mce_sys().ring_migration_by_traffic ? "Enabled " : "Disabled");
 
     if (safe_mce_sys().ring_limit_per_interface) {
         VLOG_PARAM_NUMBER("Ring limit per interface", safe_mce_sys().ring_limit_per_interface,
@@ -554,6 +564,10 @@ void print_xlio_global_settings()
                       safe_mce_sys().tx_nonblocked_eagains ? "Enabled " : "Disabled");
     VLOG_PARAM_NUMBER("Tx Prefetch Bytes", safe_mce_sys().tx_prefetch_bytes,
                       MCE_DEFAULT_TX_PREFETCH_BYTES, SYS_VAR_TX_PREFETCH_BYTES);
+    VLOG_PARAM_NUMBER("Tx Doorbell Defer Max", safe_mce_sys().tx_db_defer_max,
+                      MCE_DEFAULT_TX_DB_DEFER_MAX, SYS_VAR_TX_DB_DEFER_MAX);
+    VLOG_PARAM_NUMBER("Tx MPW Inline Max", safe_mce_sys().tx_mpw_inline_max,
+                      MCE_DEFAULT_TX_MPW_INLINE_MAX, SYS_VAR_TX_MPW_INLINE_MAX);
     VLOG_PARAM_NUMBER("Tx Bufs Batch TCP", safe_mce_sys().tx_bufs_batch_tcp,
                       MCE_DEFAULT_TX_BUFS_BATCH_TCP, SYS_VAR_TX_BUFS_BATCH_TCP);
     VLOG_PARAM_NUMBER("Tx Segs Batch TCP", safe_mce_sys().tx_segs_batch_tcp,
@@ -641,6 +655,10 @@ void print_xlio_global_settings()
     VLOG_PARAM_NUMBER(
         "STRQ Strides Compensation Level", safe_mce_sys().strq_strides_compensation_level,
         MCE_DEFAULT_STRQ_STRIDES_COMPENSATION_LEVEL, SYS_VAR_STRQ_STRIDES_COMPENSATION_LEVEL);
+    VLOG_PARAM_NUMBER("STRQ Copybreak (Bytes)", safe_mce_sys().strq_copybreak,
+                      MCE_DEFAULT_STRQ_COPYBREAK, SYS_VAR_STRQ_COPYBREAK);
+    VLOG_PARAM_NUMBER("STRQ Copybreak Buffers", safe_mce_sys().strq_copybreak_bufs,
+                      MCE_DEFAULT_STRQ_COPYBREAK_BUFS, SYS_VAR_STRQ_COPYBREAK_BUFS);
     VLOG_PARAM_NUMBER("Select Poll (usec)", safe_mce_sys().select_poll_num,
                       MCE_DEFAULT_SELECT_NUM_POLLS, SYS_VAR_SELECT_NUM_POLLS);
     VLOG_PARAM_STRING("Select Poll OS Force", safe_mce_sys().select_poll_os_force,
@@ -663,6 +681,9 @@ void print_xlio_global_settings()
         VLOG_PARAM_STRING("Select Skip OS", safe_mce_sys().select_skip_os_fd_check,
                           MCE_DEFAULT_SELECT_SKIP_OS, SYS_VAR_SELECT_SKIP_OS, "Disabled");
     }
+    VLOG_PARAM_STRING("Select Poll Adaptive", safe_mce_sys().select_poll_adaptive,
+                      MCE_DEFAULT_SELECT_POLL_ADAPTIVE, SYS_VAR_SELECT_POLL_ADAPTIVE,
+                      safe_mce_sys().select_poll_adaptive ? "Enabled " : "Disabled");
 
     if (safe_mce_sys().progress_engine_interval_msec == MCE_CQ_DRAIN_INTERVAL_DISABLED ||
         safe_mce_sys().progress_engine_wce_max == 0) {
@@ -717,6 +738,9 @@ void print_xlio_global_settings()
     VLOG_PARAM_NUMSTR("TCP control thread", safe_mce_sys().tcp_ctl_thread,
                       MCE_DEFAULT_TCP_CTL_THREAD, SYS_VAR_TCP_CTL_THREAD,
                       ctl_thread_str(safe_mce_sys().tcp_ctl_thread));
+    VLOG_PARAM_STRING("TCP timers per thread", safe_mce_sys().tcp_timers_per_thread,
+                      MCE_DEFAULT_TCP_TIMERS_PER_THREAD, SYS_VAR_TCP_TIMERS_PER_THREAD,
+                      safe_mce_sys().tcp_timers_per_thread ? "Enabled " : "Disabled");
     VLOG_PARAM_NUMBER("TCP timestamp option", safe_mce_sys().tcp_ts_opt,
                       MCE_DEFAULT_TCP_TIMESTAMP_OPTION, SYS_VAR_TCP_TIMESTAMP_OPTION);
     VLOG_PARAM_NUMBER("TCP nodelay", safe_mce_sys().tcp_nodelay, MCE_DEFAULT_TCP_NODELAY,
@@ -790,6 +814,11 @@ void print_xlio_global_settings()
                       SYS_VAR_UTLS_RX, safe_mce_sys().enable_utls_rx ? "Enabled " : "Disabled");
     VLOG_PARAM_STRING("UTLS TX support", safe_mce_sys().enable_utls_tx, MCE_DEFAULT_UTLS_TX,
                       SYS_VAR_UTLS_TX, safe_mce_sys().enable_utls_tx ? "Enabled " : "Disabled");
+    VLOG_PARAM_STRING("UTLS software fallback", safe_mce_sys().enable_utls_sw, MCE_DEFAULT_UTLS_SW,
+                      SYS_VAR_UTLS_SW, safe_mce_sys().enable_utls_sw ? "Enabled " : "Disabled");
+    VLOG_PARAM_STRING("UTLS RX batching", safe_mce_sys().enable_utls_rx_batch,
+                      MCE_DEFAULT_UTLS_RX_BATCH, SYS_VAR_UTLS_RX_BATCH,
+                      safe_mce_sys().enable_utls_rx_batch ? "Enabled " : "Disabled");
     VLOG_PARAM_NUMBER(
         "UTLS high watermark DEK cache size", safe_mce_sys().utls_high_wmark_dek_cache_size,
         MCE_DEFAULT_UTLS_HIGH_WMARK_DEK_CACHE_SIZE, SYS_VAR_UTLS_HIGH_WMARK_DEK_CACHE_SIZE);
@@ -797,6 +826,9 @@ void print_xlio_global_settings()
         "UTLS low watermark DEK cache size", safe_mce_sys().utls_low_wmark_dek_cache_size,
         MCE_DEFAULT_UTLS_LOW_WMARK_DEK_CACHE_SIZE, SYS_VAR_UTLS_LOW_WMARK_DEK_CACHE_SIZE);
 #endif /* DEFINED_UTLS */
+    VLOG_PARAM_STRING("NVMe software digest", safe_mce_sys().enable_nvme_sw_digest,
+                      MCE_DEFAULT_NVME_SW_DIGEST, SYS_VAR_NVME_SW_DIGEST,
+                      safe_mce_sys().enable_nvme_sw_digest ? "Enabled " : "Disabled");
 #if defined(DEFINED_NGINX)
     VLOG_PARAM_NUMBER("Src port stirde", safe_mce_sys().src_port_stride,
                       MCE_DEFAULT_SRC_PORT_STRIDE, SYS_VAR_SRC_PORT_STRIDE);
@@ -858,7 +890,9 @@ void print_xlio_global_settings()
             : "Disabled");
     VLOG_PARAM_STRING("Lock Type", safe_mce_sys().multilock, MCE_DEFAULT_MULTILOCK,
                       SYS_VAR_MULTILOCK,
-                      (safe_mce_sys().multilock == MULTILOCK_SPIN ? "Spin " : "Mutex"));
+                      (safe_mce_sys().multilock == MULTILOCK_SPIN
+                           ? "Spin "
+                           : (safe_mce_sys().multilock == MULTILOCK_MUTEX ? "Mutex" : "Adaptive")));
 
 #ifdef XLIO_TIME_MEASURE
     VLOG_PARAM_NUMBER("Time Measure Num Samples", safe_mce_sys().xlio_time_measure_num_samples,
@@ -1075,6 +1109,13 @@ static void do_global_ctors_helper()
                                   : NULL)));
         g_buffer_pool_rx_stride->set_RX_TX_for_stats(true);
         g_buffer_pool_rx_ptr = g_buffer_pool_rx_stride;
+
+        if (safe_mce_sys().strq_copybreak && safe_mce_sys().strq_copybreak_bufs) {
+            NEW_CTOR(g_buffer_pool_rx_copybreak,
+                     buffer_pool(safe_mce_sys().strq_copybreak_bufs, safe_mce_sys().strq_copybreak,
+                                 buffer_pool::free_rx_lwip_pbuf_custom));
+            g_buffer_pool_rx_copybreak->set_RX_TX_for_stats(true);
+        }
     } else {
         g_buffer_pool_rx_ptr = g_buffer_pool_rx_rwqe;
     }
@@ -1189,6 +1230,7 @@ void reset_globals()
     g_zc_cache = NULL;
     g_buffer_pool_rx_ptr = NULL;
     g_buffer_pool_rx_stride = NULL;
+    g_buffer_pool_rx_copybreak = NULL;
     g_buffer_pool_rx_rwqe = NULL;
     g_buffer_pool_tx = NULL;
     g_buffer_pool_zc = NULL;
@@ -1207,6 +1249,8 @@ void reset_globals()
     g_p_ib_ctx_handler_collection = NULL;
     s_cmd_nl = NULL;
     g_cpu_manager.reset();
+    epoch_reclaim::fork_reset();
+    thread_tcp_timers::fork_reset();
 }
 
 // checks that netserver runs with flags: -D, -f. Otherwise, warn user for wrong usage
@@ -87,6 +87,8 @@ public:
                               socket_fd_api *sock = 0, tx_call_t call_type = TX_UNDEF) = 0;
 
     bool try_migrate_ring(lock_base &socket_lock);
+    // Account bytes sent by the application (XLIO_RING_MIGRATION_BY_TRAFFIC)
+    inline void account_tx_traffic(size_t bytes) { m_ring_alloc_logic.account_traffic(bytes); }
 
     bool is_offloaded() { return m_b_is_offloaded; }
     void set_bound_addr(const ip_address &addr);
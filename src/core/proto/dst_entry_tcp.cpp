@@ -154,6 +154,9 @@ ssize_t dst_entry_tcp::fast_send(const iovec *p_iov, const ssize_t sz_iov, xlio_
             m_p_send_wqe = &m_inline_send_wqe;
             p_tcp_iov[0].iovec.iov_base = (uint8_t *)p_pkt + hdr_alignment_diff;
             p_tcp_iov[0].iovec.iov_len = total_packet_len;
+            if (tcp_is_pure_ack(static_cast<tcphdr *>(p_tcp_hdr), attr.length)) {
+                attr.flags = (xlio_wr_tx_packet_attr)(attr.flags | XLIO_TX_PACKET_MPW);
+            }
         } else if (is_set(attr.flags, (xlio_wr_tx_packet_attr)(XLIO_TX_PACKET_TSO))) {
             /* update send work request. do not expect noninlined scenario */
             send_wqe_h.init_not_inline_wqe(send_wqe, m_sge, sz_iov);
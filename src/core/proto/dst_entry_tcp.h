@@ -35,6 +35,15 @@
 
 #include "core/proto/dst_entry.h"
 
+/* Segment which acknowledges data only: no payload and no SYN, FIN or RST.
+ * Such segments can be packed into a multi-packet WQE.
+ */
+static inline bool tcp_is_pure_ack(const struct tcphdr *p_tcp_hdr, uint32_t length)
+{
+    return length == (uint32_t)p_tcp_hdr->doff * 4 && p_tcp_hdr->ack &&
+        !(p_tcp_hdr->syn || p_tcp_hdr->fin || p_tcp_hdr->rst);
+}
+
 /* Structure for TCP scatter/gather I/O.  */
 typedef struct tcp_iovec {
     struct iovec iovec;
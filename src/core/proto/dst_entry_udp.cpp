@@ -88,11 +88,13 @@ bool dst_entry_udp::fast_send_fragmented_ipv6(mem_buf_desc_t *p_mem_buf_desc, co
     ip6_hdr *p_ip_hdr;
     udphdr *p_udp_hdr = nullptr;
     ip6_frag *p_frag_h;
+    mem_buf_desc_t *p_first_desc = p_mem_buf_desc;
     mem_buf_desc_t *tmp;
 
     bool first_frag = true;
     uint32_t n_ip_frag_offset = 0;
     size_t sz_user_data_offset = 0;
+    uint32_t sum = 0;
 
     // fragmentation extension header - copy it to every fragment
     // the only field that will change here is ip6f_offlg
@@ -102,7 +104,9 @@ bool dst_entry_udp::fast_send_fragmented_ipv6(mem_buf_desc_t *p_mem_buf_desc, co
     frag_h.ip6f_offlg = IP6F_MORE_FRAG;
     frag_h.ip6f_reserved = 0;
 
-    while (n_num_frags--) {
+    // The UDP checksum covers the entire datagram, so all the fragments are filled first and the
+    // payload sum is collected while copying the user data
+    for (int n_frags_left = n_num_frags; n_frags_left--;) {
         // Calc this ip datagram fragment size (include any headers)
         size_t sz_ip_frag = std::min((size_t)(max_ip_payload_size),
                                      (sz_udp_payload - n_ip_frag_offset + FRAG_EXT_HLEN));
@@ -126,18 +130,12 @@ bool dst_entry_udp::fast_send_fragmented_ipv6(mem_buf_desc_t *p_mem_buf_desc, co
 
             // Only for first fragment add the udp header
             p_udp_hdr->len = htons((uint16_t)sz_udp_payload);
-
-            // temporary sum of the entire payload
-            // final checksum is calculated by attr XLIO_TX_PACKET_L4_CSUM
-            p_udp_hdr->check = calc_sum_of_payload(p_iov, sz_iov);
-            attr = (xlio_wr_tx_packet_attr)(attr | XLIO_TX_PACKET_L4_CSUM | XLIO_TX_SW_L4_CSUM);
         } else {
             get_ipv6_hdrs_frag_ext_ptr(p_pkt, p_ip_hdr, p_frag_h);
-            attr = (xlio_wr_tx_packet_attr)(attr & ~(XLIO_TX_PACKET_L4_CSUM | XLIO_TX_SW_L4_CSUM));
         }
 
         memcpy(p_frag_h, &frag_h, sizeof(ip6_frag));
-        if (n_num_frags == 0) {
+        if (n_frags_left == 0) {
             p_frag_h->ip6f_offlg &= ~IP6F_MORE_FRAG;
         }
         // offset should be << 3, but need to devide by 8, so no need to change n_ip_frag_offset
@@ -150,14 +148,14 @@ bool dst_entry_udp::fast_send_fragmented_ipv6(mem_buf_desc_t *p_mem_buf_desc, co
         uint8_t *p_payload =
             p_mem_buf_desc->p_buffer + p_header->m_transport_header_tx_offset + hdr_len;
 
-        // Copy user data to our tx buffers
-        int ret =
-            memcpy_fromiovec(p_payload, p_iov, sz_iov, sz_user_data_offset, sz_user_data_to_copy);
+        // Copy user data to our tx buffers, fragments start at even offsets of the payload
+        int ret = memcpy_fromiovec_csum(p_payload, p_iov, sz_iov, sz_user_data_offset,
+                                        sz_user_data_to_copy, sum);
         BULLSEYE_EXCLUDE_BLOCK_START
         if (ret != (int)sz_user_data_to_copy) {
             vlog_printf(VLOG_ERROR, "memcpy_fromiovec error (sz_user_data_to_copy=%zu, ret=%d)\n",
                         sz_user_data_to_copy, ret);
-            p_ring->mem_buf_tx_release(p_mem_buf_desc, true);
+            p_ring->mem_buf_tx_release(p_first_desc, true);
             return false;
         }
         BULLSEYE_EXCLUDE_BLOCK_END
@@ -165,32 +163,46 @@ bool dst_entry_udp::fast_send_fragmented_ipv6(mem_buf_desc_t *p_mem_buf_desc, co
         p_mem_buf_desc->tx.p_ip_h = p_ip_hdr;
         p_mem_buf_desc->tx.p_udp_h = p_udp_hdr;
 
+        vlog_printf(VLOG_DEBUG, "packet_sz=%zu, payload_sz=%zu, ip_offset=%u id=%u\n",
+                    p_header->m_ip_header_len + sz_ip_frag, sz_user_data_to_copy,
+                    n_ip_frag_offset, ntohl(packet_id));
+
+        p_mem_buf_desc = p_mem_buf_desc->p_next_desc;
+
+        // Update ip frag offset position
+        n_ip_frag_offset += sz_ip_frag - FRAG_EXT_HLEN;
+
+        // Update user data start offset copy location
+        sz_user_data_offset += sz_user_data_to_copy;
+
+        first_frag = false;
+    } // for(n_frags_left)
+
+    // temporary sum of the entire payload
+    // final checksum is calculated by attr XLIO_TX_PACKET_L4_CSUM
+    p_udp_hdr->check = csum_fold(sum);
+    attr = (xlio_wr_tx_packet_attr)(attr | XLIO_TX_PACKET_L4_CSUM | XLIO_TX_SW_L4_CSUM);
+
+    p_mem_buf_desc = p_first_desc;
+    while (n_num_frags--) {
+        ip6_hdr *p_frag_ip_hdr = p_mem_buf_desc->tx.p_ip6_h;
+
         p_sge[0].addr =
             (uintptr_t)(p_mem_buf_desc->p_buffer + (uint8_t)p_header->m_transport_header_tx_offset);
-        p_sge[0].length = sz_user_data_to_copy + hdr_len;
+        p_sge[0].length = p_header->m_transport_header_len + p_header->m_ip_header_len +
+            ntohs(p_frag_ip_hdr->ip6_plen);
         p_sge[0].lkey = p_ring->get_tx_lkey(user_id);
         p_send_wqe->wr_id = (uintptr_t)p_mem_buf_desc;
 
-        vlog_printf(VLOG_DEBUG, "packet_sz=%d, payload_sz=%zu, ip_offset=%u id=%u\n",
-                    p_sge[0].length - p_header->m_transport_header_len, sz_user_data_to_copy,
-                    n_ip_frag_offset, ntohl(packet_id));
-
         tmp = p_mem_buf_desc->p_next_desc;
         p_mem_buf_desc->p_next_desc = NULL;
 
         // We don't check the return valuse of post send when we reach the HW we consider that we
         // completed our job
         p_ring->send_ring_buffer(user_id, p_send_wqe, attr);
+        attr = (xlio_wr_tx_packet_attr)(attr & ~(XLIO_TX_PACKET_L4_CSUM | XLIO_TX_SW_L4_CSUM));
 
         p_mem_buf_desc = tmp;
-
-        // Update ip frag offset position
-        n_ip_frag_offset += sz_ip_frag - FRAG_EXT_HLEN;
-
-        // Update user data start offset copy location
-        sz_user_data_offset += sz_user_data_to_copy;
-
-        first_frag = false;
     } // while(n_num_frags)
 
     return true;
@@ -203,6 +215,8 @@ inline ssize_t dst_entry_udp::fast_send_not_fragmented(const iovec *p_iov, const
 {
     mem_buf_desc_t *p_mem_buf_desc;
     bool b_blocked = is_set(attr, XLIO_TX_PACKET_BLOCK);
+    // IPv6 UDP checksum is mandatory, a SW checksum ring would read the payload once again
+    bool b_sw_l4_csum = get_sa_family() == AF_INET6 && m_p_ring->is_tx_sw_csum(m_id);
 
     // Get a bunch of tx buf descriptor and data buffers
     if (unlikely(m_p_tx_mem_buf_desc_list == NULL)) {
@@ -233,7 +247,7 @@ inline ssize_t dst_entry_udp::fast_send_not_fragmented(const iovec *p_iov, const
     // Check if inline is possible
     // Skip inlining in case of L4 SW checksum because headers and data are not contiguous in memory
     if (sz_iov == 1 && ((sz_data_payload + m_header->m_total_hdr_len) < m_max_inline) &&
-        !is_set(attr, XLIO_TX_SW_L4_CSUM)) {
+        !is_set(attr, XLIO_TX_SW_L4_CSUM) && !b_sw_l4_csum) {
         m_p_send_wqe = &m_inline_send_wqe;
 
         m_header->get_udp_hdr()->len = htons((uint16_t)sz_udp_payload);
@@ -247,6 +261,8 @@ inline ssize_t dst_entry_udp::fast_send_not_fragmented(const iovec *p_iov, const
         m_sge[1].length = p_iov[0].iov_len;
         m_sge[1].addr = (uintptr_t)p_iov[0].iov_base;
         m_sge[1].lkey = m_p_ring->get_tx_lkey(m_id);
+
+        attr = (xlio_wr_tx_packet_attr)(attr | XLIO_TX_PACKET_MPW);
     } else {
         m_p_send_wqe = &m_not_inline_send_wqe;
 
@@ -290,7 +306,20 @@ inline ssize_t dst_entry_udp::fast_send_not_fragmented(const iovec *p_iov, const
             p_mem_buf_desc->p_buffer + m_header->m_transport_header_tx_offset + hdr_len;
 
         // Copy user data to our tx buffers
-        int ret = memcpy_fromiovec(p_payload, p_iov, sz_iov, 0, sz_data_payload);
+        int ret;
+        if (b_sw_l4_csum) {
+            // Sum the payload while copying it and complete the checksum here
+            udphdr *p_udp = reinterpret_cast<udphdr *>(p_udp_hdr);
+            uint32_t sum = 0;
+
+            ret = memcpy_fromiovec_csum(p_payload, p_iov, sz_iov, 0, sz_data_payload, sum);
+            p_udp->check = csum_fold(sum);
+            p_udp->check =
+                compute_ipv6_udp_frag_checksum(reinterpret_cast<ip6_hdr *>(p_ip_hdr), p_udp);
+            attr = (xlio_wr_tx_packet_attr)(attr & ~XLIO_TX_PACKET_L4_CSUM);
+        } else {
+            ret = memcpy_fromiovec(p_payload, p_iov, sz_iov, 0, sz_data_payload);
+        }
         BULLSEYE_EXCLUDE_BLOCK_START
         if (ret != (int)sz_data_payload) {
             dst_udp_logerr("memcpy_fromiovec error (sz_user_data_to_copy=%lu, ret=%d)",
@@ -0,0 +1,356 @@
+/*
+ * Copyright (c) 2001-2023 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ *
+ * This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING in the main directory of this source tree, or the
+ * BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <algorithm>
+#include <endian.h>
+#include <string.h>
+#include "utils/types.h"
+#include "util/crc32c.h"
+#include "nvme_pdu.h"
+
+bool nvme_tcp_pdu_parse(const uint8_t *ch, nvme_tcp_pdu_layout &layout)
+{
+    uint32_t plen;
+
+    memcpy(&plen, &ch[4], sizeof(plen));
+    layout.plen = le32toh(plen);
+    layout.flags = ch[1];
+    layout.hlen = ch[2];
+    layout.hdgst_len = (layout.flags & NVME_TCP_F_HDGST) ? NVME_TCP_DIGEST_LEN : 0U;
+    layout.ddgst_len = (layout.flags & NVME_TCP_F_DDGST) ? NVME_TCP_DIGEST_LEN : 0U;
+    /* PDO is zero if the PDU doesn't carry data or the data follows the header. */
+    layout.data_off = ch[3] ? ch[3] : layout.hlen + layout.hdgst_len;
+
+    uint32_t hdr_end = layout.hlen + layout.hdgst_len;
+    if (unlikely(layout.hlen < NVME_TCP_CH_LEN || hdr_end > layout.plen ||
+                 layout.data_off < hdr_end)) {
+        return false;
+    }
+    if (layout.plen > layout.data_off + layout.ddgst_len) {
+        layout.data_len = layout.plen - layout.data_off - layout.ddgst_len;
+    } else {
+        /* No data, the rest of the PDU is padding. */
+        layout.data_off = layout.plen;
+        layout.data_len = 0U;
+        layout.ddgst_len = 0U;
+    }
+    return true;
+}
+
+/* Calls fn(ptr, len) for every contiguous piece of the [offset, offset + len) range. */
+template <typename F>
+static inline void nvme_iov_walk(const iovec *iov, size_t iov_nr, size_t offset, size_t len, F fn)
+{
+    for (size_t i = 0; i < iov_nr && len > 0U; ++i) {
+        if (offset >= iov[i].iov_len) {
+            offset -= iov[i].iov_len;
+            continue;
+        }
+        size_t n = std::min(iov[i].iov_len - offset, len);
+        fn(reinterpret_cast<uint8_t *>(iov[i].iov_base) + offset, n);
+        len -= n;
+        offset = 0U;
+    }
+}
+
+static uint32_t nvme_iov_digest(const iovec *iov, size_t iov_nr, size_t offset, size_t len)
+{
+    uint32_t crc = ~0U;
+
+    nvme_iov_walk(iov, iov_nr, offset, len,
+                  [&crc](uint8_t *p, size_t n) { crc = crc32c_update(crc, p, n); });
+    return htole32(~crc);
+}
+
+static void nvme_iov_copy(const iovec *iov, size_t iov_nr, size_t offset, uint8_t *buf, size_t len,
+                          bool to_iov)
+{
+    nvme_iov_walk(iov, iov_nr, offset, len, [&buf, to_iov](uint8_t *p, size_t n) {
+        to_iov ? memcpy(p, buf, n) : memcpy(buf, p, n);
+        buf += n;
+    });
+}
+
+/*
+ * Fills the digest placeholders of a PDU which is described by iov. This is a separate read
+ * pass over the payload: NVMe/TCP TX is zerocopy and XLIO doesn't touch the data otherwise.
+ */
+bool nvme_pdu_sw_digest(const iovec *iov, size_t iov_nr, size_t pdu_len, uint8_t sw_digest)
+{
+    uint8_t ch[NVME_TCP_CH_LEN];
+    nvme_tcp_pdu_layout layout;
+    uint32_t digest;
+
+    if (unlikely(pdu_len < NVME_TCP_CH_LEN)) {
+        return false;
+    }
+    nvme_iov_copy(iov, iov_nr, 0U, ch, sizeof(ch), false);
+    if (unlikely(!nvme_tcp_pdu_parse(ch, layout) || layout.plen != pdu_len)) {
+        return false;
+    }
+    if (layout.hdgst_len && (sw_digest & NVME_TCP_F_HDGST)) {
+        digest = nvme_iov_digest(iov, iov_nr, 0U, layout.hlen);
+        nvme_iov_copy(iov, iov_nr, layout.hlen, reinterpret_cast<uint8_t *>(&digest),
+                      sizeof(digest), true);
+    }
+    if (layout.ddgst_len && (sw_digest & NVME_TCP_F_DDGST)) {
+        digest = nvme_iov_digest(iov, iov_nr, layout.data_off, layout.data_len);
+        nvme_iov_copy(iov, iov_nr, layout.data_off + layout.data_len,
+                      reinterpret_cast<uint8_t *>(&digest), sizeof(digest), true);
+    }
+    return true;
+}
+
+nvme_rx_parser::nvme_rx_parser(pbuf_free_cb_t free_cb)
+    : m_free_cb(free_cb)
+    , m_sw_digest(0U)
+    , m_is_placement(false)
+    , m_layout()
+    , m_hdr()
+    , m_digest()
+    , m_verify(0U)
+    , m_cid(0U)
+{
+    pdu_start();
+}
+
+void nvme_rx_parser::reset(uint8_t sw_digest, bool is_placement)
+{
+    m_sw_digest = sw_digest;
+    m_is_placement = is_placement;
+    pdu_start();
+}
+
+void nvme_rx_parser::set_buf(const xlio_nvme_rx_buf &buf)
+{
+    if (buf.addr) {
+        m_cmd_bufs[buf.cid] = buf;
+    } else {
+        m_cmd_bufs.erase(buf.cid);
+        if (m_drop && m_cid == buf.cid) {
+            /* Unregistered in the middle of a PDU, discard the rest of the payload. */
+            m_place = nullptr;
+        }
+    }
+}
+
+void nvme_rx_parser::pdu_start(void)
+{
+    m_stage = RX_PDU_CH;
+    m_remain = NVME_TCP_CH_LEN;
+    m_crc = ~0U;
+    m_drop = false;
+    m_place = nullptr;
+}
+
+/* Looks up the destination of a C2HData payload. Returns false for an invalid PDU. */
+bool nvme_rx_parser::pdu_place(void)
+{
+    const nvme_tcp_pdu_layout &layout = m_layout;
+    const uint8_t *hdr = m_hdr;
+    uint16_t cid;
+    uint32_t datao;
+    uint32_t datal;
+
+    if (!m_is_placement || hdr[0] != NVME_TCP_PDU_C2H_DATA || layout.data_len == 0U ||
+        m_cmd_bufs.empty()) {
+        return true;
+    }
+    if (unlikely(layout.hlen < NVME_TCP_C2H_HLEN)) {
+        return false;
+    }
+    memcpy(&cid, &hdr[8], sizeof(cid));
+    memcpy(&datao, &hdr[12], sizeof(datao));
+    memcpy(&datal, &hdr[16], sizeof(datal));
+    cid = le16toh(cid);
+    datao = le32toh(datao);
+    datal = le32toh(datal);
+
+    auto iter = m_cmd_bufs.find(cid);
+    if (iter == m_cmd_bufs.end()) {
+        return true;
+    }
+    const xlio_nvme_rx_buf &buf = iter->second;
+    if (unlikely(datal != layout.data_len || datao > buf.len || datal > buf.len - datao)) {
+        /* The payload doesn't fit the registered buffer. */
+        return false;
+    }
+    m_drop = true;
+    m_cid = cid;
+    m_place = reinterpret_cast<uint8_t *>(buf.addr) + datao;
+    return true;
+}
+
+/* Moves to the next part of the PDU when the current one is consumed. */
+bool nvme_rx_parser::pdu_next_stage(void)
+{
+    nvme_tcp_pdu_layout &layout = m_layout;
+    uint32_t digest;
+
+    switch (m_stage) {
+    case RX_PDU_CH:
+        if (unlikely(!nvme_tcp_pdu_parse(m_hdr, layout))) {
+            return false;
+        }
+        m_verify = layout.flags & m_sw_digest;
+        m_stage = RX_PDU_HDR;
+        m_remain = layout.hlen - NVME_TCP_CH_LEN;
+        break;
+    case RX_PDU_HDR:
+        m_stage = RX_PDU_HDGST;
+        m_remain = layout.hdgst_len;
+        break;
+    case RX_PDU_HDGST:
+        if (layout.hdgst_len && (m_verify & NVME_TCP_F_HDGST)) {
+            memcpy(&digest, m_digest, sizeof(digest));
+            if (unlikely(le32toh(digest) != ~m_crc)) {
+                return false;
+            }
+        }
+        m_stage = RX_PDU_PAD;
+        m_remain = layout.data_off - layout.hlen - layout.hdgst_len;
+        break;
+    case RX_PDU_PAD:
+        if (unlikely(!pdu_place())) {
+            return false;
+        }
+        m_stage = RX_PDU_DATA;
+        m_remain = layout.data_len;
+        m_crc = ~0U;
+        break;
+    case RX_PDU_DATA:
+        m_stage = RX_PDU_DDGST;
+        m_remain = layout.ddgst_len;
+        break;
+    case RX_PDU_DDGST:
+        if (layout.ddgst_len && (m_verify & NVME_TCP_F_DDGST)) {
+            memcpy(&digest, m_digest, sizeof(digest));
+            if (unlikely(le32toh(digest) != ~m_crc)) {
+                return false;
+            }
+        }
+        pdu_start();
+        break;
+    }
+    return true;
+}
+
+bool nvme_rx_parser::process(pbuf *&p, uint32_t &dropped)
+{
+    pbuf **link = &p;
+    pbuf *q;
+
+    while ((q = *link) != nullptr) {
+        uint8_t *data = reinterpret_cast<uint8_t *>(q->payload);
+        uint8_t *wr = data;
+        uint32_t len = q->len;
+
+        while (len > 0U) {
+            uint32_t n = std::min(len, m_remain);
+            bool drop = false;
+            uint32_t pos;
+
+            switch (m_stage) {
+            case RX_PDU_CH:
+                memcpy(&m_hdr[NVME_TCP_CH_LEN - m_remain], data, n);
+                m_crc = crc32c_update(m_crc, data, n);
+                break;
+            case RX_PDU_HDR:
+                pos = m_layout.hlen - m_remain;
+                if (pos < NVME_TCP_C2H_HLEN) {
+                    memcpy(&m_hdr[pos], data, std::min(n, NVME_TCP_C2H_HLEN - pos));
+                }
+                if (m_verify & NVME_TCP_F_HDGST) {
+                    m_crc = crc32c_update(m_crc, data, n);
+                }
+                break;
+            case RX_PDU_DATA:
+                if (m_verify & NVME_TCP_F_DDGST) {
+                    m_crc = crc32c_update(m_crc, data, n);
+                }
+                if (m_place) {
+                    memcpy(m_place, data, n);
+                    m_place += n;
+                }
+                drop = m_drop;
+                break;
+            case RX_PDU_HDGST:
+            case RX_PDU_DDGST:
+                memcpy(&m_digest[NVME_TCP_DIGEST_LEN - m_remain], data, n);
+                drop = m_drop && m_stage == RX_PDU_DDGST;
+                break;
+            case RX_PDU_PAD:
+                break;
+            }
+
+            if (drop) {
+                dropped += n;
+            } else {
+                if (wr != data) {
+                    memmove(wr, data, n);
+                }
+                wr += n;
+            }
+            data += n;
+            len -= n;
+            m_remain -= n;
+            /* Skip empty parts, a new PDU always starts with a non-empty common header. */
+            while (m_remain == 0U) {
+                if (unlikely(!pdu_next_stage())) {
+                    return false;
+                }
+            }
+        }
+
+        q->len = wr - reinterpret_cast<uint8_t *>(q->payload);
+        if (q->len == 0U) {
+            *link = q->next;
+            q->next = nullptr;
+            m_free_cb(q);
+        } else {
+            link = &q->next;
+        }
+    }
+
+    if (dropped) {
+        uint32_t tot_len = 0U;
+
+        for (q = p; q; q = q->next) {
+            tot_len += q->len;
+        }
+        for (q = p; q; q = q->next) {
+            q->tot_len = tot_len;
+            tot_len -= q->len;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,130 @@
+/*
+ * Copyright (c) 2001-2023 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ *
+ * This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING in the main directory of this source tree, or the
+ * BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef XLIO_NVME_PDU_H
+#define XLIO_NVME_PDU_H
+
+#include <stdint.h>
+#include <sys/uio.h>
+#include <unordered_map>
+#include "lwip/pbuf.h"
+#include "xlio_extra.h"
+
+/* NVMe/TCP PDU common header, see the NVMe/TCP transport specification. */
+#define NVME_TCP_CH_LEN     8U
+#define NVME_TCP_DIGEST_LEN 4U
+#define NVME_TCP_F_HDGST    (1U << 0)
+#define NVME_TCP_F_DDGST    (1U << 1)
+/* C2HData PDU type and its header with CCCID, DATAO and DATAL fields. */
+#define NVME_TCP_PDU_C2H_DATA 0x07U
+#define NVME_TCP_C2H_HLEN     24U
+
+/* Offsets within a PDU derived from its common header. */
+struct nvme_tcp_pdu_layout {
+    uint32_t plen;
+    uint32_t hlen;
+    uint32_t hdgst_len;
+    uint32_t data_off;
+    uint32_t data_len;
+    uint32_t ddgst_len;
+    uint8_t flags;
+};
+
+bool nvme_tcp_pdu_parse(const uint8_t *ch, nvme_tcp_pdu_layout &layout);
+
+/*
+ * Fills the digest placeholders of a PDU which is described by iov. Only the digests
+ * in sw_digest (NVME_TCP_F_*) are calculated. Returns false for a malformed PDU.
+ */
+bool nvme_pdu_sw_digest(const iovec *iov, size_t iov_nr, size_t pdu_len, uint8_t sw_digest);
+
+/*
+ * Software parser of the received NVMe/TCP stream. It verifies digests and places
+ * C2HData payload into the buffers registered per command. The parser doesn't lock,
+ * the caller serializes it with the TCP connection.
+ */
+class nvme_rx_parser {
+public:
+    typedef u8_t (*pbuf_free_cb_t)(struct pbuf *p);
+
+    nvme_rx_parser(pbuf_free_cb_t free_cb);
+
+    /* Starts parsing at a PDU boundary. */
+    void reset(uint8_t sw_digest, bool is_placement);
+    bool is_placement(void) const { return m_is_placement; }
+    /* Registers the destination of a command or unregisters it if addr is NULL. */
+    void set_buf(const xlio_nvme_rx_buf &buf);
+    /*
+     * Walks the received chain through the PDU state machine. Payload of placed PDUs is
+     * copied to its destination and removed from the chain together with the data digest,
+     * emptied pbufs are released with the free callback and 'p' can become NULL. The number
+     * of removed bytes is added to 'dropped'. Returns false if a PDU is invalid.
+     */
+    bool process(struct pbuf *&p, uint32_t &dropped);
+
+private:
+    enum rx_pdu_stage {
+        RX_PDU_CH,
+        RX_PDU_HDR,
+        RX_PDU_HDGST,
+        RX_PDU_PAD,
+        RX_PDU_DATA,
+        RX_PDU_DDGST,
+    };
+
+    void pdu_start(void);
+    bool pdu_place(void);
+    bool pdu_next_stage(void);
+
+    pbuf_free_cb_t m_free_cb;
+    /* NVME_TCP_F_* digests which are verified in software. */
+    uint8_t m_sw_digest;
+    bool m_is_placement;
+    /* Destination buffers registered with NVME_RX_BUF, the key is CID. */
+    std::unordered_map<uint16_t, xlio_nvme_rx_buf> m_cmd_bufs;
+
+    /* Position in the received byte stream, it is updated per pbuf. */
+    nvme_tcp_pdu_layout m_layout;
+    /* Common header and the C2HData specific part of the header. */
+    uint8_t m_hdr[NVME_TCP_C2H_HLEN];
+    uint8_t m_digest[NVME_TCP_DIGEST_LEN];
+    uint8_t m_verify;
+    rx_pdu_stage m_stage;
+    uint32_t m_remain;
+    uint32_t m_crc;
+    /* Payload and data digest are removed from the stream, payload goes to 'place'. */
+    bool m_drop;
+    uint16_t m_cid;
+    uint8_t *m_place;
+};
+
+#endif /* XLIO_NVME_PDU_H */
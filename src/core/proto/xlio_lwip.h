@@ -73,6 +73,10 @@ typedef enum xlio_wr_tx_packet_attr {
     XLIO_TX_PACKET_BLOCK = (1 << 8),
     /* Force SW checksum */
     XLIO_TX_SW_L4_CSUM = (1 << 9),
+    /* Postpone TX doorbell, see XLIO_TX_DB_DEFER_MAX */
+    XLIO_TX_PACKET_DB_DEFER = (1 << 10),
+    /* Small packet which can be packed into multi-packet WQE, see XLIO_TX_MPW_INLINE_MAX */
+    XLIO_TX_PACKET_MPW = (1 << 11),
 } xlio_wr_tx_packet_attr;
 
 static inline bool is_set(xlio_wr_tx_packet_attr state_, xlio_wr_tx_packet_attr tx_mode_)
@@ -63,6 +63,8 @@ int g_p_fd_collection_size_parent_process = 0;
 
 fd_collection::fd_collection()
     : lock_mutex_recursive("fd_collection")
+    , m_sockfd_reclaim(reclaim_sockfd)
+    , m_sockfd_gen(0)
     , m_b_sysvar_offloaded_sockets(safe_mce_sys().offloaded_sockets)
 #if defined(DEFINED_NGINX)
     // Avoid using socket pool for the master process (which doesn't have parent fd_collection)
@@ -114,7 +116,9 @@ fd_collection::~fd_collection()
     m_p_tap_map = NULL;
 
     m_epfd_lst.clear_without_cleanup();
-    m_pending_to_remove_lst.clear_without_cleanup();
+    for (int i = 0; i < FD_COLLECTION_PENDING_SHARDS; ++i) {
+        m_pending_to_remove[i].list.clear_without_cleanup();
+    }
 }
 
 // Triggers connection close of all handled fds.
@@ -148,12 +152,16 @@ void fd_collection::clear()
 
     lock();
 
+    m_sockfd_reclaim.reclaim(true);
+
     /* internal thread should be already dead and
      * these sockets can not be deleted through the it.
      */
-    while (!m_pending_to_remove_lst.empty()) {
-        socket_fd_api *p_sfd_api = m_pending_to_remove_lst.get_and_pop_back();
-        p_sfd_api->clean_obj();
+    for (int i = 0; i < FD_COLLECTION_PENDING_SHARDS; ++i) {
+        while (!m_pending_to_remove[i].list.empty()) {
+            socket_fd_api *p_sfd_api = m_pending_to_remove[i].list.get_and_pop_back();
+            put_sockfd(p_sfd_api);
+        }
     }
 
     g_global_stat_static.n_pending_sockets = 0U;
@@ -166,11 +174,11 @@ void fd_collection::clear()
                 socket_fd_api *p_sfd_api = get_sockfd(fd);
                 if (p_sfd_api) {
                     p_sfd_api->statistics_print();
-                    p_sfd_api->clean_obj();
+                    put_sockfd(p_sfd_api);
                 }
             }
 
-            m_p_sockfd_map[fd] = NULL;
+            set_sockfd(fd, NULL);
             fdcoll_logdbg("destroyed fd=%d", fd);
         }
 
@@ -257,7 +265,6 @@ int fd_collection::addsocket(int fd, int domain, int type, bool check_offload /*
         fdcoll_logdbg("recovering from %s", e.what());
         return -1;
     }
-    lock();
 
     BULLSEYE_EXCLUDE_BLOCK_START
     if (p_sfd_api_obj == NULL) {
@@ -274,11 +281,10 @@ int fd_collection::addsocket(int fd, int domain, int type, bool check_offload /*
         }
     }
 
+    // The new object is not published yet, so the collection lock is not needed
     assert(!get_sockfd(fd));
     assert(!get_epfd(fd));
-    m_p_sockfd_map[fd] = p_sfd_api_obj;
-
-    unlock();
+    set_sockfd(fd, p_sfd_api_obj);
 
     return fd;
 }
@@ -397,8 +403,8 @@ int fd_collection::addpipe(int fdrd, int fdwr)
     }
     BULLSEYE_EXCLUDE_BLOCK_END
 
-    m_p_sockfd_map[fdrd] = p_fdrd_api_obj;
-    m_p_sockfd_map[fdwr] = p_fdwr_api_obj;
+    set_sockfd(fdrd, p_fdrd_api_obj);
+    set_sockfd(fdwr, p_fdwr_api_obj);
 
     unlock();
 
@@ -537,20 +543,26 @@ int fd_collection::del_sockfd(int fd, bool b_cleanup /*=false*/)
         // 2. Socket deletion when TCP connection == CLOSED
         if (p_sfd_api->prepare_to_close()) {
             // the socket is already closable
-            ret_val = del(fd, b_cleanup, m_p_sockfd_map);
+            if (replace_sockfd(fd, p_sfd_api, NULL)) {
+                retire_sockfd(p_sfd_api);
+                m_sockfd_reclaim.reclaim();
+                ret_val = 0;
+            } else if (!b_cleanup) {
+                fdcoll_logdbg("[fd=%d] Could not find related object", fd);
+            }
         } else {
-            lock();
             // The socket is not ready for close.
             // Delete it from fd_col and add it to pending_to_remove list.
             // This socket will be handled and destroyed now by fd_col.
             // This will be done from fd_col timer handler.
-            if (m_p_sockfd_map[fd] == p_sfd_api) {
-                ++g_global_stat_static.n_pending_sockets;
-                m_p_sockfd_map[fd] = NULL;
-                m_pending_to_remove_lst.push_front(p_sfd_api);
-            }
+            if (replace_sockfd(fd, p_sfd_api, NULL)) {
+                lock_spin &shard_lock = pending_shard_lock(p_sfd_api);
 
-            unlock();
+                shard_lock.lock();
+                __atomic_fetch_add(&g_global_stat_static.n_pending_sockets, 1, __ATOMIC_RELAXED);
+                pending_shard_list(p_sfd_api).push_front(p_sfd_api);
+                shard_lock.unlock();
+            }
             ret_val = 0;
         }
     }
@@ -610,6 +622,17 @@ template <typename cls> int fd_collection::del(int fd, bool b_cleanup, cls **map
     return -1;
 }
 
+void fd_collection::retire_sockfd(socket_fd_api *p_sfd_api_obj)
+{
+    // Reclaim is not done here, the caller can be in a middle of timers processing
+    m_sockfd_reclaim.retire(p_sfd_api_obj);
+}
+
+void fd_collection::reclaim_sockfd(void *obj)
+{
+    put_sockfd(reinterpret_cast<socket_fd_api *>(obj));
+}
+
 void fd_collection::remove_from_all_epfds(int fd, bool passthrough)
 {
     epfd_info_list_t::iterator itr;
@@ -649,9 +672,12 @@ bool fd_collection::pop_socket_pool(int &fd, bool &add_to_udp_pool, int type)
         // use fd from pool - will skip creation of new fd by os
         socket_fd_api *sockfd = m_socket_pool.top();
         fd = sockfd->get_fd();
-        if (m_p_sockfd_map[fd] == NULL) {
-            m_p_sockfd_map[fd] = sockfd;
-            m_pending_to_remove_lst.erase(sockfd);
+        if (replace_sockfd(fd, NULL, sockfd)) {
+            lock_spin &shard_lock = pending_shard_lock(sockfd);
+
+            shard_lock.lock();
+            pending_shard_list(sockfd).erase(sockfd);
+            shard_lock.unlock();
         }
         sockfd->prepare_to_close_socket_pool(false);
         m_socket_pool.pop();
@@ -43,6 +43,7 @@
 #include "sock/cleanable_obj.h"
 #include "sock/socket_fd_api.h"
 #include "iomux/epfd_info.h"
+#include "util/epoch_reclaim.h"
 #include "utils/lock_wrapper.h"
 
 typedef xlio_list_t<socket_fd_api, socket_fd_api::pendig_to_remove_node_offset> sock_fd_api_list_t;
@@ -50,6 +51,9 @@ typedef xlio_list_t<epfd_info, epfd_info::epfd_info_node_offset> epfd_info_list_
 
 typedef std::unordered_map<pthread_t, int> offload_thread_rule_t;
 
+// Number of independently locked lists of the sockets in closing process
+#define FD_COLLECTION_PENDING_SHARDS 16
+
 #if (MAX_DEFINED_LOG_LEVEL < DEFINED_VLOG_FINER)
 #define fdcoll_logfuncall(log_fmt, log_args...) ((void)0)
 #else
@@ -152,6 +156,26 @@ public:
      */
     inline socket_fd_api *get_sockfd(int fd);
 
+    /**
+     * Get sock_fd_api by fd and take a reference which keeps the object alive even if the fd
+     * is closed concurrently. The lookup is wait-free.
+     * @return Referenced object which must be released with put_sockfd() or NULL.
+     */
+    inline socket_fd_api *get_sockfd_ref(int fd);
+    static inline void put_sockfd(socket_fd_api *p_sfd_api_obj);
+
+    /**
+     * Destroy the removed sockets which are not looked up anymore.
+     * Called by the internal thread and the close path, never by the lookups.
+     */
+    inline void reclaim_sockfds();
+
+    /**
+     * Get the generation of the sock_fd_api map. It changes whenever an fd is added to or
+     * removed from the map, so classification of fds done in the same generation is valid.
+     */
+    inline uint64_t get_sockfd_gen() const { return m_sockfd_gen.load(std::memory_order_acquire); }
+
     /**
      * Get epfd_info by fd.
      */
@@ -199,6 +223,13 @@ private:
     template <typename cls> int del(int fd, bool b_cleanup, cls **map_type);
     template <typename cls> inline cls *get(int fd, cls **map_type);
 
+    inline void set_sockfd(int fd, socket_fd_api *p_sfd_api_obj);
+    inline bool replace_sockfd(int fd, socket_fd_api *p_old_obj, socket_fd_api *p_new_obj);
+    inline sock_fd_api_list_t &pending_shard_list(socket_fd_api *p_sfd_api_obj);
+    inline lock_spin &pending_shard_lock(socket_fd_api *p_sfd_api_obj);
+    void retire_sockfd(socket_fd_api *p_sfd_api_obj);
+    static void reclaim_sockfd(void *obj);
+
     int m_n_fd_map_size;
     socket_fd_api **m_p_sockfd_map;
     epfd_info **m_p_epfd_map;
@@ -206,8 +237,15 @@ private:
     ring_tap **m_p_tap_map;
 
     epfd_info_list_t m_epfd_lst;
-    // Contains fds which are in closing process
-    sock_fd_api_list_t m_pending_to_remove_lst;
+    // Contains fds which are in closing process, sharded by fd to avoid the collection lock
+    struct pending_shard {
+        lock_spin lock;
+        sock_fd_api_list_t list;
+    } m_pending_to_remove[FD_COLLECTION_PENDING_SHARDS];
+
+    // Defers destruction of the removed sockets until concurrent lookups are done
+    epoch_reclaim m_sockfd_reclaim;
+    std::atomic<uint64_t> m_sockfd_gen;
 
     const bool m_b_sysvar_offloaded_sockets;
 
@@ -254,6 +292,33 @@ template <typename cls> inline cls *fd_collection::get(int fd, cls **map_type)
     return obj;
 }
 
+inline void fd_collection::set_sockfd(int fd, socket_fd_api *p_sfd_api_obj)
+{
+    __atomic_store_n(&m_p_sockfd_map[fd], p_sfd_api_obj, __ATOMIC_RELEASE);
+    m_sockfd_gen.fetch_add(1, std::memory_order_release);
+}
+
+inline bool fd_collection::replace_sockfd(int fd, socket_fd_api *p_old_obj,
+                                          socket_fd_api *p_new_obj)
+{
+    if (!__atomic_compare_exchange_n(&m_p_sockfd_map[fd], &p_old_obj, p_new_obj, false,
+                                     __ATOMIC_ACQ_REL, __ATOMIC_RELAXED)) {
+        return false;
+    }
+    m_sockfd_gen.fetch_add(1, std::memory_order_release);
+    return true;
+}
+
+inline sock_fd_api_list_t &fd_collection::pending_shard_list(socket_fd_api *p_sfd_api_obj)
+{
+    return m_pending_to_remove[p_sfd_api_obj->get_fd() % FD_COLLECTION_PENDING_SHARDS].list;
+}
+
+inline lock_spin &fd_collection::pending_shard_lock(socket_fd_api *p_sfd_api_obj)
+{
+    return m_pending_to_remove[p_sfd_api_obj->get_fd() % FD_COLLECTION_PENDING_SHARDS].lock;
+}
+
 inline bool fd_collection::set_immediate_os_sample(int fd)
 {
     epfd_info *epfd_fd;
@@ -279,20 +344,29 @@ inline bool fd_collection::set_immediate_os_sample(int fd)
 
 inline void fd_collection::reuse_sockfd(int fd, socket_fd_api *p_sfd_api_obj)
 {
-    lock();
-    m_pending_to_remove_lst.erase(p_sfd_api_obj);
-    m_p_sockfd_map[fd] = p_sfd_api_obj;
-    --g_global_stat_static.n_pending_sockets;
-    unlock();
+    lock_spin &shard_lock = pending_shard_lock(p_sfd_api_obj);
+
+    shard_lock.lock();
+    pending_shard_list(p_sfd_api_obj).erase(p_sfd_api_obj);
+    __atomic_fetch_sub(&g_global_stat_static.n_pending_sockets, 1, __ATOMIC_RELAXED);
+    shard_lock.unlock();
+    set_sockfd(fd, p_sfd_api_obj);
 }
 
 inline void fd_collection::destroy_sockfd(socket_fd_api *p_sfd_api_obj)
 {
-    lock();
-    --g_global_stat_static.n_pending_sockets;
-    m_pending_to_remove_lst.erase(p_sfd_api_obj);
-    p_sfd_api_obj->clean_obj();
-    unlock();
+    lock_spin &shard_lock = pending_shard_lock(p_sfd_api_obj);
+
+    shard_lock.lock();
+    // The socket stays in the timers until it is reclaimed, destroy it only once
+    if (!p_sfd_api_obj->pendig_to_remove_node.is_list_member()) {
+        shard_lock.unlock();
+        return;
+    }
+    __atomic_fetch_sub(&g_global_stat_static.n_pending_sockets, 1, __ATOMIC_RELAXED);
+    pending_shard_list(p_sfd_api_obj).erase(p_sfd_api_obj);
+    shard_lock.unlock();
+    retire_sockfd(p_sfd_api_obj);
 }
 
 inline socket_fd_api *fd_collection::get_sockfd(int fd)
@@ -300,6 +374,38 @@ inline socket_fd_api *fd_collection::get_sockfd(int fd)
     return get(fd, m_p_sockfd_map);
 }
 
+inline socket_fd_api *fd_collection::get_sockfd_ref(int fd)
+{
+    socket_fd_api *p_sfd_api_obj;
+
+    if (!is_valid_fd(fd)) {
+        return NULL;
+    }
+
+    m_sockfd_reclaim.read_lock();
+    p_sfd_api_obj = __atomic_load_n(&m_p_sockfd_map[fd], __ATOMIC_ACQUIRE);
+    if (p_sfd_api_obj) {
+        p_sfd_api_obj->get_ref();
+    }
+    m_sockfd_reclaim.read_unlock();
+
+    return p_sfd_api_obj;
+}
+
+inline void fd_collection::reclaim_sockfds()
+{
+    if (m_sockfd_reclaim.has_retired()) {
+        m_sockfd_reclaim.reclaim();
+    }
+}
+
+inline void fd_collection::put_sockfd(socket_fd_api *p_sfd_api_obj)
+{
+    if (p_sfd_api_obj->put_ref()) {
+        p_sfd_api_obj->clean_obj();
+    }
+}
+
 inline epfd_info *fd_collection::get_epfd(int fd)
 {
     return get(fd, m_p_epfd_map);
@@ -334,6 +440,38 @@ inline socket_fd_api *fd_collection_get_sockfd(int fd)
     return NULL;
 }
 
+/**
+ * Scoped reference to a sock_fd_api object. The object is not destroyed while the reference
+ * exists, even if another thread closes the fd.
+ */
+class sockfd_ref {
+public:
+    sockfd_ref(int fd)
+        : m_p_obj(g_p_fd_collection ? g_p_fd_collection->get_sockfd_ref(fd) : NULL)
+    {
+    }
+    ~sockfd_ref()
+    {
+        if (m_p_obj) {
+            fd_collection::put_sockfd(m_p_obj);
+        }
+    }
+    sockfd_ref(const sockfd_ref &) = delete;
+    sockfd_ref &operator=(const sockfd_ref &) = delete;
+
+    inline socket_fd_api *get() const { return m_p_obj; }
+    inline operator socket_fd_api *() const { return m_p_obj; }
+    inline socket_fd_api *operator->() const { return m_p_obj; }
+
+private:
+    socket_fd_api *m_p_obj;
+};
+
+inline uint64_t fd_collection_get_sockfd_gen()
+{
+    return g_p_fd_collection ? g_p_fd_collection->get_sockfd_gen() : 0;
+}
+
 inline epfd_info *fd_collection_get_epfd(int fd)
 {
     if (g_p_fd_collection) {
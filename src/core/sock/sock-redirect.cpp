@@ -60,6 +60,7 @@
 
 #include <sock/sockinfo_tcp.h>
 #include <sock/sockinfo_udp.h>
+#include <sock/sock_uring.h>
 
 #include "fd_collection.h"
 #include "util/instrumentation.h"
@@ -274,7 +275,7 @@ bool handle_close(int fd, bool cleanup, bool passthrough)
         // Remove fd from all existing epoll sets
         g_p_fd_collection->remove_from_all_epfds(fd, passthrough);
 
-        socket_fd_api *sockfd = fd_collection_get_sockfd(fd);
+        sockfd_ref sockfd(fd);
         if (sockfd) {
             // Don't call close(2) for objects without a shadow socket (TCP incoming sockets).
             to_close_now = !passthrough && sockfd->is_shadow_socket_present();
@@ -424,8 +425,7 @@ extern "C" int xlio_register_recv_callback(int __fd, xlio_recv_callback_t __call
 {
     srdr_logfunc_entry("fd=%d", __fd);
 
-    socket_fd_api *p_socket_object = NULL;
-    p_socket_object = fd_collection_get_sockfd(__fd);
+    sockfd_ref p_socket_object(__fd);
     if (p_socket_object && !safe_mce_sys().enable_socketxtreme) {
         p_socket_object->register_callback(__callback, __context);
         return 0;
@@ -439,8 +439,7 @@ extern "C" int xlio_recvfrom_zcopy(int __fd, void *__buf, size_t __nbytes, int *
 {
     srdr_logfuncall_entry("fd=%d", __fd);
 
-    socket_fd_api *p_socket_object = NULL;
-    p_socket_object = fd_collection_get_sockfd(__fd);
+    sockfd_ref p_socket_object(__fd);
     if (p_socket_object) {
         struct iovec piov[1];
         piov[0].iov_base = __buf;
@@ -459,8 +458,7 @@ extern "C" int xlio_recvfrom_zcopy(int __fd, void *__buf, size_t __nbytes, int *
 extern "C" int xlio_recvfrom_zcopy_free_packets(int __fd, struct xlio_recvfrom_zcopy_packet_t *pkts,
                                                 size_t count)
 {
-    socket_fd_api *p_socket_object = NULL;
-    p_socket_object = fd_collection_get_sockfd(__fd);
+    sockfd_ref p_socket_object(__fd);
     if (p_socket_object) {
         return p_socket_object->recvfrom_zcopy_free_packets(pkts, count);
     }
@@ -490,6 +488,9 @@ extern "C" int xlio_socketxtreme_poll(int fd, struct xlio_socketxtreme_completio
     int ret_val = -1;
     cq_channel_info *cq_ch_info = NULL;
 
+    tx_db_defer_window_close();
+    thread_tcp_timers_progress();
+
     cq_ch_info = g_p_fd_collection->get_cq_channel_fd(fd);
 
     if (likely(cq_ch_info)) {
@@ -513,6 +514,7 @@ extern "C" int xlio_socketxtreme_poll(int fd, struct xlio_socketxtreme_completio
 #ifdef RDTSC_MEASURE_RECEIVEFROM_TO_SENDTO
         RDTSC_TAKE_START(g_rdtsc_instr_info_arr[RDTSC_FLOW_RECEIVEFROM_TO_SENDTO]);
 #endif // RDTSC_MEASURE_RECEIVEFROM_TO_SENDTO
+        tx_db_defer_window_open();
         return ret_val;
     } else {
         errno = EBADFD;
@@ -625,8 +627,7 @@ extern "C" int xlio_socketxtreme_free_buff(xlio_buff_t *buff)
 
 extern "C" int xlio_get_socket_rings_num(int fd)
 {
-    socket_fd_api *p_socket_object = NULL;
-    p_socket_object = fd_collection_get_sockfd(fd);
+    sockfd_ref p_socket_object(fd);
     if (p_socket_object && p_socket_object->check_rings()) {
         return p_socket_object->get_rings_num();
     }
@@ -641,7 +642,7 @@ extern "C" int xlio_get_socket_rings_fds(int fd, int *ring_fds, int ring_fds_sz)
         return -1;
     }
 
-    socket_fd_api *p_socket_object = fd_collection_get_sockfd(fd);
+    sockfd_ref p_socket_object(fd);
     if (p_socket_object && p_socket_object->check_rings()) {
         int rings_num = 0;
         int *p_rings_fds = p_socket_object->get_rings_fds(rings_num);
@@ -686,6 +687,55 @@ extern "C" int xlio_dump_fd_stats(int fd, int log_level)
     return -1;
 }
 
+extern "C" int xlio_tx_flush(void)
+{
+    if (g_p_net_device_table_mgr) {
+        g_b_tx_db_pending = false;
+        g_p_net_device_table_mgr->global_ring_flush_tx_db();
+        return 0;
+    }
+    return -1;
+}
+
+extern "C" int xlio_register_recv_memory(int fd, void *addr, size_t length)
+{
+    if (!addr || !length || !fd_collection_get_sockfd(fd)) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    struct iovec mem_desc = {addr, length};
+    return setsockopt(fd, SOL_SOCKET, SO_XLIO_RING_USER_MEMORY, &mem_desc, sizeof(mem_desc));
+}
+
+extern "C" struct xlio_uring *xlio_uring_setup(unsigned int entries)
+{
+    return sock_uring::create(entries);
+}
+
+extern "C" int xlio_uring_enter(struct xlio_uring *ring, unsigned int min_complete)
+{
+    sock_uring *uring = sock_uring::from_ring(ring);
+
+    if (!uring) {
+        errno = EINVAL;
+        return -1;
+    }
+    return uring->enter(min_complete);
+}
+
+extern "C" int xlio_uring_destroy(struct xlio_uring *ring)
+{
+    sock_uring *uring = sock_uring::from_ring(ring);
+
+    if (!uring) {
+        errno = EINVAL;
+        return -1;
+    }
+    delete uring;
+    return 0;
+}
+
 static inline struct cmsghdr *__cmsg_nxthdr(void *__ctl, size_t __size, struct cmsghdr *__cmsg)
 {
     struct cmsghdr *__ptr;
@@ -849,8 +899,7 @@ extern "C" EXPORT_SYMBOL int shutdown(int __fd, int __how)
 {
     srdr_logdbg_entry("fd=%d, how=%d", __fd, __how);
 
-    socket_fd_api *p_socket_object = NULL;
-    p_socket_object = fd_collection_get_sockfd(__fd);
+    sockfd_ref p_socket_object(__fd);
     if (p_socket_object) {
         return p_socket_object->shutdown(__how);
     }
@@ -868,8 +917,7 @@ extern "C" EXPORT_SYMBOL int listen(int __fd, int backlog)
 {
     srdr_logdbg_entry("fd=%d, backlog=%d", __fd, backlog);
 
-    socket_fd_api *p_socket_object = NULL;
-    p_socket_object = fd_collection_get_sockfd(__fd);
+    sockfd_ref p_socket_object(__fd);
 
     if (p_socket_object) {
         // for verifying that the socket is really offloaded
@@ -904,8 +952,7 @@ extern "C" EXPORT_SYMBOL int listen(int __fd, int backlog)
 
 extern "C" EXPORT_SYMBOL int accept(int __fd, struct sockaddr *__addr, socklen_t *__addrlen)
 {
-    socket_fd_api *p_socket_object = NULL;
-    p_socket_object = fd_collection_get_sockfd(__fd);
+    sockfd_ref p_socket_object(__fd);
     if (p_socket_object) {
         return p_socket_object->accept(__addr, __addrlen);
     }
@@ -922,8 +969,7 @@ extern "C" EXPORT_SYMBOL int accept(int __fd, struct sockaddr *__addr, socklen_t
 extern "C" EXPORT_SYMBOL int accept4(int __fd, struct sockaddr *__addr, socklen_t *__addrlen,
                                      int __flags)
 {
-    socket_fd_api *p_socket_object = NULL;
-    p_socket_object = fd_collection_get_sockfd(__fd);
+    sockfd_ref p_socket_object(__fd);
     if (p_socket_object) {
         return p_socket_object->accept4(__addr, __addrlen, __flags);
     }
@@ -953,8 +999,7 @@ extern "C" EXPORT_SYMBOL int bind(int __fd, const struct sockaddr *__addr, sockl
     srdr_logdbg_entry("fd=%d, %s", __fd, sprintf_sockaddr(buf, 256, __addr, __addrlen));
 
     int ret = 0;
-    socket_fd_api *p_socket_object = NULL;
-    p_socket_object = fd_collection_get_sockfd(__fd);
+    sockfd_ref p_socket_object(__fd);
     if (p_socket_object) {
         ret = p_socket_object->bind(__addr, __addrlen);
         if (p_socket_object->isPassthrough()) {
@@ -1000,7 +1045,7 @@ extern "C" EXPORT_SYMBOL int connect(int __fd, const struct sockaddr *__to, sock
     srdr_logdbg_entry("fd=%d, %s", __fd, sprintf_sockaddr(buf, 256, __to, __tolen));
 
     int ret = 0;
-    socket_fd_api *p_socket_object = fd_collection_get_sockfd(__fd);
+    sockfd_ref p_socket_object(__fd);
     if (p_socket_object == nullptr) {
         srdr_logdbg_exit("Unable to get sock_fd_api");
         ret = orig_os_api.connect(__fd, __to, __tolen);
@@ -1042,9 +1087,7 @@ extern "C" EXPORT_SYMBOL int setsockopt(int __fd, int __level, int __optname,
     }
 
     int ret = 0;
-    socket_fd_api *p_socket_object = NULL;
-
-    p_socket_object = fd_collection_get_sockfd(__fd);
+    sockfd_ref p_socket_object(__fd);
     if (p_socket_object) {
         VERIFY_PASSTROUGH_CHANGED(
             ret, p_socket_object->setsockopt(__level, __optname, __optval, __optlen));
@@ -1116,6 +1159,12 @@ extern "C" EXPORT_SYMBOL int getsockopt(int __fd, int __level, int __optname, vo
                           XLIO_EXTRA_API_SOCKETXTREME_FREE_XLIO_BUFF);
             SET_EXTRA_API(dump_fd_stats, xlio_dump_fd_stats, XLIO_EXTRA_API_DUMP_FD_STATS);
             SET_EXTRA_API(ioctl, xlio_ioctl, XLIO_EXTRA_API_IOCTL);
+            SET_EXTRA_API(tx_flush, xlio_tx_flush, XLIO_EXTRA_API_TX_FLUSH);
+            SET_EXTRA_API(register_recv_memory, xlio_register_recv_memory,
+                          XLIO_EXTRA_API_REGISTER_RECV_MEMORY);
+            SET_EXTRA_API(uring_setup, xlio_uring_setup, XLIO_EXTRA_API_URING);
+            SET_EXTRA_API(uring_enter, xlio_uring_enter, XLIO_EXTRA_API_URING);
+            SET_EXTRA_API(uring_destroy, xlio_uring_destroy, XLIO_EXTRA_API_URING);
         }
 
         *((xlio_api_t **)__optval) = xlio_api;
@@ -1124,8 +1173,7 @@ extern "C" EXPORT_SYMBOL int getsockopt(int __fd, int __level, int __optname, vo
     }
 
     int ret = 0;
-    socket_fd_api *p_socket_object = NULL;
-    p_socket_object = fd_collection_get_sockfd(__fd);
+    sockfd_ref p_socket_object(__fd);
     if (p_socket_object) {
         VERIFY_PASSTROUGH_CHANGED(
             ret, p_socket_object->getsockopt(__level, __optname, __optval, __optlen));
@@ -1167,8 +1215,7 @@ extern "C" EXPORT_SYMBOL int fcntl(int __fd, int __cmd, ...)
     va_end(va);
 
     int ret = 0;
-    socket_fd_api *p_socket_object = NULL;
-    p_socket_object = fd_collection_get_sockfd(__fd);
+    sockfd_ref p_socket_object(__fd);
     if (p_socket_object) {
         VERIFY_PASSTROUGH_CHANGED(res, p_socket_object->fcntl(__cmd, arg));
     } else {
@@ -1214,8 +1261,7 @@ extern "C" EXPORT_SYMBOL int fcntl64(int __fd, int __cmd, ...)
     va_end(va);
 
     int ret = 0;
-    socket_fd_api *p_socket_object = NULL;
-    p_socket_object = fd_collection_get_sockfd(__fd);
+    sockfd_ref p_socket_object(__fd);
     BULLSEYE_EXCLUDE_BLOCK_START
     if (!orig_os_api.fcntl64) {
         get_orig_funcs();
@@ -1264,8 +1310,7 @@ extern "C" EXPORT_SYMBOL int ioctl(int __fd, unsigned long int __request, ...)
 
     int ret = 0;
 
-    socket_fd_api *p_socket_object = NULL;
-    p_socket_object = fd_collection_get_sockfd(__fd);
+    sockfd_ref p_socket_object(__fd);
     if (p_socket_object && arg) {
         VERIFY_PASSTROUGH_CHANGED(res, p_socket_object->ioctl(__request, arg));
     } else {
@@ -1290,8 +1335,7 @@ extern "C" EXPORT_SYMBOL int getsockname(int __fd, struct sockaddr *__name, sock
     srdr_logdbg_entry("fd=%d", __fd);
 
     int ret = 0;
-    socket_fd_api *p_socket_object = NULL;
-    p_socket_object = fd_collection_get_sockfd(__fd);
+    sockfd_ref p_socket_object(__fd);
     if (p_socket_object) {
         ret = p_socket_object->getsockname(__name, __namelen);
 
@@ -1325,8 +1369,7 @@ extern "C" EXPORT_SYMBOL int getpeername(int __fd, struct sockaddr *__name, sock
     srdr_logdbg_entry("fd=%d", __fd);
 
     int ret = 0;
-    socket_fd_api *p_socket_object = NULL;
-    p_socket_object = fd_collection_get_sockfd(__fd);
+    sockfd_ref p_socket_object(__fd);
     if (p_socket_object) {
         ret = p_socket_object->getpeername(__name, __namelen);
     } else {
@@ -1355,8 +1398,7 @@ extern "C" EXPORT_SYMBOL ssize_t read(int __fd, void *__buf, size_t __nbytes)
 {
     srdr_logfuncall_entry("fd=%d", __fd);
 
-    socket_fd_api *p_socket_object = NULL;
-    p_socket_object = fd_collection_get_sockfd(__fd);
+    sockfd_ref p_socket_object(__fd);
     if (p_socket_object) {
         struct iovec piov[1];
         piov[0].iov_base = __buf;
@@ -1386,8 +1428,7 @@ extern "C" EXPORT_SYMBOL ssize_t __read_chk(int __fd, void *__buf, size_t __nbyt
 {
     srdr_logfuncall_entry("fd=%d", __fd);
 
-    socket_fd_api *p_socket_object = NULL;
-    p_socket_object = fd_collection_get_sockfd(__fd);
+    sockfd_ref p_socket_object(__fd);
     if (p_socket_object) {
         BULLSEYE_EXCLUDE_BLOCK_START
         if (__nbytes > __buflen) {
@@ -1421,8 +1462,7 @@ extern "C" EXPORT_SYMBOL ssize_t readv(int __fd, const struct iovec *iov, int io
 {
     srdr_logfuncall_entry("fd=%d", __fd);
 
-    socket_fd_api *p_socket_object = NULL;
-    p_socket_object = fd_collection_get_sockfd(__fd);
+    sockfd_ref p_socket_object(__fd);
     if (p_socket_object) {
         struct iovec *piov = (struct iovec *)iov;
         int dummy_flags = 0;
@@ -1446,8 +1486,7 @@ extern "C" EXPORT_SYMBOL ssize_t recv(int __fd, void *__buf, size_t __nbytes, in
 {
     srdr_logfuncall_entry("fd=%d", __fd);
 
-    socket_fd_api *p_socket_object = NULL;
-    p_socket_object = fd_collection_get_sockfd(__fd);
+    sockfd_ref p_socket_object(__fd);
     if (p_socket_object) {
         struct iovec piov[1];
         piov[0].iov_base = __buf;
@@ -1476,8 +1515,7 @@ extern "C" EXPORT_SYMBOL ssize_t __recv_chk(int __fd, void *__buf, size_t __nbyt
 {
     srdr_logfuncall_entry("fd=%d", __fd);
 
-    socket_fd_api *p_socket_object = NULL;
-    p_socket_object = fd_collection_get_sockfd(__fd);
+    sockfd_ref p_socket_object(__fd);
     if (p_socket_object) {
         BULLSEYE_EXCLUDE_BLOCK_START
         if (__nbytes > __buflen) {
@@ -1515,8 +1553,7 @@ extern "C" EXPORT_SYMBOL ssize_t recvmsg(int __fd, struct msghdr *__msg, int __f
         return -1;
     }
 
-    socket_fd_api *p_socket_object = NULL;
-    p_socket_object = fd_collection_get_sockfd(__fd);
+    sockfd_ref p_socket_object(__fd);
     if (p_socket_object) {
         __msg->msg_flags = 0;
         return p_socket_object->rx(RX_RECVMSG, __msg->msg_iov, __msg->msg_iovlen, &__flags,
@@ -1577,8 +1614,7 @@ extern "C" EXPORT_SYMBOL
     if (__timeout) {
         gettime(&start_time);
     }
-    socket_fd_api *p_socket_object = NULL;
-    p_socket_object = fd_collection_get_sockfd(__fd);
+    sockfd_ref p_socket_object(__fd);
     if (p_socket_object) {
         int ret = 0;
         for (unsigned int i = 0; i < __vlen; i++) {
@@ -1634,8 +1670,7 @@ extern "C" EXPORT_SYMBOL ssize_t recvfrom(int __fd, void *__buf, size_t __nbytes
 
     srdr_logfuncall_entry("fd=%d", __fd);
 
-    socket_fd_api *p_socket_object = NULL;
-    p_socket_object = fd_collection_get_sockfd(__fd);
+    sockfd_ref p_socket_object(__fd);
     if (p_socket_object) {
         struct iovec piov[1];
         piov[0].iov_base = __buf;
@@ -1683,8 +1718,7 @@ extern "C" EXPORT_SYMBOL ssize_t __recvfrom_chk(int __fd, void *__buf, size_t __
 {
     srdr_logfuncall_entry("fd=%d", __fd);
 
-    socket_fd_api *p_socket_object = NULL;
-    p_socket_object = fd_collection_get_sockfd(__fd);
+    sockfd_ref p_socket_object(__fd);
     if (p_socket_object) {
         BULLSEYE_EXCLUDE_BLOCK_START
         if (__nbytes > __buflen) {
@@ -1715,8 +1749,7 @@ extern "C" EXPORT_SYMBOL ssize_t write(int __fd, __const void *__buf, size_t __n
 {
     srdr_logfuncall_entry("fd=%d, nbytes=%d", __fd, __nbytes);
 
-    socket_fd_api *p_socket_object = NULL;
-    p_socket_object = fd_collection_get_sockfd(__fd);
+    sockfd_ref p_socket_object(__fd);
     if (p_socket_object) {
         struct iovec piov[1] = {{(void *)__buf, __nbytes}};
         xlio_tx_call_attr_t tx_arg;
@@ -1744,8 +1777,7 @@ extern "C" EXPORT_SYMBOL ssize_t writev(int __fd, const struct iovec *iov, int i
 {
     srdr_logfuncall_entry("fd=%d, %d iov blocks", __fd, iovcnt);
 
-    socket_fd_api *p_socket_object = NULL;
-    p_socket_object = fd_collection_get_sockfd(__fd);
+    sockfd_ref p_socket_object(__fd);
     if (p_socket_object) {
         xlio_tx_call_attr_t tx_arg;
 
@@ -1772,8 +1804,7 @@ extern "C" EXPORT_SYMBOL ssize_t send(int __fd, __const void *__buf, size_t __nb
 {
     srdr_logfuncall_entry("fd=%d, nbytes=%d", __fd, __nbytes);
 
-    socket_fd_api *p_socket_object = NULL;
-    p_socket_object = fd_collection_get_sockfd(__fd);
+    sockfd_ref p_socket_object(__fd);
     if (p_socket_object) {
         struct iovec piov[1] = {{(void *)__buf, __nbytes}};
         xlio_tx_call_attr_t tx_arg;
@@ -1809,8 +1840,7 @@ extern "C" EXPORT_SYMBOL ssize_t sendmsg(int __fd, __const struct msghdr *__msg,
 {
     srdr_logfuncall_entry("fd=%d", __fd);
 
-    socket_fd_api *p_socket_object = NULL;
-    p_socket_object = fd_collection_get_sockfd(__fd);
+    sockfd_ref p_socket_object(__fd);
     if (p_socket_object) {
         xlio_tx_call_attr_t tx_arg;
 
@@ -1875,9 +1905,11 @@ extern "C" EXPORT_SYMBOL int sendmmsg(int __fd, struct mmsghdr *__mmsghdr, unsig
         return -1;
     }
 
-    socket_fd_api *p_socket_object = NULL;
-    p_socket_object = fd_collection_get_sockfd(__fd);
+    sockfd_ref p_socket_object(__fd);
     if (p_socket_object) {
+        bool was_open = tx_db_defer_burst_begin();
+        int ret = 0;
+
         for (unsigned int i = 0; i < __vlen; i++) {
             xlio_tx_call_attr_t tx_arg;
 
@@ -1889,18 +1921,15 @@ extern "C" EXPORT_SYMBOL int sendmmsg(int __fd, struct mmsghdr *__mmsghdr, unsig
             tx_arg.attr.len = (socklen_t)__mmsghdr[i].msg_hdr.msg_namelen;
             tx_arg.attr.hdr = &__mmsghdr[i].msg_hdr;
 
-            int ret = p_socket_object->tx(tx_arg);
+            ret = p_socket_object->tx(tx_arg);
             if (ret < 0) {
-                if (num_of_msg) {
-                    return num_of_msg;
-                } else {
-                    return ret;
-                }
+                break;
             }
             num_of_msg++;
             __mmsghdr[i].msg_len = ret;
         }
-        return num_of_msg;
+        tx_db_defer_burst_end(was_open);
+        return (num_of_msg || ret >= 0) ? num_of_msg : ret;
     }
 
     // Ignore dummy messages for OS
@@ -1934,8 +1963,7 @@ extern "C" EXPORT_SYMBOL ssize_t sendto(int __fd, __const void *__buf, size_t __
 #endif // RDTSC_MEASURE_TX_SENDTO_TO_AFTER_POST_SEND
     srdr_logfuncall_entry("fd=%d, nbytes=%d", __fd, __nbytes);
 
-    socket_fd_api *p_socket_object = NULL;
-    p_socket_object = fd_collection_get_sockfd(__fd);
+    sockfd_ref p_socket_object(__fd);
     if (p_socket_object) {
         struct iovec piov[1] = {{(void *)__buf, __nbytes}};
         xlio_tx_call_attr_t tx_arg;
@@ -2149,7 +2177,7 @@ extern "C" EXPORT_SYMBOL ssize_t sendfile(int out_fd, int in_fd, off_t *offset,
     srdr_logfuncall_entry("out_fd=%d, in_fd=%d, offset=%p, *offset=%zu, count=%d", out_fd, in_fd,
                           offset, offset ? *offset : 0, count);
 
-    socket_fd_api *p_socket_object = fd_collection_get_sockfd(out_fd);
+    sockfd_ref p_socket_object(out_fd);
     if (!p_socket_object) {
         if (!orig_os_api.sendfile) {
             get_orig_funcs();
@@ -2165,7 +2193,7 @@ extern "C" EXPORT_SYMBOL ssize_t sendfile64(int out_fd, int in_fd, __off64_t *of
     srdr_logfuncall_entry("out_fd=%d, in_fd=%d, offset=%p, *offset=%zu, count=%d", out_fd, in_fd,
                           offset, offset ? *offset : 0, count);
 
-    socket_fd_api *p_socket_object = fd_collection_get_sockfd(out_fd);
+    sockfd_ref p_socket_object(out_fd);
     if (!p_socket_object) {
         if (!orig_os_api.sendfile64) {
             get_orig_funcs();
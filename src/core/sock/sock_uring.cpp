@@ -0,0 +1,286 @@
+/*
+ * Copyright (c) 2001-2023 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ *
+ * This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING in the main directory of this source tree, or the
+ * BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <errno.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <new>
+#include <unordered_set>
+
+#include "vlogger/vlogger.h"
+#include "util/sys_vars.h"
+#include "dev/net_device_table_mgr.h"
+#include "sock/fd_collection.h"
+#include "sock/sock_uring.h"
+
+#define MODULE_NAME "uring"
+
+#define uring_logdbg    __log_dbg
+#define uring_logfunc   __log_func
+
+// The completion ring is larger to absorb results of the pending operations
+#define URING_CQ_FACTOR     2
+#define URING_MAX_ENTRIES   (1U << 15)
+
+struct xlio_uring *sock_uring::create(unsigned int entries)
+{
+    uint32_t sq_entries = 1;
+
+    if (entries == 0 || entries > URING_MAX_ENTRIES) {
+        errno = EINVAL;
+        return NULL;
+    }
+    while (sq_entries < entries) {
+        sq_entries <<= 1;
+    }
+
+    sock_uring *uring = new (std::nothrow) sock_uring(sq_entries);
+    if (!uring || !uring->m_ring.sqes || !uring->m_ring.cqes) {
+        delete uring;
+        errno = ENOMEM;
+        return NULL;
+    }
+
+    uring_logdbg("created ring %p with %u entries", &uring->m_ring, sq_entries);
+    return &uring->m_ring;
+}
+
+sock_uring *sock_uring::from_ring(struct xlio_uring *ring)
+{
+    if (!ring || !ring->priv || &((sock_uring *)ring->priv)->m_ring != ring) {
+        return NULL;
+    }
+    return (sock_uring *)ring->priv;
+}
+
+sock_uring::sock_uring(uint32_t sq_entries)
+    : m_lock("sock_uring")
+    , m_poll_sn(0)
+{
+    uint32_t cq_entries = sq_entries * URING_CQ_FACTOR;
+
+    memset(&m_ring, 0, sizeof(m_ring));
+    m_ring.sq_mask = sq_entries - 1;
+    m_ring.cq_mask = cq_entries - 1;
+    m_ring.sqes = (struct xlio_uring_sqe *)calloc(sq_entries, sizeof(struct xlio_uring_sqe));
+    m_ring.cqes = (struct xlio_uring_cqe *)calloc(cq_entries, sizeof(struct xlio_uring_cqe));
+    m_ring.priv = this;
+}
+
+sock_uring::~sock_uring()
+{
+    if (!m_pending.empty()) {
+        uring_logdbg("ring %p destroyed with %zu pending operations", &m_ring, m_pending.size());
+    }
+    m_ring.priv = NULL;
+    free(m_ring.sqes);
+    free(m_ring.cqes);
+}
+
+void sock_uring::post_cqe(uint64_t user_data, int32_t res)
+{
+    struct xlio_uring_cqe *cqe = &m_ring.cqes[m_ring.cq_tail & m_ring.cq_mask];
+
+    cqe->user_data = user_data;
+    cqe->res = res;
+    cqe->flags = 0;
+    __atomic_store_n(&m_ring.cq_tail, m_ring.cq_tail + 1, __ATOMIC_RELEASE);
+}
+
+void sock_uring::add_pending(const struct xlio_uring_sqe &sqe)
+{
+    m_pending.push_back(sqe);
+    ++m_pending_per_fd[sqe.fd];
+}
+
+void sock_uring::cancel_pending(int fd)
+{
+    if (m_pending_per_fd.erase(fd) == 0) {
+        return;
+    }
+
+    std::deque<struct xlio_uring_sqe> pending;
+    for (const struct xlio_uring_sqe &sqe : m_pending) {
+        if (sqe.fd == fd) {
+            post_cqe(sqe.user_data, -ECANCELED);
+        } else {
+            pending.push_back(sqe);
+        }
+    }
+    m_pending.swap(pending);
+}
+
+/**
+ * Execute one operation without blocking.
+ * @return false if the operation would block, true if it completed with res.
+ */
+bool sock_uring::execute(const struct xlio_uring_sqe &sqe, int32_t &res)
+{
+    ssize_t ret;
+
+    if (sqe.opcode == XLIO_URING_OP_NOP) {
+        res = 0;
+        return true;
+    }
+    if (sqe.opcode == XLIO_URING_OP_CLOSE) {
+        cancel_pending(sqe.fd);
+        res = close(sqe.fd) ? -errno : 0;
+        return true;
+    }
+
+    sockfd_ref p_socket_object(sqe.fd);
+    if (!p_socket_object) {
+        res = -EOPNOTSUPP;
+        return true;
+    }
+
+    switch (sqe.opcode) {
+    case XLIO_URING_OP_SEND: {
+        struct iovec iov = {(void *)sqe.addr, sqe.len};
+        xlio_tx_call_attr_t tx_arg;
+
+        tx_arg.opcode = TX_SEND;
+        tx_arg.attr.iov = &iov;
+        tx_arg.attr.sz_iov = 1;
+        tx_arg.attr.flags = sqe.flags | MSG_DONTWAIT;
+        ret = p_socket_object->tx(tx_arg);
+        break;
+    }
+    case XLIO_URING_OP_RECV: {
+        struct iovec iov = {(void *)sqe.addr, sqe.len};
+        int flags = sqe.flags | MSG_DONTWAIT;
+
+        ret = p_socket_object->rx(RX_RECV, &iov, 1, &flags);
+        break;
+    }
+    case XLIO_URING_OP_ACCEPT:
+        // Listen socket can be blocking, so accept only when a connection is ready
+        if (!p_socket_object->is_readable(NULL)) {
+            return false;
+        }
+        ret = p_socket_object->accept4((struct sockaddr *)sqe.addr, (socklen_t *)sqe.addr2,
+                                       sqe.flags);
+        break;
+    default:
+        res = -EINVAL;
+        return true;
+    }
+
+    if (ret < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+        return false;
+    }
+    res = (ret < 0) ? -errno : (int32_t)ret;
+    return true;
+}
+
+void sock_uring::progress_pending()
+{
+    std::deque<struct xlio_uring_sqe> pending;
+    std::unordered_set<int> blocked_fds;
+    int32_t res;
+
+    if (g_p_net_device_table_mgr) {
+        g_p_net_device_table_mgr->global_ring_poll_and_process_element(&m_poll_sn, NULL);
+    }
+
+    m_pending.swap(pending);
+    m_pending_per_fd.clear();
+    while (!pending.empty()) {
+        struct xlio_uring_sqe sqe = pending.front();
+
+        pending.pop_front();
+        // Keep the submission order of the operations of the same fd
+        if (blocked_fds.count(sqe.fd) || !execute(sqe, res)) {
+            blocked_fds.insert(sqe.fd);
+            add_pending(sqe);
+        } else {
+            post_cqe(sqe.user_data, res);
+        }
+    }
+}
+
+int sock_uring::enter(unsigned int min_complete)
+{
+    int errno_save = errno;
+    int consumed = 0;
+    int32_t res;
+
+    if (min_complete > m_ring.cq_mask + 1) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    m_lock.lock();
+
+    if (!m_pending.empty()) {
+        progress_pending();
+    }
+
+    uint32_t head = m_ring.sq_head;
+    uint32_t tail = __atomic_load_n(&m_ring.sq_tail, __ATOMIC_ACQUIRE);
+
+    // Every pending operation has a CQE reserved
+    while (head != tail && cq_space() > m_pending.size()) {
+        struct xlio_uring_sqe sqe = m_ring.sqes[head & m_ring.sq_mask];
+
+        ++head;
+        ++consumed;
+        if (m_pending_per_fd.count(sqe.fd) && sqe.opcode != XLIO_URING_OP_CLOSE) {
+            add_pending(sqe);
+        } else if (execute(sqe, res)) {
+            post_cqe(sqe.user_data, res);
+        } else {
+            add_pending(sqe);
+        }
+    }
+    __atomic_store_n(&m_ring.sq_head, head, __ATOMIC_RELEASE);
+
+    /* Only pending operations can produce more completions. Poll them for at most
+     * XLIO_RX_POLL rounds and release the lock between the rounds, so other threads which
+     * enter the ring are not starved.
+     */
+    int32_t poll_budget = safe_mce_sys().rx_poll_num;
+    while (cq_ready() < min_complete && !m_pending.empty() && poll_budget != 0) {
+        m_lock.unlock();
+        m_lock.lock();
+        progress_pending();
+        if (poll_budget > 0) {
+            --poll_budget;
+        }
+    }
+
+    m_lock.unlock();
+
+    uring_logfunc("ring %p consumed=%d pending=%zu", &m_ring, consumed, m_pending.size());
+    errno = errno_save;
+    return consumed;
+}
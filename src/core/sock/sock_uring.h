@@ -0,0 +1,78 @@
+/*
+ * Copyright (c) 2001-2023 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ *
+ * This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING in the main directory of this source tree, or the
+ * BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef SOCK_URING_H
+#define SOCK_URING_H
+
+#include <deque>
+#include <unordered_map>
+
+#include "xlio_extra.h"
+#include "utils/lock_wrapper.h"
+
+/**
+ * Submission/completion ring pair of the extra API.
+ * Operations are executed inline by enter() in the caller context. Operations which would
+ * block are kept in the pending queue and are retried by the next enter() calls.
+ */
+class sock_uring {
+public:
+    static struct xlio_uring *create(unsigned int entries);
+    static sock_uring *from_ring(struct xlio_uring *ring);
+    ~sock_uring();
+
+    int enter(unsigned int min_complete);
+
+private:
+    sock_uring(uint32_t sq_entries);
+
+    inline uint32_t cq_ready() const
+    {
+        return m_ring.cq_tail - __atomic_load_n(&m_ring.cq_head, __ATOMIC_ACQUIRE);
+    }
+    inline uint32_t cq_space() const { return m_ring.cq_mask + 1 - cq_ready(); }
+
+    void post_cqe(uint64_t user_data, int32_t res);
+    void add_pending(const struct xlio_uring_sqe &sqe);
+    void cancel_pending(int fd);
+    bool execute(const struct xlio_uring_sqe &sqe, int32_t &res);
+    void progress_pending();
+
+    struct xlio_uring m_ring;
+    lock_spin m_lock;
+    // Operations which would block, in submission order
+    std::deque<struct xlio_uring_sqe> m_pending;
+    std::unordered_map<int, uint32_t> m_pending_per_fd;
+    uint64_t m_poll_sn;
+};
+
+#endif /* SOCK_URING_H */
@@ -47,9 +47,14 @@
 
 socket_fd_api::socket_fd_api(int fd)
     : m_epoll_event_flags(0)
+    , m_epoll_pending_events(0)
+    , m_ep_pending_next(NULL)
+    , m_epoll_level_events(0)
     , m_fd(fd)
     , m_n_sysvar_select_poll_os_ratio(safe_mce_sys().select_poll_os_ratio)
     , m_econtext(NULL)
+    , m_econtext_lock("socket_fd_api:econtext")
+    , m_fd_refs(1)
 #if defined(DEFINED_NGINX)
     , m_is_for_socket_pool(false)
     , m_is_listen(false)
@@ -331,15 +336,27 @@ int socket_fd_api::add_epoll_context(epfd_info *epfd)
 void socket_fd_api::remove_epoll_context(epfd_info *epfd)
 {
     if (m_econtext == epfd) {
+        // A notifier which has seen the old context completes before it is cleared
+        m_econtext_lock.lock();
         m_econtext = NULL;
+        m_econtext_lock.unlock();
     }
 }
 
 void socket_fd_api::notify_epoll_context(uint32_t events)
 {
+    if (!m_econtext) {
+        return;
+    }
+
+    /* Notifiers run under the RX or TX lock of the socket, and the TX path doesn't exclude
+     * remove_epoll_context(). The context is checked again under m_econtext_lock.
+     */
+    m_econtext_lock.lock();
     if (m_econtext) {
         m_econtext->insert_epoll_event_cb(this, events);
     }
+    m_econtext_lock.unlock();
 }
 
 void socket_fd_api::notify_epoll_context_add_ring(ring *ring)
@@ -35,6 +35,8 @@
 
 #include "config.h"
 #include <sys/socket.h>
+#include <sys/epoll.h>
+#include <atomic>
 #include "xlio_extra.h"
 
 #include <dev/cq_mgr.h>
@@ -50,6 +52,12 @@
 #ifndef SO_MAX_PACING_RATE
 #define SO_MAX_PACING_RATE 47
 #endif
+#ifndef EPOLLEXCLUSIVE
+#define EPOLLEXCLUSIVE (1U << 28)
+#endif
+
+/* Epoll flags which are kept by a disarmed EPOLLONESHOT fd (same as kernel EP_PRIVATE_BITS) */
+#define EPOLL_PRIVATE_BITS (EPOLLWAKEUP | EPOLLONESHOT | EPOLLET | EPOLLEXCLUSIVE)
 
 #define IS_DUMMY_PACKET(flags) (flags & XLIO_SND_FLAGS_DUMMY)
 
@@ -70,6 +78,14 @@ struct epoll_fd_rec {
         memset(&this->epdata, 0, sizeof(this->epdata));
         this->offloaded_index = 0;
     }
+
+    // EPOLLONESHOT fd which already reported its events and waits for EPOLL_CTL_MOD
+    bool is_disarmed() const
+    {
+        return (this->events & EPOLLONESHOT) && !(this->events & ~EPOLL_PRIVATE_BITS);
+    }
+
+    void disarm() { this->events &= EPOLL_PRIVATE_BITS; }
 };
 
 typedef enum {
@@ -258,6 +274,10 @@ public:
     }
     list_node<socket_fd_api, socket_fd_api::pendig_to_remove_node_offset> pendig_to_remove_node;
 
+    // References which keep the object alive, fd_collection holds one while the fd is open
+    inline void get_ref() { m_fd_refs.fetch_add(1, std::memory_order_relaxed); }
+    inline bool put_ref() { return m_fd_refs.fetch_sub(1, std::memory_order_acq_rel) == 1; }
+
     static inline size_t socket_fd_list_node_offset(void)
     {
         return NODE_OFFSET(socket_fd_api, socket_fd_list_node);
@@ -270,6 +290,13 @@ public:
     }
     list_node<socket_fd_api, socket_fd_api::ep_ready_fd_node_offset> ep_ready_fd_node;
     uint32_t m_epoll_event_flags;
+    // Events published without epfd lock, merged into m_epoll_event_flags by epfd_info
+    std::atomic<uint32_t> m_epoll_pending_events;
+    socket_fd_api *m_ep_pending_next;
+    // Events which are ready, kept up to date by the socket under its own locks. Level triggered
+    // epoll reports them as is and calls is_readable()/is_writeable()/is_errorable() for the
+    // other events only.
+    std::atomic<uint32_t> m_epoll_level_events;
 
     static inline size_t ep_info_fd_node_offset(void)
     {
@@ -287,6 +314,17 @@ public:
     }
 
 protected:
+    inline void set_epoll_level(uint32_t events, bool ready)
+    {
+        uint32_t level = m_epoll_level_events.load(std::memory_order_relaxed);
+
+        if (ready && (level & events) != events) {
+            m_epoll_level_events.fetch_or(events, std::memory_order_relaxed);
+        } else if (!ready && (level & events)) {
+            m_epoll_level_events.fetch_and(~events, std::memory_order_relaxed);
+        }
+    }
+
     void notify_epoll_context(uint32_t events);
     void notify_epoll_context_add_ring(ring *ring);
     void notify_epoll_context_remove_ring(ring *ring);
@@ -301,6 +339,11 @@ protected:
     ssize_t rx_os(const rx_call_t call_type, iovec *p_iov, ssize_t sz_iov, const int flags,
                   sockaddr *__from, socklen_t *__fromlen, struct msghdr *__msg);
     epfd_info *m_econtext;
+    // Excludes notify_epoll_context() from remove_epoll_context(), the epfd lock isn't taken
+    lock_mutex m_econtext_lock;
+
+private:
+    std::atomic<int> m_fd_refs;
 
 public:
 #if defined(DEFINED_NGINX)
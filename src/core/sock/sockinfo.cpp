@@ -1681,6 +1681,7 @@ void sockinfo::pop_descs_rx_ready(descq_t *cache, ring *p_ring)
         m_p_socket_stats->n_rx_ready_byte_count -= temp->rx.sz_payload;
         cache->push_back(temp);
     }
+    update_epoll_level_in();
 }
 
 void sockinfo::push_descs_rx_ready(descq_t *cache)
@@ -1699,6 +1700,7 @@ void sockinfo::push_descs_rx_ready(descq_t *cache)
         m_p_socket_stats->n_rx_ready_byte_count += temp->rx.sz_payload;
         push_back_m_rx_pkt_ready_list(temp);
     }
+    update_epoll_level_in();
 }
 
 void sockinfo::reuse_descs(descq_t *reuseq, ring *p_ring)
@@ -2093,6 +2095,7 @@ void sockinfo::handle_recv_errqueue(struct cmsg_state *cm_state)
 
     m_error_queue_lock.lock();
     buff = m_error_queue.get_and_pop_front();
+    set_epoll_level(EPOLLERR, !m_error_queue.empty());
     m_error_queue_lock.unlock();
 
     if (!(buff->m_flags & mem_buf_desc_t::CLONED)) {
@@ -41,7 +41,7 @@
 #include "util/sock_addr.h"
 #include "util/xlio_stats.h"
 #include "util/sys_vars.h"
-#include "util/wakeup_pipe.h"
+#include "util/wakeup_eventfd.h"
 #include "proto/flow_tuple.h"
 #include "proto/mem_buf_desc.h"
 #include "proto/dst_entry.h"
@@ -156,7 +156,7 @@ const uint8_t ip_tos2prio[16] = {0, 0, 0, 0, 2, 2, 2, 2, 6, 6, 6, 6, 4, 4, 4, 4}
 class sockinfo : public socket_fd_api,
                  public pkt_rcvr_sink,
                  public pkt_sndr_source,
-                 public wakeup_pipe {
+                 public wakeup_eventfd {
 public:
     sockinfo(int fd, int domain);
     virtual ~sockinfo();
@@ -220,6 +220,7 @@ public:
         m_rx_ready_byte_count = 0;
         m_p_socket_stats->n_rx_ready_pkt_count = 0;
         m_p_socket_stats->n_rx_ready_byte_count = 0;
+        update_epoll_level_in();
 
         unlock_rx_q();
     }
@@ -410,7 +411,7 @@ protected:
     virtual inline void do_wakeup()
     {
         if (!is_socketxtreme()) {
-            wakeup_pipe::do_wakeup();
+            wakeup_eventfd::do_wakeup();
         }
     }
 
@@ -431,6 +432,12 @@ protected:
         }
     }
 
+    // EPOLLIN level follows the ready queue, must be called under the RX queue lock
+    inline void update_epoll_level_in()
+    {
+        set_epoll_level(EPOLLIN, m_n_rx_pkt_ready_list_count > 0);
+    }
+
     inline void set_events(uint64_t events)
     {
         /* Collect all events if rx ring is enabled */
@@ -526,6 +533,7 @@ protected:
             m_p_socket_stats->n_rx_ready_byte_count -= total_rx;
             post_deqeue(relase_buff);
             save_stats_rx_offload(total_rx);
+            m_ring_alloc_logic.account_traffic(total_rx);
         }
 
         total_rx = handle_msg_trunc(total_rx, payload_size, in_flags, p_out_flags);
@@ -43,32 +43,68 @@
 #define si_nvme_loginfo __log_info_info
 #define si_nvme_logerr  __log_info_err
 
+/* Digests requested without offload are handled in software if XLIO_NVME_SW_DIGEST is on. */
+static inline uint8_t nvme_sw_digest_flags(uint32_t config)
+{
+    if (!safe_mce_sys().enable_nvme_sw_digest ||
+        (config & (XLIO_NVME_DDGST_OFFLOAD | XLIO_NVME_HDGST_OFFLOAD))) {
+        return 0U;
+    }
+    return ((config & XLIO_NVME_HDGST_ENABLE) ? NVME_TCP_F_HDGST : 0U) |
+        ((config & XLIO_NVME_DDGST_ENABLE) ? NVME_TCP_F_DDGST : 0U);
+}
+
 int sockinfo_tcp_ops_nvme::setsockopt(int level, int optname, const void *optval, socklen_t optlen)
 {
     if (level != NVDA_NVME) {
         return m_p_sock->tcp_setsockopt(level, optname, optval, optlen);
     }
 
-    if (unlikely(optname != NVME_TX && optname != NVME_RX)) {
+    if (unlikely(optname != NVME_TX && optname != NVME_RX && optname != NVME_RX_BUF)) {
         errno = ENOPROTOOPT;
         return -1;
     }
 
+    if (optname == NVME_RX_BUF) {
+        return setsockopt_rx_buf(optval, optlen);
+    }
+
+    if (optname == NVME_RX && optval && optlen == sizeof(uint32_t)) {
+        uint32_t config = *reinterpret_cast<const uint32_t *>(optval);
+        uint8_t sw_digest = nvme_sw_digest_flags(config);
+        bool is_placement = config & XLIO_NVME_RX_PLACEMENT;
+
+        /* Placed payload is removed from the stream, so its digest must be verified here. */
+        if (is_placement && (config & XLIO_NVME_DDGST_ENABLE) &&
+            !(sw_digest & NVME_TCP_F_DDGST)) {
+            errno = EINVAL;
+            return -1;
+        }
+        if (sw_digest || is_placement) {
+            return setsockopt_rx_sw(sw_digest, is_placement);
+        }
+    }
+
     if (optname == NVME_RX && !((ring::NVME_CRC_RX | ring::NVME_ZEROCOPY) & m_nvme_feature_mask)) {
         errno = ENOTSUP;
         return -1;
     }
 
     if (optname == NVME_TX) {
-        if (!(ring::NVME_CRC_TX & m_nvme_feature_mask)) {
-            errno = ENOTSUP;
-            return -1;
-        }
-        if (optlen != sizeof(uint32_t)) {
+        if (optlen != sizeof(uint32_t) || !optval) {
             errno = EINVAL;
             return -1;
         }
         uint32_t config = *reinterpret_cast<const uint32_t *>(optval);
+        m_tx_sw_digest = nvme_sw_digest_flags(config);
+        if (m_tx_sw_digest) {
+            si_nvme_logdbg("NVME_TX digests are calculated in software");
+            return 0;
+        }
+        if (!(ring::NVME_CRC_TX & m_nvme_feature_mask)) {
+            errno = ENOTSUP;
+            return -1;
+        }
         int ret = setsockopt_tx(config);
         m_is_tx_offload = (ret == 0);
         m_is_ddgs_on = m_is_tx_offload && (XLIO_NVME_DDGST_MASK == (config & XLIO_NVME_DDGST_MASK));
@@ -80,7 +116,7 @@ int sockinfo_tcp_ops_nvme::setsockopt(int level, int optname, const void *optval
 
 ssize_t sockinfo_tcp_ops_nvme::tx(xlio_tx_call_attr_t &tx_arg)
 {
-    if (!m_is_tx_offload) {
+    if (!m_is_tx_offload && !m_tx_sw_digest) {
         return m_p_sock->tcp_tx(tx_arg);
     }
 
@@ -105,6 +141,7 @@ ssize_t sockinfo_tcp_ops_nvme::tx(xlio_tx_call_attr_t &tx_arg)
 
     /* The new request points at a new PDU */
     while (num_iovecs < msg->msg_iovlen && sndbuf_len > total_tx_length) {
+        size_t pdu_first_iov = num_iovecs;
         size_t data_len = aux_data[num_iovecs].message_length;
         /* Check if there is enough place in sndbuf for the current PDU */
         if (sndbuf_len < total_tx_length + data_len) {
@@ -123,6 +160,17 @@ ssize_t sockinfo_tcp_ops_nvme::tx(xlio_tx_call_attr_t &tx_arg)
             errno = EINVAL;
             return -1;
         }
+
+        /* Software fallback for adapters without NVMe/TCP offload. It costs an extra read of
+         * the payload, the offload (m_is_tx_offload) calculates the data digest on the wire.
+         */
+        if (m_tx_sw_digest &&
+            !nvme_pdu_sw_digest(&msg->msg_iov[pdu_first_iov], num_iovecs - pdu_first_iov,
+                                aux_data[pdu_first_iov].message_length, m_tx_sw_digest)) {
+            si_nvme_logerr("Invalid PDU header - unable to calculate digests");
+            errno = EINVAL;
+            return -1;
+        }
     }
     if (num_iovecs == 0U || total_tx_length == 0U) {
         si_nvme_logerr("Found %zu iovecs with length %zu to fit in sndbuff %u", num_iovecs,
@@ -241,7 +289,74 @@ bool sockinfo_tcp_ops_nvme::handle_send_ret(ssize_t ret, tcp_seg *seg)
 
 err_t sockinfo_tcp_ops_nvme::recv(pbuf *p)
 {
-    return p != nullptr ? ERR_OK : ERR_ARG;
+    uint32_t dropped = 0U;
+
+    if (p == nullptr) {
+        return ERR_ARG;
+    }
+    if (unlikely(!m_rx_parser.process(p, dropped))) {
+        /* A corrupted PDU breaks the stream framing, so the connection can't recover. */
+        si_nvme_logdbg("NVME_RX PDU verification failed, shutting down RX");
+        m_p_sock->tcp_shutdown_rx();
+        return sockinfo_tcp::rx_drop_lwip_cb(m_p_sock, m_p_sock->get_pcb(), p, ERR_OK);
+    }
+    if (dropped) {
+        /* Placed payload never reaches the socket queue, release its window right away. */
+        m_p_sock->m_p_socket_stats->counters.n_rx_bytes += dropped;
+        tcp_recved(m_p_sock->get_pcb(), dropped);
+    }
+    if (p == nullptr) {
+        return ERR_OK;
+    }
+    return sockinfo_tcp::rx_lwip_cb(m_p_sock, m_p_sock->get_pcb(), p, ERR_OK);
+}
+
+/* static */
+err_t sockinfo_tcp_ops_nvme::rx_lwip_cb(void *arg, struct tcp_pcb *tpcb, struct pbuf *p, err_t err)
+{
+    sockinfo_tcp *conn = (sockinfo_tcp *)arg;
+
+    if (likely(p && err == ERR_OK)) {
+        return conn->get_ops()->recv(p);
+    }
+    return sockinfo_tcp::rx_lwip_cb(arg, tpcb, p, err);
+}
+
+/*
+ * Software RX digests and data placement. Received PDUs are tracked from the moment of the
+ * setsockopt(), so it must be called at a PDU boundary, i.e. after the ICResp PDU which
+ * negotiates the digests.
+ */
+int sockinfo_tcp_ops_nvme::setsockopt_rx_sw(uint8_t sw_digest, bool is_placement)
+{
+    m_p_sock->lock_tcp_con();
+    m_rx_parser.reset(sw_digest, is_placement);
+    tcp_recv(m_p_sock->get_pcb(), sockinfo_tcp_ops_nvme::rx_lwip_cb);
+    m_p_sock->unlock_tcp_con();
+
+    si_nvme_logdbg("NVME_RX is parsed in software, digests=%#x placement=%d", sw_digest,
+                   is_placement);
+    return 0;
+}
+
+int sockinfo_tcp_ops_nvme::setsockopt_rx_buf(const void *optval, socklen_t optlen)
+{
+    if (unlikely(!optval || optlen != sizeof(xlio_nvme_rx_buf))) {
+        errno = EINVAL;
+        return -1;
+    }
+    if (unlikely(!m_rx_parser.is_placement())) {
+        si_nvme_logdbg("NVME_RX_BUF requires XLIO_NVME_RX_PLACEMENT");
+        errno = EINVAL;
+        return -1;
+    }
+
+    const xlio_nvme_rx_buf *buf = reinterpret_cast<const xlio_nvme_rx_buf *>(optval);
+
+    m_p_sock->lock_tcp_con();
+    m_rx_parser.set_buf(*buf);
+    m_p_sock->unlock_tcp_con();
+    return 0;
 }
 
 int sockinfo_tcp_ops_nvme::setsockopt_tx(const uint32_t &config)
@@ -38,6 +38,7 @@
 #include "sockinfo_ulp.h" /* sockinfo_tcp_ops */
 #include "dev/qp_mgr_eth_mlx5.h"
 #include "proto/nvme_parse_input_args.h"
+#include "proto/nvme_pdu.h"
 #include "xlio_extra.h"
 #include "lwip/err.h" /* err_t */
 
@@ -54,6 +55,8 @@ public:
         , m_expected_seqno(0U)
         , m_is_tx_offload(false)
         , m_is_ddgs_on(false)
+        , m_tx_sw_digest(0U)
+        , m_rx_parser(pbuf_free)
     {
     }
     ~sockinfo_tcp_ops_nvme()
@@ -68,6 +71,8 @@ public:
     bool handle_send_ret(ssize_t ret, struct tcp_seg *seg) override;
     err_t recv(struct pbuf *p) override;
 
+    static err_t rx_lwip_cb(void *arg, struct tcp_pcb *tpcb, struct pbuf *p, err_t err);
+
     int m_nvme_feature_mask;
 
 private:
@@ -76,8 +81,14 @@ private:
     uint32_t m_expected_seqno;
     bool m_is_tx_offload;
     bool m_is_ddgs_on;
+    /* NVME_TCP_F_* digests which are calculated by XLIO in software. */
+    uint8_t m_tx_sw_digest;
+    /* Software RX digests and data placement. */
+    nvme_rx_parser m_rx_parser;
 
     int setsockopt_tx(const uint32_t &config);
+    int setsockopt_rx_sw(uint8_t sw_digest, bool is_placement);
+    int setsockopt_rx_buf(const void *optval, socklen_t optlen);
 };
 
 #endif /* _SOCKINFO_NVME_H */
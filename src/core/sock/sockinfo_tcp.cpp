@@ -30,6 +30,7 @@
  * SOFTWARE.
  */
 
+#include <atomic>
 #include <functional>
 #include <numeric>
 #include <stdio.h>
@@ -247,6 +248,7 @@ inline void sockinfo_tcp::reuse_buffer(mem_buf_desc_t *buff)
 sockinfo_tcp::sockinfo_tcp(int fd, int domain)
     : sockinfo(fd, domain)
     , m_timer_handle(NULL)
+    , m_p_thread_timers(NULL)
     , m_tcp_con_lock(MULTILOCK_RECURSIVE, "tcp_con")
     , m_sysvar_buffer_batching_mode(safe_mce_sys().buffer_batching_mode)
     , m_sysvar_tx_segs_batch_tcp(safe_mce_sys().tx_segs_batch_tcp)
@@ -433,14 +435,25 @@ void sockinfo_tcp::clean_obj()
     lock_tcp_con();
     set_cleaned();
 
+    /* Thread timers are removed after releasing the socket lock, because
+     * thread_tcp_timers takes the socket lock with its own lock held.
+     */
+    thread_tcp_timers *p_thread_timers = m_p_thread_timers;
+    timer_node_t *p_thread_node = (timer_node_t *)m_timer_handle;
+    m_p_thread_timers = NULL;
+
     /* Remove group timers from g_tcp_timers_collection */
-    if (g_p_event_handler_manager->is_running() && m_timer_handle) {
+    if (!p_thread_timers && g_p_event_handler_manager->is_running() && m_timer_handle) {
         g_p_event_handler_manager->unregister_timer_event(this, m_timer_handle);
     }
 
     m_timer_handle = NULL;
     unlock_tcp_con();
 
+    if (p_thread_timers && p_thread_node) {
+        p_thread_timers->remove_socket_timer(p_thread_node);
+    }
+
     if (g_p_event_handler_manager->is_running()) {
         g_p_event_handler_manager->unregister_timers_event_and_delete(this);
     } else {
@@ -466,6 +479,7 @@ bool sockinfo_tcp::prepare_listen_to_close()
         new_sock->unlock_tcp_con();
         close(new_sock->get_fd());
     }
+    set_epoll_level(EPOLLIN, false);
 
     // remove the sockets from the syn_received connections list
     syn_received_map_t::iterator syn_received_itr;
@@ -524,6 +538,7 @@ bool sockinfo_tcp::prepare_to_close(bool process_shutdown /* = false */)
         reuse_buffer(p_rx_pkt_desc);
     }
     m_rx_pkt_ready_offset = 0;
+    update_epoll_level_in();
 
     while (!m_rx_ctl_packets_list.empty()) {
         /* coverity[double_lock] TODO: RM#1049980 */
@@ -1081,6 +1096,7 @@ retry_is_ready:
             }
 
             err = tcp_write(&m_pcb, tx_ptr, tx_size, apiflags, &tx_arg.priv);
+            update_epoll_level_out();
             if (unlikely(err != ERR_OK)) {
                 if (unlikely(err == ERR_CONN)) { // happens when remote drops during big write
                     si_tcp_logdbg("connection closed: tx'ed = %d", total_tx);
@@ -1138,6 +1154,12 @@ done:
         m_p_socket_stats->counters.n_tx_sent_byte_count += total_tx;
         m_p_socket_stats->counters.n_tx_sent_pkt_count++;
         m_p_socket_stats->n_tx_ready_byte_count += total_tx;
+        /* Segments sent by ip_output() include ACKs and retransmissions of the internal
+         * thread, so only the application data votes for the TX ring.
+         */
+        if (m_p_connected_dst_entry) {
+            m_p_connected_dst_entry->account_tx_traffic(total_tx);
+        }
     }
 
     /* Each send call with MSG_ZEROCOPY that successfully sends
@@ -1733,6 +1755,7 @@ err_t sockinfo_tcp::ack_recvd_lwip_cb(void *arg, struct tcp_pcb *tpcb, u16_t ack
     ASSERT_LOCKED(conn->m_tcp_con_lock);
 
     conn->m_p_socket_stats->n_tx_ready_byte_count -= ack;
+    conn->update_epoll_level_out();
 
     if (conn->sndbuf_available() >= conn->m_required_send_block) {
         NOTIFY_ON_EVENTS(conn, EPOLLOUT);
@@ -1970,6 +1993,7 @@ inline void sockinfo_tcp::save_packet_info_in_ready_list(pbuf *p)
 {
     m_rx_pkt_ready_list.push_back(reinterpret_cast<mem_buf_desc_t *>(p));
     m_n_rx_pkt_ready_list_count++;
+    update_epoll_level_in();
     m_rx_ready_byte_count += p->tot_len;
     m_p_socket_stats->counters.n_rx_bytes += p->tot_len;
     m_p_socket_stats->n_rx_ready_byte_count += p->tot_len;
@@ -2365,7 +2389,22 @@ ssize_t sockinfo_tcp::rx(const rx_call_t call_type, iovec *p_iov, ssize_t sz_iov
 
 void sockinfo_tcp::register_timer()
 {
-    if (m_timer_handle == NULL) {
+    thread_tcp_timers *p_thread_timers =
+        safe_mce_sys().tcp_timers_per_thread ? thread_tcp_timers::get_instance() : NULL;
+
+    if (m_timer_handle == NULL && p_thread_timers) {
+        timer_node_t *node = (timer_node_t *)calloc(1, sizeof(timer_node_t));
+        BULLSEYE_EXCLUDE_BLOCK_START
+        if (!node) {
+            si_tcp_logdbg("malloc failure");
+            throw_xlio_exception("malloc failure");
+        }
+        BULLSEYE_EXCLUDE_BLOCK_END
+        node->lock_timer = lock_spin_recursive("timer");
+        p_thread_timers->add_socket_timer(node, this);
+        m_p_thread_timers = p_thread_timers;
+        m_timer_handle = node;
+    } else if (m_timer_handle == NULL) {
         /* user_data is the socket itself for a fast cast in the timer_expired(). */
         m_timer_handle = g_p_event_handler_manager->register_timer_event(
             safe_mce_sys().tcp_timer_resolution_msec, this, PERIODIC_TIMER,
@@ -3092,6 +3131,7 @@ int sockinfo_tcp::accept_helper(struct sockaddr *__addr, socklen_t *__addrlen,
     BULLSEYE_EXCLUDE_BLOCK_END
 
     m_ready_conn_cnt--;
+    set_epoll_level(EPOLLIN, m_ready_conn_cnt > 0);
     m_p_socket_stats->listen_counters.n_conn_backlog--;
     tcp_accepted(m_sock);
 
@@ -3383,6 +3423,7 @@ err_t sockinfo_tcp::accept_lwip_cb(void *arg, struct tcp_pcb *child_pcb, err_t e
     } else {
         conn->m_accepted_conns.push_back(new_sock);
         conn->m_ready_conn_cnt++;
+        conn->set_epoll_level(EPOLLIN, true);
 
         NOTIFY_ON_EVENTS(conn, EPOLLIN);
     }
@@ -3724,6 +3765,7 @@ err_t sockinfo_tcp::connect_lwip_cb(void *arg, struct tcp_pcb *tpcb, err_t err)
         conn->m_error_status = ECONNREFUSED;
         conn->m_conn_state = TCP_CONN_FAILED;
     }
+    conn->update_epoll_level_out();
 
     NOTIFY_ON_EVENTS(conn, EPOLLOUT);
     // OLG: Now we should wakeup all threads that are sleeping on this socket.
@@ -4250,7 +4292,8 @@ int sockinfo_tcp::tcp_setsockopt(int __level, int __optname, __const void *__opt
             if (__optval && __optlen >= 4 && strncmp((char *)__optval, "nvme", 4) == 0) {
                 is_nvme = true;
                 auto nvme_feature_mask = get_supported_nvme_feature_mask();
-                if (nvme_feature_mask == 0U) {
+                /* Software digests don't need the NVMe offload capabilities. */
+                if (nvme_feature_mask == 0U && !safe_mce_sys().enable_nvme_sw_digest) {
                     errno = ENOTSUP;
                     ret = -1;
                     break;
@@ -4260,7 +4303,8 @@ int sockinfo_tcp::tcp_setsockopt(int __level, int __optname, __const void *__opt
             }
 #ifdef DEFINED_UTLS
             else if (__optval && __optlen >= 3 && strncmp((char *)__optval, "tls", 3) == 0) {
-                if (is_utls_supported(UTLS_MODE_TX | UTLS_MODE_RX)) {
+                if (is_utls_supported(UTLS_MODE_TX | UTLS_MODE_RX) ||
+                    is_utls_sw_supported(UTLS_MODE_TX | UTLS_MODE_RX)) {
                     si_tcp_logdbg("(TCP_ULP) val: tls");
                     if (unlikely(!is_rts())) {
                         errno = ENOTCONN;
@@ -5021,8 +5065,7 @@ int sockinfo_tcp::rx_wait_helper(int &poll_count, bool blocking)
     // this code and wakeup mechanism.
 
     lock_tcp_con();
-    if (!m_n_rx_pkt_ready_list_count && !m_ready_conn_cnt) {
-        going_to_sleep();
+    if (!m_n_rx_pkt_ready_list_count && !m_ready_conn_cnt && going_to_sleep()) {
         unlock_tcp_con();
     } else {
         unlock_tcp_con();
@@ -5047,9 +5090,6 @@ int sockinfo_tcp::rx_wait_helper(int &poll_count, bool blocking)
     for (int event_idx = 0; event_idx < ret; event_idx++) {
         int fd = rx_epfd_events[event_idx].data.fd;
         if (is_wakeup_fd(fd)) { // wakeup event
-            lock_tcp_con();
-            remove_wakeup_fd();
-            unlock_tcp_con();
             continue;
         }
 
@@ -5098,6 +5138,7 @@ mem_buf_desc_t *sockinfo_tcp::get_next_desc(mem_buf_desc_t *p_desc)
     } else {
         reuse_buffer(p_desc);
     }
+    update_epoll_level_in();
     if (m_n_rx_pkt_ready_list_count) {
         return m_rx_pkt_ready_list.front();
     } else {
@@ -5208,6 +5249,7 @@ int sockinfo_tcp::zero_copy_rx(iovec *p_iov, mem_buf_desc_t *pdesc, int *p_flags
         len -= sizeof(xlio_recvfrom_zcopy_packet_t);
         offset += sizeof(xlio_recvfrom_zcopy_packet_t);
     }
+    update_epoll_level_in();
 
     return total_rx;
 }
@@ -5627,6 +5669,7 @@ void sockinfo_tcp::tcp_tx_zc_handle(mem_buf_desc_t *p_desc)
         err_queue = p_desc->clone();
         sock->m_error_queue.push_back(err_queue);
     }
+    set_epoll_level(EPOLLERR, true);
 
     m_error_queue_lock.unlock();
 
@@ -5732,6 +5775,8 @@ tcp_timers_collection::tcp_timers_collection(int period, int resolution)
     m_n_location = 0;
     m_n_next_insert_bucket = 0;
     m_n_count = 0;
+    m_p_next_iter = NULL;
+    m_b_internal_thread = true;
 }
 
 tcp_timers_collection::~tcp_timers_collection()
@@ -5774,6 +5819,17 @@ void tcp_timers_collection::clean_obj()
 void tcp_timers_collection::handle_timer_expired(void *user_data)
 {
     NOT_IN_USE(user_data);
+
+    process_bucket();
+
+    /* Processing all messages for the daemon */
+    if (g_p_agent != NULL) {
+        g_p_agent->progress();
+    }
+}
+
+void tcp_timers_collection::process_bucket()
+{
     timer_node_t *iter = m_p_intervals[m_n_location];
     sockinfo_tcp *p_sock;
 
@@ -5781,6 +5837,7 @@ void tcp_timers_collection::handle_timer_expired(void *user_data)
 
     while (iter) {
         p_sock = reinterpret_cast<sockinfo_tcp *>(iter->user_data);
+        m_p_next_iter = iter->next;
 
         /* It is not guaranteed that the same sockinfo object is met once
          * in this loop.
@@ -5797,13 +5854,9 @@ void tcp_timers_collection::handle_timer_expired(void *user_data)
             }
             p_sock->unlock_tcp_con();
         }
-        iter = iter->next;
-    }
-
-    /* Processing all messages for the daemon */
-    if (g_p_agent != NULL) {
-        g_p_agent->progress();
+        iter = m_p_next_iter;
     }
+    m_p_next_iter = NULL;
 }
 
 void tcp_timers_collection::add_new_timer(timer_node_t *node, timer_handler *handler,
@@ -5821,7 +5874,7 @@ void tcp_timers_collection::add_new_timer(timer_node_t *node, timer_handler *han
     m_p_intervals[m_n_next_insert_bucket] = node;
     m_n_next_insert_bucket = (m_n_next_insert_bucket + 1) % m_n_intervals_size;
 
-    if (m_n_count == 0) {
+    if (m_n_count == 0 && m_b_internal_thread) {
         m_timer_handle = g_p_event_handler_manager->register_timer_event(m_n_resolution, this,
                                                                          PERIODIC_TIMER, NULL);
     }
@@ -5838,6 +5891,10 @@ void tcp_timers_collection::remove_timer(timer_node_t *node)
 
     node->group = NULL;
 
+    if (m_p_next_iter == node) {
+        m_p_next_iter = node->next;
+    }
+
     if (node->prev) {
         node->prev->next = node->next;
     } else {
@@ -5866,6 +5923,253 @@ void tcp_timers_collection::remove_timer(timer_node_t *node)
     free(node);
 }
 
+__thread thread_tcp_timers *g_p_thread_tcp_timers = NULL;
+
+static pthread_key_t s_thread_tcp_timers_key;
+static pthread_once_t s_thread_tcp_timers_once = PTHREAD_ONCE_INIT;
+static lock_spin s_thread_tcp_timers_lock("thread_tcp_timers");
+static thread_tcp_timers *s_thread_tcp_timers_all = NULL;
+static thread_tcp_timers *s_thread_tcp_timers_idle = NULL;
+// Number of thread collections which hold timers
+static std::atomic<int> s_n_busy_thread_tcp_timers(0);
+static std::atomic<bool> s_b_thread_tcp_timers_armed(false);
+
+/* One shot timer of the internal thread, re-armed while thread collections hold timers.
+ * Sockets of threads which exited or are blocked outside of the iomux calls rely on it.
+ */
+class thread_tcp_timers_fallback : public timer_handler {
+public:
+    virtual void handle_timer_expired(void *user_data)
+    {
+        NOT_IN_USE(user_data);
+
+        thread_tcp_timers::progress_stale();
+
+        /* Processing all messages for the daemon, the global collection can be idle */
+        if (g_p_agent != NULL) {
+            g_p_agent->progress();
+        }
+
+        s_b_thread_tcp_timers_armed.store(false);
+        if (s_n_busy_thread_tcp_timers.load() > 0) {
+            thread_tcp_timers::arm_fallback();
+        }
+    }
+};
+
+static thread_tcp_timers_fallback s_thread_tcp_timers_fallback;
+
+static void thread_tcp_timers_key_create()
+{
+    if (pthread_key_create(&s_thread_tcp_timers_key, thread_tcp_timers::thread_exit)) {
+        __log_err("pthread_key_create failed, errno=%d", errno);
+    }
+}
+
+thread_tcp_timers::thread_tcp_timers(int period, int resolution)
+    : tcp_timers_collection(period, resolution)
+    , m_lock("thread_tcp_timers")
+    , m_b_orphan(false)
+    , m_p_next_idle(NULL)
+    , m_p_next_all(NULL)
+{
+    m_b_internal_thread = false;
+    m_tsc_resolution = get_tsc_rate_per_second() * resolution / 1000U;
+    gettimeoftsc(&m_next_tsc);
+    m_next_tsc += m_tsc_resolution;
+}
+
+thread_tcp_timers *thread_tcp_timers::get_instance()
+{
+    thread_tcp_timers *p_timers = g_p_thread_tcp_timers;
+
+    if (likely(p_timers)) {
+        return p_timers;
+    }
+
+    /* The internal thread keeps using the global collection */
+    if (pthread_equal(pthread_self(), g_n_internal_thread_id)) {
+        return NULL;
+    }
+
+    pthread_once(&s_thread_tcp_timers_once, thread_tcp_timers_key_create);
+
+    s_thread_tcp_timers_lock.lock();
+    p_timers = s_thread_tcp_timers_idle;
+    if (p_timers) {
+        s_thread_tcp_timers_idle = p_timers->m_p_next_idle;
+        p_timers->m_p_next_idle = NULL;
+    }
+    s_thread_tcp_timers_lock.unlock();
+
+    if (p_timers) {
+        p_timers->m_lock.lock();
+        p_timers->m_b_orphan = false;
+        gettimeoftsc(&p_timers->m_next_tsc);
+        p_timers->m_next_tsc += p_timers->m_tsc_resolution;
+        p_timers->m_lock.unlock();
+    } else {
+        try {
+            p_timers = new thread_tcp_timers(safe_mce_sys().tcp_timer_resolution_msec,
+                                             safe_mce_sys().timer_resolution_msec);
+        } catch (xlio_exception &e) {
+            __log_dbg("failed to create thread TCP timers (%s)", e.what());
+            return NULL;
+        }
+        s_thread_tcp_timers_lock.lock();
+        p_timers->m_p_next_all = s_thread_tcp_timers_all;
+        s_thread_tcp_timers_all = p_timers;
+        s_thread_tcp_timers_lock.unlock();
+    }
+
+    pthread_setspecific(s_thread_tcp_timers_key, p_timers);
+    g_p_thread_tcp_timers = p_timers;
+    __log_dbg("thread TCP timers %p attached to thread %lu", p_timers, pthread_self());
+
+    return p_timers;
+}
+
+void thread_tcp_timers::thread_exit(void *arg)
+{
+    thread_tcp_timers *p_timers = reinterpret_cast<thread_tcp_timers *>(arg);
+    bool is_idle;
+
+    /* Remaining timers are driven by the internal thread from now on */
+    p_timers->m_lock.lock();
+    p_timers->m_b_orphan = true;
+    is_idle = (p_timers->m_n_count == 0);
+    p_timers->m_lock.unlock();
+
+    if (is_idle) {
+        s_thread_tcp_timers_lock.lock();
+        p_timers->m_p_next_idle = s_thread_tcp_timers_idle;
+        s_thread_tcp_timers_idle = p_timers;
+        s_thread_tcp_timers_lock.unlock();
+    }
+    g_p_thread_tcp_timers = NULL;
+}
+
+void thread_tcp_timers::destroy_all()
+{
+    thread_tcp_timers *p_timers;
+
+    s_thread_tcp_timers_lock.lock();
+    p_timers = s_thread_tcp_timers_all;
+    s_thread_tcp_timers_all = NULL;
+    s_thread_tcp_timers_idle = NULL;
+    s_thread_tcp_timers_lock.unlock();
+
+    g_p_thread_tcp_timers = NULL;
+    while (p_timers) {
+        thread_tcp_timers *p_next = p_timers->m_p_next_all;
+        p_timers->clean_obj();
+        p_timers = p_next;
+    }
+}
+
+void thread_tcp_timers::fork_reset()
+{
+    /* Collections of the parent threads are not usable in the child */
+    s_thread_tcp_timers_all = NULL;
+    s_thread_tcp_timers_idle = NULL;
+    s_n_busy_thread_tcp_timers.store(0);
+    s_b_thread_tcp_timers_armed.store(false);
+    g_p_thread_tcp_timers = NULL;
+}
+
+void thread_tcp_timers::arm_fallback()
+{
+    if (g_p_event_handler_manager && !s_b_thread_tcp_timers_armed.exchange(true)) {
+        g_p_event_handler_manager->register_timer_event(safe_mce_sys().timer_resolution_msec,
+                                                        &s_thread_tcp_timers_fallback,
+                                                        ONE_SHOT_TIMER, NULL);
+    }
+}
+
+void thread_tcp_timers::add_socket_timer(timer_node_t *node, sockinfo_tcp *p_sock)
+{
+    bool was_idle;
+
+    m_lock.lock();
+    was_idle = (m_n_count == 0);
+    add_new_timer(node, p_sock, reinterpret_cast<void *>(p_sock));
+    if (was_idle) {
+        s_n_busy_thread_tcp_timers.fetch_add(1);
+    }
+    m_lock.unlock();
+
+    if (was_idle) {
+        arm_fallback();
+    }
+}
+
+void thread_tcp_timers::remove_socket_timer(timer_node_t *node)
+{
+    m_lock.lock();
+    remove_timer(node);
+    m_lock.unlock();
+}
+
+void thread_tcp_timers::remove_timer(timer_node_t *node)
+{
+    if (!node) {
+        return;
+    }
+
+    tcp_timers_collection::remove_timer(node);
+
+    if (m_n_count == 0) {
+        s_n_busy_thread_tcp_timers.fetch_sub(1);
+    }
+    if (m_b_orphan && m_n_count == 0) {
+        m_b_orphan = false;
+        s_thread_tcp_timers_lock.lock();
+        m_p_next_idle = s_thread_tcp_timers_idle;
+        s_thread_tcp_timers_idle = this;
+        s_thread_tcp_timers_lock.unlock();
+    }
+}
+
+void thread_tcp_timers::progress_stale()
+{
+    thread_tcp_timers *p_timers;
+
+    /* Collections are never unlinked before destroy_all(), so the list is walked unlocked.
+     * The timers can remove the socket of an orphan, which takes the list lock.
+     */
+    s_thread_tcp_timers_lock.lock();
+    p_timers = s_thread_tcp_timers_all;
+    s_thread_tcp_timers_lock.unlock();
+
+    for (; p_timers; p_timers = p_timers->m_p_next_all) {
+        /* Allow the owner a full resolution of delay before taking over */
+        p_timers->progress(p_timers->m_b_orphan ? 0 : p_timers->m_tsc_resolution);
+    }
+}
+
+void thread_tcp_timers::progress(tscval_t slack)
+{
+    tscval_t now;
+    int ticks = 0;
+
+    gettimeoftsc(&now);
+    if (now < m_next_tsc + slack || m_lock.trylock()) {
+        return;
+    }
+
+    while (now >= m_next_tsc && ticks < m_n_intervals_size) {
+        process_bucket();
+        m_next_tsc += m_tsc_resolution;
+        ticks++;
+    }
+    /* Skip the missed buckets if the owner was away for a whole period */
+    if (now >= m_next_tsc) {
+        m_next_tsc = now + m_tsc_resolution;
+    }
+
+    m_lock.unlock();
+}
+
 void sockinfo_tcp::update_header_field(data_updater *updater)
 {
     lock_tcp_con();
@@ -5900,6 +6204,22 @@ bool sockinfo_tcp::is_utls_supported(int direction) const
     return result;
 }
 
+/* Whether the software TLS record layer can serve a direction without HW offload. */
+bool sockinfo_tcp::is_utls_sw_supported(int direction) const
+{
+    bool result = false;
+
+#ifdef DEFINED_UTLS
+    if (safe_mce_sys().enable_utls_sw) {
+        result = result || ((direction & UTLS_MODE_TX) && safe_mce_sys().enable_utls_tx);
+        result = result || ((direction & UTLS_MODE_RX) && safe_mce_sys().enable_utls_rx);
+    }
+#else
+    NOT_IN_USE(direction);
+#endif /* DEFINED_UTLS */
+    return result;
+}
+
 int sockinfo_tcp::get_supported_nvme_feature_mask() const
 {
     ring *p_ring = get_tx_ring();
@@ -34,6 +34,7 @@
 #define TCP_SOCKINFO_H
 
 #include "utils/lock_wrapper.h"
+#include "utils/rdtsc.h"
 #include "proto/mem_buf_desc.h"
 #include "sock/socket_fd_api.h"
 #include "dev/buffer_pool.h"
@@ -48,6 +49,8 @@
 #include "sockinfo_ulp.h"
 #include "sockinfo_nvme.h"
 
+class thread_tcp_timers;
+
 #define BLOCK_THIS_RUN(blocking, flags) (blocking && !(flags & MSG_DONTWAIT))
 
 /**
@@ -268,6 +271,12 @@ public:
         return m_sock_state == TCP_SOCK_CONNECTED_WR || m_sock_state == TCP_SOCK_CONNECTED_RDWR;
     }
 
+    // EPOLLOUT level follows is_writeable() of a connected socket, under the connection lock
+    inline void update_epoll_level_out()
+    {
+        set_epoll_level(EPOLLOUT, is_rts() && tcp_sndbuf(&m_pcb) > m_required_send_block);
+    }
+
     bool is_server()
     {
         return m_sock_state == TCP_SOCK_ACCEPT_READY || m_sock_state == TCP_SOCK_ACCEPT_SHUT;
@@ -310,6 +319,7 @@ public:
     inline void reset_ops(void) noexcept { set_ops(m_ops_tcp); }
 
     bool is_utls_supported(int direction) const;
+    bool is_utls_sw_supported(int direction) const;
 
     int get_supported_nvme_feature_mask() const;
 
@@ -319,7 +329,12 @@ public:
 
     list_node<sockinfo_tcp, sockinfo_tcp::accepted_conns_node_offset> accepted_conns_node;
 
-    inline void set_reguired_send_block(unsigned sz) { m_required_send_block = sz; }
+    inline void set_reguired_send_block(unsigned sz)
+    {
+        m_required_send_block = sz;
+        // Verified by is_writeable() until the next update under the connection lock
+        set_epoll_level(EPOLLOUT, false);
+    }
 
 protected:
     virtual void lock_rx_q();
@@ -375,6 +390,7 @@ private:
     int m_backlog;
 
     void *m_timer_handle;
+    thread_tcp_timers *m_p_thread_timers;
     multilock m_tcp_con_lock;
 
     // used for reporting 'connected' on second non-blocking call to connect or
@@ -605,20 +621,82 @@ protected:
     // called for stopping (unregistering) a timer
     void remove_timer(timer_node_t *node);
 
+    // run the timers of the current bucket and move to the next one
+    void process_bucket();
+
+    int m_n_resolution;
+    int m_n_intervals_size;
+    int m_n_count;
+    // registered with the internal thread while the collection holds timers
+    bool m_b_internal_thread;
+
 private:
     void *m_timer_handle;
     timer_node_t **m_p_intervals;
+    // next node to visit by process_bucket(), kept valid by remove_timer()
+    timer_node_t *m_p_next_iter;
 
     int m_n_period;
-    int m_n_resolution;
-    int m_n_intervals_size;
     int m_n_location;
-    int m_n_count;
     int m_n_next_insert_bucket;
 
     void free_tta_resources();
 };
 
+/*
+ * TCP timers owned by an application thread (XLIO_TCP_TIMERS_PER_THREAD).
+ * Sockets created by the thread add their timers here directly and the thread
+ * runs them from its select/poll/epoll_wait/socketxtreme_poll calls, so the
+ * internal thread is not involved in the data path of these sockets.
+ * The collection is not registered with the internal thread. While any thread
+ * collection holds timers, a single one shot timer of the internal thread is
+ * kept armed. It runs progress_stale(), which drives the collections whose
+ * owner stopped polling (e.g. blocked in recv()) or exited. Collections of
+ * exited threads are reused by new threads.
+ */
+class thread_tcp_timers : public tcp_timers_collection {
+public:
+    thread_tcp_timers(int period, int resolution);
+    virtual ~thread_tcp_timers() {}
+
+    // run the buckets which are due, called by the owner thread
+    void progress() { progress(0); }
+
+    void add_socket_timer(timer_node_t *node, sockinfo_tcp *p_sock);
+    void remove_socket_timer(timer_node_t *node);
+
+    // collection of the calling thread, NULL if the thread must not own one
+    static thread_tcp_timers *get_instance();
+    static void destroy_all();
+    static void fork_reset();
+    static void thread_exit(void *arg);
+    // internal thread fallback for the collections whose owner is late or exited
+    static void progress_stale();
+    // keep the internal thread fallback armed while thread collections hold timers
+    static void arm_fallback();
+
+protected:
+    void remove_timer(timer_node_t *node);
+
+private:
+    lock_spin_recursive m_lock;
+    tscval_t m_next_tsc;
+    tscval_t m_tsc_resolution;
+    bool m_b_orphan;
+    thread_tcp_timers *m_p_next_idle;
+    thread_tcp_timers *m_p_next_all;
+
+    void progress(tscval_t slack);
+};
+
 extern tcp_timers_collection *g_tcp_timers_collection;
+extern __thread thread_tcp_timers *g_p_thread_tcp_timers;
+
+static inline void thread_tcp_timers_progress()
+{
+    if (g_p_thread_tcp_timers) {
+        g_p_thread_tcp_timers->progress();
+    }
+}
 
 #endif
@@ -203,8 +203,7 @@ inline int sockinfo_udp::rx_wait(bool blocking)
         // release lock so other threads that wait on this socket will not consume CPU
         /* coverity[double_lock] TODO: RM#1049980 */
         m_lock_rcv.lock();
-        if (!m_n_rx_pkt_ready_list_count) {
-            going_to_sleep();
+        if (!m_n_rx_pkt_ready_list_count && going_to_sleep()) {
             /* coverity[double_unlock] TODO: RM#1049980 */
             m_lock_rcv.unlock();
         } else {
@@ -243,8 +242,7 @@ inline int sockinfo_udp::rx_wait(bool blocking)
             /* Quick check for a ready rx datagram on this sockinfo
              * (if some other sockinfo::rx might have added a rx ready packet to our pool
              *
-             * This is the classical case of wakeup, but we don't want to
-             * waist time on removing wakeup fd, it will be done next time
+             * This is the classical case of wakeup
              */
             if (is_readable(NULL)) {
                 return 0;
@@ -254,11 +252,6 @@ inline int sockinfo_udp::rx_wait(bool blocking)
             for (int event_idx = 0; event_idx < ret; ++event_idx) {
                 int fd = rx_epfd_events[event_idx].data.fd;
                 if (is_wakeup_fd(fd)) {
-                    /* coverity[double_lock] TODO: RM#1049980 */
-                    m_lock_rcv.lock();
-                    remove_wakeup_fd();
-                    /* coverity[double_unlock] TODO: RM#1049980 */
-                    m_lock_rcv.unlock();
                     continue;
                 }
 
@@ -402,6 +395,8 @@ sockinfo_udp::sockinfo_udp(int fd, int domain)
     m_protocol = PROTO_UDP;
     m_p_socket_stats->socket_type = SOCK_DGRAM;
     m_p_socket_stats->b_is_offloaded = m_sock_offload;
+    // UDP socket is always writeable, see socket_fd_api::is_writeable()
+    set_epoll_level(EPOLLOUT, true);
 
     // Update MC related stats (default values)
     m_p_socket_stats->mc_tx_if = m_mc_tx_src_ip;
@@ -1714,6 +1709,7 @@ void sockinfo_udp::drop_rx_ready_byte_count(size_t n_rx_bytes_limit)
             break;
         }
     }
+    update_epoll_level_in();
     m_lock_rcv.unlock();
 }
 
@@ -2180,6 +2176,7 @@ ssize_t sockinfo_udp::tx(xlio_tx_call_attr_t &tx_arg)
                                          tx_arg.opcode);
         }
 
+        p_dst_entry->account_tx_traffic(sz_data_payload);
         if (unlikely(p_dst_entry->try_migrate_ring(m_lock_snd))) {
             m_p_socket_stats->counters.n_tx_migrations++;
         }
@@ -2374,6 +2371,7 @@ inline void sockinfo_udp::update_ready(mem_buf_desc_t *p_desc, void *pv_fd_ready
         // Save rx packet info in our ready list
         m_rx_pkt_ready_list.push_back(p_desc);
         m_n_rx_pkt_ready_list_count++;
+        update_epoll_level_in();
         m_rx_ready_byte_count += p_desc->rx.sz_payload;
         m_p_socket_stats->n_rx_ready_pkt_count++;
         m_p_socket_stats->n_rx_ready_byte_count += p_desc->rx.sz_payload;
@@ -3203,6 +3201,7 @@ void sockinfo_udp::post_deqeue(bool release_buff)
     mem_buf_desc_t *to_resue = m_rx_pkt_ready_list.get_and_pop_front();
     m_p_socket_stats->n_rx_ready_pkt_count--;
     m_n_rx_pkt_ready_list_count--;
+    update_epoll_level_in();
     if (release_buff) {
         reuse_buffer(to_resue);
     }
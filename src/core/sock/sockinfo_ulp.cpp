@@ -32,6 +32,8 @@
 
 #include "sockinfo_tcp.h"
 #include "sockinfo_ulp.h"
+#include "fd_collection.h"
+#include "util/aes_gcm_mb.h"
 
 #include <algorithm>
 #include <assert.h>
@@ -91,6 +93,8 @@ struct xlio_tls_api {
     int (*EVP_CIPHER_CTX_reset)(EVP_CIPHER_CTX *);
     const EVP_CIPHER *(*EVP_aes_128_gcm)(void);
     const EVP_CIPHER *(*EVP_aes_256_gcm)(void);
+    /* Optional, ChaCha20-Poly1305 is rejected in setsockopt() if not found. */
+    const EVP_CIPHER *(*EVP_chacha20_poly1305)(void);
     int (*EVP_DecryptInit_ex)(EVP_CIPHER_CTX *, const EVP_CIPHER *, ENGINE *, const unsigned char *,
                               const unsigned char *);
     int (*EVP_DecryptUpdate)(EVP_CIPHER_CTX *, unsigned char *, int *, const unsigned char *, int);
@@ -123,6 +127,7 @@ void xlio_tls_api_setup(void)
     XLIO_TLS_API_FIND(EVP_CIPHER_CTX_reset);
     XLIO_TLS_API_FIND(EVP_aes_128_gcm);
     XLIO_TLS_API_FIND(EVP_aes_256_gcm);
+    XLIO_TLS_API_FIND(EVP_chacha20_poly1305);
     XLIO_TLS_API_FIND(EVP_DecryptInit_ex);
     XLIO_TLS_API_FIND(EVP_DecryptUpdate);
     XLIO_TLS_API_FIND(EVP_CIPHER_CTX_ctrl);
@@ -185,12 +190,17 @@ enum {
     TLS_RECORD_MAX = 16384U,
     /* Block size big enough to hold TLS header/trailer for zerocopy records. */
     TLS_ZC_BLOCK = 32U,
+    /* Largest AAD: TLS 1.2 sequence number + header. */
+    TLS_RECORD_AAD_MAX = 13U,
+    /* Larger records are decrypted faster by OpenSSL than by the multi-buffer batch. */
+    TLS_RX_BATCH_RECORD_MAX = 1024U,
+    TLS_RX_BATCH_SEGS_MAX = 16U,
 };
 
 class tls_record : public mem_desc {
 public:
     tls_record(sockinfo_tcp_ops_tls *tls_sock, uint32_t seqno, uint64_t record_number, uint8_t *iv,
-               mem_desc *zc_owner)
+               bool is_tls13, mem_desc *zc_owner)
     {
         m_p_tx_ring = tls_sock->get_tx_ring();
         /* Allocate record with a taken reference. */
@@ -204,7 +214,8 @@ public:
             if (iv) {
                 m_size += TLS_RECORD_IV_LEN;
                 memcpy(&m_p_data[5], iv, TLS_RECORD_IV_LEN);
-            } else {
+            }
+            if (is_tls13) {
                 /* For TLS1.3 we need to add a room for the inner type field. */
                 m_size += 1;
             }
@@ -273,6 +284,23 @@ public:
         return len;
     }
 
+    /* Position of the next payload byte in the record buffer. */
+    inline uint8_t *data_tail(bool is_tls13)
+    {
+        return m_p_data + m_size - TLS_RECORD_TAG_LEN - !!is_tls13;
+    }
+
+    /* Reserve room for payload in the record buffer, the caller fills it. */
+    inline uint8_t *reserve_data(size_t &len, bool is_tls13)
+    {
+        uint8_t *data = data_tail(is_tls13);
+
+        len = std::min(len, avail_space());
+        m_size += len;
+        set_length();
+        return data;
+    }
+
     inline size_t avail_space(void)
     {
         /* Don't produce records larger than 16KB according to the protocol. */
@@ -337,6 +365,88 @@ public:
     ring *m_p_tx_ring;
 };
 
+/*
+ * tls_rx_batch
+ *
+ * Software RX records completed during a ring poll are collected per thread and
+ * decrypted together by the multi-buffer AES-GCM at the end of the poll. Another thread can
+ * close the socket or destroy the TLS object before the flush, therefore, the batch entry
+ * holds a socket reference (released with put_sockfd()), copies of the crypto material and
+ * references to the underlying buffers.
+ */
+
+struct tls_rx_batch_entry {
+    struct aes_gcm_mb_key key;
+    sockinfo_tcp *sock;
+    sockinfo_tcp_ops *ops;
+    mem_buf_desc_t *bufs[TLS_RX_BATCH_SEGS_MAX];
+    struct iovec iov[TLS_RX_BATCH_SEGS_MAX];
+    uint32_t iov_nr;
+    uint32_t aad_len;
+    uint8_t nonce[TLS_RECORD_NONCE_LEN];
+    uint8_t aad[TLS_RECORD_AAD_MAX];
+    uint8_t tag[TLS_RECORD_TAG_LEN];
+};
+
+struct tls_rx_batch {
+    struct tls_rx_batch_entry entries[AES_GCM_MB_LANES_MAX];
+    uint32_t nr;
+    /* Nested polls don't collect records, they would be flushed without their ring lock. */
+    uint32_t depth;
+    bool flushing;
+};
+
+static __thread struct tls_rx_batch t_rx_batch;
+
+bool tls_rx_batch_begin(void)
+{
+    if (!safe_mce_sys().enable_utls_rx_batch) {
+        return false;
+    }
+    ++t_rx_batch.depth;
+    return true;
+}
+
+void tls_rx_batch_end(void)
+{
+    struct tls_rx_batch *batch = &t_rx_batch;
+    struct aes_gcm_mb_job jobs[AES_GCM_MB_LANES_MAX];
+
+    if (--batch->depth > 0 || batch->nr == 0 || batch->flushing) {
+        return;
+    }
+
+    batch->flushing = true;
+    for (uint32_t i = 0; i < batch->nr; ++i) {
+        struct tls_rx_batch_entry *entry = &batch->entries[i];
+
+        jobs[i] = {&entry->key, entry->nonce, entry->aad, entry->aad_len,
+                   entry->iov, entry->iov_nr, entry->tag, false};
+    }
+    aes_gcm_mb_process(jobs, batch->nr, true);
+
+    for (uint32_t i = 0; i < batch->nr; ++i) {
+        struct tls_rx_batch_entry *entry = &batch->entries[i];
+
+        entry->sock->lock_tcp_con();
+        if (entry->sock->get_ops() == entry->ops) {
+            sockinfo_tcp_ops_tls *ops = static_cast<sockinfo_tcp_ops_tls *>(entry->ops);
+
+            ops->tls_rx_batch_complete(jobs[i].auth_ok ? sockinfo_tcp_ops_tls::TLS_RX_BATCH_DONE
+                                                       : sockinfo_tcp_ops_tls::TLS_RX_BATCH_FAIL);
+        }
+        /* Release references taken by tls_rx_batch_enqueue(). */
+        for (uint32_t j = 0; j < entry->iov_nr; ++j) {
+            pbuf_free(&entry->bufs[j]->lwip_pbuf.pbuf);
+        }
+        entry->sock->unlock_tcp_con();
+        fd_collection::put_sockfd(entry->sock);
+        memset(&entry->key, 0, sizeof(entry->key));
+    }
+    batch->nr = 0;
+    batch->flushing = false;
+}
+
 /*
  * sockinfo_tcp_ops_tls
  */
@@ -352,6 +462,8 @@ sockinfo_tcp_ops_tls::sockinfo_tcp_ops_tls(sockinfo_tcp *sock)
 
     m_is_tls_tx = false;
     m_is_tls_rx = false;
+    m_is_tls_tx_sw = false;
+    m_is_tls_rx_sw = false;
     m_tls_rec_overhead = 0;
 
     m_p_tis = nullptr;
@@ -359,14 +471,20 @@ sockinfo_tcp_ops_tls::sockinfo_tcp_ops_tls(sockinfo_tcp *sock)
     m_zc_stor_offset = 0;
     m_expected_seqno = 0;
     m_next_recno_tx = 0;
+    m_p_cipher_ctx_tx = nullptr;
 
     m_p_tir = nullptr;
     m_p_evp_cipher = nullptr;
     m_p_cipher_ctx = nullptr;
+    m_p_cipher_ctx_enc = nullptr;
+    m_p_rx_batch_key = nullptr;
+    m_rx_batch_state = TLS_RX_BATCH_NONE;
     m_next_recno_rx = 0;
     m_rx_offset = 0;
     m_rx_rec_len = 0;
     m_rx_rec_rcvd = 0;
+    m_rx_cursor_desc = nullptr;
+    m_rx_cursor_base = 0;
     m_rx_sm = TLS_RX_SM_HEADER;
     m_refused_data = nullptr;
     m_rx_rule = nullptr;
@@ -379,8 +497,14 @@ sockinfo_tcp_ops_tls::~sockinfo_tcp_ops_tls()
     /* Destroy TLS object under TCP connection lock. */
 
     if (m_is_tls_tx) {
-        m_p_tx_ring->tls_release_tis(m_p_tis);
-        m_p_tis = nullptr;
+        if (m_p_tis) {
+            m_p_tx_ring->tls_release_tis(m_p_tis);
+            m_p_tis = nullptr;
+        }
+        if (m_p_cipher_ctx_tx) {
+            g_tls_api->EVP_CIPHER_CTX_free(reinterpret_cast<EVP_CIPHER_CTX *>(m_p_cipher_ctx_tx));
+            m_p_cipher_ctx_tx = nullptr;
+        }
         if (m_zc_stor) {
             /* Release references taken in advance, but not used. See get_record_buf(). */
             unsigned extra_ref = (m_zc_stor->sz_buffer - m_zc_stor_offset) / TLS_ZC_BLOCK;
@@ -394,12 +518,24 @@ sockinfo_tcp_ops_tls::~sockinfo_tcp_ops_tls()
             delete m_rx_rule;
             m_rx_rule = nullptr;
         }
-        m_p_tx_ring->tls_release_tir(m_p_tir);
-        m_p_tir = nullptr;
+        if (m_p_tir) {
+            m_p_tx_ring->tls_release_tir(m_p_tir);
+            m_p_tir = nullptr;
+        }
         if (m_p_cipher_ctx) {
             g_tls_api->EVP_CIPHER_CTX_free(reinterpret_cast<EVP_CIPHER_CTX *>(m_p_cipher_ctx));
             m_p_cipher_ctx = nullptr;
         }
+        if (m_p_cipher_ctx_enc) {
+            g_tls_api->EVP_CIPHER_CTX_free(reinterpret_cast<EVP_CIPHER_CTX *>(m_p_cipher_ctx_enc));
+            m_p_cipher_ctx_enc = nullptr;
+        }
+        if (m_p_rx_batch_key) {
+            /* A pending batch entry holds its own key copy and buffer references. */
+            memset(m_p_rx_batch_key, 0, sizeof(*m_p_rx_batch_key));
+            delete m_p_rx_batch_key;
+            m_p_rx_batch_key = nullptr;
+        }
         while (m_refused_data) {
             struct pbuf *p = m_refused_data;
             m_refused_data = p->next;
@@ -472,6 +608,7 @@ int sockinfo_tcp_ops_tls::setsockopt(int __level, int __optname, const void *__o
     unsigned char *rec_seq;
     unsigned char *key;
     uint32_t keylen;
+    void *evp_cipher = nullptr;
     const struct tls_crypto_info *base_info = (const struct tls_crypto_info *)__optval;
 
     if (__level != SOL_TLS) {
@@ -495,16 +632,29 @@ int sockinfo_tcp_ops_tls::setsockopt(int __level, int __optname, const void *__o
         return -1;
     }
 
+    /* The adapter offloads AES-GCM only, other ciphers need the software record layer. */
+    bool is_sw_cipher = base_info->cipher_type != TLS_CIPHER_AES_GCM_128;
+#ifdef DEFINED_UTLS_AES256
+    is_sw_cipher = is_sw_cipher && base_info->cipher_type != TLS_CIPHER_AES_GCM_256;
+#endif /* DEFINED_UTLS_AES256 */
+
     if (__optname == TLS_TX) {
         /* TX offload checks. */
-        if (unlikely(!m_p_sock->is_utls_supported(UTLS_MODE_TX))) {
+        m_is_tls_tx_sw = is_sw_cipher || !m_p_sock->is_utls_supported(UTLS_MODE_TX);
+        if (unlikely(m_is_tls_tx_sw && !m_p_sock->is_utls_sw_supported(UTLS_MODE_TX))) {
             si_ulp_logdbg("TLS_TX is not supported.");
             errno = ENOPROTOOPT;
             return -1;
         }
+        if (unlikely(m_is_tls_tx_sw && !g_tls_api)) {
+            si_ulp_logdbg("OpenSSL symbols aren't found, cannot support TLS TX in software.");
+            errno = ENOPROTOOPT;
+            return -1;
+        }
     } else {
         /* RX offload checks. */
-        if (unlikely(!m_p_sock->is_utls_supported(UTLS_MODE_RX))) {
+        m_is_tls_rx_sw = is_sw_cipher || !m_p_sock->is_utls_supported(UTLS_MODE_RX);
+        if (unlikely(m_is_tls_rx_sw && !m_p_sock->is_utls_sw_supported(UTLS_MODE_RX))) {
             si_ulp_logdbg("TLS_RX is not supported.");
             errno = ENOPROTOOPT;
             return -1;
@@ -514,12 +664,13 @@ int sockinfo_tcp_ops_tls::setsockopt(int __level, int __optname, const void *__o
             errno = ENOPROTOOPT;
             return -1;
         }
-        if (unlikely(!m_p_rx_ring)) {
+        /* The software record layer doesn't need the NIC, skip the ring checks. */
+        if (unlikely(!m_is_tls_rx_sw && !m_p_rx_ring)) {
             si_ulp_logdbg("Cannot determine RX ring, TLS RX offload is impossible.");
             errno = ENOPROTOOPT;
             return -1;
         }
-        if (unlikely(m_p_tx_ring->get_ctx(0) != m_p_rx_ring->get_ctx(0))) {
+        if (unlikely(!m_is_tls_rx_sw && m_p_tx_ring->get_ctx(0) != m_p_rx_ring->get_ctx(0))) {
             si_ulp_logdbg("TLS_RX doesn't support scenario where TX "
                           "and RX rings are on different IB contexts.");
             errno = ENOPROTOOPT;
@@ -538,8 +689,8 @@ int sockinfo_tcp_ops_tls::setsockopt(int __level, int __optname, const void *__o
             rec_seq = crypto_info->rec_seq;
             key = crypto_info->key;
             keylen = TLS_CIPHER_AES_GCM_128_KEY_SIZE;
-            if (__optname == TLS_RX) {
-                m_p_evp_cipher = (void *)g_tls_api->EVP_aes_128_gcm();
+            if (g_tls_api) {
+                evp_cipher = (void *)g_tls_api->EVP_aes_128_gcm();
             }
         }
         break;
@@ -558,12 +709,40 @@ int sockinfo_tcp_ops_tls::setsockopt(int __level, int __optname, const void *__o
             rec_seq = crypto_info->rec_seq;
             key = crypto_info->key;
             keylen = TLS_CIPHER_AES_GCM_256_KEY_SIZE;
-            if (__optname == TLS_RX) {
-                m_p_evp_cipher = (void *)g_tls_api->EVP_aes_256_gcm();
+            if (g_tls_api) {
+                evp_cipher = (void *)g_tls_api->EVP_aes_256_gcm();
             }
         }
         break;
 #endif /* DEFINED_UTLS_AES256 */
+#ifdef DEFINED_UTLS_CHACHA20
+    case TLS_CIPHER_CHACHA20_POLY1305:
+        if (unlikely(__optlen < sizeof(tls12_crypto_info_chacha20_poly1305))) {
+            errno = EINVAL;
+            return -1;
+        }
+        if (unlikely(!g_tls_api->EVP_chacha20_poly1305)) {
+            si_ulp_logdbg("OpenSSL doesn't provide ChaCha20-Poly1305.");
+            errno = ENOPROTOOPT;
+            return -1;
+        }
+        /* Wrap with a block to avoid initialization error */
+        {
+            struct tls12_crypto_info_chacha20_poly1305 *crypto_info =
+                (struct tls12_crypto_info_chacha20_poly1305 *)__optval;
+            /*
+             * There is no salt, split the 12 bytes IV to fit the AES-GCM layout.
+             * The nonce is built as salt || (iv64 ^ recno) for both TLS versions.
+             */
+            salt = crypto_info->iv;
+            iv = crypto_info->iv + TLS_AES_GCM_SALT_LEN;
+            rec_seq = crypto_info->rec_seq;
+            key = crypto_info->key;
+            keylen = TLS_CIPHER_CHACHA20_POLY1305_KEY_SIZE;
+            evp_cipher = (void *)g_tls_api->EVP_chacha20_poly1305();
+        }
+        break;
+#endif /* DEFINED_UTLS_CHACHA20 */
     default:
         si_ulp_logdbg("Unsupported TLS cipher ID: %u.", base_info->cipher_type);
         errno = ENOPROTOOPT;
@@ -587,8 +766,24 @@ int sockinfo_tcp_ops_tls::setsockopt(int __level, int __optname, const void *__o
 
     m_tls_rec_overhead =
         (base_info->version == TLS_1_2_VERSION) ? TLS_12_RECORD_OVERHEAD : TLS_13_RECORD_OVERHEAD;
+    if (base_info->version == TLS_1_2_VERSION && !has_explicit_iv(*tls_info)) {
+        m_tls_rec_overhead -= TLS_RECORD_IV_LEN;
+    }
 
-    if (__optname == TLS_TX) {
+    if (__optname == TLS_TX && m_is_tls_tx_sw) {
+        /* Software record layer: records are encrypted in tx() with a pre-keyed context. */
+        m_p_cipher_ctx_tx = tls_cipher_ctx_create(evp_cipher, m_tls_info_tx.key, false);
+        /* We don't need key for TX anymore. */
+        memset(m_tls_info_tx.key, 0, keylen);
+        if (unlikely(!m_p_cipher_ctx_tx)) {
+            si_ulp_logdbg("OpenSSL initialization failed.");
+            errno = ENOPROTOOPT;
+            return -1;
+        }
+        m_next_recno_tx = be64toh(recno_be64);
+        m_is_tls_tx = true;
+        m_p_sock->m_p_socket_stats->tls_tx_offload = true;
+    } else if (__optname == TLS_TX) {
         if (!m_p_tx_ring->credits_get(SQ_CREDITS_TLS_TX_CONTEXT)) {
             si_ulp_logdbg("No available space in SQ to create TLS TX context");
             errno = ENOPROTOOPT;
@@ -607,24 +802,36 @@ int sockinfo_tcp_ops_tls::setsockopt(int __level, int __optname, const void *__o
         m_is_tls_tx = true;
         m_p_sock->m_p_socket_stats->tls_tx_offload = true;
     } else {
-        m_p_cipher_ctx = (void *)g_tls_api->EVP_CIPHER_CTX_new();
+        m_p_evp_cipher = evp_cipher;
+        m_p_cipher_ctx = tls_cipher_ctx_create(m_p_evp_cipher, m_tls_info_rx.key, true);
         if (unlikely(!m_p_cipher_ctx)) {
             si_ulp_logdbg("OpenSSL initialization failed.");
             errno = ENOPROTOOPT;
             return -1;
         }
 
+        if (m_is_tls_rx_sw && !is_sw_cipher && safe_mce_sys().enable_utls_rx_batch) {
+            m_p_rx_batch_key = new aes_gcm_mb_key;
+            if (!aes_gcm_mb_key_init(m_p_rx_batch_key, m_tls_info_rx.key, keylen)) {
+                si_ulp_logdbg("Multi-buffer AES-GCM isn't supported, RX batching is off.");
+                delete m_p_rx_batch_key;
+                m_p_rx_batch_key = nullptr;
+            }
+        }
+
         m_next_recno_rx = be64toh(recno_be64);
         m_is_tls_rx = true;
 
         /*
          * First, get TIR from the TX ring cache. Create new one in
-         * the RX ring if the cache is empty.
+         * the RX ring if the cache is empty. Software mode doesn't use TIR.
          */
-        m_p_tir = m_p_tx_ring->tls_create_tir(true) ?: m_p_rx_ring->tls_create_tir(false);
+        if (!m_is_tls_rx_sw) {
+            m_p_tir = m_p_tx_ring->tls_create_tir(true) ?: m_p_rx_ring->tls_create_tir(false);
+        }
 
         m_p_sock->lock_tcp_con();
-        if (m_p_tir) {
+        if (m_p_tir || m_is_tls_rx_sw) {
             err_t err = tls_rx_consume_ready_packets();
             if (unlikely(err != ERR_OK)) {
                 si_ulp_logdbg("Cannot consume ready packets, TLS RX offload will likely fail.");
@@ -649,7 +856,7 @@ int sockinfo_tcp_ops_tls::setsockopt(int __level, int __optname, const void *__o
                 m_p_tir = nullptr;
             }
         }
-        if (unlikely(!m_p_tir)) {
+        if (unlikely(!m_p_tir && !m_is_tls_rx_sw)) {
             si_ulp_logdbg("TLS RX offload setup failed");
             m_is_tls_rx = false;
             m_p_sock->unlock_tcp_con();
@@ -665,9 +872,12 @@ int sockinfo_tcp_ops_tls::setsockopt(int __level, int __optname, const void *__o
     m_p_sock->m_p_socket_stats->tls_version = base_info->version;
     m_p_sock->m_p_socket_stats->tls_cipher = base_info->cipher_type;
 
-    si_ulp_logdbg("TLS%s %s offload is configured, keylen=%u",
+    si_ulp_logdbg("TLS%s %s %s is configured, keylen=%u",
                   base_info->version == TLS_1_2_VERSION ? "1.2" : "1.3",
-                  __optname == TLS_TX ? "TX" : "RX", keylen);
+                  __optname == TLS_TX ? "TX" : "RX",
+                  (__optname == TLS_TX ? m_is_tls_tx_sw : m_is_tls_rx_sw) ? "software record layer"
+                                                                           : "offload",
+                  keylen);
     return 0;
 }
 
@@ -719,7 +929,15 @@ ssize_t sockinfo_tcp_ops_tls::tx(xlio_tx_call_attr_t &tx_arg)
     size_t pos;
     int errno_save;
     bool block_this_run = BLOCK_THIS_RUN(m_p_sock->is_blocking(), tx_arg.attr.flags);
-    bool is_zerocopy = tx_arg.attr.flags & MSG_ZEROCOPY;
+    /* Software records are encrypted into TX buffers, so user data is never referenced. */
+    bool is_zerocopy = (tx_arg.attr.flags & MSG_ZEROCOPY) && !m_is_tls_tx_sw;
+    /*
+     * sendfile() fallback when the file can't be mapped. iov_base points to the file offset
+     * and plaintext is read directly into the record buffer.
+     */
+    bool is_file = (tx_arg.opcode == TX_FILE && tx_arg.priv.attr == PBUF_DESC_FD);
+    __off64_t file_offset =
+        is_file ? *reinterpret_cast<__off64_t *>(tx_arg.attr.iov[0].iov_base) : 0;
     uint8_t tls_type = 0x17;
 
     if (!m_is_tls_tx) {
@@ -776,7 +994,7 @@ ssize_t sockinfo_tcp_ops_tls::tx(xlio_tx_call_attr_t &tx_arg)
 
             rec = new tls_record(
                 this, m_p_sock->get_next_tcp_seqno(), m_next_recno_tx,
-                is_tx_tls13() ? nullptr : m_tls_info_tx.iv,
+                is_tx_explicit_iv() ? m_tls_info_tx.iv : nullptr, is_tx_tls13(),
                 is_zerocopy ? reinterpret_cast<mem_desc *>(tx_arg.priv.mdesc) : nullptr);
             if (unlikely(!rec || !rec->m_p_buf)) {
                 if (ret == 0) {
@@ -791,9 +1009,9 @@ ssize_t sockinfo_tcp_ops_tls::tx(xlio_tx_call_attr_t &tx_arg)
             ++m_next_recno_tx;
             /*
              * Prepare unique explicit_nonce for the next TLS1.2 record.
-             * TLS1.3 always uses the initial IV.
+             * TLS1.3 and ChaCha20-Poly1305 always use the initial IV.
              */
-            if (!is_tx_tls13()) {
+            if (is_tx_explicit_iv()) {
                 ++m_tls_info_tx.iv64;
             }
 
@@ -801,9 +1019,43 @@ ssize_t sockinfo_tcp_ops_tls::tx(xlio_tx_call_attr_t &tx_arg)
                 /* sndbuf overflow is not possible since we have a check above. */
                 tosend = std::min(tosend, sndbuf - m_tls_rec_overhead);
             }
-            tosend = rec->append_data((uint8_t *)p_iov[i].iov_base + pos, tosend, is_tx_tls13());
-            /* Set type after all data, because for TLS1.3 it is in the tail. */
-            rec->set_type(tls_type, is_tx_tls13());
+            if (is_file) {
+                ssize_t read_len = tls_tx_read_file(rec, tx_arg.priv.fd, file_offset + pos, tosend);
+                if (unlikely(read_len <= 0)) {
+                    if (ret == 0 && read_len < 0) {
+                        ret = -1;
+                    }
+                    rec->put();
+                    --m_next_recno_tx;
+                    goto done;
+                }
+                tosend = (size_t)read_len;
+            }
+            if (m_is_tls_tx_sw) {
+                /* File data is encrypted in place. */
+                const uint8_t *data = is_file ? rec->data_tail(is_tx_tls13())
+                                              : (uint8_t *)p_iov[i].iov_base + pos;
+                ssize_t enc_len = tls_tx_encrypt(rec, data, tosend, tls_type);
+                if (unlikely(enc_len < 0)) {
+                    if (ret == 0) {
+                        errno = EIO;
+                        ret = -1;
+                    }
+                    rec->put();
+                    --m_next_recno_tx;
+                    goto done;
+                }
+                tosend = (size_t)enc_len;
+            } else {
+                if (is_file) {
+                    rec->reserve_data(tosend, is_tx_tls13());
+                } else {
+                    tosend = rec->append_data((uint8_t *)p_iov[i].iov_base + pos, tosend,
+                                              is_tx_tls13());
+                }
+                /* Set type after all data, because for TLS1.3 it is in the tail. */
+                rec->set_type(tls_type, is_tx_tls13());
+            }
             rec->fill_iov(tls_arg.attr.iov, ARRAY_SIZE(tls_iov), is_tx_tls13());
             tls_arg.priv.mdesc = reinterpret_cast<void *>(rec);
             pos += tosend;
@@ -867,7 +1119,8 @@ done:
 
 int sockinfo_tcp_ops_tls::postrouting(struct pbuf *p, struct tcp_seg *seg, xlio_send_attr &attr)
 {
-    if (m_is_tls_tx && seg && p->type != PBUF_RAM) {
+    /* Software records are already encrypted and don't need TIS or resync. */
+    if (m_is_tls_tx && !m_is_tls_tx_sw && seg && p->type != PBUF_RAM) {
         if (seg->len != 0) {
             if (unlikely(seg->seqno != m_expected_seqno)) {
 
@@ -1045,18 +1298,40 @@ void sockinfo_tcp_ops_tls::terminate_session_fatal(uint8_t alert_type)
     m_rx_sm = TLS_RX_SM_FAIL;
 }
 
-void sockinfo_tcp_ops_tls::copy_by_offset(uint8_t *dst, uint32_t offset, uint32_t len)
+/*
+ * Returns the buffer which holds the offset (relative to the head buffer) and converts the
+ * offset to the in-buffer one. The lookup starts from the RX cursor when the offset is beyond
+ * it and moves the cursor forward, so the record tail is reached without rescanning the list.
+ */
+xlio_desc_list_t::iterator sockinfo_tcp_ops_tls::rx_buf_seek(uint32_t &offset)
 {
-    auto iter = m_rx_bufs.begin();
-    mem_buf_desc_t *pdesc = *iter;
+    xlio_desc_list_t::iterator iter;
+    uint32_t base = 0;
 
-    /* Skip leading buffers */
-    if (unlikely(pdesc->lwip_pbuf.pbuf.len <= offset)) {
-        while (pdesc && pdesc->lwip_pbuf.pbuf.len <= offset) {
-            offset -= pdesc->lwip_pbuf.pbuf.len;
-            pdesc = *(++iter);
-        }
+    if (m_rx_cursor_desc && offset >= m_rx_cursor_base) {
+        iter = m_rx_cursor_desc;
+        base = m_rx_cursor_base;
+    } else {
+        iter = m_rx_bufs.begin();
+    }
+    offset -= base;
+
+    while (*iter && iter->lwip_pbuf.pbuf.len <= offset) {
+        offset -= iter->lwip_pbuf.pbuf.len;
+        base += iter->lwip_pbuf.pbuf.len;
+        ++iter;
+    }
+    if (*iter && (!m_rx_cursor_desc || base > m_rx_cursor_base)) {
+        m_rx_cursor_desc = *iter;
+        m_rx_cursor_base = base;
     }
+    return iter;
+}
+
+void sockinfo_tcp_ops_tls::copy_by_offset(uint8_t *dst, uint32_t offset, uint32_t len)
+{
+    auto iter = rx_buf_seek(offset);
+    mem_buf_desc_t *pdesc = *iter;
 
     /* Copy */
     while (likely(pdesc) && len > 0) {
@@ -1074,18 +1349,10 @@ void sockinfo_tcp_ops_tls::copy_by_offset(uint8_t *dst, uint32_t offset, uint32_
 /* More efficient method to get 16bit value in the buffer list. */
 uint16_t sockinfo_tcp_ops_tls::offset_to_host16(uint32_t offset)
 {
-    auto iter = m_rx_bufs.begin();
+    auto iter = rx_buf_seek(offset);
     mem_buf_desc_t *pdesc = *iter;
     uint16_t res = 0;
 
-    /* Skip leading buffers */
-    if (unlikely(pdesc->lwip_pbuf.pbuf.len <= offset)) {
-        while (pdesc && pdesc->lwip_pbuf.pbuf.len <= offset) {
-            offset -= pdesc->lwip_pbuf.pbuf.len;
-            pdesc = *(++iter);
-        }
-    }
-
     if (likely(pdesc)) {
         res = (uint16_t)((uint8_t *)pdesc->lwip_pbuf.pbuf.payload)[offset] << 8U;
         ++offset;
@@ -1101,34 +1368,160 @@ uint16_t sockinfo_tcp_ops_tls::offset_to_host16(uint32_t offset)
     return res;
 }
 
-int sockinfo_tcp_ops_tls::tls_rx_decrypt(struct pbuf *plist)
+void *sockinfo_tcp_ops_tls::tls_cipher_ctx_create(void *evp_cipher, const uint8_t *key,
+                                                  bool decrypt)
+{
+    EVP_CIPHER_CTX *tls_ctx = g_tls_api->EVP_CIPHER_CTX_new();
+    int ret;
+
+    if (unlikely(!tls_ctx)) {
+        return nullptr;
+    }
+    /* Expand the key schedule once, IV is provided per record. */
+    if (decrypt) {
+        ret = g_tls_api->EVP_DecryptInit_ex(tls_ctx, (EVP_CIPHER *)evp_cipher, NULL, key, NULL);
+    } else {
+        ret = g_tls_api->EVP_EncryptInit_ex(tls_ctx, (EVP_CIPHER *)evp_cipher, NULL, key, NULL);
+    }
+    if (unlikely(!ret)) {
+        g_tls_api->EVP_CIPHER_CTX_free(tls_ctx);
+        return nullptr;
+    }
+    return tls_ctx;
+}
+
+/* Reads file data into the payload room of the record without reserving it. */
+ssize_t sockinfo_tcp_ops_tls::tls_tx_read_file(tls_record *rec, int fd, __off64_t offset,
+                                               size_t len)
+{
+    ssize_t ret;
+
+    len = std::min(len, rec->avail_space());
+    do {
+        ret = pread64(fd, rec->data_tail(is_tx_tls13()), len, offset);
+    } while (ret < 0 && errno == EINTR);
+    return ret;
+}
+
+/*
+ * Software TX record layer. Encrypts user data straight into the record buffer,
+ * so the payload is touched once. Returns the number of consumed bytes or -1.
+ */
+ssize_t sockinfo_tcp_ops_tls::tls_tx_encrypt(tls_record *rec, const uint8_t *data, size_t len,
+                                             uint8_t type)
 {
     /* Multi-purpose buffer, TAG is the largest object. */
     uint8_t buf[TLS_RECORD_TAG_LEN] __attribute__((aligned(8)));
-    EVP_CIPHER_CTX *tls_ctx;
-    struct pbuf *p;
-    int len;
+    EVP_CIPHER_CTX *tls_ctx = (EVP_CIPHER_CTX *)m_p_cipher_ctx_tx;
+    bool is_tls13 = is_tx_tls13();
+    uint8_t *payload;
+    int outlen;
     int ret;
 
-    tls_ctx = (EVP_CIPHER_CTX *)m_p_cipher_ctx;
     assert(tls_ctx);
-    ret = g_tls_api->EVP_CIPHER_CTX_reset(tls_ctx);
-    if (unlikely(!ret)) {
-        return TLS_DECRYPT_INTERNAL;
-    }
+    payload = rec->reserve_data(len, is_tls13);
+    /* For TLS1.3 the type is the last byte of the plaintext and it is encrypted too. */
+    rec->set_type(type, is_tls13);
 
     /* Build nonce. */
-    memcpy(buf, m_tls_info_rx.salt, TLS_AES_GCM_SALT_LEN);
-    if (is_rx_tls13()) {
-        uint64_t iv64 = m_tls_info_rx.iv64;
-        iv64 ^= htobe64(m_next_recno_rx);
+    memcpy(buf, m_tls_info_tx.salt, TLS_AES_GCM_SALT_LEN);
+    if (is_tx_explicit_iv()) {
+        memcpy(&buf[TLS_AES_GCM_SALT_LEN], &rec->m_p_data[TLS_RECORD_HDR_LEN], TLS_RECORD_IV_LEN);
+    } else {
+        uint64_t iv64 = m_tls_info_tx.iv64;
+        iv64 ^= htobe64(rec->m_record_number);
         memcpy(&buf[TLS_AES_GCM_SALT_LEN], &iv64, sizeof(iv64));
+    }
+    ret = g_tls_api->EVP_EncryptInit_ex(tls_ctx, NULL, NULL, NULL, buf);
+    if (unlikely(!ret)) {
+        return -1;
+    }
+
+    /* Additional data for AEAD */
+    if (is_tls13) {
+        ret = g_tls_api->EVP_EncryptUpdate(tls_ctx, NULL, &outlen, rec->m_p_data,
+                                           TLS_RECORD_HDR_LEN);
     } else {
-        copy_by_offset(&buf[TLS_AES_GCM_SALT_LEN], m_rx_offset + TLS_RECORD_HDR_LEN,
+        *((uint64_t *)buf) = htobe64(rec->m_record_number);
+        memcpy(buf + 8, rec->m_p_data, 3);
+        buf[11] = len >> 8U;
+        buf[12] = len & 0xFFU;
+        ret = g_tls_api->EVP_EncryptUpdate(tls_ctx, NULL, &outlen, buf, 13);
+    }
+    if (unlikely(!ret)) {
+        return -1;
+    }
+
+    ret = g_tls_api->EVP_EncryptUpdate(tls_ctx, payload, &outlen, data, (int)len);
+    if (unlikely(!ret || outlen != (int)len)) {
+        return -1;
+    }
+    if (is_tls13) {
+        ret = g_tls_api->EVP_EncryptUpdate(tls_ctx, payload + len, &outlen, payload + len, 1);
+        if (unlikely(!ret || outlen != 1)) {
+            return -1;
+        }
+    }
+    ret = g_tls_api->EVP_EncryptFinal_ex(tls_ctx, buf /* XXX */, &outlen);
+    if (unlikely(!ret || outlen != 0)) {
+        return -1;
+    }
+    ret = g_tls_api->EVP_CIPHER_CTX_ctrl(tls_ctx, EVP_CTRL_GCM_GET_TAG, TLS_RECORD_TAG_LEN,
+                                         rec->m_p_data + rec->m_size - TLS_RECORD_TAG_LEN);
+    return likely(ret) ? (ssize_t)len : -1;
+}
+
+/* Builds nonce and AAD of the first unhandled record, returns AAD length. */
+uint32_t sockinfo_tcp_ops_tls::tls_rx_nonce_aad(uint8_t *nonce, uint8_t *aad)
+{
+    memcpy(nonce, m_tls_info_rx.salt, TLS_AES_GCM_SALT_LEN);
+    if (is_rx_explicit_iv()) {
+        copy_by_offset(&nonce[TLS_AES_GCM_SALT_LEN], m_rx_offset + TLS_RECORD_HDR_LEN,
                        TLS_RECORD_IV_LEN);
+    } else {
+        uint64_t iv64 = m_tls_info_rx.iv64;
+
+        iv64 ^= htobe64(m_next_recno_rx);
+        memcpy(&nonce[TLS_AES_GCM_SALT_LEN], &iv64, sizeof(iv64));
     }
-    ret = g_tls_api->EVP_DecryptInit_ex(tls_ctx, (EVP_CIPHER *)m_p_evp_cipher, NULL,
-                                        m_tls_info_rx.key, buf);
+
+    if (is_rx_tls13()) {
+        uint16_t rec_len = m_rx_rec_len - TLS_RECORD_HDR_LEN;
+
+        copy_by_offset(aad, m_rx_offset, 3);
+        aad[3] = rec_len >> 8U;
+        aad[4] = rec_len & 0xFFU;
+        return 5;
+    }
+
+    uint16_t rec_len = m_rx_rec_len - m_tls_rec_overhead;
+    uint64_t recno_be64 = htobe64(m_next_recno_rx);
+
+    memcpy(aad, &recno_be64, sizeof(recno_be64));
+    copy_by_offset(aad + 8, m_rx_offset, 3);
+    aad[11] = rec_len >> 8U;
+    aad[12] = rec_len & 0xFFU;
+    return TLS_RECORD_AAD_MAX;
+}
+
+int sockinfo_tcp_ops_tls::tls_rx_decrypt(struct pbuf *plist)
+{
+    /* Multi-purpose buffer, TAG is the largest object. */
+    uint8_t buf[TLS_RECORD_TAG_LEN] __attribute__((aligned(8)));
+    uint8_t aad[TLS_RECORD_AAD_MAX];
+    uint32_t aad_len;
+    EVP_CIPHER_CTX *tls_ctx;
+    struct pbuf *p;
+    int len;
+    int ret;
+
+    tls_ctx = (EVP_CIPHER_CTX *)m_p_cipher_ctx;
+    assert(tls_ctx);
+
+    /* Build nonce and additional data for AEAD. */
+    aad_len = tls_rx_nonce_aad(buf, aad);
+    /* The key is already set, reinitialize GCM state with the new IV only. */
+    ret = g_tls_api->EVP_DecryptInit_ex(tls_ctx, NULL, NULL, NULL, buf);
     if (unlikely(!ret)) {
         return TLS_DECRYPT_INTERNAL;
     }
@@ -1140,21 +1533,7 @@ int sockinfo_tcp_ops_tls::tls_rx_decrypt(struct pbuf *plist)
         return TLS_DECRYPT_INTERNAL;
     }
 
-    /* Additional data for AEAD */
-    if (is_rx_tls13()) {
-        uint16_t rec_len = m_rx_rec_len - TLS_RECORD_HDR_LEN;
-        copy_by_offset(buf, m_rx_offset, 3);
-        buf[3] = rec_len >> 8U;
-        buf[4] = rec_len & 0xFFU;
-        ret = g_tls_api->EVP_DecryptUpdate(tls_ctx, NULL, &len, buf, 5);
-    } else {
-        uint16_t rec_len = m_rx_rec_len - m_tls_rec_overhead;
-        *((uint64_t *)buf) = htobe64(m_next_recno_rx);
-        copy_by_offset(buf + 8, m_rx_offset, 3);
-        buf[11] = rec_len >> 8U;
-        buf[12] = rec_len & 0xFFU;
-        ret = g_tls_api->EVP_DecryptUpdate(tls_ctx, NULL, &len, buf, 13);
-    }
+    ret = g_tls_api->EVP_DecryptUpdate(tls_ctx, NULL, &len, aad, aad_len);
     if (unlikely(!ret)) {
         return TLS_DECRYPT_INTERNAL;
     }
@@ -1193,12 +1572,13 @@ int sockinfo_tcp_ops_tls::tls_rx_encrypt(struct pbuf *plist)
     int len;
     int ret;
 
-    tls_ctx = (EVP_CIPHER_CTX *)m_p_cipher_ctx;
-    assert(tls_ctx);
-    ret = g_tls_api->EVP_CIPHER_CTX_reset(tls_ctx);
-    if (unlikely(!ret)) {
-        return TLS_DECRYPT_INTERNAL;
+    if (unlikely(!m_p_cipher_ctx_enc)) {
+        m_p_cipher_ctx_enc = tls_cipher_ctx_create(m_p_evp_cipher, m_tls_info_rx.key, false);
+        if (unlikely(!m_p_cipher_ctx_enc)) {
+            return TLS_DECRYPT_INTERNAL;
+        }
     }
+    tls_ctx = (EVP_CIPHER_CTX *)m_p_cipher_ctx_enc;
 
     /* Build nonce. */
     memcpy(buf, m_tls_info_rx.salt, TLS_AES_GCM_SALT_LEN);
@@ -1210,8 +1590,7 @@ int sockinfo_tcp_ops_tls::tls_rx_encrypt(struct pbuf *plist)
         copy_by_offset(&buf[TLS_AES_GCM_SALT_LEN], m_rx_offset + TLS_RECORD_HDR_LEN,
                        TLS_RECORD_IV_LEN);
     }
-    ret = g_tls_api->EVP_EncryptInit_ex(tls_ctx, (EVP_CIPHER *)m_p_evp_cipher, NULL,
-                                        m_tls_info_rx.key, buf);
+    ret = g_tls_api->EVP_EncryptInit_ex(tls_ctx, NULL, NULL, NULL, buf);
     if (unlikely(!ret)) {
         return TLS_DECRYPT_INTERNAL;
     }
@@ -1261,13 +1640,86 @@ int sockinfo_tcp_ops_tls::tls_rx_encrypt(struct pbuf *plist)
     return 0;
 }
 
+/*
+ * Adds the first unhandled record to the current thread's batch. The record must be
+ * complete. Returns false if the record isn't eligible or there is no room.
+ */
+bool sockinfo_tcp_ops_tls::tls_rx_batch_enqueue(void)
+{
+    struct tls_rx_batch *batch = &t_rx_batch;
+    struct tls_rx_batch_entry *entry;
+    uint32_t offset =
+        m_rx_offset + TLS_RECORD_HDR_LEN + (is_rx_explicit_iv() ? TLS_RECORD_IV_LEN : 0);
+    uint32_t remain = m_rx_rec_len - m_tls_rec_overhead + (is_rx_tls13() ? 1 : 0);
+    uint32_t iov_nr = 0;
+    uint32_t base = 0;
+
+    if (batch->depth != 1 || batch->flushing || batch->nr >= AES_GCM_MB_LANES_MAX ||
+        m_rx_rec_len > TLS_RX_BATCH_RECORD_MAX) {
+        return false;
+    }
+
+    entry = &batch->entries[batch->nr];
+    auto iter = m_rx_bufs.begin();
+    for (mem_buf_desc_t *pdesc = *iter; pdesc && remain > 0; pdesc = *(++iter)) {
+        struct pbuf *pi = &pdesc->lwip_pbuf.pbuf;
+        uint32_t len;
+
+        if (pi->len <= offset) {
+            offset -= pi->len;
+            base += pi->len;
+            continue;
+        }
+        if (iov_nr == TLS_RX_BATCH_SEGS_MAX) {
+            return false;
+        }
+        len = std::min<uint32_t>(pi->len - offset, remain);
+        entry->iov[iov_nr].iov_base = (uint8_t *)pi->payload + offset;
+        entry->iov[iov_nr].iov_len = len;
+        entry->bufs[iov_nr++] = pdesc;
+        remain -= len;
+        offset = 0;
+        /* The tag follows the payload, leave the cursor at the last payload buffer. */
+        m_rx_cursor_desc = pdesc;
+        m_rx_cursor_base = base;
+        base += pi->len;
+    }
+    if (unlikely(remain > 0)) {
+        return false;
+    }
+
+    entry->iov_nr = iov_nr;
+    entry->aad_len = tls_rx_nonce_aad(entry->nonce, entry->aad);
+    copy_by_offset(entry->tag, m_rx_offset + m_rx_rec_len - TLS_RECORD_TAG_LEN,
+                   TLS_RECORD_TAG_LEN);
+    entry->key = *m_p_rx_batch_key;
+    entry->sock = m_p_sock;
+    entry->sock->get_ref();
+    entry->ops = this;
+    for (uint32_t i = 0; i < iov_nr; ++i) {
+        /* Keep the buffers even if the TLS object is destroyed before the flush. */
+        ++entry->bufs[i]->lwip_pbuf.pbuf.ref;
+    }
+    ++batch->nr;
+    m_rx_batch_state = TLS_RX_BATCH_PENDING;
+    return true;
+}
+
+/* Called under TCP connection lock when the batch with the first record is flushed. */
+void sockinfo_tcp_ops_tls::tls_rx_batch_complete(enum tls_rx_batch_state state)
+{
+    assert(m_rx_batch_state == TLS_RX_BATCH_PENDING);
+    m_rx_batch_state = state;
+    tls_rx_process_records();
+}
+
 err_t sockinfo_tcp_ops_tls::recv(struct pbuf *p)
 {
     bool resync_requested = false;
-    err_t err;
 
     if (m_rx_bufs.empty()) {
         m_rx_offset = 0;
+        m_rx_cursor_desc = nullptr;
     }
 
     m_rx_rec_rcvd += p->tot_len;
@@ -1275,6 +1727,10 @@ err_t sockinfo_tcp_ops_tls::recv(struct pbuf *p)
         mem_buf_desc_t *pdesc = reinterpret_cast<mem_buf_desc_t *>(p);
         struct pbuf *ptmp = p->next;
 
+        if (m_is_tls_rx_sw) {
+            /* No HW offload, the whole record is decrypted in place by tls_rx_decrypt(). */
+            pdesc->rx.tls_decrypted = TLS_RX_ENCRYPTED;
+        }
         if (unlikely(pdesc->rx.tls_decrypted == TLS_RX_RESYNC)) {
             resync_requested = true;
         }
@@ -1300,6 +1756,18 @@ err_t sockinfo_tcp_ops_tls::recv(struct pbuf *p)
         }
     }
 
+    return tls_rx_process_records();
+}
+
+err_t sockinfo_tcp_ops_tls::tls_rx_process_records(void)
+{
+    err_t err;
+
+    if (m_rx_batch_state == TLS_RX_BATCH_PENDING) {
+        /* The first record is in a batch, keep the new data until the batch is flushed. */
+        return ERR_OK;
+    }
+
     if (unlikely(m_refused_data)) {
         err =
             sockinfo_tcp::rx_lwip_cb((void *)m_p_sock, m_p_sock->get_pcb(), m_refused_data, ERR_OK);
@@ -1335,12 +1803,20 @@ check_single_record:
 
     /* The first record is complete - push the payload to application. */
 
+    if (m_p_rx_batch_key && m_rx_batch_state == TLS_RX_BATCH_NONE && tls_rx_batch_enqueue()) {
+        /* The record is decrypted by tls_rx_batch_end() at the end of the ring poll. */
+        return ERR_OK;
+    }
+
     auto iter = m_rx_bufs.begin();
     struct pbuf *pi;
     struct pbuf *pres = nullptr;
     struct pbuf *ptmp = nullptr;
-    uint32_t offset = m_rx_offset + TLS_RECORD_HDR_LEN + (is_rx_tls13() ? 0 : TLS_RECORD_IV_LEN);
+    struct pbuf *ptail = nullptr;
+    uint32_t offset =
+        m_rx_offset + TLS_RECORD_HDR_LEN + (is_rx_explicit_iv() ? TLS_RECORD_IV_LEN : 0);
     uint32_t remain = m_rx_rec_len - m_tls_rec_overhead;
+    uint32_t base = 0;
     unsigned bufs_nr = 0;
     unsigned decrypted_nr = 0;
     uint8_t tls_type;
@@ -1356,6 +1832,7 @@ check_single_record:
             return ERR_OK;
         }
     }
+    uint32_t payload_len = remain;
     while (remain > 0) {
         if (unlikely(!pdesc)) {
             /* TODO Handle this situation, buffers chain is broken. */
@@ -1386,9 +1863,10 @@ check_single_record:
         if (!pres) {
             pres = ptmp;
         } else {
-            /* XXX Complexity of building pres list is O(N^2). */
-            pbuf_cat(pres, ptmp);
+            /* tot_len is fixed up once the list is complete. */
+            ptail->next = ptmp;
         }
+        ptail = ptmp;
 
         /* Reference counting for the underlying buffer. TODO Refactor. */
         ++pi->ref;
@@ -1397,13 +1875,30 @@ check_single_record:
 
         remain -= ptmp->len;
         offset = 0;
+        /* The tag follows the payload, leave the cursor at the last payload buffer. */
+        m_rx_cursor_desc = pdesc;
+        m_rx_cursor_base = base;
 
     next_buffer:
+        base += pi->len;
         pdesc = *(++iter);
     }
+    payload_len -= remain;
+    for (ptail = pres; ptail; ptail = ptail->next) {
+        ptail->tot_len = payload_len;
+        payload_len -= ptail->len;
+    }
 
     int ret = 0;
-    if (bufs_nr != decrypted_nr) {
+    if (m_rx_batch_state != TLS_RX_BATCH_NONE) {
+        /* The batch has decrypted the record in place. */
+        ret = (m_rx_batch_state == TLS_RX_BATCH_DONE) ? 0 : TLS_DECRYPT_BAD_MAC;
+        m_rx_batch_state = TLS_RX_BATCH_NONE;
+        for (pi = pres; ret == 0 && pi; pi = pi->next) {
+            ((mem_buf_desc_t *)pi)->rx.tls_decrypted = TLS_RX_DECRYPTED;
+        }
+        m_p_sock->m_p_socket_stats->tls_counters.n_tls_rx_records_enc += 1U;
+    } else if (bufs_nr != decrypted_nr) {
         /*
          * tls_decrypted holds value for the last buffer.
          *
@@ -1513,6 +2008,7 @@ check_single_record:
     }
     m_rx_offset += m_rx_rec_len;
     m_rx_rec_rcvd -= m_rx_rec_len;
+    m_rx_cursor_desc = nullptr;
 
     m_rx_sm = TLS_RX_SM_HEADER;
     if (pdesc && err == ERR_OK) {
@@ -47,7 +47,9 @@
 /* Forward declarations */
 class sockinfo_tcp;
 class xlio_tis;
+class tls_record;
 struct pbuf;
+struct aes_gcm_mb_key;
 
 class sockinfo_tcp_ops {
 public:
@@ -81,6 +83,14 @@ enum xlio_utls_mode {
 
 void xlio_tls_api_setup(void);
 
+/*
+ * Batching of software TLS RX records within a ring poll, see XLIO_UTLS_RX_BATCH.
+ * Both are called under the ring RX lock and tls_rx_batch_end() is called only if
+ * tls_rx_batch_begin() returns true.
+ */
+bool tls_rx_batch_begin(void);
+void tls_rx_batch_end(void);
+
 class sockinfo_tcp_ops_tls : public sockinfo_tcp_ops {
 public:
     sockinfo_tcp_ops_tls(sockinfo_tcp *sock);
@@ -94,18 +104,43 @@ public:
     void get_record_buf(mem_buf_desc_t *&buf, uint8_t *&data, bool is_zerocopy);
 
 private:
+    friend void tls_rx_batch_end(void);
+
     inline bool is_tx_tls13(void) { return m_tls_info_tx.tls_version == TLS_1_3_VERSION; }
     inline bool is_rx_tls13(void) { return m_tls_info_rx.tls_version == TLS_1_3_VERSION; }
 
+    /*
+     * Only AES-GCM in TLS1.2 carries an explicit nonce in the record. TLS1.3 and
+     * ChaCha20-Poly1305 derive the nonce from the static IV and record number.
+     */
+    static inline bool has_explicit_iv(const xlio_tls_info &info)
+    {
+#ifdef DEFINED_UTLS_CHACHA20
+        if (info.tls_cipher == TLS_CIPHER_CHACHA20_POLY1305) {
+            return false;
+        }
+#endif /* DEFINED_UTLS_CHACHA20 */
+        return info.tls_version == TLS_1_2_VERSION;
+    }
+    inline bool is_tx_explicit_iv(void) { return has_explicit_iv(m_tls_info_tx); }
+    inline bool is_rx_explicit_iv(void) { return has_explicit_iv(m_tls_info_rx); }
+
     int send_alert(uint8_t alert_type);
     void terminate_session_fatal(uint8_t alert_type);
 
     err_t tls_rx_consume_ready_packets(void);
     err_t recv(struct pbuf *p);
+    err_t tls_rx_process_records(void);
+    xlio_desc_list_t::iterator rx_buf_seek(uint32_t &offset);
     void copy_by_offset(uint8_t *dst, uint32_t offset, uint32_t len);
     uint16_t offset_to_host16(uint32_t offset);
+    void *tls_cipher_ctx_create(void *evp_cipher, const uint8_t *key, bool decrypt);
+    ssize_t tls_tx_read_file(tls_record *rec, int fd, __off64_t offset, size_t len);
+    ssize_t tls_tx_encrypt(tls_record *rec, const uint8_t *data, size_t len, uint8_t type);
+    uint32_t tls_rx_nonce_aad(uint8_t *nonce, uint8_t *aad);
     int tls_rx_decrypt(struct pbuf *plist);
     int tls_rx_encrypt(struct pbuf *plist);
+    bool tls_rx_batch_enqueue(void);
 
     uint64_t find_recno(uint32_t seqno);
 
@@ -122,6 +157,19 @@ private:
         TLS_RX_SM_FAIL,
     };
 
+    enum tls_rx_batch_state {
+        /* The first unhandled record isn't in a batch. */
+        TLS_RX_BATCH_NONE = 0,
+        /* The first unhandled record waits for the batch flush. */
+        TLS_RX_BATCH_PENDING,
+        /* The batch decrypted the record in place. */
+        TLS_RX_BATCH_DONE,
+        /* The batch failed to authenticate the record. */
+        TLS_RX_BATCH_FAIL,
+    };
+
+    void tls_rx_batch_complete(enum tls_rx_batch_state state);
+
     enum tls_decrypt_error {
         TLS_DECRYPT_OK = 0,
         TLS_DECRYPT_INTERNAL = -1,
@@ -158,6 +206,9 @@ private:
     /* Whether offload is configured. */
     bool m_is_tls_tx;
     bool m_is_tls_rx;
+    /* Whether the direction is served by the software record layer instead of the NIC. */
+    bool m_is_tls_tx_sw;
+    bool m_is_tls_rx_sw;
     /* TLS record overhead (header + trailer). Different across versions. */
     uint32_t m_tls_rec_overhead;
 
@@ -172,13 +223,23 @@ private:
     uint32_t m_expected_seqno;
     /* Track TX record number for TX resync flow. */
     uint64_t m_next_recno_tx;
+    /* OpenSSL encryption context for the software TX record layer. */
+    void *m_p_cipher_ctx_tx;
 
     /* RX specific fields */
     xlio_tir *m_p_tir;
 
-    /* OpenSSL objects for SW decryption. */
+    /*
+     * OpenSSL objects for SW decryption. Contexts are initialized with the key
+     * once, so per record only the IV is set and the key schedule is reused.
+     * The encryption context is created on the first resync re-encryption.
+     */
     void *m_p_evp_cipher;
     void *m_p_cipher_ctx;
+    void *m_p_cipher_ctx_enc;
+    /* Expanded RX key for the multi-buffer batch, NULL if batching is off. */
+    struct aes_gcm_mb_key *m_p_rx_batch_key;
+    enum tls_rx_batch_state m_rx_batch_state;
 
     /* List of RX buffers that contain unhandled records. */
     xlio_desc_list_t m_rx_bufs;
@@ -190,6 +251,12 @@ private:
     uint32_t m_rx_rec_len;
     /* Number of bytes received after m_rx_offset. */
     uint32_t m_rx_rec_rcvd;
+    /*
+     * Cursor into m_rx_bufs within the first unhandled record: a buffer and the offset
+     * of its first byte relative to the head buffer. Reset when the head changes.
+     */
+    mem_buf_desc_t *m_rx_cursor_desc;
+    uint32_t m_rx_cursor_base;
     /* State machine for TLS RX stream. */
     enum tls_rx_state m_rx_sm;
     /* Refused data by sockinfo_tcp::rx_lwip_cb() to be retried. */
@@ -0,0 +1,640 @@
+/*
+ * Copyright (c) 2001-2023 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ *
+ * This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING in the main directory of this source tree, or the
+ * BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <string.h>
+#include "aes_gcm_mb.h"
+
+#if defined(__x86_64__)
+
+#include <immintrin.h>
+
+/*
+ * The library isn't built with -maes/-mpclmul, so only these functions are compiled
+ * for the extensions. They're called only after aes_gcm_mb_supported() check.
+ */
+#define AES_GCM_MB_TARGET __attribute__((target("aes,pclmul,sse4.1,ssse3")))
+#define AES_GCM_MB_TARGET_VAES                                                                     \
+    __attribute__((target("aes,pclmul,sse4.1,ssse3,avx2,avx512f,avx512bw,vaes,vpclmulqdq")))
+
+struct gcm_lane {
+    struct aes_gcm_mb_job *job;
+    const __m128i *rk;
+    uint32_t rounds;
+    __m128i h[AES_GCM_MB_HASH_POWERS];
+    /* GHASH accumulator in the byte reflected form. */
+    __m128i x;
+    /* Counter block in the byte reflected form, so 32bit increment is a single add. */
+    __m128i ctr;
+    __m128i ek_j0;
+    /* Data cursor. */
+    uint32_t iov_idx;
+    uint32_t iov_off;
+    uint64_t data_len;
+    uint64_t remain;
+};
+
+AES_GCM_MB_TARGET static inline __m128i bswap_mask(void)
+{
+    return _mm_set_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+}
+
+AES_GCM_MB_TARGET static inline __m128i aes_128_assist(__m128i t1, __m128i t2)
+{
+    __m128i t3;
+
+    t2 = _mm_shuffle_epi32(t2, 0xff);
+    t3 = _mm_slli_si128(t1, 0x4);
+    t1 = _mm_xor_si128(t1, t3);
+    t3 = _mm_slli_si128(t3, 0x4);
+    t1 = _mm_xor_si128(t1, t3);
+    t3 = _mm_slli_si128(t3, 0x4);
+    t1 = _mm_xor_si128(t1, t3);
+    return _mm_xor_si128(t1, t2);
+}
+
+#define AES_128_EXPAND(__k, __rcon) aes_128_assist(__k, _mm_aeskeygenassist_si128(__k, __rcon))
+
+AES_GCM_MB_TARGET static void aes_128_expand(const uint8_t *raw_key, __m128i *rk)
+{
+    rk[0] = _mm_loadu_si128((const __m128i *)raw_key);
+    rk[1] = AES_128_EXPAND(rk[0], 0x01);
+    rk[2] = AES_128_EXPAND(rk[1], 0x02);
+    rk[3] = AES_128_EXPAND(rk[2], 0x04);
+    rk[4] = AES_128_EXPAND(rk[3], 0x08);
+    rk[5] = AES_128_EXPAND(rk[4], 0x10);
+    rk[6] = AES_128_EXPAND(rk[5], 0x20);
+    rk[7] = AES_128_EXPAND(rk[6], 0x40);
+    rk[8] = AES_128_EXPAND(rk[7], 0x80);
+    rk[9] = AES_128_EXPAND(rk[8], 0x1b);
+    rk[10] = AES_128_EXPAND(rk[9], 0x36);
+}
+
+AES_GCM_MB_TARGET static inline __m128i aes_256_assist_2(__m128i t1, __m128i t3)
+{
+    __m128i t2 = _mm_shuffle_epi32(_mm_aeskeygenassist_si128(t1, 0x0), 0xaa);
+    __m128i t4;
+
+    t4 = _mm_slli_si128(t3, 0x4);
+    t3 = _mm_xor_si128(t3, t4);
+    t4 = _mm_slli_si128(t4, 0x4);
+    t3 = _mm_xor_si128(t3, t4);
+    t4 = _mm_slli_si128(t4, 0x4);
+    t3 = _mm_xor_si128(t3, t4);
+    return _mm_xor_si128(t3, t2);
+}
+
+#define AES_256_EXPAND(__i, __rcon)                                                                \
+    do {                                                                                           \
+        rk[__i] = aes_128_assist(rk[__i - 2], _mm_aeskeygenassist_si128(rk[__i - 1], __rcon));     \
+        rk[__i + 1] = aes_256_assist_2(rk[__i], rk[__i - 1]);                                      \
+    } while (0)
+
+AES_GCM_MB_TARGET static void aes_256_expand(const uint8_t *raw_key, __m128i *rk)
+{
+    rk[0] = _mm_loadu_si128((const __m128i *)raw_key);
+    rk[1] = _mm_loadu_si128((const __m128i *)(raw_key + 16));
+    AES_256_EXPAND(2, 0x01);
+    AES_256_EXPAND(4, 0x02);
+    AES_256_EXPAND(6, 0x04);
+    AES_256_EXPAND(8, 0x08);
+    AES_256_EXPAND(10, 0x10);
+    AES_256_EXPAND(12, 0x20);
+    rk[14] = aes_128_assist(rk[12], _mm_aeskeygenassist_si128(rk[13], 0x40));
+}
+
+AES_GCM_MB_TARGET static inline __m128i aes_encrypt_block(const __m128i *rk, uint32_t rounds,
+                                                          __m128i blk)
+{
+    blk = _mm_xor_si128(blk, rk[0]);
+    for (uint32_t r = 1; r < rounds; ++r) {
+        blk = _mm_aesenc_si128(blk, rk[r]);
+    }
+    return _mm_aesenclast_si128(blk, rk[rounds]);
+}
+
+/*
+ * GF(2^128) multiplication of byte reflected operands, see Intel CLMUL white paper.
+ * Products are accumulated unreduced, so several blocks share a single reduction.
+ */
+AES_GCM_MB_TARGET static inline void clmul_acc(__m128i a, __m128i b, __m128i *lo, __m128i *mid,
+                                               __m128i *hi)
+{
+    *lo = _mm_xor_si128(*lo, _mm_clmulepi64_si128(a, b, 0x00));
+    *hi = _mm_xor_si128(*hi, _mm_clmulepi64_si128(a, b, 0x11));
+    *mid = _mm_xor_si128(*mid, _mm_clmulepi64_si128(a, b, 0x10));
+    *mid = _mm_xor_si128(*mid, _mm_clmulepi64_si128(a, b, 0x01));
+}
+
+AES_GCM_MB_TARGET static inline __m128i gf_reduce(__m128i lo, __m128i mid, __m128i hi)
+{
+    __m128i t2, t3, t4, t5, t6, t7, t8, t9;
+
+    t3 = _mm_xor_si128(lo, _mm_slli_si128(mid, 8));
+    t6 = _mm_xor_si128(hi, _mm_srli_si128(mid, 8));
+
+    /* Shift the 256bit product left by 1 bit. */
+    t7 = _mm_srli_epi32(t3, 31);
+    t8 = _mm_srli_epi32(t6, 31);
+    t3 = _mm_slli_epi32(t3, 1);
+    t6 = _mm_slli_epi32(t6, 1);
+    t9 = _mm_srli_si128(t7, 12);
+    t8 = _mm_slli_si128(t8, 4);
+    t7 = _mm_slli_si128(t7, 4);
+    t3 = _mm_or_si128(t3, t7);
+    t6 = _mm_or_si128(t6, t8);
+    t6 = _mm_or_si128(t6, t9);
+
+    /* Reduction modulo x^128 + x^7 + x^2 + x + 1. */
+    t7 = _mm_slli_epi32(t3, 31);
+    t8 = _mm_slli_epi32(t3, 30);
+    t9 = _mm_slli_epi32(t3, 25);
+    t7 = _mm_xor_si128(t7, t8);
+    t7 = _mm_xor_si128(t7, t9);
+    t8 = _mm_srli_si128(t7, 4);
+    t7 = _mm_slli_si128(t7, 12);
+    t3 = _mm_xor_si128(t3, t7);
+    t2 = _mm_srli_epi32(t3, 1);
+    t4 = _mm_srli_epi32(t3, 2);
+    t5 = _mm_srli_epi32(t3, 7);
+    t2 = _mm_xor_si128(t2, t4);
+    t2 = _mm_xor_si128(t2, t5);
+    t2 = _mm_xor_si128(t2, t8);
+    t3 = _mm_xor_si128(t3, t2);
+    return _mm_xor_si128(t6, t3);
+}
+
+AES_GCM_MB_TARGET static inline __m128i gfmul(__m128i a, __m128i b)
+{
+    __m128i lo = _mm_setzero_si128();
+    __m128i mid = _mm_setzero_si128();
+    __m128i hi = _mm_setzero_si128();
+
+    clmul_acc(a, b, &lo, &mid, &hi);
+    return gf_reduce(lo, mid, hi);
+}
+
+AES_GCM_MB_TARGET static inline void ghash_block(struct gcm_lane *lane, __m128i blk)
+{
+    lane->x = gfmul(_mm_xor_si128(lane->x, _mm_shuffle_epi8(blk, bswap_mask())), lane->h[0]);
+}
+
+/* X = (X + C0) * H^4 + C1 * H^3 + C2 * H^2 + C3 * H */
+AES_GCM_MB_TARGET static inline void ghash_stride(struct gcm_lane *lane, const __m128i *blk)
+{
+    const __m128i mask = bswap_mask();
+    __m128i lo = _mm_setzero_si128();
+    __m128i mid = _mm_setzero_si128();
+    __m128i hi = _mm_setzero_si128();
+
+    clmul_acc(_mm_xor_si128(lane->x, _mm_shuffle_epi8(blk[0], mask)), lane->h[3], &lo, &mid, &hi);
+    clmul_acc(_mm_shuffle_epi8(blk[1], mask), lane->h[2], &lo, &mid, &hi);
+    clmul_acc(_mm_shuffle_epi8(blk[2], mask), lane->h[1], &lo, &mid, &hi);
+    clmul_acc(_mm_shuffle_epi8(blk[3], mask), lane->h[0], &lo, &mid, &hi);
+    lane->x = gf_reduce(lo, mid, hi);
+}
+
+/* Copies n bytes between the data at the lane cursor and buf without moving the cursor. */
+static void lane_copy(struct gcm_lane *lane, uint8_t *buf, uint32_t n, bool to_iov)
+{
+    const struct iovec *iov = lane->job->iov;
+    uint32_t idx = lane->iov_idx;
+    uint32_t off = lane->iov_off;
+
+    while (n > 0 && idx < lane->job->iov_nr) {
+        uint32_t len = (uint32_t)iov[idx].iov_len - off;
+
+        len = len < n ? len : n;
+        if (to_iov) {
+            memcpy((uint8_t *)iov[idx].iov_base + off, buf, len);
+        } else {
+            memcpy(buf, (uint8_t *)iov[idx].iov_base + off, len);
+        }
+        buf += len;
+        n -= len;
+        off = 0;
+        ++idx;
+    }
+}
+
+static void lane_advance(struct gcm_lane *lane, uint32_t n)
+{
+    const struct iovec *iov = lane->job->iov;
+
+    lane->remain -= n;
+    while (lane->iov_idx < lane->job->iov_nr) {
+        uint32_t len = (uint32_t)iov[lane->iov_idx].iov_len - lane->iov_off;
+
+        if (n < len) {
+            lane->iov_off += n;
+            break;
+        }
+        n -= len;
+        lane->iov_off = 0;
+        ++lane->iov_idx;
+    }
+}
+
+AES_GCM_MB_TARGET static void lane_init(struct gcm_lane *lane, struct aes_gcm_mb_job *job)
+{
+    uint8_t blk[16] __attribute__((aligned(16)));
+    __m128i j0;
+
+    lane->job = job;
+    lane->rk = (const __m128i *)job->key->round_keys;
+    lane->rounds = job->key->rounds;
+    for (uint32_t i = 0; i < AES_GCM_MB_HASH_POWERS; ++i) {
+        lane->h[i] = _mm_load_si128((const __m128i *)job->key->hash_key[i]);
+    }
+    lane->x = _mm_setzero_si128();
+    lane->iov_idx = 0;
+    lane->iov_off = 0;
+    lane->data_len = 0;
+    for (uint32_t i = 0; i < job->iov_nr; ++i) {
+        lane->data_len += job->iov[i].iov_len;
+    }
+    lane->remain = lane->data_len;
+
+    /* J0 = IV || 0^31 || 1 */
+    memcpy(blk, job->iv, AES_GCM_MB_IV_LEN);
+    blk[12] = blk[13] = blk[14] = 0;
+    blk[15] = 1;
+    j0 = _mm_load_si128((const __m128i *)blk);
+    lane->ek_j0 = aes_encrypt_block(lane->rk, lane->rounds, j0);
+    lane->ctr = _mm_add_epi32(_mm_shuffle_epi8(j0, bswap_mask()), _mm_set_epi32(0, 0, 0, 1));
+
+    for (uint32_t off = 0; off < job->aad_len; off += 16) {
+        uint32_t n = job->aad_len - off < 16 ? job->aad_len - off : 16;
+
+        memset(blk, 0, sizeof(blk));
+        memcpy(blk, job->aad + off, n);
+        ghash_block(lane, _mm_load_si128((const __m128i *)blk));
+    }
+}
+
+AES_GCM_MB_TARGET static void lane_finish(struct gcm_lane *lane, bool decrypt)
+{
+    uint8_t tag[AES_GCM_MB_TAG_LEN] __attribute__((aligned(16)));
+    __m128i len_blk = _mm_set_epi64x((long long)(lane->job->aad_len * 8ULL),
+                                     (long long)(lane->data_len * 8ULL));
+    uint8_t diff = 0;
+
+    /* The lengths block is built in the reflected form already. */
+    lane->x = gfmul(_mm_xor_si128(lane->x, len_blk), lane->h[0]);
+    _mm_store_si128((__m128i *)tag,
+                    _mm_xor_si128(_mm_shuffle_epi8(lane->x, bswap_mask()), lane->ek_j0));
+    if (decrypt) {
+        for (uint32_t i = 0; i < AES_GCM_MB_TAG_LEN; ++i) {
+            diff |= tag[i] ^ lane->job->tag[i];
+        }
+        lane->job->auth_ok = (diff == 0);
+    } else {
+        memcpy(lane->job->tag, tag, AES_GCM_MB_TAG_LEN);
+        lane->job->auth_ok = true;
+    }
+}
+
+/*
+ * Zero masking forms of the intrinsics are used as the plain ones pass _mm512_undefined_*()
+ * which trips -Wmaybe-uninitialized with some GCC versions.
+ */
+AES_GCM_MB_TARGET_VAES static inline __m512i broadcast_128(__m128i v)
+{
+    return _mm512_maskz_broadcast_i32x4((__mmask16)-1, v);
+}
+
+/* XOR of the four 128bit parts. */
+AES_GCM_MB_TARGET_VAES static inline __m128i fold_512(__m512i z)
+{
+    z = _mm512_xor_si512(z, _mm512_maskz_shuffle_i32x4((__mmask16)-1, z, z, 0x4e));
+    z = _mm512_xor_si512(z, _mm512_maskz_shuffle_i32x4((__mmask16)-1, z, z, 0xb1));
+    return _mm512_maskz_extracti32x4_epi32((__mmask8)-1, z, 0);
+}
+
+/*
+ * Bulk phase on VAES/AVX-512 capable CPUs: every ZMM register holds 4 consecutive blocks of
+ * a lane and the lanes are interleaved the same way as in the generic loop. Lanes leave the
+ * phase once less than 64 contiguous bytes remain, the rest is done by the generic loop.
+ */
+AES_GCM_MB_TARGET_VAES static void gcm_mb_bulk_vaes(struct gcm_lane **lanes, uint32_t nr,
+                                                    bool decrypt)
+{
+    struct gcm_lane *active[AES_GCM_MB_LANES_MAX];
+    uint8_t *data[AES_GCM_MB_LANES_MAX];
+    __m512i in[AES_GCM_MB_LANES_MAX];
+    __m512i blk[AES_GCM_MB_LANES_MAX];
+    __m512i hpow[AES_GCM_MB_LANES_MAX];
+    __m512i hsel[AES_GCM_MB_LANES_MAX];
+    const __m512i mask = broadcast_128(bswap_mask());
+    const __m512i ctr_inc = _mm512_set_epi32(0, 0, 0, 3, 0, 0, 0, 2, 0, 0, 0, 1, 0, 0, 0, 0);
+    const __m128i four = _mm_set_epi32(0, 0, 0, 4);
+    const uint32_t stride = AES_GCM_MB_HASH_POWERS * 16;
+    uint32_t max_rounds = 0;
+
+    for (uint32_t i = 0; i < nr; ++i) {
+        /* The first block is multiplied by H^4 and the last one by H. */
+        hpow[i] = _mm512_zextsi128_si512(lanes[i]->h[3]);
+        hpow[i] = _mm512_inserti32x4(hpow[i], lanes[i]->h[2], 1);
+        hpow[i] = _mm512_inserti32x4(hpow[i], lanes[i]->h[1], 2);
+        hpow[i] = _mm512_inserti32x4(hpow[i], lanes[i]->h[0], 3);
+        max_rounds = lanes[i]->rounds > max_rounds ? lanes[i]->rounds : max_rounds;
+    }
+
+    while (true) {
+        uint32_t active_nr = 0;
+
+        for (uint32_t i = 0; i < nr; ++i) {
+            struct gcm_lane *lane = lanes[i];
+            const struct iovec *iov = &lane->job->iov[lane->iov_idx];
+            __m512i ctr;
+
+            if (lane->remain < stride || iov->iov_len - lane->iov_off < stride) {
+                continue;
+            }
+            data[active_nr] = (uint8_t *)iov->iov_base + lane->iov_off;
+            in[active_nr] = _mm512_loadu_si512(data[active_nr]);
+            ctr = _mm512_add_epi32(broadcast_128(lane->ctr), ctr_inc);
+            blk[active_nr] = _mm512_xor_si512(_mm512_shuffle_epi8(ctr, mask),
+                                              broadcast_128(lane->rk[0]));
+            lane->ctr = _mm_add_epi32(lane->ctr, four);
+            hsel[active_nr] = hpow[i];
+            active[active_nr++] = lane;
+        }
+        if (active_nr == 0) {
+            break;
+        }
+
+        for (uint32_t r = 1; r <= max_rounds; ++r) {
+            for (uint32_t i = 0; i < active_nr; ++i) {
+                const uint32_t rounds = active[i]->rounds;
+                const __m512i rk = broadcast_128(active[i]->rk[r <= rounds ? r : 0]);
+
+                if (r < rounds) {
+                    blk[i] = _mm512_aesenc_epi128(blk[i], rk);
+                } else if (r == rounds) {
+                    blk[i] = _mm512_aesenclast_epi128(blk[i], rk);
+                }
+            }
+        }
+
+        for (uint32_t i = 0; i < active_nr; ++i) {
+            struct gcm_lane *lane = active[i];
+            __m512i c, lo, mid, hi;
+            __m128i lo_x, mid_x, hi_x;
+
+            blk[i] = _mm512_xor_si512(in[i], blk[i]);
+            _mm512_storeu_si512(data[i], blk[i]);
+
+            c = _mm512_shuffle_epi8(decrypt ? in[i] : blk[i], mask);
+            c = _mm512_xor_si512(c, _mm512_zextsi128_si512(lane->x));
+            lo = _mm512_clmulepi64_epi128(c, hsel[i], 0x00);
+            hi = _mm512_clmulepi64_epi128(c, hsel[i], 0x11);
+            mid = _mm512_xor_si512(_mm512_clmulepi64_epi128(c, hsel[i], 0x10),
+                                   _mm512_clmulepi64_epi128(c, hsel[i], 0x01));
+            lo_x = fold_512(lo);
+            mid_x = fold_512(mid);
+            hi_x = fold_512(hi);
+            lane->x = gf_reduce(lo_x, mid_x, hi_x);
+            lane_advance(lane, stride);
+        }
+    }
+}
+
+static bool s_vaes_enabled = true;
+
+static bool aes_gcm_mb_vaes_supported(void)
+{
+    static int s_supported = -1;
+
+    if (s_supported < 0) {
+        __builtin_cpu_init();
+        s_supported = __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw") &&
+            __builtin_cpu_supports("vaes") && __builtin_cpu_supports("vpclmulqdq");
+    }
+    return s_supported > 0 && s_vaes_enabled;
+}
+
+void aes_gcm_mb_vaes_enable(bool enable)
+{
+    s_vaes_enabled = enable;
+}
+
+AES_GCM_MB_TARGET static void gcm_mb_process(struct aes_gcm_mb_job *jobs, uint32_t nr,
+                                             bool decrypt)
+{
+    struct gcm_lane lanes[AES_GCM_MB_LANES_MAX];
+    struct gcm_lane *active[AES_GCM_MB_LANES_MAX];
+    uint8_t tmp[AES_GCM_MB_LANES_MAX][16] __attribute__((aligned(16)));
+    uint8_t *direct[AES_GCM_MB_LANES_MAX];
+    uint32_t n[AES_GCM_MB_LANES_MAX];
+    uint32_t nb[AES_GCM_MB_LANES_MAX];
+    __m128i in[AES_GCM_MB_LANES_MAX][AES_GCM_MB_HASH_POWERS];
+    __m128i blk[AES_GCM_MB_LANES_MAX][AES_GCM_MB_HASH_POWERS];
+    const __m128i one = _mm_set_epi32(0, 0, 0, 1);
+    const __m128i mask = bswap_mask();
+    const uint32_t stride = AES_GCM_MB_HASH_POWERS * 16;
+    uint32_t active_nr = 0;
+    uint32_t max_rounds = 0;
+
+    for (uint32_t i = 0; i < nr; ++i) {
+        lane_init(&lanes[i], &jobs[i]);
+        active[active_nr++] = &lanes[i];
+        max_rounds = lanes[i].rounds > max_rounds ? lanes[i].rounds : max_rounds;
+    }
+
+    if (aes_gcm_mb_vaes_supported()) {
+        gcm_mb_bulk_vaes(active, active_nr, decrypt);
+    }
+
+    while (true) {
+        /* Retire completed lanes. */
+        for (uint32_t i = 0; i < active_nr;) {
+            if (active[i]->remain == 0) {
+                lane_finish(active[i], decrypt);
+                active[i] = active[--active_nr];
+            } else {
+                ++i;
+            }
+        }
+        if (active_nr == 0) {
+            break;
+        }
+
+        /* Load the next blocks of every lane and start the counter encryption. */
+        for (uint32_t i = 0; i < active_nr; ++i) {
+            struct gcm_lane *lane = active[i];
+            const struct iovec *iov = &lane->job->iov[lane->iov_idx];
+            uint64_t contig = iov->iov_len - lane->iov_off;
+
+            contig = contig < lane->remain ? contig : lane->remain;
+            if (contig >= 16) {
+                direct[i] = (uint8_t *)iov->iov_base + lane->iov_off;
+                nb[i] = contig >= stride ? AES_GCM_MB_HASH_POWERS : 1;
+                n[i] = nb[i] * 16;
+                for (uint32_t b = 0; b < nb[i]; ++b) {
+                    in[i][b] = _mm_loadu_si128((const __m128i *)(direct[i] + b * 16));
+                }
+            } else {
+                /* The block is partial or crosses a buffer boundary. */
+                direct[i] = nullptr;
+                nb[i] = 1;
+                n[i] = lane->remain < 16 ? (uint32_t)lane->remain : 16;
+                memset(tmp[i], 0, sizeof(tmp[i]));
+                lane_copy(lane, tmp[i], n[i], false);
+                in[i][0] = _mm_load_si128((const __m128i *)tmp[i]);
+            }
+            for (uint32_t b = 0; b < nb[i]; ++b) {
+                blk[i][b] = _mm_xor_si128(_mm_shuffle_epi8(lane->ctr, mask), lane->rk[0]);
+                lane->ctr = _mm_add_epi32(lane->ctr, one);
+            }
+        }
+
+        /* AES rounds are interleaved across the lanes to hide AESENC latency. */
+        for (uint32_t r = 1; r <= max_rounds; ++r) {
+            for (uint32_t i = 0; i < active_nr; ++i) {
+                const uint32_t rounds = active[i]->rounds;
+
+                if (r < rounds) {
+                    for (uint32_t b = 0; b < nb[i]; ++b) {
+                        blk[i][b] = _mm_aesenc_si128(blk[i][b], active[i]->rk[r]);
+                    }
+                } else if (r == rounds) {
+                    for (uint32_t b = 0; b < nb[i]; ++b) {
+                        blk[i][b] = _mm_aesenclast_si128(blk[i][b], active[i]->rk[r]);
+                    }
+                }
+            }
+        }
+
+        for (uint32_t i = 0; i < active_nr; ++i) {
+            struct gcm_lane *lane = active[i];
+
+            for (uint32_t b = 0; b < nb[i]; ++b) {
+                blk[i][b] = _mm_xor_si128(in[i][b], blk[i][b]);
+            }
+            if (direct[i]) {
+                for (uint32_t b = 0; b < nb[i]; ++b) {
+                    _mm_storeu_si128((__m128i *)(direct[i] + b * 16), blk[i][b]);
+                }
+            } else {
+                _mm_store_si128((__m128i *)tmp[i], blk[i][0]);
+                lane_copy(lane, tmp[i], n[i], true);
+                memset(tmp[i] + n[i], 0, 16 - n[i]);
+                blk[i][0] = _mm_load_si128((const __m128i *)tmp[i]);
+            }
+            /* GHASH is computed over the ciphertext, partial block is zero padded. */
+            if (nb[i] == AES_GCM_MB_HASH_POWERS) {
+                ghash_stride(lane, decrypt ? in[i] : blk[i]);
+            } else {
+                ghash_block(lane, decrypt ? in[i][0] : blk[i][0]);
+            }
+            lane_advance(lane, n[i]);
+        }
+    }
+}
+
+bool aes_gcm_mb_supported(void)
+{
+    static int s_supported = -1;
+
+    if (s_supported < 0) {
+        __builtin_cpu_init();
+        s_supported = __builtin_cpu_supports("aes") && __builtin_cpu_supports("pclmul") &&
+            __builtin_cpu_supports("sse4.1");
+    }
+    return s_supported > 0;
+}
+
+AES_GCM_MB_TARGET static void gcm_key_init(struct aes_gcm_mb_key *key, const uint8_t *raw_key,
+                                           uint32_t key_len)
+{
+    __m128i *rk = (__m128i *)key->round_keys;
+    __m128i h, hn;
+
+    if (key_len == 16) {
+        aes_128_expand(raw_key, rk);
+        key->rounds = 10;
+    } else {
+        aes_256_expand(raw_key, rk);
+        key->rounds = 14;
+    }
+    h = _mm_shuffle_epi8(aes_encrypt_block(rk, key->rounds, _mm_setzero_si128()), bswap_mask());
+    hn = h;
+    for (uint32_t i = 0; i < AES_GCM_MB_HASH_POWERS; ++i) {
+        _mm_store_si128((__m128i *)key->hash_key[i], hn);
+        hn = gfmul(hn, h);
+    }
+}
+
+bool aes_gcm_mb_key_init(struct aes_gcm_mb_key *key, const uint8_t *raw_key, uint32_t key_len)
+{
+    if ((key_len != 16 && key_len != 32) || !aes_gcm_mb_supported()) {
+        return false;
+    }
+    gcm_key_init(key, raw_key, key_len);
+    return true;
+}
+
+void aes_gcm_mb_process(struct aes_gcm_mb_job *jobs, uint32_t nr, bool decrypt)
+{
+    nr = nr < AES_GCM_MB_LANES_MAX ? nr : AES_GCM_MB_LANES_MAX;
+    gcm_mb_process(jobs, nr, decrypt);
+}
+
+#else /* __x86_64__ */
+
+bool aes_gcm_mb_supported(void)
+{
+    return false;
+}
+
+bool aes_gcm_mb_key_init(struct aes_gcm_mb_key *key, const uint8_t *raw_key, uint32_t key_len)
+{
+    (void)key;
+    (void)raw_key;
+    (void)key_len;
+    return false;
+}
+
+void aes_gcm_mb_process(struct aes_gcm_mb_job *jobs, uint32_t nr, bool decrypt)
+{
+    for (uint32_t i = 0; i < nr; ++i) {
+        jobs[i].auth_ok = false;
+    }
+    (void)decrypt;
+}
+
+void aes_gcm_mb_vaes_enable(bool enable)
+{
+    (void)enable;
+}
+
+#endif /* __x86_64__ */
@@ -0,0 +1,86 @@
+/*
+ * Copyright (c) 2001-2023 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ *
+ * This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING in the main directory of this source tree, or the
+ * BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef AES_GCM_MB_H
+#define AES_GCM_MB_H
+
+#include <stdint.h>
+#include <sys/uio.h>
+
+/**
+ * Multi-buffer AES-GCM.
+ *
+ * Processes up to AES_GCM_MB_LANES_MAX independent AES-GCM operations at once. Every job
+ * has its own key, nonce and scattered data. One block of every job is processed per step,
+ * so AES rounds and GHASH multiplications of different jobs are interleaved and hide the
+ * instruction latency which dominates single small records. Data is processed in place.
+ *
+ * The engine requires AES-NI and PCLMULQDQ, see aes_gcm_mb_supported(). It is used as a
+ * batching backend for small TLS records, large records are faster with OpenSSL.
+ */
+
+#define AES_GCM_MB_LANES_MAX 8U
+#define AES_GCM_MB_IV_LEN    12U
+#define AES_GCM_MB_TAG_LEN   16U
+/* Blocks of a lane processed per step with a single GHASH reduction. */
+#define AES_GCM_MB_HASH_POWERS 4U
+
+struct aes_gcm_mb_key {
+    uint8_t round_keys[15][16] __attribute__((aligned(16)));
+    /* GHASH key powers H^1..H^4 in the byte reflected form. */
+    uint8_t hash_key[AES_GCM_MB_HASH_POWERS][16] __attribute__((aligned(16)));
+    uint32_t rounds;
+};
+
+struct aes_gcm_mb_job {
+    const struct aes_gcm_mb_key *key;
+    const uint8_t *iv;
+    const uint8_t *aad;
+    uint32_t aad_len;
+    /* Data to encrypt or decrypt in place. */
+    const struct iovec *iov;
+    uint32_t iov_nr;
+    /* Expected tag for decryption or output tag for encryption. */
+    uint8_t *tag;
+    /* Output: false if authentication of a decrypted job fails. */
+    bool auth_ok;
+};
+
+bool aes_gcm_mb_supported(void);
+/* Expands a 16 or 32 bytes key. Returns false for unsupported key length or CPU. */
+bool aes_gcm_mb_key_init(struct aes_gcm_mb_key *key, const uint8_t *raw_key, uint32_t key_len);
+/* Processes up to AES_GCM_MB_LANES_MAX jobs. */
+void aes_gcm_mb_process(struct aes_gcm_mb_job *jobs, uint32_t nr, bool decrypt);
+/* Allows the VAES bulk phase if the CPU supports it (default). Lets tests cover both paths. */
+void aes_gcm_mb_vaes_enable(bool enable);
+
+#endif /* AES_GCM_MB_H */
@@ -0,0 +1,260 @@
+/*
+ * Copyright (c) 2001-2023 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ *
+ * This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING in the main directory of this source tree, or the
+ * BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <string.h>
+#include "crc32c.h"
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#elif defined(__aarch64__)
+#include <arm_acle.h>
+#include <sys/auxv.h>
+#include <asm/hwcap.h>
+#endif
+
+/* Reflected CRC32C polynomial. */
+#define CRC32C_POLY 0x82f63b78U
+
+/*
+ * Stream lengths of the interleaved loops. CRC32 instruction has latency 3 and throughput 1,
+ * so three independent streams keep the unit busy. The streams are merged with a carry-less
+ * multiplication by x^(8 * stream length).
+ */
+#define CRC32C_LONG  2048U
+#define CRC32C_SHORT 256U
+
+typedef uint32_t (*crc32c_func_t)(uint32_t crc, const void *buf, size_t len);
+
+static uint32_t s_crc32c_table[8][256];
+
+static void crc32c_table_init(void)
+{
+    for (uint32_t n = 0; n < 256; ++n) {
+        uint32_t crc = n;
+
+        for (int k = 0; k < 8; ++k) {
+            crc = (crc & 1) ? (crc >> 1) ^ CRC32C_POLY : crc >> 1;
+        }
+        s_crc32c_table[0][n] = crc;
+    }
+    for (uint32_t n = 0; n < 256; ++n) {
+        for (int k = 1; k < 8; ++k) {
+            uint32_t prev = s_crc32c_table[k - 1][n];
+            s_crc32c_table[k][n] = (prev >> 8) ^ s_crc32c_table[0][prev & 0xff];
+        }
+    }
+}
+
+static uint32_t crc32c_sw(uint32_t crc, const void *buf, size_t len)
+{
+    const uint8_t *p = (const uint8_t *)buf;
+
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    while (len && ((uintptr_t)p & 7)) {
+        crc = s_crc32c_table[0][(crc ^ *p++) & 0xff] ^ (crc >> 8);
+        --len;
+    }
+    /* Slicing-by-8. */
+    while (len >= 8) {
+        uint64_t v = *(const uint64_t *)p ^ crc;
+
+        crc = s_crc32c_table[7][v & 0xff] ^ s_crc32c_table[6][(v >> 8) & 0xff] ^
+            s_crc32c_table[5][(v >> 16) & 0xff] ^ s_crc32c_table[4][(v >> 24) & 0xff] ^
+            s_crc32c_table[3][(v >> 32) & 0xff] ^ s_crc32c_table[2][(v >> 40) & 0xff] ^
+            s_crc32c_table[1][(v >> 48) & 0xff] ^ s_crc32c_table[0][v >> 56];
+        p += 8;
+        len -= 8;
+    }
+#endif
+    while (len--) {
+        crc = s_crc32c_table[0][(crc ^ *p++) & 0xff] ^ (crc >> 8);
+    }
+    return crc;
+}
+
+#if defined(__x86_64__)
+
+/*
+ * The library isn't built with -msse4.2/-mpclmul, so only these functions are compiled
+ * for the extensions. They're selected only after the CPU check.
+ */
+#define CRC32C_TARGET __attribute__((target("sse4.2,pclmul")))
+
+static uint32_t s_crc32c_long_shift;
+static uint32_t s_crc32c_short_shift;
+
+/* Multiplies two polynomials modulo P, x^0 is the most significant bit. */
+static uint32_t crc32c_multmodp(uint32_t a, uint32_t b)
+{
+    uint32_t m = 1U << 31;
+    uint32_t p = 0;
+
+    for (;;) {
+        if (a & m) {
+            p ^= b;
+            if ((a & (m - 1)) == 0) {
+                break;
+            }
+        }
+        m >>= 1;
+        b = (b & 1) ? (b >> 1) ^ CRC32C_POLY : b >> 1;
+    }
+    return p;
+}
+
+/* Returns x^(8 * len) modulo P, i.e. the operator which appends len zero bytes. */
+static uint32_t crc32c_xpow8n(size_t len)
+{
+    uint32_t res = 1U << 31;
+    uint32_t sq = 1U << (31 - 8);
+
+    while (len) {
+        if (len & 1) {
+            res = crc32c_multmodp(res, sq);
+        }
+        sq = crc32c_multmodp(sq, sq);
+        len >>= 1;
+    }
+    return res;
+}
+
+/* Returns crc * k modulo P, where k is one of the x^(8 * len) constants. */
+CRC32C_TARGET static inline uint32_t crc32c_shift(uint32_t crc, uint32_t k)
+{
+    __m128i prod =
+        _mm_clmulepi64_si128(_mm_cvtsi32_si128((int)crc), _mm_cvtsi32_si128((int)k), 0x00);
+    /* The 63 bits product is aligned to 64 bits, the CRC32 instruction reduces the low half. */
+    uint64_t v = (uint64_t)_mm_cvtsi128_si64(prod) << 1;
+
+    return _mm_crc32_u32(0, (uint32_t)v) ^ (uint32_t)(v >> 32);
+}
+
+CRC32C_TARGET static inline uint32_t crc32c_3way(uint32_t crc, const uint8_t **pp, size_t *plen,
+                                                 size_t stream, uint32_t k)
+{
+    const uint8_t *p = *pp;
+    size_t len = *plen;
+
+    while (len >= 3 * stream) {
+        const uint8_t *end = p + stream;
+        uint64_t c0 = crc;
+        uint64_t c1 = 0;
+        uint64_t c2 = 0;
+
+        do {
+            c0 = _mm_crc32_u64(c0, *(const uint64_t *)p);
+            c1 = _mm_crc32_u64(c1, *(const uint64_t *)(p + stream));
+            c2 = _mm_crc32_u64(c2, *(const uint64_t *)(p + 2 * stream));
+            p += 8;
+        } while (p < end);
+
+        crc = crc32c_shift((uint32_t)c0, k) ^ (uint32_t)c1;
+        crc = crc32c_shift(crc, k) ^ (uint32_t)c2;
+        p += 2 * stream;
+        len -= 3 * stream;
+    }
+    *pp = p;
+    *plen = len;
+    return crc;
+}
+
+CRC32C_TARGET static uint32_t crc32c_sse42(uint32_t crc, const void *buf, size_t len)
+{
+    const uint8_t *p = (const uint8_t *)buf;
+
+    while (len && ((uintptr_t)p & 7)) {
+        crc = _mm_crc32_u8(crc, *p++);
+        --len;
+    }
+    crc = crc32c_3way(crc, &p, &len, CRC32C_LONG, s_crc32c_long_shift);
+    crc = crc32c_3way(crc, &p, &len, CRC32C_SHORT, s_crc32c_short_shift);
+    while (len >= 8) {
+        crc = (uint32_t)_mm_crc32_u64(crc, *(const uint64_t *)p);
+        p += 8;
+        len -= 8;
+    }
+    while (len--) {
+        crc = _mm_crc32_u8(crc, *p++);
+    }
+    return crc;
+}
+
+#elif defined(__aarch64__)
+
+#define CRC32C_TARGET __attribute__((target("+crc")))
+
+CRC32C_TARGET static uint32_t crc32c_armv8(uint32_t crc, const void *buf, size_t len)
+{
+    const uint8_t *p = (const uint8_t *)buf;
+
+    while (len && ((uintptr_t)p & 7)) {
+        crc = __crc32cb(crc, *p++);
+        --len;
+    }
+    while (len >= 8) {
+        crc = __crc32cd(crc, *(const uint64_t *)p);
+        p += 8;
+        len -= 8;
+    }
+    while (len--) {
+        crc = __crc32cb(crc, *p++);
+    }
+    return crc;
+}
+
+#endif
+
+static crc32c_func_t crc32c_select(void)
+{
+#if defined(__x86_64__)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("sse4.2") && __builtin_cpu_supports("pclmul")) {
+        s_crc32c_long_shift = crc32c_xpow8n(CRC32C_LONG);
+        s_crc32c_short_shift = crc32c_xpow8n(CRC32C_SHORT);
+        return crc32c_sse42;
+    }
+#elif defined(__aarch64__)
+    if (getauxval(AT_HWCAP) & HWCAP_CRC32) {
+        return crc32c_armv8;
+    }
+#endif
+    crc32c_table_init();
+    return crc32c_sw;
+}
+
+/* Resolved once when the library is loaded. */
+static const crc32c_func_t s_crc32c_impl = crc32c_select();
+
+uint32_t crc32c_update(uint32_t crc, const void *buf, size_t len)
+{
+    return s_crc32c_impl(crc, buf, len);
+}
@@ -30,26 +30,26 @@
  * SOFTWARE.
  */
 
-#ifndef WAKEUP_PIPE_H
-#define WAKEUP_PIPE_H
+#ifndef CRC32C_H
+#define CRC32C_H
+
+#include <stddef.h>
+#include <stdint.h>
 
 /**
- * wakeup class that adds a wakeup functionality to socket (tcp and udp) and epoll using a pipe.
+ * CRC32C (Castagnoli), used by the NVMe/TCP header and data digests.
+ *
+ * The implementation is selected at runtime: SSE4.2 CRC32 instruction over three
+ * interleaved streams which are folded with PCLMULQDQ on x86_64, ARMv8 CRC32
+ * instructions on aarch64 and slicing-by-8 tables otherwise.
  */
-#include "wakeup.h"
-#include "utils/atomic.h"
 
-class wakeup_pipe : public wakeup {
-public:
-    wakeup_pipe(void);
-    ~wakeup_pipe();
-    virtual void do_wakeup();
-    virtual inline bool is_wakeup_fd(int fd) { return fd == g_wakeup_pipes[0]; };
-    virtual void remove_wakeup_fd();
+/* Raw update without pre and post inversion, so scattered data can be chained. */
+uint32_t crc32c_update(uint32_t crc, const void *buf, size_t len);
 
-private:
-    static int g_wakeup_pipes[2];
-    static atomic_t ref_count;
-};
+static inline uint32_t crc32c(const void *buf, size_t len)
+{
+    return ~crc32c_update(~0U, buf, len);
+}
 
-#endif /* WAKEUP_PIPE_H */
+#endif /* CRC32C_H */
@@ -0,0 +1,375 @@
+/*
+ * Copyright (c) 2001-2023 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ *
+ * This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING in the main directory of this source tree, or the
+ * BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <string.h>
+#include "csum.h"
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+/*
+ * The kernels accumulate 32-bit words into 64-bit lanes, so the carries are kept in the
+ * upper half and no lane can overflow. Since 2^16 == 1 modulo 0xffff, the sum of 32-bit
+ * words folds to the same value as the sum of 16-bit words regardless of the byte order.
+ */
+
+static inline uint32_t csum_fold64(uint64_t acc)
+{
+    acc = (acc & 0xffffffffU) + (acc >> 32);
+    acc = (acc & 0xffffffffU) + (acc >> 32);
+    return static_cast<uint32_t>(acc);
+}
+
+static inline uint64_t csum_tail(const uint8_t *p, size_t len, uint64_t acc)
+{
+    uint32_t w32;
+    uint16_t w16;
+
+    while (len >= 4U) {
+        memcpy(&w32, p, sizeof(w32));
+        acc += w32;
+        p += 4;
+        len -= 4;
+    }
+    if (len >= 2U) {
+        memcpy(&w16, p, sizeof(w16));
+        acc += w16;
+        p += 2;
+        len -= 2;
+    }
+    if (len) {
+        uint8_t last[2] = {*p, 0U};
+        memcpy(&w16, last, sizeof(w16));
+        acc += w16;
+    }
+    return acc;
+}
+
+static uint64_t csum_sw(const uint8_t *p, size_t len, uint64_t acc)
+{
+    uint32_t w[4];
+
+    while (len >= sizeof(w)) {
+        memcpy(w, p, sizeof(w));
+        acc += (uint64_t)w[0] + w[1] + w[2] + w[3];
+        p += sizeof(w);
+        len -= sizeof(w);
+    }
+    return csum_tail(p, len, acc);
+}
+
+static uint64_t csum_copy_sw(uint8_t *dst, const uint8_t *src, size_t len, uint64_t acc)
+{
+    uint32_t w[4];
+
+    while (len >= sizeof(w)) {
+        memcpy(w, src, sizeof(w));
+        memcpy(dst, w, sizeof(w));
+        acc += (uint64_t)w[0] + w[1] + w[2] + w[3];
+        src += sizeof(w);
+        dst += sizeof(w);
+        len -= sizeof(w);
+    }
+    memcpy(dst, src, len);
+    return csum_tail(src, len, acc);
+}
+
+#if defined(__x86_64__)
+
+#define CSUM_AVX2_TARGET   __attribute__((target("avx2")))
+#define CSUM_AVX512_TARGET __attribute__((target("avx512f")))
+
+CSUM_AVX2_TARGET static inline __m256i csum_avx2_add(__m256i acc, __m256i v)
+{
+    const __m256i lo32 = _mm256_set1_epi64x(0xffffffffLL);
+
+    acc = _mm256_add_epi64(acc, _mm256_and_si256(v, lo32));
+    return _mm256_add_epi64(acc, _mm256_srli_epi64(v, 32));
+}
+
+CSUM_AVX2_TARGET static inline uint64_t csum_avx2_reduce(__m256i acc0, __m256i acc1)
+{
+    uint64_t lanes[4];
+    uint64_t acc = 0U;
+
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(lanes), _mm256_add_epi64(acc0, acc1));
+    for (int i = 0; i < 4; ++i) {
+        acc += csum_fold64(lanes[i]);
+    }
+    return acc;
+}
+
+CSUM_AVX2_TARGET static uint64_t csum_avx2(const uint8_t *p, size_t len, uint64_t acc)
+{
+    __m256i acc0 = _mm256_setzero_si256();
+    __m256i acc1 = _mm256_setzero_si256();
+
+    while (len >= 64U) {
+        __m256i v0 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+        __m256i v1 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p + 32));
+        acc0 = csum_avx2_add(acc0, v0);
+        acc1 = csum_avx2_add(acc1, v1);
+        p += 64;
+        len -= 64;
+    }
+    acc += csum_avx2_reduce(acc0, acc1);
+    return csum_sw(p, len, acc);
+}
+
+CSUM_AVX2_TARGET static uint64_t csum_copy_avx2(uint8_t *dst, const uint8_t *src, size_t len,
+                                                uint64_t acc)
+{
+    __m256i acc0 = _mm256_setzero_si256();
+    __m256i acc1 = _mm256_setzero_si256();
+
+    while (len >= 64U) {
+        __m256i v0 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src));
+        __m256i v1 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + 32));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst), v0);
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + 32), v1);
+        acc0 = csum_avx2_add(acc0, v0);
+        acc1 = csum_avx2_add(acc1, v1);
+        src += 64;
+        dst += 64;
+        len -= 64;
+    }
+    acc += csum_avx2_reduce(acc0, acc1);
+    return csum_copy_sw(dst, src, len, acc);
+}
+
+CSUM_AVX512_TARGET static inline __m512i csum_avx512_add(__m512i acc, __m512i v)
+{
+    const __m512i lo32 = _mm512_set1_epi64(0xffffffffLL);
+
+    acc = _mm512_add_epi64(acc, _mm512_and_si512(v, lo32));
+    /* The zero-masked form avoids a bogus uninitialized warning in the unmasked intrinsic. */
+    return _mm512_add_epi64(acc, _mm512_maskz_srli_epi64(0xff, v, 32));
+}
+
+CSUM_AVX512_TARGET static inline uint64_t csum_avx512_reduce(__m512i acc0, __m512i acc1)
+{
+    uint64_t lanes[8];
+    uint64_t acc = 0U;
+
+    _mm512_storeu_si512(lanes, _mm512_add_epi64(acc0, acc1));
+    for (int i = 0; i < 8; ++i) {
+        acc += csum_fold64(lanes[i]);
+    }
+    return acc;
+}
+
+CSUM_AVX512_TARGET static uint64_t csum_avx512(const uint8_t *p, size_t len, uint64_t acc)
+{
+    __m512i acc0 = _mm512_setzero_si512();
+    __m512i acc1 = _mm512_setzero_si512();
+
+    while (len >= 128U) {
+        acc0 = csum_avx512_add(acc0, _mm512_loadu_si512(p));
+        acc1 = csum_avx512_add(acc1, _mm512_loadu_si512(p + 64));
+        p += 128;
+        len -= 128;
+    }
+    acc += csum_avx512_reduce(acc0, acc1);
+    return csum_sw(p, len, acc);
+}
+
+CSUM_AVX512_TARGET static uint64_t csum_copy_avx512(uint8_t *dst, const uint8_t *src, size_t len,
+                                                    uint64_t acc)
+{
+    __m512i acc0 = _mm512_setzero_si512();
+    __m512i acc1 = _mm512_setzero_si512();
+
+    while (len >= 128U) {
+        __m512i v0 = _mm512_loadu_si512(src);
+        __m512i v1 = _mm512_loadu_si512(src + 64);
+        _mm512_storeu_si512(dst, v0);
+        _mm512_storeu_si512(dst + 64, v1);
+        acc0 = csum_avx512_add(acc0, v0);
+        acc1 = csum_avx512_add(acc1, v1);
+        src += 128;
+        dst += 128;
+        len -= 128;
+    }
+    acc += csum_avx512_reduce(acc0, acc1);
+    return csum_copy_sw(dst, src, len, acc);
+}
+
+#elif defined(__aarch64__)
+
+static uint64_t csum_neon(const uint8_t *p, size_t len, uint64_t acc)
+{
+    uint64x2_t acc0 = vdupq_n_u64(0);
+    uint64x2_t acc1 = vdupq_n_u64(0);
+
+    while (len >= 32U) {
+        acc0 = vpadalq_u32(acc0, vreinterpretq_u32_u8(vld1q_u8(p)));
+        acc1 = vpadalq_u32(acc1, vreinterpretq_u32_u8(vld1q_u8(p + 16)));
+        p += 32;
+        len -= 32;
+    }
+    acc0 = vaddq_u64(acc0, acc1);
+    acc += (uint64_t)csum_fold64(vgetq_lane_u64(acc0, 0)) + csum_fold64(vgetq_lane_u64(acc0, 1));
+    return csum_sw(p, len, acc);
+}
+
+static uint64_t csum_copy_neon(uint8_t *dst, const uint8_t *src, size_t len, uint64_t acc)
+{
+    uint64x2_t acc0 = vdupq_n_u64(0);
+    uint64x2_t acc1 = vdupq_n_u64(0);
+
+    while (len >= 32U) {
+        uint8x16_t v0 = vld1q_u8(src);
+        uint8x16_t v1 = vld1q_u8(src + 16);
+        vst1q_u8(dst, v0);
+        vst1q_u8(dst + 16, v1);
+        acc0 = vpadalq_u32(acc0, vreinterpretq_u32_u8(v0));
+        acc1 = vpadalq_u32(acc1, vreinterpretq_u32_u8(v1));
+        src += 32;
+        dst += 32;
+        len -= 32;
+    }
+    acc0 = vaddq_u64(acc0, acc1);
+    acc += (uint64_t)csum_fold64(vgetq_lane_u64(acc0, 0)) + csum_fold64(vgetq_lane_u64(acc0, 1));
+    return csum_copy_sw(dst, src, len, acc);
+}
+
+#endif /* __aarch64__ */
+
+#if defined(__x86_64__)
+static bool csum_has_avx512(void)
+{
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx512f");
+}
+
+static bool csum_has_avx2(void)
+{
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+}
+#endif /* __x86_64__ */
+
+static bool csum_has_any(void)
+{
+    return true;
+}
+
+/* All the kernels of the architecture in the order of preference. */
+static const struct {
+    csum_kernel kernel;
+    bool (*supported)(void);
+} s_csum_kernel_table[] = {
+#if defined(__x86_64__)
+    {{"csum_avx512", csum_avx512, csum_copy_avx512}, csum_has_avx512},
+    {{"csum_avx2", csum_avx2, csum_copy_avx2}, csum_has_avx2},
+#elif defined(__aarch64__)
+    {{"csum_neon", csum_neon, csum_copy_neon}, csum_has_any},
+#endif
+    {{"csum_sw", csum_sw, csum_copy_sw}, csum_has_any},
+};
+
+#define CSUM_KERNELS_MAX (sizeof(s_csum_kernel_table) / sizeof(s_csum_kernel_table[0]))
+
+static csum_kernel s_csum_kernels[CSUM_KERNELS_MAX];
+
+static size_t csum_kernels_init(void)
+{
+    size_t count = 0;
+
+    for (size_t i = 0; i < CSUM_KERNELS_MAX; ++i) {
+        if (s_csum_kernel_table[i].supported()) {
+            s_csum_kernels[count++] = s_csum_kernel_table[i].kernel;
+        }
+    }
+    return count;
+}
+
+/* Headers are too short to amortize the vector setup. */
+#define CSUM_SHORT_LEN 64U
+
+/* Resolved once when the library is loaded. */
+static const size_t s_csum_kernels_count = csum_kernels_init();
+static const csum_func_t s_csum_impl = s_csum_kernels[0].csum;
+static const csum_copy_func_t s_csum_copy_impl = s_csum_kernels[0].csum_copy;
+
+size_t csum_get_kernels(const struct csum_kernel **kernels)
+{
+    *kernels = s_csum_kernels;
+    return s_csum_kernels_count;
+}
+
+uint32_t csum_partial(const void *buf, size_t len, uint32_t sum)
+{
+    const uint8_t *p = static_cast<const uint8_t *>(buf);
+
+    return csum_fold64(len < CSUM_SHORT_LEN ? csum_sw(p, len, sum) : s_csum_impl(p, len, sum));
+}
+
+uint32_t csum_partial_copy(void *dst, const void *src, size_t len, uint32_t sum)
+{
+    return csum_fold64(s_csum_copy_impl(static_cast<uint8_t *>(dst),
+                                        static_cast<const uint8_t *>(src), len, sum));
+}
+
+int memcpy_fromiovec_csum(uint8_t *p_dst, const struct iovec *p_iov, size_t sz_iov,
+                          size_t sz_src_start_offset, size_t sz_data, uint32_t &sum)
+{
+    /* Skip to start offset  */
+    int n_iovpos = 0;
+    while (n_iovpos < (int)sz_iov && sz_src_start_offset >= p_iov[n_iovpos].iov_len) {
+        sz_src_start_offset -= p_iov[n_iovpos].iov_len;
+        n_iovpos++;
+    }
+
+    /* Copy len size into pBuf and sum it in the same pass */
+    int n_total = 0;
+    while (n_iovpos < (int)sz_iov && sz_data > 0) {
+        if (p_iov[n_iovpos].iov_len && p_iov[n_iovpos].iov_base) {
+            uint8_t *p_src = ((uint8_t *)(p_iov[n_iovpos].iov_base)) + sz_src_start_offset;
+            size_t sz_block = p_iov[n_iovpos].iov_len - sz_src_start_offset;
+            int sz_data_block_to_copy = (int)(sz_data < sz_block ? sz_data : sz_block);
+            sz_src_start_offset = 0;
+
+            uint32_t block_sum = csum_partial_copy(p_dst, p_src, sz_data_block_to_copy, 0U);
+            sum = csum_add(sum, (n_total & 1) ? csum_odd(block_sum) : block_sum);
+
+            p_dst += sz_data_block_to_copy;
+            sz_data -= sz_data_block_to_copy;
+            n_total += sz_data_block_to_copy;
+        }
+        n_iovpos++;
+    }
+    return n_total;
+}
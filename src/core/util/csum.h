@@ -0,0 +1,101 @@
+/*
+ * Copyright (c) 2001-2023 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ *
+ * This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING in the main directory of this source tree, or the
+ * BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef CSUM_H
+#define CSUM_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/uio.h>
+
+/**
+ * Internet checksum (RFC 1071) kernels used by the software checksum paths.
+ *
+ * The partial sum is a 32-bit one's complement accumulator of the 16-bit words of the
+ * buffer in memory order, an odd trailing byte is padded with zero. The implementation
+ * is selected at runtime: AVX-512 or AVX2 on x86_64, NEON on aarch64 and a 64-bit
+ * scalar loop otherwise.
+ */
+
+uint32_t csum_partial(const void *buf, size_t len, uint32_t sum);
+
+/* Copies 'len' bytes from 'src' to 'dst' and returns the partial sum in the same pass. */
+uint32_t csum_partial_copy(void *dst, const void *src, size_t len, uint32_t sum);
+
+/* One's complement addition of two partial sums. */
+static inline uint32_t csum_add(uint32_t a, uint32_t b)
+{
+    a += b;
+    return a + (a < b);
+}
+
+/* Folds a partial sum to 16 bits, the result isn't inverted. */
+static inline uint16_t csum_fold(uint32_t sum)
+{
+    sum = (sum & 0xffffU) + (sum >> 16);
+    sum = (sum & 0xffffU) + (sum >> 16);
+    return static_cast<uint16_t>(sum);
+}
+
+/* Partial sum of a block which starts at an odd offset of the checksummed data. */
+static inline uint32_t csum_odd(uint32_t sum)
+{
+    uint16_t folded = csum_fold(sum);
+    return static_cast<uint16_t>((folded << 8) | (folded >> 8));
+}
+
+/*
+ * A kernel returns the unfolded 64-bit accumulator, csum_partial() folds it to 32 bits.
+ * csum_get_kernels() is used by the unit tests: it returns the kernels which the CPU supports
+ * in the order of preference, the first one is used by csum_partial() and the scalar csum_sw
+ * is always the last one.
+ */
+typedef uint64_t (*csum_func_t)(const uint8_t *buf, size_t len, uint64_t acc);
+typedef uint64_t (*csum_copy_func_t)(uint8_t *dst, const uint8_t *src, size_t len, uint64_t acc);
+
+struct csum_kernel {
+    const char *name;
+    csum_func_t csum;
+    csum_copy_func_t csum_copy;
+};
+
+size_t csum_get_kernels(const struct csum_kernel **kernels);
+
+/**
+ * Same as memcpy_fromiovec() and adds the copied data to the partial Internet checksum 'sum'.
+ * The checksummed data must start at an even offset from p_dst.
+ * Returns total bytes copyed
+ */
+int memcpy_fromiovec_csum(uint8_t *p_dst, const struct iovec *p_iov, size_t sz_iov,
+                          size_t sz_src_start_offset, size_t sz_data, uint32_t &sum);
+
+#endif /* CSUM_H */
@@ -0,0 +1,192 @@
+/*
+ * Copyright (c) 2001-2023 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ *
+ * This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING in the main directory of this source tree, or the
+ * BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <inttypes.h>
+#include <pthread.h>
+#include <sched.h>
+#include "vlogger/vlogger.h"
+#include "epoch_reclaim.h"
+
+#define MODULE_NAME "epoch"
+
+#define epoch_logdbg __log_dbg
+
+// Epoch 0 is reserved for threads outside of a read section
+std::atomic<uint64_t> epoch_reclaim::s_global_epoch(1);
+std::atomic<epoch_reclaim::thread_rec *> epoch_reclaim::s_thread_recs(nullptr);
+__thread epoch_reclaim::thread_rec *epoch_reclaim::s_thread_rec = nullptr;
+
+static pthread_key_t g_epoch_key;
+static pthread_once_t g_epoch_key_once = PTHREAD_ONCE_INIT;
+
+void epoch_reclaim::key_create()
+{
+    // Releases the record of an exiting thread
+    pthread_key_create(&g_epoch_key, unregister_thread);
+}
+
+epoch_reclaim::epoch_reclaim(reclaim_cb_t reclaim_cb)
+    : m_reclaim_cb(reclaim_cb)
+    , m_lock("epoch_reclaim")
+    , m_n_retired(0)
+{
+}
+
+epoch_reclaim::~epoch_reclaim()
+{
+    reclaim(true);
+}
+
+epoch_reclaim::thread_rec *epoch_reclaim::register_thread()
+{
+    thread_rec *rec;
+
+    pthread_once(&g_epoch_key_once, key_create);
+
+    // Records are never freed, reuse a record of an exited thread if possible
+    for (rec = s_thread_recs.load(std::memory_order_acquire); rec; rec = rec->next) {
+        bool expected = false;
+        if (!rec->in_use.load(std::memory_order_relaxed) &&
+            rec->in_use.compare_exchange_strong(expected, true)) {
+            break;
+        }
+    }
+
+    if (!rec) {
+        rec = new thread_rec;
+        rec->epoch.store(0, std::memory_order_relaxed);
+        rec->in_use.store(true, std::memory_order_relaxed);
+        rec->next = s_thread_recs.load(std::memory_order_relaxed);
+        while (!s_thread_recs.compare_exchange_weak(rec->next, rec, std::memory_order_release,
+                                                    std::memory_order_relaxed)) {
+        }
+    }
+
+    rec->nest = 0;
+    s_thread_rec = rec;
+    pthread_setspecific(g_epoch_key, rec);
+    return rec;
+}
+
+void epoch_reclaim::unregister_thread(void *r)
+{
+    thread_rec *rec = (thread_rec *)r;
+
+    rec->epoch.store(0, std::memory_order_relaxed);
+    rec->nest = 0;
+    rec->in_use.store(false, std::memory_order_release);
+}
+
+uint64_t epoch_reclaim::oldest_reader_epoch()
+{
+    uint64_t oldest = UINT64_MAX;
+
+    // Pairs with the fence in read_lock()
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    for (thread_rec *rec = s_thread_recs.load(std::memory_order_acquire); rec; rec = rec->next) {
+        uint64_t rec_epoch = rec->epoch.load(std::memory_order_acquire);
+        if (rec_epoch != 0 && rec_epoch < oldest) {
+            oldest = rec_epoch;
+        }
+    }
+
+    return oldest;
+}
+
+void epoch_reclaim::retire(void *obj)
+{
+    // The object must be unpublished before the epoch is sampled
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    m_lock.lock();
+    m_retired.push_back({obj, s_global_epoch.load(std::memory_order_relaxed)});
+    m_n_retired.fetch_add(1, std::memory_order_relaxed);
+    m_lock.unlock();
+}
+
+void epoch_reclaim::reclaim(bool force)
+{
+    std::deque<retired_obj> expired;
+
+    if (m_lock.trylock()) {
+        // Another thread is reclaiming
+        if (!force) {
+            return;
+        }
+        m_lock.lock();
+    }
+
+    uint64_t epoch = s_global_epoch.load(std::memory_order_relaxed);
+    uint64_t oldest = oldest_reader_epoch();
+
+    /* An object retired in epoch E is observable only by readers which entered in epoch E or
+     * earlier. Readers which enter after the epoch is advanced can't see it, so the object is
+     * reclaimed as soon as the older readers leave, or at once if there are no readers.
+     */
+    if (oldest >= epoch) {
+        s_global_epoch.compare_exchange_strong(epoch, epoch + 1);
+    }
+    while (!m_retired.empty() && (force || m_retired.front().epoch < oldest)) {
+        expired.push_back(m_retired.front());
+        m_retired.pop_front();
+    }
+    m_n_retired.fetch_sub(expired.size(), std::memory_order_relaxed);
+    m_lock.unlock();
+
+    if (!expired.empty()) {
+        epoch_logdbg("reclaiming %zu objects at epoch %" PRIu64, expired.size(), epoch);
+    }
+    for (retired_obj &retired : expired) {
+        m_reclaim_cb(retired.obj);
+    }
+}
+
+void epoch_reclaim::synchronize()
+{
+    // Readers which enter after the epoch is advanced observe the caller's preceding stores
+    uint64_t epoch = s_global_epoch.fetch_add(1, std::memory_order_acq_rel);
+
+    while (oldest_reader_epoch() <= epoch) {
+        sched_yield();
+    }
+}
+
+void epoch_reclaim::fork_reset()
+{
+    thread_rec *self = s_thread_rec;
+
+    for (thread_rec *rec = s_thread_recs.load(std::memory_order_acquire); rec; rec = rec->next) {
+        if (rec != self) {
+            unregister_thread(rec);
+        }
+    }
+}
@@ -0,0 +1,138 @@
+/*
+ * Copyright (c) 2001-2023 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ *
+ * This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING in the main directory of this source tree, or the
+ * BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef EPOCH_RECLAIM_H
+#define EPOCH_RECLAIM_H
+
+#include <atomic>
+#include <deque>
+#include <stdint.h>
+#include "utils/lock_wrapper.h"
+
+/**
+ * Epoch based reclamation.
+ *
+ * Readers wrap short lookups of a shared pointer with read_lock()/read_unlock(). Both are
+ * wait-free and never block on writers. A writer unpublishes the object first and then calls
+ * retire(). The reclaim callback is called for the object only after every reader, which could
+ * observe the pointer, has left its read section.
+ *
+ * Read sections must be short and must not block, otherwise reclamation of all retired objects
+ * is delayed. Objects which are used for longer must be pinned by the caller (e.g. reference
+ * counter taken inside the read section).
+ */
+class epoch_reclaim {
+public:
+    typedef void (*reclaim_cb_t)(void *obj);
+
+    epoch_reclaim(reclaim_cb_t reclaim_cb);
+    ~epoch_reclaim();
+
+    static inline void read_lock()
+    {
+        thread_rec *rec = s_thread_rec;
+
+        if (!rec) {
+            rec = register_thread();
+        }
+
+        if (rec->nest++ == 0) {
+            rec->epoch.store(s_global_epoch.load(std::memory_order_acquire),
+                             std::memory_order_relaxed);
+            // The announcement must be visible before the protected loads
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+        }
+    }
+
+    static inline void read_unlock()
+    {
+        thread_rec *rec = s_thread_rec;
+
+        if (--rec->nest == 0) {
+            rec->epoch.store(0, std::memory_order_release);
+        }
+    }
+
+    /**
+     * Defer reclaim callback of an unpublished object.
+     */
+    void retire(void *obj);
+
+    /**
+     * Reclaim retired objects whose grace period has expired.
+     * @param force Reclaim all the objects regardless of readers (teardown only).
+     */
+    void reclaim(bool force = false);
+
+    inline bool has_retired() { return m_n_retired.load(std::memory_order_relaxed) > 0; }
+
+    /**
+     * Wait until every read section, which has been entered before the call, is left.
+     * For objects which are destroyed in place rather than retired. Must not be called
+     * inside a read section.
+     */
+    static void synchronize();
+
+    /**
+     * Forget read sections of the threads which do not exist in a forked child.
+     */
+    static void fork_reset();
+
+private:
+    struct thread_rec {
+        std::atomic<uint64_t> epoch; // Global epoch observed by the reader, 0 - not reading
+        std::atomic<bool> in_use;
+        uint32_t nest;
+        thread_rec *next;
+    };
+
+    struct retired_obj {
+        void *obj;
+        uint64_t epoch;
+    };
+
+    static void key_create();
+    static thread_rec *register_thread();
+    static void unregister_thread(void *rec);
+    static uint64_t oldest_reader_epoch();
+
+    reclaim_cb_t m_reclaim_cb;
+    lock_spin m_lock;
+    std::deque<retired_obj> m_retired;
+    std::atomic<size_t> m_n_retired;
+
+    static std::atomic<uint64_t> s_global_epoch;
+    static std::atomic<thread_rec *> s_thread_recs;
+    static __thread thread_rec *s_thread_rec;
+};
+
+#endif /* EPOCH_RECLAIM_H */
@@ -656,6 +656,7 @@ void mce_sys_var::get_env_params()
     ring_allocation_logic_rx = MCE_DEFAULT_RING_ALLOCATION_LOGIC_RX;
     ring_migration_ratio_tx = MCE_DEFAULT_RING_MIGRATION_RATIO_TX;
     ring_migration_ratio_rx = MCE_DEFAULT_RING_MIGRATION_RATIO_RX;
+    ring_migration_by_traffic = MCE_DEFAULT_RING_MIGRATION_TRAFFIC;
     ring_limit_per_interface = MCE_DEFAULT_RING_LIMIT_PER_INTERFACE;
     ring_dev_mem_tx = MCE_DEFAULT_RING_DEV_MEM_TX;
 
@@ -674,6 +675,8 @@ void mce_sys_var::get_env_params()
     tx_mc_loopback_default = MCE_DEFAULT_TX_MC_LOOPBACK;
     tx_nonblocked_eagains = MCE_DEFAULT_TX_NONBLOCKED_EAGAINS;
     tx_prefetch_bytes = MCE_DEFAULT_TX_PREFETCH_BYTES;
+    tx_db_defer_max = MCE_DEFAULT_TX_DB_DEFER_MAX;
+    tx_mpw_inline_max = MCE_DEFAULT_TX_MPW_INLINE_MAX;
     tx_bufs_batch_udp = MCE_DEFAULT_TX_BUFS_BATCH_UDP;
     tx_bufs_batch_tcp = MCE_DEFAULT_TX_BUFS_BATCH_TCP;
     tx_segs_batch_tcp = MCE_DEFAULT_TX_SEGS_BATCH_TCP;
@@ -700,6 +703,8 @@ void mce_sys_var::get_env_params()
     strq_stride_size_bytes = MCE_DEFAULT_STRQ_STRIDE_SIZE_BYTES;
     strq_strides_num_bufs = MCE_DEFAULT_STRQ_STRIDES_NUM_BUFS;
     strq_strides_compensation_level = MCE_DEFAULT_STRQ_STRIDES_COMPENSATION_LEVEL;
+    strq_copybreak = MCE_DEFAULT_STRQ_COPYBREAK;
+    strq_copybreak_bufs = MCE_DEFAULT_STRQ_COPYBREAK_BUFS;
 
     gro_streams_max = MCE_DEFAULT_GRO_STREAMS_MAX;
     disable_flow_tag = MCE_DEFAULT_DISABLE_FLOW_TAG;
@@ -713,6 +718,7 @@ void mce_sys_var::get_env_params()
     select_poll_os_force = MCE_DEFAULT_SELECT_POLL_OS_FORCE;
     select_poll_os_ratio = MCE_DEFAULT_SELECT_POLL_OS_RATIO;
     select_skip_os_fd_check = MCE_DEFAULT_SELECT_SKIP_OS;
+    select_poll_adaptive = MCE_DEFAULT_SELECT_POLL_ADAPTIVE;
 
     cq_moderation_enable = MCE_DEFAULT_CQ_MODERATION_ENABLE;
     cq_moderation_count = MCE_DEFAULT_CQ_MODERATION_COUNT;
@@ -734,6 +740,7 @@ void mce_sys_var::get_env_params()
     timer_resolution_msec = MCE_DEFAULT_TIMER_RESOLUTION_MSEC;
     tcp_timer_resolution_msec = MCE_DEFAULT_TCP_TIMER_RESOLUTION_MSEC;
     tcp_ctl_thread = MCE_DEFAULT_TCP_CTL_THREAD;
+    tcp_timers_per_thread = MCE_DEFAULT_TCP_TIMERS_PER_THREAD;
     tcp_ts_opt = MCE_DEFAULT_TCP_TIMESTAMP_OPTION;
     tcp_nodelay = MCE_DEFAULT_TCP_NODELAY;
     tcp_quickack = MCE_DEFAULT_TCP_QUICKACK;
@@ -750,9 +757,12 @@ void mce_sys_var::get_env_params()
 #ifdef DEFINED_UTLS
     enable_utls_rx = MCE_DEFAULT_UTLS_RX;
     enable_utls_tx = MCE_DEFAULT_UTLS_TX;
+    enable_utls_sw = MCE_DEFAULT_UTLS_SW;
+    enable_utls_rx_batch = MCE_DEFAULT_UTLS_RX_BATCH;
     utls_high_wmark_dek_cache_size = MCE_DEFAULT_UTLS_HIGH_WMARK_DEK_CACHE_SIZE;
     utls_low_wmark_dek_cache_size = MCE_DEFAULT_UTLS_LOW_WMARK_DEK_CACHE_SIZE;
 #endif /* DEFINED_UTLS */
+    enable_nvme_sw_digest = MCE_DEFAULT_NVME_SW_DIGEST;
     enable_lro = MCE_DEFAULT_LRO;
     handle_fork = MCE_DEFAULT_FORK_SUPPORT;
     handle_bf = MCE_DEFAULT_BF_FLAG;
@@ -1157,6 +1167,19 @@ void mce_sys_var::get_env_params()
         strq_strides_compensation_level = (uint32_t)atoi(env_ptr);
     }
 
+    if ((env_ptr = getenv(SYS_VAR_STRQ_COPYBREAK)) != NULL) {
+        strq_copybreak = (uint32_t)atoi(env_ptr);
+        if (strq_copybreak > MCE_MAX_STRQ_COPYBREAK) {
+            vlog_printf(VLOG_WARNING, "%s must be up to %d bytes (set to max)\n",
+                        SYS_VAR_STRQ_COPYBREAK, MCE_MAX_STRQ_COPYBREAK);
+            strq_copybreak = MCE_MAX_STRQ_COPYBREAK;
+        }
+    }
+
+    if ((env_ptr = getenv(SYS_VAR_STRQ_COPYBREAK_BUFS)) != NULL) {
+        strq_copybreak_bufs = (uint32_t)atoi(env_ptr);
+    }
+
     if ((env_ptr = getenv(SYS_VAR_ZC_NUM_BUFS)) != NULL) {
         zc_num_bufs = (uint32_t)atoi(env_ptr);
     }
@@ -1224,6 +1247,19 @@ void mce_sys_var::get_env_params()
         tx_prefetch_bytes = (uint32_t)atoi(env_ptr);
     }
 
+    if ((env_ptr = getenv(SYS_VAR_TX_DB_DEFER_MAX)) != NULL) {
+        tx_db_defer_max = (uint32_t)atoi(env_ptr);
+    }
+
+    if ((env_ptr = getenv(SYS_VAR_TX_MPW_INLINE_MAX)) != NULL) {
+        tx_mpw_inline_max = (uint32_t)atoi(env_ptr);
+        if (tx_mpw_inline_max > MCE_MAX_TX_MPW_INLINE) {
+            vlog_printf(VLOG_WARNING, "%s must be up to %d bytes (set to max)\n",
+                        SYS_VAR_TX_MPW_INLINE_MAX, MCE_MAX_TX_MPW_INLINE);
+            tx_mpw_inline_max = MCE_MAX_TX_MPW_INLINE;
+        }
+    }
+
     if ((env_ptr = getenv(SYS_VAR_TX_BUFS_BATCH_TCP)) != NULL) {
         tx_bufs_batch_tcp = (uint32_t)atoi(env_ptr);
         if (tx_bufs_batch_tcp < 1) {
@@ -1273,6 +1309,10 @@ void mce_sys_var::get_env_params()
         ring_migration_ratio_rx = atoi(env_ptr);
     }
 
+    if ((env_ptr = getenv(SYS_VAR_RING_MIGRATION_TRAFFIC)) != NULL) {
+        ring_migration_by_traffic = atoi(env_ptr) ? true : false;
+    }
+
     if ((env_ptr = getenv(SYS_VAR_RING_LIMIT_PER_INTERFACE)) != NULL) {
         ring_limit_per_interface = std::max(0, atoi(env_ptr));
     }
@@ -1464,6 +1504,10 @@ void mce_sys_var::get_env_params()
         select_skip_os_fd_check = (uint32_t)atoi(env_ptr);
     }
 
+    if ((env_ptr = getenv(SYS_VAR_SELECT_POLL_ADAPTIVE)) != NULL) {
+        select_poll_adaptive = atoi(env_ptr) ? true : false;
+    }
+
 #ifdef DEFINED_IBV_CQ_ATTR_MODERATE
     if ((mce_spec != MCE_SPEC_NVME_BF2) && (rx_poll_num < 0 || select_poll_num < 0)) {
         cq_moderation_enable = false;
@@ -1601,6 +1645,15 @@ void mce_sys_var::get_env_params()
         }
     }
 
+    if ((env_ptr = getenv(SYS_VAR_TCP_TIMERS_PER_THREAD)) != NULL) {
+        tcp_timers_per_thread = atoi(env_ptr) ? true : false;
+    }
+    if (tcp_timers_per_thread && tcp_ctl_thread > CTL_THREAD_DISABLE) {
+        vlog_printf(VLOG_WARNING, "%s is not supported with %s, disabling it\n",
+                    SYS_VAR_TCP_TIMERS_PER_THREAD, SYS_VAR_TCP_CTL_THREAD);
+        tcp_timers_per_thread = false;
+    }
+
     if ((env_ptr = getenv(SYS_VAR_TCP_TIMESTAMP_OPTION)) != NULL) {
         tcp_ts_opt = (tcp_ts_opt_t)atoi(env_ptr);
         if ((uint32_t)tcp_ts_opt >= TCP_TS_OPTION_LAST) {
@@ -1767,6 +1820,14 @@ void mce_sys_var::get_env_params()
         enable_utls_tx = atoi(env_ptr) ? true : false;
     }
 
+    if ((env_ptr = getenv(SYS_VAR_UTLS_SW)) != NULL) {
+        enable_utls_sw = atoi(env_ptr) ? true : false;
+    }
+
+    if ((env_ptr = getenv(SYS_VAR_UTLS_RX_BATCH)) != NULL) {
+        enable_utls_rx_batch = atoi(env_ptr) ? true : false;
+    }
+
     if ((env_ptr = getenv(SYS_VAR_UTLS_HIGH_WMARK_DEK_CACHE_SIZE)) != NULL) {
         int temp = atoi(env_ptr);
         utls_high_wmark_dek_cache_size = (temp >= 0 ? static_cast<size_t>(temp) : 0);
@@ -1781,6 +1842,10 @@ void mce_sys_var::get_env_params()
     }
 #endif /* DEFINED_UTLS */
 
+    if ((env_ptr = getenv(SYS_VAR_NVME_SW_DIGEST)) != NULL) {
+        enable_nvme_sw_digest = atoi(env_ptr) ? true : false;
+    }
+
     if ((env_ptr = getenv(SYS_VAR_LRO)) != NULL) {
         enable_lro = option_3::from_str(env_ptr, MCE_DEFAULT_LRO);
     }
@@ -1862,7 +1927,7 @@ void mce_sys_var::get_env_params()
 
     if ((env_ptr = getenv(SYS_VAR_MULTILOCK)) != NULL) {
         int temp = atoi(env_ptr);
-        if (temp < 0 || temp > MULTILOCK_MUTEX) {
+        if (temp < 0 || temp > MULTILOCK_ADAPTIVE) {
             temp = 0;
         }
         multilock = (multilock_t)temp;
@@ -181,6 +181,7 @@ typedef enum {
 typedef enum {
     MULTILOCK_SPIN = 0,
     MULTILOCK_MUTEX = 1,
+    MULTILOCK_ADAPTIVE = 2,
 } multilock_t;
 
 typedef enum {
@@ -350,6 +351,7 @@ public:
     ring_logic_t ring_allocation_logic_rx;
     int ring_migration_ratio_tx;
     int ring_migration_ratio_rx;
+    bool ring_migration_by_traffic;
     int ring_limit_per_interface;
     int ring_dev_mem_tx;
     int tcp_max_syn_rate;
@@ -367,6 +369,8 @@ public:
     bool tx_mc_loopback_default;
     bool tx_nonblocked_eagains;
     uint32_t tx_prefetch_bytes;
+    uint32_t tx_db_defer_max;
+    uint32_t tx_mpw_inline_max;
     uint32_t tx_bufs_batch_udp;
     uint32_t tx_bufs_batch_tcp;
     uint32_t tx_segs_batch_tcp;
@@ -393,6 +397,8 @@ public:
     uint32_t strq_stride_size_bytes;
     uint32_t strq_strides_num_bufs;
     uint32_t strq_strides_compensation_level;
+    uint32_t strq_copybreak;
+    uint32_t strq_copybreak_bufs;
 
     uint32_t gro_streams_max;
     bool disable_flow_tag;
@@ -408,6 +414,7 @@ public:
     bool select_poll_os_force;
     uint32_t select_poll_os_ratio;
     uint32_t select_skip_os_fd_check;
+    bool select_poll_adaptive;
     bool select_handle_cpu_usage_stats;
 
     bool cq_moderation_enable;
@@ -429,6 +436,7 @@ public:
     uint32_t timer_resolution_msec;
     uint32_t tcp_timer_resolution_msec;
     tcp_ctl_thread_t tcp_ctl_thread;
+    bool tcp_timers_per_thread;
     tcp_ts_opt_t tcp_ts_opt;
     bool tcp_nodelay;
     bool tcp_quickack;
@@ -460,12 +468,18 @@ public:
 #ifdef DEFINED_UTLS
     bool enable_utls_rx;
     bool enable_utls_tx;
+    // Fall back to the software TLS record layer if the NIC lacks crypto offload.
+    bool enable_utls_sw;
+    // Decrypt small software RX records of a ring poll together with multi-buffer AES-GCM.
+    bool enable_utls_rx_batch;
     // DEK cache size high-watermark. Max number of DEKs to be stored in the cache.
     size_t utls_high_wmark_dek_cache_size;
     // DEK cache size low-watermark. Min number of available DEKs required in the cache
     // to perform Crypto-Sync and reuse.
     size_t utls_low_wmark_dek_cache_size;
 #endif /* DEFINED_UTLS */
+    // Compute and verify NVMe/TCP digests in software if they aren't offloaded.
+    bool enable_nvme_sw_digest;
     uint32_t timer_netlink_update_msec;
 
     // Neigh parameters
@@ -552,6 +566,7 @@ extern mce_sys_var &safe_mce_sys();
 #define SYS_VAR_RING_ALLOCATION_LOGIC_RX "XLIO_RING_ALLOCATION_LOGIC_RX"
 #define SYS_VAR_RING_MIGRATION_RATIO_TX  "XLIO_RING_MIGRATION_RATIO_TX"
 #define SYS_VAR_RING_MIGRATION_RATIO_RX  "XLIO_RING_MIGRATION_RATIO_RX"
+#define SYS_VAR_RING_MIGRATION_TRAFFIC   "XLIO_RING_MIGRATION_BY_TRAFFIC"
 #define SYS_VAR_RING_LIMIT_PER_INTERFACE "XLIO_RING_LIMIT_PER_INTERFACE"
 #define SYS_VAR_RING_DEV_MEM_TX          "XLIO_RING_DEV_MEM_TX"
 
@@ -568,6 +583,8 @@ extern mce_sys_var &safe_mce_sys();
 #define SYS_VAR_TX_MC_LOOPBACK        "XLIO_TX_MC_LOOPBACK"
 #define SYS_VAR_TX_NONBLOCKED_EAGAINS "XLIO_TX_NONBLOCKED_EAGAINS"
 #define SYS_VAR_TX_PREFETCH_BYTES     "XLIO_TX_PREFETCH_BYTES"
+#define SYS_VAR_TX_DB_DEFER_MAX       "XLIO_TX_DB_DEFER_MAX"
+#define SYS_VAR_TX_MPW_INLINE_MAX     "XLIO_TX_MPW_INLINE_MAX"
 #define SYS_VAR_TX_BUFS_BATCH_TCP     "XLIO_TX_BUFS_BATCH_TCP"
 #define SYS_VAR_TX_SEGS_BATCH_TCP     "XLIO_TX_SEGS_BATCH_TCP"
 
@@ -576,6 +593,8 @@ extern mce_sys_var &safe_mce_sys();
 #define SYS_VAR_STRQ_STRIDE_SIZE_BYTES          "XLIO_STRQ_STRIDE_SIZE_BYTES"
 #define SYS_VAR_STRQ_STRIDES_NUM_BUFS           "XLIO_STRQ_STRIDES_NUM_BUFS"
 #define SYS_VAR_STRQ_STRIDES_COMPENSATION_LEVEL "XLIO_STRQ_STRIDES_COMPENSATION_LEVEL"
+#define SYS_VAR_STRQ_COPYBREAK                  "XLIO_STRQ_COPYBREAK"
+#define SYS_VAR_STRQ_COPYBREAK_BUFS             "XLIO_STRQ_COPYBREAK_BUFS"
 
 #define SYS_VAR_RX_NUM_BUFS             "XLIO_RX_BUFS"
 #define SYS_VAR_RX_BUF_SIZE             "XLIO_RX_BUF_SIZE"
@@ -606,6 +625,7 @@ extern mce_sys_var &safe_mce_sys();
 #define SYS_VAR_SELECT_POLL_OS_FORCE   "XLIO_SELECT_POLL_OS_FORCE"
 #define SYS_VAR_SELECT_POLL_OS_RATIO   "XLIO_SELECT_POLL_OS_RATIO"
 #define SYS_VAR_SELECT_SKIP_OS         "XLIO_SELECT_SKIP_OS"
+#define SYS_VAR_SELECT_POLL_ADAPTIVE   "XLIO_SELECT_POLL_ADAPTIVE"
 
 #define SYS_VAR_CQ_MODERATION_ENABLE           "XLIO_CQ_MODERATION_ENABLE"
 #define SYS_VAR_CQ_MODERATION_COUNT            "XLIO_CQ_MODERATION_COUNT"
@@ -625,6 +645,7 @@ extern mce_sys_var &safe_mce_sys();
 #define SYS_VAR_TIMER_RESOLUTION_MSEC     "XLIO_TIMER_RESOLUTION_MSEC"
 #define SYS_VAR_TCP_TIMER_RESOLUTION_MSEC "XLIO_TCP_TIMER_RESOLUTION_MSEC"
 #define SYS_VAR_TCP_CTL_THREAD            "XLIO_TCP_CTL_THREAD"
+#define SYS_VAR_TCP_TIMERS_PER_THREAD     "XLIO_TCP_TIMERS_PER_THREAD"
 #define SYS_VAR_TCP_TIMESTAMP_OPTION      "XLIO_TCP_TIMESTAMP_OPTION"
 #define SYS_VAR_TCP_NODELAY               "XLIO_TCP_NODELAY"
 #define SYS_VAR_TCP_QUICKACK              "XLIO_TCP_QUICKACK"
@@ -657,10 +678,14 @@ extern mce_sys_var &safe_mce_sys();
 #ifdef DEFINED_UTLS
 #define SYS_VAR_UTLS_RX                        "XLIO_UTLS_RX"
 #define SYS_VAR_UTLS_TX                        "XLIO_UTLS_TX"
+#define SYS_VAR_UTLS_SW                        "XLIO_UTLS_SW"
+#define SYS_VAR_UTLS_RX_BATCH                  "XLIO_UTLS_RX_BATCH"
 #define SYS_VAR_UTLS_HIGH_WMARK_DEK_CACHE_SIZE "XLIO_UTLS_HIGH_WMARK_DEK_CACHE_SIZE"
 #define SYS_VAR_UTLS_LOW_WMARK_DEK_CACHE_SIZE  "XLIO_UTLS_LOW_WMARK_DEK_CACHE_SIZE"
 #endif /* DEFINED_UTLS */
 
+#define SYS_VAR_NVME_SW_DIGEST "XLIO_NVME_SW_DIGEST"
+
 #define SYS_VAR_LRO "XLIO_LRO"
 
 #define SYS_VAR_INTERNAL_THREAD_AFFINITY "XLIO_INTERNAL_THREAD_AFFINITY"
@@ -705,6 +730,7 @@ extern mce_sys_var &safe_mce_sys();
 #define MCE_DEFAULT_RING_ALLOCATION_LOGIC_RX (RING_LOGIC_PER_INTERFACE)
 #define MCE_DEFAULT_RING_MIGRATION_RATIO_TX  (100)
 #define MCE_DEFAULT_RING_MIGRATION_RATIO_RX  (100)
+#define MCE_DEFAULT_RING_MIGRATION_TRAFFIC   (false)
 #define MCE_DEFAULT_RING_LIMIT_PER_INTERFACE (0)
 #define MCE_DEFAULT_RING_DEV_MEM_TX          (0)
 #define MCE_DEFAULT_TCP_MAX_SYN_RATE         (0)
@@ -722,6 +748,9 @@ extern mce_sys_var &safe_mce_sys();
 #define MCE_DEFAULT_TX_MC_LOOPBACK           (true)
 #define MCE_DEFAULT_TX_NONBLOCKED_EAGAINS    (false)
 #define MCE_DEFAULT_TX_PREFETCH_BYTES        (256)
+#define MCE_DEFAULT_TX_DB_DEFER_MAX          (0)
+#define MCE_DEFAULT_TX_MPW_INLINE_MAX        (0)
+#define MCE_MAX_TX_MPW_INLINE                (512)
 #define MCE_DEFAULT_TX_BUFS_BATCH_UDP        (8)
 #define MCE_DEFAULT_TX_BUFS_BATCH_TCP        (16)
 #define MCE_DEFAULT_TX_SEGS_BATCH_TCP        (64)
@@ -742,6 +771,9 @@ extern mce_sys_var &safe_mce_sys();
 #define MCE_DEFAULT_STRQ_COMPENSATION_LEVEL         (1)
 #define MCE_DEFAULT_STRQ_STRIDES_NUM_BUFS           (262144)
 #define MCE_DEFAULT_STRQ_STRIDES_COMPENSATION_LEVEL (16384)
+#define MCE_DEFAULT_STRQ_COPYBREAK                  (0)
+#define MCE_DEFAULT_STRQ_COPYBREAK_BUFS             (32768)
+#define MCE_MAX_STRQ_COPYBREAK                      (4096)
 
 #define MCE_DEFAULT_RX_NUM_BUFS                   (200000)
 #define MCE_DEFAULT_RX_BUF_SIZE                   (0)
@@ -768,6 +800,7 @@ extern mce_sys_var &safe_mce_sys();
 #define MCE_DEFAULT_SELECT_POLL_OS_FORCE          (0)
 #define MCE_DEFAULT_SELECT_POLL_OS_RATIO          (10)
 #define MCE_DEFAULT_SELECT_SKIP_OS                (4)
+#define MCE_DEFAULT_SELECT_POLL_ADAPTIVE          (false)
 #define MCE_DEFAULT_SELECT_CPU_USAGE_STATS        (false)
 #ifdef DEFINED_IBV_CQ_ATTR_MODERATE
 #define MCE_DEFAULT_CQ_MODERATION_ENABLE (true)
@@ -792,6 +825,7 @@ extern mce_sys_var &safe_mce_sys();
 #define MCE_DEFAULT_TIMER_RESOLUTION_MSEC          (10)
 #define MCE_DEFAULT_TCP_TIMER_RESOLUTION_MSEC      (100)
 #define MCE_DEFAULT_TCP_CTL_THREAD                 (CTL_THREAD_DISABLE)
+#define MCE_DEFAULT_TCP_TIMERS_PER_THREAD          (false)
 #define MCE_DEFAULT_TCP_TIMESTAMP_OPTION           (TCP_TS_OPTION_DISABLE)
 #define MCE_DEFAULT_TCP_NODELAY                    (false)
 #define MCE_DEFAULT_TCP_QUICKACK                   (false)
@@ -849,10 +883,14 @@ extern mce_sys_var &safe_mce_sys();
 #ifdef DEFINED_UTLS
 #define MCE_DEFAULT_UTLS_RX                        (false)
 #define MCE_DEFAULT_UTLS_TX                        (true)
+#define MCE_DEFAULT_UTLS_SW                        (false)
+#define MCE_DEFAULT_UTLS_RX_BATCH                  (false)
 #define MCE_DEFAULT_UTLS_HIGH_WMARK_DEK_CACHE_SIZE (1024)
 #define MCE_DEFAULT_UTLS_LOW_WMARK_DEK_CACHE_SIZE  (512)
 #endif /* DEFINED_UTLS */
 
+#define MCE_DEFAULT_NVME_SW_DIGEST (false)
+
 #define MCE_DEFAULT_LRO                            (option_3::AUTO)
 #define MCE_DEFAULT_DEFERRED_CLOSE                 (false)
 #define MCE_DEFAULT_TCP_ABORT_ON_CLOSE             (false)
@@ -263,15 +263,7 @@ void compute_tx_checksum(mem_buf_desc_t *p_mem_buf_desc, bool l3_csum, bool l4_c
 
 unsigned short compute_ip_checksum(const uint16_t *p_data, size_t sz_count)
 {
-    unsigned long sum = 0;
-
-    while (sz_count--) {
-        sum += *p_data;
-        p_data++;
-    }
-    sum = (sum >> 16) + (sum & 0xffff);
-    sum += (sum >> 16);
-    return ~sum;
+    return ~csum_fold(csum_partial(p_data, sz_count * sizeof(uint16_t), 0U));
 }
 
 unsigned short compute_ip_checksum(const iphdr *p_ip_h)
@@ -314,22 +306,7 @@ static uint32_t compute_pseudo_header(const ip6_hdr *ipv6, uint16_t proto, uint1
 static unsigned short compute_payload_checksum(const uint16_t *payload, uint16_t payload_len,
                                                uint32_t sum)
 {
-    while (payload_len > 1) {
-        sum += *payload++;
-        payload_len -= 2;
-    }
-
-    if (payload_len > 0) {
-        sum += ((*payload) & htons(0xFF00));
-    }
-    //
-    // Fold 32-bit sum to 16 bits: add carrier to result
-    while (sum >> 16) {
-        sum = (sum & 0xffff) + (sum >> 16);
-    }
-
-    sum = ~sum;
-    return static_cast<unsigned short>(sum);
+    return ~csum_fold(csum_partial(payload, payload_len, sum));
 }
 
 unsigned short compute_tcp_checksum(const iphdr *ipv4, const uint16_t *payload, uint16_t hdr_len)
@@ -365,54 +342,33 @@ unsigned short compute_ipv6_udp_frag_checksum(const ip6_hdr *ipv6, udphdr *udp)
     sum += compute_pseudo_header(ipv6, IPPROTO_UDP, ntohs(udp->len));
     sum += udp->source + udp->dest + udp->len;
 
-    // Fold 32-bit sum to 16 bits: add carrier to result
-    while (sum >> 16) {
-        sum = (sum & 0xffff) + (sum >> 16);
-    }
-
-    sum = ~sum;
-    return static_cast<unsigned short>(sum);
+    return ~csum_fold(sum);
 }
 
 unsigned short compute_udp_payload_checksum_rx(const struct udphdr *udphdrp,
                                                mem_buf_desc_t *p_rx_wc_buf_desc, uint16_t udp_len,
                                                uint32_t sum)
 {
-    const uint16_t *p_ip_payload = (const uint16_t *)udphdrp;
+    const uint8_t *p_ip_payload = reinterpret_cast<const uint8_t *>(udphdrp);
     mem_buf_desc_t *p_ip_frag = p_rx_wc_buf_desc;
-    unsigned short ip_frag_len = p_ip_frag->rx.frag.iov_len + sizeof(struct udphdr);
-    unsigned short ip_frag_remainder = ip_frag_len;
+    size_t ip_frag_len = p_ip_frag->rx.frag.iov_len + sizeof(struct udphdr);
 
     // add the IP payload
-    while (udp_len > 1) {
-        // Each packet but the last must contain a payload length that is a multiple of 8
-        if (!ip_frag_remainder && p_ip_frag->p_next_desc) {
-            p_ip_frag = p_ip_frag->p_next_desc;
-            p_ip_payload = (const uint16_t *)p_ip_frag->rx.frag.iov_base;
-            ip_frag_remainder = ip_frag_len = p_ip_frag->rx.frag.iov_len;
-        }
-
-        while (ip_frag_remainder > 1) {
-            sum += *p_ip_payload++;
-            ip_frag_remainder -= 2;
+    // Each packet but the last must contain a payload length that is a multiple of 8
+    while (true) {
+        size_t len = std::min<size_t>(ip_frag_len, udp_len);
+
+        sum = csum_partial(p_ip_payload, len, sum);
+        udp_len -= len;
+        p_ip_frag = p_ip_frag->p_next_desc;
+        if (!udp_len || !p_ip_frag) {
+            break;
         }
-
-        udp_len -= (ip_frag_len - ip_frag_remainder);
-    }
-
-    // if any bytes left, pad the bytes and add
-    if (udp_len > 0) {
-        sum += ((*p_ip_payload) & htons(0xFF00));
-    }
-
-    // Fold sum to 16 bits: add carrier to result
-    while (sum >> 16) {
-        sum = (sum & 0xffff) + (sum >> 16);
+        p_ip_payload = reinterpret_cast<const uint8_t *>(p_ip_frag->rx.frag.iov_base);
+        ip_frag_len = p_ip_frag->rx.frag.iov_len;
     }
 
-    sum = ~sum;
-    // computation result
-    return (unsigned short)sum;
+    return ~csum_fold(sum);
 }
 
 /* set udp checksum: given IP header and UDP datagram
@@ -57,7 +57,7 @@ wakeup::wakeup()
     m_is_sleeping = 0;
     memset(&m_ev, 0, sizeof(m_ev));
 }
-void wakeup::going_to_sleep()
+bool wakeup::going_to_sleep()
 {
     BULLSEYE_EXCLUDE_BLOCK_START
     if (likely(m_epfd)) {
@@ -67,6 +67,7 @@ void wakeup::going_to_sleep()
         m_is_sleeping = 0;
     }
     BULLSEYE_EXCLUDE_BLOCK_END
+    return true;
 }
 
 void wakeup::wakeup_set_epoll_fd(int epfd)
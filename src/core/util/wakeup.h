@@ -45,9 +45,9 @@ public:
     virtual ~wakeup() {};
     virtual void do_wakeup() = 0;
     virtual bool is_wakeup_fd(int fd) = 0;
-    virtual void remove_wakeup_fd() = 0;
-    void going_to_sleep();
-    void return_from_sleep() { --m_is_sleeping; };
+    // Returns false if the caller must keep polling instead of blocking
+    virtual bool going_to_sleep();
+    virtual void return_from_sleep() { --m_is_sleeping; };
     void wakeup_clear() { m_is_sleeping = 0; }
 
 protected:
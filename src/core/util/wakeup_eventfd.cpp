@@ -0,0 +1,191 @@
+/*
+ * Copyright (c) 2001-2023 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ *
+ * This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING in the main directory of this source tree, or the
+ * BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <sys/eventfd.h>
+#include "utils/bullseye.h"
+#include "vlogger/vlogger.h"
+#include "wakeup_eventfd.h"
+#include "sock/sock-redirect.h"
+
+#define MODULE_NAME "wakeup_eventfd"
+
+#define wkup_logpanic   __log_info_panic
+#define wkup_logerr     __log_info_err
+#define wkup_logwarn    __log_info_warn
+#define wkup_loginfo    __log_info_info
+#define wkup_logdbg     __log_info_dbg
+#define wkup_logfunc    __log_info_func
+#define wkup_logfuncall __log_info_funcall
+#define wkup_entry_dbg  __log_entry_dbg
+
+#undef MODULE_HDR_INFO
+#define MODULE_HDR_INFO MODULE_NAME "[epfd=%d]:%d:%s() "
+#undef __INFO__
+#define __INFO__          m_epfd
+#define UNINIT_EVENTFD_FD (-1)
+
+wakeup_eventfd::wakeup_eventfd()
+    : m_wakeup_fd(UNINIT_EVENTFD_FD)
+    , m_b_signaled(false)
+    , m_n_wakeup_pending(0)
+{
+}
+
+bool wakeup_eventfd::going_to_sleep()
+{
+    // This func should be called under socket / epoll lock
+
+    wakeup::going_to_sleep();
+    if (likely(m_wakeup_fd != UNINIT_EVENTFD_FD) || !m_is_sleeping) {
+        return true;
+    }
+
+    /* The eventfd is created on the first sleep, so objects which are never waited on in the
+     * kernel do not consume a file descriptor.
+     * The eventfd is never read. With edge triggered registration every write() generates a
+     * new event which is reported to a single epoll_wait() caller.
+     * Without the eventfd nobody can wake the thread up, so it keeps polling and the creation
+     * is retried on the next attempt to sleep.
+     */
+    int errno_tmp = errno;
+    int fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    BULLSEYE_EXCLUDE_BLOCK_START
+    if (fd < 0) {
+        VLOG_PRINTF_INFO_ONCE_THEN_ALWAYS(VLOG_ERROR, VLOG_DEBUG,
+                                          "wakeup eventfd create failed, polling instead of "
+                                          "sleeping (errno=%d %m)",
+                                          errno);
+        goto err;
+    }
+    BULLSEYE_EXCLUDE_BLOCK_END
+
+    m_ev.events = EPOLLIN | EPOLLET;
+    m_ev.data.fd = fd;
+    BULLSEYE_EXCLUDE_BLOCK_START
+    if (orig_os_api.epoll_ctl(m_epfd, EPOLL_CTL_ADD, fd, &m_ev)) {
+        VLOG_PRINTF_INFO_ONCE_THEN_ALWAYS(VLOG_ERROR, VLOG_DEBUG,
+                                          "Failed to add wakeup fd to internal epfd, polling "
+                                          "instead of sleeping (errno=%d %m)",
+                                          errno);
+        orig_os_api.close(fd);
+        goto err;
+    }
+    BULLSEYE_EXCLUDE_BLOCK_END
+    m_wakeup_fd = fd;
+    errno = errno_tmp;
+    wkup_logdbg("created wakeup eventfd %d", m_wakeup_fd);
+    return true;
+
+err:
+    --m_is_sleeping;
+    errno = errno_tmp;
+    return false;
+}
+
+void wakeup_eventfd::return_from_sleep()
+{
+    // This func should be called under socket / epoll lock
+
+    wakeup::return_from_sleep();
+    m_b_signaled = false;
+
+    /* The event of a wakeup is reported to a single sleeper, pass it on until as many threads
+     * as were sleeping at the wakeup time have returned. Threads which went to sleep after the
+     * wakeup are not counted, otherwise the returned threads would keep waking each other up.
+     */
+    if (m_n_wakeup_pending > 0 && --m_n_wakeup_pending > 0) {
+        if (m_is_sleeping > 0) {
+            signal();
+        } else {
+            m_n_wakeup_pending = 0;
+        }
+    }
+}
+
+void wakeup_eventfd::signal()
+{
+    uint64_t val = 1;
+    int errno_tmp = errno; // don't let wakeup affect errno
+    BULLSEYE_EXCLUDE_BLOCK_START
+    if (orig_os_api.write(m_wakeup_fd, &val, sizeof(val)) != sizeof(val)) {
+        wkup_logerr("wakeup eventfd write failed (errno=%d %m)", errno);
+    }
+    BULLSEYE_EXCLUDE_BLOCK_END
+    m_b_signaled = true;
+    errno = errno_tmp;
+}
+
+void wakeup_eventfd::do_wakeup()
+{
+    wkup_logfuncall("");
+
+    // This func should be called under socket / epoll lock
+
+    // Call to wakeup only in case there is some thread that is sleeping on epoll
+    if (!m_is_sleeping) {
+        wkup_logfunc("There is no thread in epoll_wait, therefore not calling for wakeup");
+        return;
+    }
+
+    wkup_entry_dbg("");
+
+    m_n_wakeup_pending = m_is_sleeping;
+    if (!m_b_signaled) {
+        signal();
+    }
+}
+
+void wakeup_eventfd::do_wakeup_one()
+{
+    wkup_logfuncall("");
+
+    // This func should be called under epoll lock
+
+    if (!m_is_sleeping) {
+        wkup_logfunc("There is no thread in epoll_wait, therefore not calling for wakeup");
+        return;
+    }
+
+    wkup_entry_dbg("");
+
+    if (!m_b_signaled) {
+        signal();
+    }
+}
+
+wakeup_eventfd::~wakeup_eventfd()
+{
+    if (m_wakeup_fd != UNINIT_EVENTFD_FD) {
+        orig_os_api.close(m_wakeup_fd);
+        m_wakeup_fd = UNINIT_EVENTFD_FD;
+    }
+}
@@ -0,0 +1,62 @@
+/*
+ * Copyright (c) 2001-2023 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ *
+ * This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING in the main directory of this source tree, or the
+ * BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef WAKEUP_EVENTFD_H
+#define WAKEUP_EVENTFD_H
+
+/**
+ * wakeup class that adds a wakeup functionality to socket (tcp and udp) and epoll using an eventfd.
+ * Each waiter object owns an eventfd which is added once to its epfd as edge triggered, so a
+ * wakeup costs a single write() and only the threads sleeping on that epfd are woken.
+ */
+#include "wakeup.h"
+
+class wakeup_eventfd : public wakeup {
+public:
+    wakeup_eventfd(void);
+    ~wakeup_eventfd();
+    virtual void do_wakeup();
+    // Wake a single thread sleeping on the epfd, used for EPOLLEXCLUSIVE fds
+    void do_wakeup_one();
+    virtual inline bool is_wakeup_fd(int fd) { return fd == m_wakeup_fd; };
+    virtual bool going_to_sleep();
+    virtual void return_from_sleep();
+
+private:
+    void signal();
+
+    int m_wakeup_fd;
+    bool m_b_signaled; // an event is posted and no sleeper has returned since
+    int m_n_wakeup_pending; // sleepers of the last do_wakeup() which have not returned yet
+};
+
+#endif /* WAKEUP_EVENTFD_H */
@@ -69,6 +69,7 @@ typedef enum {
     DUMP_FD,
     DUMP_ROUTE,
     DUMP_NEIGH,
+    DUMP_LOCKS,
 } dump_type_t;
 
 // Common iomux stats
@@ -81,6 +82,9 @@ typedef struct {
     uint32_t n_iomux_rx_ready;
     uint32_t n_iomux_os_rx_ready;
     uint32_t n_iomux_polling_time;
+    uint64_t n_iomux_spin_usec;
+    uint64_t n_iomux_sleep_usec;
+    uint32_t n_iomux_poll_budget; // last polling duration chosen by XLIO_SELECT_POLL_ADAPTIVE
 } iomux_func_stats_t;
 
 typedef enum { e_totals = 1, e_deltas } print_details_mode_t;
@@ -312,6 +316,7 @@ typedef struct {
     uint64_t n_rx_gro_packets;
     uint64_t n_rx_gro_bytes;
     uint64_t n_rx_gro_frags;
+    uint64_t n_rx_copybreak_packets;
     uint32_t n_rx_sw_queue_len;
     uint32_t n_rx_drained_at_once_max;
     uint32_t n_buffer_pool_len;
@@ -352,6 +357,10 @@ typedef struct {
             uint64_t n_tx_dev_mem_byte_count;
             uint64_t n_tx_dev_mem_oob;
             uint32_t n_tx_dev_mem_allocated;
+            uint64_t n_tx_db_deferred;
+            uint64_t n_tx_db_flushes;
+            uint64_t n_tx_mpw_packets;
+            uint64_t n_tx_mpw_wqes;
         } simple;
         struct {
             char s_tap_name[IFNAMSIZ];
@@ -374,6 +383,8 @@ typedef struct {
     uint32_t n_buffer_pool_size;
     uint32_t n_buffer_pool_no_bufs;
     uint32_t n_buffer_pool_expands;
+    uint32_t n_buffer_pool_pinned;
+    uint64_t n_buffer_pool_pinned_bytes;
 } bpool_stats_t;
 
 typedef struct {
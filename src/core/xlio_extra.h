@@ -118,19 +118,45 @@ struct xlio_pd_key {
     uint32_t mkey;
 };
 
-#define NVDA_NVME 666
-#define NVME_TX   1
-#define NVME_RX   2
+#define NVDA_NVME   666
+#define NVME_TX     1
+#define NVME_RX     2
+#define NVME_RX_BUF 3
 
 enum {
     XLIO_NVME_DDGST_ENABLE = 1U << 31,
     XLIO_NVME_DDGST_OFFLOAD = 1U << 30,
     XLIO_NVME_HDGST_ENABLE = 1U << 29,
     XLIO_NVME_HDGST_OFFLOAD = 1U << 28,
+    /* NVME_RX only: place C2HData payload into buffers registered with NVME_RX_BUF. */
+    XLIO_NVME_RX_PLACEMENT = 1U << 27,
     XLIO_NVME_PDA_MASK = ((1U << 4) - 1U),
     XLIO_NVME_DDGST_MASK = (XLIO_NVME_DDGST_ENABLE | XLIO_NVME_DDGST_OFFLOAD),
 };
 
+/**
+ * @brief Pass this structure into setsockopt(NVDA_NVME, NVME_RX_BUF) to register
+ * 	the destination buffer of a command. Requires XLIO_NVME_RX_PLACEMENT in NVME_RX.
+ * 	Payload of C2HData PDUs with matching CCCID is copied to addr + DATAO and
+ * 	removed from the received stream together with its data digest, so the
+ * 	application reads only PDO bytes of such PDUs. The PDU header isn't modified,
+ * 	so PLEN in the delivered header no longer matches the number of bytes of the
+ * 	PDU in the stream: PLEN - DATAL - data digest length bytes are delivered.
+ * 	The buffer stays registered until it is unregistered with addr == NULL.
+ * 	If it is unregistered in the middle of a PDU, the rest of the payload is
+ * 	discarded.
+ *
+ * @param addr - destination buffer or NULL to unregister the command
+ * @param len - size of the destination buffer
+ * @param cid - command identifier
+ */
+struct xlio_nvme_rx_buf {
+    void *addr;
+    uint32_t len;
+    uint16_t cid;
+    uint16_t reserved;
+};
+
 /************ SocketXtreme API types definition start***************/
 
 enum {
@@ -189,6 +215,66 @@ struct xlio_socketxtreme_completion_t {
 
 /************ SocketXtreme API types definition end ***************/
 
+/************ Submission ring API types definition start ***************/
+
+/*
+ * Operations of the submission queue entry
+ */
+enum {
+    XLIO_URING_OP_NOP = 0,
+    XLIO_URING_OP_SEND, /* send(fd, addr, len, flags) */
+    XLIO_URING_OP_RECV, /* recv(fd, addr, len, flags) */
+    XLIO_URING_OP_ACCEPT, /* accept4(fd, addr, addr2, flags) */
+    XLIO_URING_OP_CLOSE, /* close(fd) */
+};
+
+/*
+ * Submission queue entry
+ * Used in submission ring extended API.
+ */
+struct xlio_uring_sqe {
+    uint8_t opcode; /* XLIO_URING_OP_* */
+    uint8_t reserved[3];
+    int32_t fd;
+    uint32_t flags; /* MSG_* flags for send/recv, SOCK_* flags for accept */
+    uint32_t len; /* buffer length */
+    uint64_t addr; /* buffer or struct sockaddr for accept */
+    uint64_t addr2; /* socklen_t for accept */
+    uint64_t user_data; /* copied to the completion as is */
+};
+
+/*
+ * Completion queue entry
+ * Used in submission ring extended API.
+ */
+struct xlio_uring_cqe {
+    uint64_t user_data; /* user_data of the submission */
+    int32_t res; /* result of the operation or -errno */
+    uint32_t flags;
+};
+
+/*
+ * Pair of single producer/single consumer rings shared between the application
+ * and the library. The application produces SQEs at sq_tail and consumes CQEs at
+ * cq_head, the library does the opposite. Heads and tails are free running,
+ * index the arrays with (value & mask).
+ */
+struct xlio_uring {
+    uint32_t sq_head;
+    uint32_t sq_tail;
+    uint32_t sq_mask;
+    uint32_t cq_head;
+    uint32_t cq_tail;
+    uint32_t cq_mask;
+    uint32_t cq_overflow; /* reserved */
+    uint32_t reserved;
+    struct xlio_uring_sqe *sqes;
+    struct xlio_uring_cqe *cqes;
+    void *priv; /* library private */
+};
+
+/************ Submission ring API types definition end ***************/
+
 /**
  * Represents one packet
  * Used in receive zero-copy extended API.
@@ -295,6 +381,9 @@ enum {
     XLIO_EXTRA_API_SOCKETXTREME_FREE_XLIO_BUFF = (1 << 10),
     XLIO_EXTRA_API_DUMP_FD_STATS = (1 << 11),
     XLIO_EXTRA_API_IOCTL = (1 << 12),
+    XLIO_EXTRA_API_TX_FLUSH = (1 << 13),
+    XLIO_EXTRA_API_REGISTER_RECV_MEMORY = (1 << 14),
+    XLIO_EXTRA_API_URING = (1 << 15),
 };
 
 /**
@@ -589,8 +678,128 @@ struct __attribute__((packed)) xlio_api_t {
      *                  EOPNOTSUPP - socketXtreme was not enabled during configuration time.
      */
     int (*socketxtreme_free_buff)(struct xlio_buff_t *buff);
+
+    /**
+     * Ring the TX doorbell for all the packets postponed by XLIO_TX_DB_DEFER_MAX.
+     *
+     * Doorbells are flushed automatically on the next epoll/poll/select or
+     * socketxtreme_poll() call. This function allows to flush them explicitly,
+     * for example, before a blocking call.
+     *
+     * @return 0 on success, -1 on failure
+     */
+    int (*tx_flush)(void);
+
+    /**
+     * Register application memory for receive buffers of a socket.
+     * The socket gets a dedicated ring which posts its receive WQEs into
+     * [addr, addr + length), so packets land directly in the application memory.
+     * Received packets are returned by recvfrom_zcopy() or socketxtreme_poll()
+     * as usual; the offset of the payload in the region is the iov_base (or
+     * payload) address minus addr. The memory must stay valid until the socket
+     * is closed and all the zero-copy packets taken from it are freed; the
+     * registration is dropped only after the last packet is returned. Must be
+     * called before the socket gets its RX ring, i.e. before bind()/connect().
+     * Same as setsockopt(SO_XLIO_RING_USER_MEMORY).
+     *
+     * @param fd The socket.
+     * @param addr Start of the memory region.
+     * @param length Length of the memory region.
+     * @return 0 on success, -1 on failure
+     *
+     * errno is set to: EINVAL - not an offloaded socket or bad arguments
+     */
+    int (*register_recv_memory)(int fd, void *addr, size_t length);
+
+    /**
+     * Create a submission/completion ring pair.
+     * Operations are submitted by writing SQEs and advancing sq_tail
+     * (see xlio_uring_get_sqe() and xlio_uring_submit()) and are executed by
+     * uring_enter(). Results are posted to the completion ring.
+     *
+     * @param entries Number of SQEs, rounded up to a power of 2. The completion
+     *        ring has twice as many entries.
+     * @return Ring on success, NULL on failure
+     *
+     * errno is set to: EINVAL - bad number of entries
+     *                  ENOMEM - not enough memory
+     */
+    struct xlio_uring *(*uring_setup)(unsigned int entries);
+
+    /**
+     * Execute submitted operations and make progress on the operations which
+     * could not complete immediately.
+     *
+     * All operations run in the caller context without blocking. Receive, send
+     * and accept operations which would block are kept by the library and are
+     * retried on the next calls after polling the rings, in submission order per
+     * fd. Only offloaded sockets are supported, other fds complete with
+     * -EOPNOTSUPP, except for XLIO_URING_OP_CLOSE.
+     * The SQ is consumed only while there is room in the CQ for the results.
+     *
+     * @param ring The ring.
+     * @param min_complete Busy poll until at least this number of CQEs is
+     *        available to the application. Polling stops after XLIO_RX_POLL
+     *        rounds, so fewer CQEs can be available on return.
+     * @return Number of consumed SQEs on success, -1 on failure
+     *
+     * errno is set to: EINVAL - bad ring or min_complete exceeds the CQ size
+     */
+    int (*uring_enter)(struct xlio_uring *ring, unsigned int min_complete);
+
+    /**
+     * Destroy a ring created by uring_setup().
+     * Operations which have not completed yet are dropped.
+     *
+     * @param ring The ring.
+     * @return 0 on success, -1 on failure
+     */
+    int (*uring_destroy)(struct xlio_uring *ring);
 };
 
+/**
+ * Get the n-th free SQE after sq_tail, or NULL if the SQ is full.
+ * Fill SQEs 0..n-1 and pass them to the library by xlio_uring_submit(ring, n).
+ */
+static inline struct xlio_uring_sqe *xlio_uring_get_sqe(struct xlio_uring *ring, unsigned int n)
+{
+    uint32_t head = __atomic_load_n(&ring->sq_head, __ATOMIC_ACQUIRE);
+
+    if (ring->sq_tail + n - head > ring->sq_mask) {
+        return NULL;
+    }
+    return &ring->sqes[(ring->sq_tail + n) & ring->sq_mask];
+}
+
+/**
+ * Publish n SQEs filled after xlio_uring_get_sqe().
+ */
+static inline void xlio_uring_submit(struct xlio_uring *ring, unsigned int n)
+{
+    __atomic_store_n(&ring->sq_tail, ring->sq_tail + n, __ATOMIC_RELEASE);
+}
+
+/**
+ * Get the oldest unconsumed CQE, or NULL if the CQ is empty.
+ */
+static inline struct xlio_uring_cqe *xlio_uring_peek_cqe(struct xlio_uring *ring)
+{
+    uint32_t tail = __atomic_load_n(&ring->cq_tail, __ATOMIC_ACQUIRE);
+
+    if (ring->cq_head == tail) {
+        return NULL;
+    }
+    return &ring->cqes[ring->cq_head & ring->cq_mask];
+}
+
+/**
+ * Return the CQE obtained by xlio_uring_peek_cqe() to the library.
+ */
+static inline void xlio_uring_cqe_seen(struct xlio_uring *ring)
+{
+    __atomic_store_n(&ring->cq_head, ring->cq_head + 1, __ATOMIC_RELEASE);
+}
+
 /**
  * Retrieve XLIO extended API.
  * This function can be called as an alternative to getsockopt() call
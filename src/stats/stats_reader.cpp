@@ -106,6 +106,8 @@ typedef enum { e_K = 1024, e_M = 1048576 } units_t;
 #define FORMAT_RING_INTERRUPT  "%-20s %zu / %zu [requests/received] %-3s\n"
 #define FORMAT_RING_MODERATION "%-20s %u / %u [frames/usec period] %-3s\n"
 #define FORMAT_RING_DM_STATS   "%-20s %zu / %zu / %zu [kilobytes/packets/oob] %-3s\n"
+#define FORMAT_RING_DB_DEFER   "%-20s %zu / %zu [deferred/flushes] %-3s\n"
+#define FORMAT_RING_MPW        "%-20s %zu / %zu [packets/WQEs] %-3s\n"
 #define FORMAT_RING_TAP_NAME   "%-20s %s\n"
 #define FORMAT_RING_MASTER     "%-20s %p\n"
 
@@ -187,6 +189,8 @@ void usage(const char *argv0)
         " log level to <level>(one of: none/panic/error/warn/info/details/debug/fine/finer/all)\n");
     printf("  -S, --fd_dump=<fd> [<level>]\tDump statistics for fd number <fd> using log level "
            "<level>. use 0 value for all open fds.\n");
+    printf("      --dump=<route|locks>\tDump routing tables or lock profile (built with "
+           "--enable-lock-profile) using the log level set by --fd_dump\n");
     printf("  -D, --details_level=<level>\tSet " PRODUCT_NAME
            " log details level to <level>(0 <= level <= 3)\n");
     printf("  -s, --sockets=<list|range>\tLog only sockets that match <list> or <range>, format: "
@@ -348,6 +352,11 @@ void update_delta_iomux_stat(iomux_func_stats_t *p_curr_stats, iomux_func_stats_
             (p_curr_stats->n_iomux_rx_ready - p_prev_stats->n_iomux_rx_ready) / delay;
         p_prev_stats->n_iomux_timeouts =
             (p_curr_stats->n_iomux_timeouts - p_prev_stats->n_iomux_timeouts) / delay;
+        p_prev_stats->n_iomux_spin_usec =
+            (p_curr_stats->n_iomux_spin_usec - p_prev_stats->n_iomux_spin_usec) / delay;
+        p_prev_stats->n_iomux_sleep_usec =
+            (p_curr_stats->n_iomux_sleep_usec - p_prev_stats->n_iomux_sleep_usec) / delay;
+        p_prev_stats->n_iomux_poll_budget = p_curr_stats->n_iomux_poll_budget;
         p_prev_stats->threadid_last = p_curr_stats->threadid_last;
     }
 }
@@ -397,6 +406,22 @@ void update_delta_ring_stat(ring_stats_t *p_curr_ring_stats, ring_stats_t *p_pre
                 p_curr_ring_stats->simple.n_rx_cq_moderation_count;
             p_prev_ring_stats->simple.n_rx_cq_moderation_period =
                 p_curr_ring_stats->simple.n_rx_cq_moderation_period;
+            p_prev_ring_stats->simple.n_tx_db_deferred =
+                (p_curr_ring_stats->simple.n_tx_db_deferred -
+                 p_prev_ring_stats->simple.n_tx_db_deferred) /
+                delay;
+            p_prev_ring_stats->simple.n_tx_db_flushes =
+                (p_curr_ring_stats->simple.n_tx_db_flushes -
+                 p_prev_ring_stats->simple.n_tx_db_flushes) /
+                delay;
+            p_prev_ring_stats->simple.n_tx_mpw_packets =
+                (p_curr_ring_stats->simple.n_tx_mpw_packets -
+                 p_prev_ring_stats->simple.n_tx_mpw_packets) /
+                delay;
+            p_prev_ring_stats->simple.n_tx_mpw_wqes =
+                (p_curr_ring_stats->simple.n_tx_mpw_wqes -
+                 p_prev_ring_stats->simple.n_tx_mpw_wqes) /
+                delay;
             p_prev_ring_stats->simple.n_tx_dev_mem_allocated =
                 p_curr_ring_stats->simple.n_tx_dev_mem_allocated;
             p_prev_ring_stats->simple.n_tx_dev_mem_byte_count =
@@ -434,6 +459,9 @@ void update_delta_cq_stat(cq_stats_t *p_curr_cq_stats, cq_stats_t *p_prev_cq_sta
             (p_curr_cq_stats->n_rx_gro_frags - p_prev_cq_stats->n_rx_gro_frags) / delay;
         p_prev_cq_stats->n_rx_gro_bytes =
             (p_curr_cq_stats->n_rx_gro_bytes - p_prev_cq_stats->n_rx_gro_bytes) / delay;
+        p_prev_cq_stats->n_rx_copybreak_packets = (p_curr_cq_stats->n_rx_copybreak_packets -
+                                                   p_prev_cq_stats->n_rx_copybreak_packets) /
+            delay;
         p_prev_cq_stats->n_rx_consumed_rwqe_count = (p_curr_cq_stats->n_rx_consumed_rwqe_count -
                                                      p_prev_cq_stats->n_rx_consumed_rwqe_count) /
             delay;
@@ -452,6 +480,9 @@ void update_delta_bpool_stat(bpool_stats_t *p_curr_bpool_stats, bpool_stats_t *p
     int delay = user_params.interval;
     if (p_curr_bpool_stats && p_prev_bpool_stats) {
         p_prev_bpool_stats->n_buffer_pool_size = p_curr_bpool_stats->n_buffer_pool_size;
+        p_prev_bpool_stats->n_buffer_pool_pinned = p_curr_bpool_stats->n_buffer_pool_pinned;
+        p_prev_bpool_stats->n_buffer_pool_pinned_bytes =
+            p_curr_bpool_stats->n_buffer_pool_pinned_bytes;
         p_prev_bpool_stats->n_buffer_pool_no_bufs = (p_curr_bpool_stats->n_buffer_pool_no_bufs -
                                                      p_prev_bpool_stats->n_buffer_pool_no_bufs) /
             delay;
@@ -552,6 +583,15 @@ void print_ring_stats(ring_instance_block_t *p_ring_inst_arr)
                            p_ring_stats->simple.n_tx_dev_mem_pkt_count,
                            p_ring_stats->simple.n_tx_dev_mem_oob, post_fix);
                 }
+                if (p_ring_stats->simple.n_tx_db_deferred) {
+                    printf(FORMAT_RING_DB_DEFER,
+                           "TX Doorbell Defer:", p_ring_stats->simple.n_tx_db_deferred,
+                           p_ring_stats->simple.n_tx_db_flushes, post_fix);
+                }
+                if (p_ring_stats->simple.n_tx_mpw_wqes) {
+                    printf(FORMAT_RING_MPW, "TX MPW:", p_ring_stats->simple.n_tx_mpw_packets,
+                           p_ring_stats->simple.n_tx_mpw_wqes, post_fix);
+                }
             }
         }
     }
@@ -606,6 +646,10 @@ void print_cq_stats(cq_instance_block_t *p_cq_inst_arr)
                     FORMAT_STATS_double, "GRO frags per packet:",
                     static_cast<double>(p_cq_stats->n_rx_gro_frags) / p_cq_stats->n_rx_gro_packets);
             }
+            if (p_cq_stats->n_rx_copybreak_packets) {
+                printf(FORMAT_STATS_64bit, "Copybreak packets:", p_cq_stats->n_rx_copybreak_packets,
+                       post_fix);
+            }
         }
     }
     printf("======================================================\n");
@@ -636,6 +680,11 @@ void print_bpool_stats(bpool_instance_block_t *p_bpool_inst_arr)
             if (p_bpool_stats->n_buffer_pool_expands) {
                 printf(FORMAT_STATS_32bit, "Expands:", p_bpool_stats->n_buffer_pool_expands);
             }
+            if (p_bpool_stats->n_buffer_pool_pinned) {
+                printf(FORMAT_STATS_32bit, "Pinned:", p_bpool_stats->n_buffer_pool_pinned);
+                printf(FORMAT_STATS_64bit,
+                       "Pinned bytes:", p_bpool_stats->n_buffer_pool_pinned_bytes, "");
+            }
         }
     }
     printf("======================================================\n");
@@ -930,6 +979,15 @@ void print_full_iomux_stats(const char *func_name, iomux_func_stats_t *p_iomux_s
             printf("Polls [miss/hit]%s: %u / %u (%2.2f%%)\n", post_fix,
                    p_iomux_stats->n_iomux_poll_miss, p_iomux_stats->n_iomux_poll_hit,
                    iomux_poll_hit_percentage);
+            if (p_iomux_stats->n_iomux_spin_usec + p_iomux_stats->n_iomux_sleep_usec) {
+                double iomux_spin = (double)p_iomux_stats->n_iomux_spin_usec;
+                double iomux_spin_percentage =
+                    (iomux_spin / (iomux_spin + (double)p_iomux_stats->n_iomux_sleep_usec)) * 100;
+                printf("Spin / Sleep [usec]%s: %" PRIu64 " / %" PRIu64 " (%2.2f%% spin)\n",
+                       post_fix, p_iomux_stats->n_iomux_spin_usec,
+                       p_iomux_stats->n_iomux_sleep_usec, iomux_spin_percentage);
+                printf("Poll budget: %u usec\n", p_iomux_stats->n_iomux_poll_budget);
+            }
             if (p_iomux_stats->n_iomux_timeouts) {
                 printf("Timeouts%s: %u\n", post_fix, p_iomux_stats->n_iomux_timeouts);
             }
@@ -1403,7 +1461,8 @@ void stats_reader_handler(sh_mem_t *p_sh_mem, int pid)
             {DUMP_DISABLED, "Unknown"},
             {DUMP_FD, "Fd"},
             {DUMP_ROUTE, "Routing"},
-            {DUMP_NEIGH, "Neighboring"}};
+            {DUMP_NEIGH, "Neighboring"},
+            {DUMP_LOCKS, "Lock profile"}};
 
         const char *name = dump_type_names[user_params.dump] ?: "Unknown";
         log_msg("Dumping %s information to " PRODUCT_NAME " using log level = %s...", name,
@@ -1767,6 +1826,10 @@ void zero_ring_stats(ring_stats_t *p_ring_stats)
         p_ring_stats->simple.n_tx_dev_mem_byte_count = 0;
         p_ring_stats->simple.n_tx_dev_mem_pkt_count = 0;
         p_ring_stats->simple.n_tx_dev_mem_oob = 0;
+        p_ring_stats->simple.n_tx_db_deferred = 0;
+        p_ring_stats->simple.n_tx_db_flushes = 0;
+        p_ring_stats->simple.n_tx_mpw_packets = 0;
+        p_ring_stats->simple.n_tx_mpw_wqes = 0;
     }
 }
 
@@ -1779,6 +1842,8 @@ void zero_bpool_stats(bpool_stats_t *p_bpool_stats)
 {
     p_bpool_stats->n_buffer_pool_size = 0;
     p_bpool_stats->n_buffer_pool_no_bufs = 0;
+    p_bpool_stats->n_buffer_pool_pinned = 0;
+    p_bpool_stats->n_buffer_pool_pinned_bytes = 0;
 }
 
 void zero_counters(sh_mem_t *p_sh_mem)
@@ -1901,6 +1966,8 @@ int main(int argc, char **argv)
                     user_params.dump = DUMP_ROUTE;
                 } else if (strcasecmp("neigh", optarg) == 0) {
                     user_params.dump = DUMP_NEIGH;
+                } else if (strcasecmp("locks", optarg) == 0) {
+                    user_params.dump = DUMP_LOCKS;
                 } else {
                     log_err("'--dump' Invalid argument: %s", optarg);
                     usage(argv[0]);
@@ -51,6 +51,9 @@
 #define wmb()    asm volatile("dsb st" ::: "memory")
 #define wc_wmb() wmb()
 
+// Spin-wait loop hint
+#define cpu_relax() asm volatile("yield" ::: "memory")
+
 /**
  * Add to the atomic variable.
  * @param i integer value to add.
@@ -51,6 +51,9 @@
 #define wmb()    rmb()
 #define wc_wmb() mb()
 
+// Spin-wait loop hint
+#define cpu_relax() asm volatile("or 27,27,27" ::: "memory")
+
 /**
  * Add to the atomic variable.
  * @param i integer value to add.
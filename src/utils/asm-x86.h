@@ -44,6 +44,9 @@
 #define wmb()    asm volatile("" ::: "memory")
 #define wc_wmb() asm volatile("sfence" ::: "memory")
 
+// Spin-wait loop hint
+#define cpu_relax() asm volatile("pause" ::: "memory")
+
 #define COPY_64B_NT(dst, src)                                                                      \
     __asm__ __volatile__(" movdqa   (%1),%%xmm0\n"                                                 \
                          " movdqa 16(%1),%%xmm1\n"                                                 \
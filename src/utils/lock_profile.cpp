@@ -0,0 +1,136 @@
+/*
+ * Copyright (c) 2001-2023 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ *
+ * This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING in the main directory of this source tree, or the
+ * BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <string.h>
+#include <inttypes.h>
+#include "utils/lock_profile.h"
+
+#ifdef DEFINED_LOCK_PROFILE
+
+#define LOCK_PROFILE_TABLE_SIZE 512
+
+static lock_profile_entry s_lock_profile_table[LOCK_PROFILE_TABLE_SIZE];
+static lock_profile_entry s_lock_profile_other;
+
+static uint32_t lock_profile_hash(const char *name)
+{
+    uint32_t hash = 2166136261U;
+
+    while (*name) {
+        hash = (hash ^ static_cast<uint8_t>(*name++)) * 16777619U;
+    }
+    return hash;
+}
+
+lock_profile_entry *lock_profile_get(const char *name)
+{
+    if (!name) {
+        name = "unnamed";
+    }
+
+    /* Names are usually string literals, so the same name may come with different pointers
+     * from different objects. Entries are never removed, lookup is lock free.
+     */
+    uint32_t idx = lock_profile_hash(name);
+    for (int i = 0; i < LOCK_PROFILE_TABLE_SIZE; i++, idx++) {
+        lock_profile_entry *entry = &s_lock_profile_table[idx % LOCK_PROFILE_TABLE_SIZE];
+        const char *entry_name = entry->name.load(std::memory_order_acquire);
+
+        if (!entry_name) {
+            if (entry->name.compare_exchange_strong(entry_name, name, std::memory_order_acq_rel)) {
+                return entry;
+            }
+        }
+        if (entry_name == name || strcmp(entry_name, name) == 0) {
+            return entry;
+        }
+    }
+
+    s_lock_profile_other.name.store("other", std::memory_order_relaxed);
+    return &s_lock_profile_other;
+}
+
+static void lock_profile_dump_hist(vlog_levels_t log_level, const char *title,
+                                   const std::atomic<uint64_t> *hist, double nsec_per_tsc)
+{
+    for (int i = 0; i < LOCK_PROFILE_BUCKETS; i++) {
+        uint64_t count = hist[i].load(std::memory_order_relaxed);
+        if (count) {
+            vlog_printf(log_level, "    %s < %12.0f ns: %" PRIu64 "\n", title,
+                        static_cast<double>(2ULL << i) * nsec_per_tsc, count);
+        }
+    }
+}
+
+static void lock_profile_dump_entry(vlog_levels_t log_level, lock_profile_entry *entry,
+                                    double nsec_per_tsc)
+{
+    uint64_t n_acquired = entry->n_acquired.load(std::memory_order_relaxed);
+    uint64_t n_waited = entry->n_waited.load(std::memory_order_relaxed);
+
+    if (!n_acquired && !n_waited) {
+        return;
+    }
+
+    vlog_printf(log_level,
+                "  %s: held %" PRIu64 " times, avg %.0f ns; lock() %" PRIu64
+                " times, avg wait %.0f ns\n",
+                entry->name.load(std::memory_order_relaxed), n_acquired,
+                n_acquired ? entry->hold_total.load() * nsec_per_tsc / n_acquired : 0.0,
+                n_waited, n_waited ? entry->wait_total.load() * nsec_per_tsc / n_waited : 0.0);
+    lock_profile_dump_hist(log_level, "wait", entry->wait_hist, nsec_per_tsc);
+    lock_profile_dump_hist(log_level, "hold", entry->hold_hist, nsec_per_tsc);
+}
+
+void lock_profile_dump(vlog_levels_t log_level)
+{
+    double nsec_per_tsc = 1000000000.0 / get_tsc_rate_per_second();
+
+    vlog_printf(log_level, "Lock profile (per lock name):\n");
+    for (int i = 0; i < LOCK_PROFILE_TABLE_SIZE; i++) {
+        if (s_lock_profile_table[i].name.load(std::memory_order_acquire)) {
+            lock_profile_dump_entry(log_level, &s_lock_profile_table[i], nsec_per_tsc);
+        }
+    }
+    if (s_lock_profile_other.name.load(std::memory_order_acquire)) {
+        lock_profile_dump_entry(log_level, &s_lock_profile_other, nsec_per_tsc);
+    }
+}
+
+#else /* DEFINED_LOCK_PROFILE */
+
+void lock_profile_dump(vlog_levels_t log_level)
+{
+    vlog_printf(log_level, "Lock profile is not available, build with --enable-lock-profile\n");
+}
+
+#endif /* DEFINED_LOCK_PROFILE */
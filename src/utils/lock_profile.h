@@ -0,0 +1,84 @@
+/*
+ * Copyright (c) 2001-2023 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ *
+ * This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING in the main directory of this source tree, or the
+ * BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef LOCK_PROFILE_H
+#define LOCK_PROFILE_H
+
+#include <stdint.h>
+#include <atomic>
+#include "utils/rdtsc.h"
+#include <vlogger/vlogger.h>
+
+/*
+ * Lock contention profiler, built with --enable-lock-profile (DEFINED_LOCK_PROFILE).
+ * Wait and hold times are accumulated per lock name into log2 histograms of TSC cycles.
+ * The report is printed with "xlio_stats --dump=locks".
+ */
+
+#define LOCK_PROFILE_BUCKETS 32
+
+struct lock_profile_entry {
+    std::atomic<const char *> name;
+    std::atomic<uint64_t> n_acquired;
+    std::atomic<uint64_t> n_waited;
+    std::atomic<uint64_t> wait_total;
+    std::atomic<uint64_t> hold_total;
+    std::atomic<uint64_t> wait_hist[LOCK_PROFILE_BUCKETS];
+    std::atomic<uint64_t> hold_hist[LOCK_PROFILE_BUCKETS];
+
+    static inline int bucket(tscval_t delta)
+    {
+        int idx = delta ? (63 - __builtin_clzll(delta)) : 0;
+        return idx < LOCK_PROFILE_BUCKETS ? idx : LOCK_PROFILE_BUCKETS - 1;
+    }
+
+    inline void record_wait(tscval_t delta)
+    {
+        n_waited.fetch_add(1, std::memory_order_relaxed);
+        wait_total.fetch_add(delta, std::memory_order_relaxed);
+        wait_hist[bucket(delta)].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    inline void record_hold(tscval_t delta)
+    {
+        n_acquired.fetch_add(1, std::memory_order_relaxed);
+        hold_total.fetch_add(delta, std::memory_order_relaxed);
+        hold_hist[bucket(delta)].fetch_add(1, std::memory_order_relaxed);
+    }
+};
+
+// Entry shared by all the locks with the given name, never NULL
+lock_profile_entry *lock_profile_get(const char *name);
+
+void lock_profile_dump(vlog_levels_t log_level);
+
+#endif /* LOCK_PROFILE_H */
@@ -38,9 +38,16 @@
 #include <string.h>
 #include <stdio.h>
 #include <assert.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
 #include "types.h"
+#include "utils/asm.h"
 #include "utils/bullseye.h"
 #include "utils/rdtsc.h"
+#include "utils/lock_profile.h"
+#include <atomic>
 #include <memory>
 #include <vlogger/vlogger.h>
 #include <core/util/sys_vars.h>
@@ -73,6 +80,18 @@
 #define LOCK_BASE_END_LOCK_WAIT   end_lock_wait(timeval);
 #endif
 
+#ifdef DEFINED_LOCK_PROFILE
+#define LOCK_PROFILE_START_WAIT    tscval_t profile_wait_start = profile_now();
+#define LOCK_PROFILE_END_WAIT      profile_acquired(profile_wait_start);
+#define LOCK_PROFILE_TRYLOCK(_ret) profile_trylocked(_ret);
+#define LOCK_PROFILE_UNLOCK        profile_release();
+#else
+#define LOCK_PROFILE_START_WAIT
+#define LOCK_PROFILE_END_WAIT
+#define LOCK_PROFILE_TRYLOCK(_ret)
+#define LOCK_PROFILE_UNLOCK
+#endif
+
 #ifdef NO_LOCK_STATS
 
 // pthread lock stats counter for debugging
@@ -80,7 +99,12 @@
 class lock_base {
 public:
     lock_base(const char *_lock_name = NULL)
-        : m_lock_name(_lock_name) {};
+        : m_lock_name(_lock_name)
+#ifdef DEFINED_LOCK_PROFILE
+        , m_profile(NULL)
+        , m_hold_start(0)
+#endif
+    {};
     virtual ~lock_base() {};
     virtual int lock() = 0;
     virtual int trylock() = 0;
@@ -93,8 +117,49 @@ public:
 
     const char *to_str() { return m_lock_name; }
 
+#ifdef DEFINED_LOCK_PROFILE
+protected:
+    static inline tscval_t profile_now()
+    {
+        tscval_t t;
+        gettimeoftsc(&t);
+        return t;
+    }
+
+    inline void profile_acquired(tscval_t wait_start)
+    {
+        m_hold_start = profile_now();
+        if (unlikely(!m_profile)) {
+            m_profile = lock_profile_get(m_lock_name);
+        }
+        m_profile->record_wait(m_hold_start - wait_start);
+    }
+
+    inline void profile_trylocked(int ret)
+    {
+        if (ret == 0) {
+            m_hold_start = profile_now();
+        }
+    }
+
+    inline void profile_release()
+    {
+        if (m_hold_start) {
+            if (unlikely(!m_profile)) {
+                m_profile = lock_profile_get(m_lock_name);
+            }
+            m_profile->record_hold(profile_now() - m_hold_start);
+            m_hold_start = 0;
+        }
+    }
+#endif
+
 private:
     const char *m_lock_name;
+#ifdef DEFINED_LOCK_PROFILE
+    lock_profile_entry *m_profile;
+    tscval_t m_hold_start;
+#endif
 };
 #else // NO_LOCK_STATS
 
@@ -193,7 +258,9 @@ public:
     {
         DEFINED_NO_THREAD_LOCK_RETURN_0
         LOCK_BASE_START_LOCK_WAIT
+        LOCK_PROFILE_START_WAIT
         int ret = pthread_spin_lock(&m_lock);
+        LOCK_PROFILE_END_WAIT
         LOCK_BASE_LOCK
         LOCK_BASE_END_LOCK_WAIT
         return ret;
@@ -202,6 +269,7 @@ public:
     {
         DEFINED_NO_THREAD_LOCK_RETURN_0
         int ret = pthread_spin_trylock(&m_lock);
+        LOCK_PROFILE_TRYLOCK(ret)
         LOCK_BASE_TRYLOCK
         return ret;
     };
@@ -209,6 +277,7 @@ public:
     {
         DEFINED_NO_THREAD_LOCK_RETURN_0
         LOCK_BASE_UNLOCK
+        LOCK_PROFILE_UNLOCK
         return pthread_spin_unlock(&m_lock);
     };
 
@@ -303,7 +372,9 @@ public:
     {
         DEFINED_NO_THREAD_LOCK_RETURN_0
         LOCK_BASE_START_LOCK_WAIT
+        LOCK_PROFILE_START_WAIT
         int ret = pthread_mutex_lock(&m_lock);
+        LOCK_PROFILE_END_WAIT
         LOCK_BASE_LOCK
         LOCK_BASE_END_LOCK_WAIT
         return ret;
@@ -312,6 +383,7 @@ public:
     {
         DEFINED_NO_THREAD_LOCK_RETURN_0
         int ret = pthread_mutex_trylock(&m_lock);
+        LOCK_PROFILE_TRYLOCK(ret)
         LOCK_BASE_TRYLOCK
         return ret;
     };
@@ -319,6 +391,7 @@ public:
     {
         DEFINED_NO_THREAD_LOCK_RETURN_0
         LOCK_BASE_UNLOCK
+        LOCK_PROFILE_UNLOCK
         return pthread_mutex_unlock(&m_lock);
     };
 
@@ -396,6 +469,158 @@ protected:
     int m_lock_count;
 };
 
+/**
+ * Adaptive lock
+ * Contended lock() spins with exponential backoff for a bounded time and then parks the thread
+ * on a futex. An uncontended lock()/unlock() pair is a CAS and an exchange without syscalls.
+ */
+#define LOCK_ADAPTIVE_SPIN_ROUNDS 10 // backoff doubles each round, ~1000 pauses in total
+
+/* coverity[missing_move_assignment] */
+class lock_adaptive : public lock_base {
+public:
+    lock_adaptive(const char *name = "lock_adaptive")
+        : lock_base(name)
+        , m_state(LOCK_FREE) {};
+    ~lock_adaptive() {};
+    inline int lock()
+    {
+        DEFINED_NO_THREAD_LOCK_RETURN_0
+        LOCK_PROFILE_START_WAIT
+        int expected = LOCK_FREE;
+        if (unlikely(!m_state.compare_exchange_strong(expected, LOCK_LOCKED,
+                                                      std::memory_order_acquire,
+                                                      std::memory_order_relaxed))) {
+            lock_slow();
+        }
+        LOCK_PROFILE_END_WAIT
+        return 0;
+    };
+    inline int trylock()
+    {
+        DEFINED_NO_THREAD_LOCK_RETURN_0
+        int expected = LOCK_FREE;
+        int ret = m_state.compare_exchange_strong(expected, LOCK_LOCKED,
+                                                  std::memory_order_acquire,
+                                                  std::memory_order_relaxed)
+            ? 0
+            : EBUSY;
+        LOCK_PROFILE_TRYLOCK(ret)
+        return ret;
+    };
+    inline int unlock()
+    {
+        DEFINED_NO_THREAD_LOCK_RETURN_0
+        LOCK_PROFILE_UNLOCK
+        if (unlikely(m_state.exchange(LOCK_FREE, std::memory_order_release) == LOCK_PARKED)) {
+            syscall(SYS_futex, reinterpret_cast<int *>(&m_state), FUTEX_WAKE_PRIVATE, 1, NULL,
+                    NULL, 0);
+        }
+        return 0;
+    };
+
+protected:
+    enum { LOCK_FREE = 0, LOCK_LOCKED = 1, LOCK_PARKED = 2 };
+
+    void lock_slow()
+    {
+        int backoff = 1;
+
+        for (int round = 0; round < LOCK_ADAPTIVE_SPIN_ROUNDS; round++) {
+            for (int i = 0; i < backoff; i++) {
+                cpu_relax();
+            }
+            backoff <<= 1;
+
+            int state = m_state.load(std::memory_order_relaxed);
+            if (state == LOCK_FREE &&
+                m_state.compare_exchange_weak(state, LOCK_LOCKED, std::memory_order_acquire,
+                                              std::memory_order_relaxed)) {
+                return;
+            }
+            if (state == LOCK_PARKED) {
+                // Other waiters are already parked, do not overtake them
+                break;
+            }
+        }
+
+        // The lock is taken as parked, unlock() wakes one of the possible waiters
+        while (m_state.exchange(LOCK_PARKED, std::memory_order_acquire) != LOCK_FREE) {
+            syscall(SYS_futex, reinterpret_cast<int *>(&m_state), FUTEX_WAIT_PRIVATE,
+                    LOCK_PARKED, NULL, NULL, 0);
+        }
+    }
+
+    std::atomic<int> m_state;
+};
+
+/**
+ * Adaptive recursive lock
+ */
+/* coverity[missing_move_assignment] */
+class lock_adaptive_recursive : public lock_adaptive {
+public:
+    lock_adaptive_recursive(const char *name = "lock_adaptive_recursive")
+        : lock_adaptive(name)
+        , m_lock_count(0)
+    {
+        memset(&m_invalid_owner, 0xff, sizeof(m_invalid_owner));
+        m_owner = m_invalid_owner;
+    };
+    ~lock_adaptive_recursive() {};
+
+    inline int lock()
+    {
+        DEFINED_NO_THREAD_LOCK_RETURN_0
+        pthread_t self = pthread_self();
+        if (m_owner == self) {
+            ++m_lock_count;
+            return 0;
+        }
+        int ret = lock_adaptive::lock();
+        if (likely(ret == 0)) {
+            ++m_lock_count;
+            m_owner = self;
+        }
+        return ret;
+    };
+    inline int trylock()
+    {
+        DEFINED_NO_THREAD_LOCK_RETURN_0
+        pthread_t self = pthread_self();
+        if (m_owner == self) {
+            ++m_lock_count;
+            return 0;
+        }
+        int ret = lock_adaptive::trylock();
+        if (ret == 0) {
+            ++m_lock_count;
+            m_owner = self;
+        }
+        return ret;
+    };
+    inline int unlock()
+    {
+        DEFINED_NO_THREAD_LOCK_RETURN_0
+        if (--m_lock_count == 0) {
+            m_owner = m_invalid_owner;
+            return lock_adaptive::unlock();
+        }
+        return 0;
+    };
+    inline int is_locked_by_me()
+    {
+        DEFINED_NO_THREAD_LOCK_RETURN_1
+        pthread_t self = pthread_self();
+        return ((m_owner == self && m_lock_count) ? m_lock_count : 0);
+    };
+
+protected:
+    pthread_t m_owner;
+    pthread_t m_invalid_owner;
+    int m_lock_count;
+};
+
 /**
  * pthread rwlock
  */
@@ -456,6 +681,10 @@ public:
             lock = (_recursive == MULTILOCK_RECURSIVE) ? new lock_mutex_recursive(_str)
                                                        : new lock_mutex(_str);
             break;
+        case MULTILOCK_ADAPTIVE:
+            lock = (_recursive == MULTILOCK_RECURSIVE) ? new lock_adaptive_recursive(_str)
+                                                       : new lock_adaptive(_str);
+            break;
         default:
             vlog_printf(VLOG_ERROR, "multilock type is not supported.\n");
             return;
@@ -0,0 +1,70 @@
+/*
+ * Copyright (c) 2001-2023 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ *
+ * This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING in the main directory of this source tree, or the
+ * BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <sys/epoll.h>
+
+#include "vlogger/vlogger.h"
+#include "core/sock/sock-redirect.h"
+#include "core/util/sys_vars.h"
+#include "core/dev/ring.h"
+
+/* Unit tests build some library sources directly into the test binary and these are the
+ * globals they use. Library internals are hidden, so a preloaded libxlio is not affected.
+ */
+vlog_levels_t g_vlogger_level = VLOG_NONE;
+os_api orig_os_api;
+__thread bool g_b_tx_db_defer_window = false;
+__thread bool g_b_tx_db_pending = false;
+__thread struct tx_db_pending_rings g_tx_db_pending_rings;
+std::atomic<uint64_t> g_tx_db_ring_gen(0);
+
+/* The parameters are zeroed and tests set only the fields which the tested code reads,
+ * the environment is not parsed.
+ */
+mce_sys_var &safe_mce_sys()
+{
+    static char s_sys_var[sizeof(mce_sys_var)] __attribute__((aligned(64)));
+    return *reinterpret_cast<mce_sys_var *>(s_sys_var);
+}
+
+void vlog_output(vlog_levels_t log_level, const char *fmt, ...)
+{
+    (void)log_level;
+    (void)fmt;
+}
+
+static void __attribute__((constructor)) core_stubs_init(void)
+{
+    orig_os_api.close = close;
+    orig_os_api.write = write;
+    orig_os_api.epoll_ctl = epoll_ctl;
+}
@@ -0,0 +1,168 @@
+/*
+ * Copyright (c) 2001-2023 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ *
+ * This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING in the main directory of this source tree, or the
+ * BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <sys/mman.h>
+
+#include "common/def.h"
+#include "common/log.h"
+#include "common/sys.h"
+#include "common/base.h"
+#include "common/cmn.h"
+
+#include "udp/udp_base.h"
+#include "xlio_base.h"
+
+#if defined(EXTRA_API_ENABLED) && (EXTRA_API_ENABLED == 1)
+
+class xlio_recv_memory : public xlio_base {
+protected:
+    void SetUp()
+    {
+        uint64_t xlio_extra_api_cap =
+            XLIO_EXTRA_API_REGISTER_RECV_MEMORY | XLIO_EXTRA_API_RECVFROM_ZCOPY;
+
+        xlio_base::SetUp();
+
+        SKIP_TRUE((xlio_api->cap_mask & xlio_extra_api_cap) == xlio_extra_api_cap,
+                  "This test requires XLIO capabilities as XLIO_EXTRA_API_REGISTER_RECV_MEMORY "
+                  "XLIO_EXTRA_API_RECVFROM_ZCOPY");
+
+        m_region = mmap(NULL, m_region_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS,
+                        -1, 0);
+        ASSERT_NE(MAP_FAILED, m_region);
+    }
+    void TearDown()
+    {
+        if (m_region && m_region != MAP_FAILED) {
+            munmap(m_region, m_region_size);
+        }
+        xlio_base::TearDown();
+    }
+
+    bool is_in_region(const void *ptr) const
+    {
+        return (uintptr_t)ptr >= (uintptr_t)m_region &&
+            (uintptr_t)ptr < (uintptr_t)m_region + m_region_size;
+    }
+
+    udp_base_sock m_udp_base;
+    void *m_region = NULL;
+    const size_t m_region_size = 1024 * 1024;
+};
+
+/**
+ * @test xlio_recv_memory.ti_1_buffer_return
+ * @brief
+ *    Freed zero-copy packets return to the pool over the registered memory
+ * @details
+ *    Many more packets than the region can hold are received one by one. Every
+ *    packet must land in the region, so the ring keeps getting its buffers back.
+ */
+TEST_F(xlio_recv_memory, ti_1_buffer_return)
+{
+    const int packets = 8 * (m_region_size / 2048);
+    char msg[64];
+
+    memset(msg, 'x', sizeof(msg));
+
+    int pid = fork();
+
+    if (0 == pid) { /* I am the child */
+        char ack;
+
+        barrier_fork(pid);
+
+        int fd = m_udp_base.sock_create_to(m_family, false, 10);
+        ASSERT_LE(0, fd);
+
+        int rc = bind(fd, (struct sockaddr *)&client_addr, sizeof(client_addr));
+        ASSERT_EQ(0, rc);
+
+        for (int i = 0; i < packets; i++) {
+            rc = sendto(fd, msg, sizeof(msg), 0, (struct sockaddr *)&server_addr,
+                        sizeof(server_addr));
+            ASSERT_EQ((int)sizeof(msg), rc);
+            rc = recv(fd, &ack, sizeof(ack), 0);
+            ASSERT_EQ(1, rc) << "packet " << i;
+        }
+
+        close(fd);
+
+        /* This exit is very important, otherwise the fork
+         * keeps running and may duplicate other tests.
+         */
+        exit(testing::Test::HasFailure());
+    } else { /* I am the parent */
+        char buf[sizeof(xlio_recvfrom_zcopy_packets_t) + sizeof(xlio_recvfrom_zcopy_packet_t) +
+                 sizeof(iovec)];
+        struct xlio_recvfrom_zcopy_packets_t *xlio_packets =
+            (struct xlio_recvfrom_zcopy_packets_t *)buf;
+        struct xlio_recvfrom_zcopy_packet_t *xlio_packet = &xlio_packets->pkts[0];
+        char ack = 'a';
+
+        int fd = m_udp_base.sock_create_to(m_family, false, 10);
+        ASSERT_LE(0, fd);
+
+        int rc = xlio_api->register_recv_memory(fd, m_region, m_region_size);
+        ASSERT_EQ(0, rc);
+
+        rc = bind(fd, (struct sockaddr *)&server_addr, sizeof(server_addr));
+        ASSERT_EQ(0, rc);
+
+        barrier_fork(pid);
+
+        for (int i = 0; i < packets; i++) {
+            int flags = 0;
+
+            rc = xlio_api->recvfrom_zcopy(fd, buf, sizeof(buf), &flags, NULL, NULL);
+            ASSERT_EQ((int)sizeof(msg), rc) << "packet " << i;
+            ASSERT_TRUE(flags & MSG_XLIO_ZCOPY);
+            ASSERT_EQ(1U, xlio_packets->n_packet_num);
+            ASSERT_EQ(1U, xlio_packet->sz_iov);
+            EXPECT_TRUE(is_in_region(xlio_packet->iov[0].iov_base)) << "packet " << i;
+            EXPECT_EQ(0, memcmp(xlio_packet->iov[0].iov_base, msg, sizeof(msg)));
+
+            rc = xlio_api->recvfrom_zcopy_free_packets(fd, xlio_packets->pkts, 1);
+            ASSERT_EQ(0, rc);
+
+            rc = sendto(fd, &ack, sizeof(ack), 0, (struct sockaddr *)&client_addr,
+                        sizeof(client_addr));
+            ASSERT_EQ(1, rc);
+        }
+
+        close(fd);
+
+        ASSERT_EQ(0, wait_fork(pid));
+    }
+}
+
+#endif /* EXTRA_API_ENABLED */
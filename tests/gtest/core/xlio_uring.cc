@@ -0,0 +1,188 @@
+/*
+ * Copyright (c) 2001-2023 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ *
+ * This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING in the main directory of this source tree, or the
+ * BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "common/def.h"
+#include "common/log.h"
+#include "common/sys.h"
+#include "common/base.h"
+#include "common/cmn.h"
+
+#if defined(EXTRA_API_ENABLED) && (EXTRA_API_ENABLED == 1)
+
+#include "udp/udp_base.h"
+#include "xlio_base.h"
+
+class xlio_uring_api : public xlio_base {
+protected:
+    void SetUp()
+    {
+        uint64_t xlio_extra_api_cap = XLIO_EXTRA_API_URING;
+
+        xlio_base::SetUp();
+
+        SKIP_TRUE((xlio_api->cap_mask & xlio_extra_api_cap) == xlio_extra_api_cap,
+                  "This test requires XLIO capabilities as XLIO_EXTRA_API_URING");
+    }
+    void TearDown() { xlio_base::TearDown(); }
+
+    udp_base_sock m_udp_base_sock;
+};
+
+/**
+ * @test xlio_uring_api.ti_1
+ * @brief
+ *    Ring setup with invalid number of entries
+ * @details
+ */
+TEST_F(xlio_uring_api, ti_1)
+{
+    struct xlio_uring *ring;
+
+    errno = EOK;
+    ring = xlio_api->uring_setup(0);
+    EXPECT_TRUE(ring == NULL);
+    EXPECT_EQ(EINVAL, errno);
+
+    errno = EOK;
+    EXPECT_EQ(-1, xlio_api->uring_enter(NULL, 0));
+    EXPECT_EQ(EINVAL, errno);
+
+    ring = xlio_api->uring_setup(5);
+    ASSERT_TRUE(ring != NULL);
+    EXPECT_EQ(7U, ring->sq_mask);
+    EXPECT_EQ(15U, ring->cq_mask);
+
+    errno = EOK;
+    EXPECT_EQ(-1, xlio_api->uring_enter(ring, ring->cq_mask + 2));
+    EXPECT_EQ(EINVAL, errno);
+
+    EXPECT_EQ(0, xlio_api->uring_destroy(ring));
+}
+
+/**
+ * @test xlio_uring_api.ti_2
+ * @brief
+ *    NOP operations complete in submission order
+ * @details
+ */
+TEST_F(xlio_uring_api, ti_2)
+{
+    struct xlio_uring *ring;
+    struct xlio_uring_sqe *sqe;
+    struct xlio_uring_cqe *cqe;
+    unsigned int i;
+
+    ring = xlio_api->uring_setup(4);
+    ASSERT_TRUE(ring != NULL);
+
+    for (i = 0; i < 4; i++) {
+        sqe = xlio_uring_get_sqe(ring, i);
+        ASSERT_TRUE(sqe != NULL);
+        memset(sqe, 0, sizeof(*sqe));
+        sqe->opcode = XLIO_URING_OP_NOP;
+        sqe->user_data = i;
+    }
+    EXPECT_TRUE(xlio_uring_get_sqe(ring, 4) == NULL);
+    xlio_uring_submit(ring, 4);
+
+    EXPECT_EQ(4, xlio_api->uring_enter(ring, 4));
+
+    for (i = 0; i < 4; i++) {
+        cqe = xlio_uring_peek_cqe(ring);
+        ASSERT_TRUE(cqe != NULL);
+        EXPECT_EQ(i, cqe->user_data);
+        EXPECT_EQ(0, cqe->res);
+        xlio_uring_cqe_seen(ring);
+    }
+    EXPECT_TRUE(xlio_uring_peek_cqe(ring) == NULL);
+
+    EXPECT_EQ(0, xlio_api->uring_destroy(ring));
+}
+
+/**
+ * @test xlio_uring_api.ti_3
+ * @brief
+ *    Pending receive is cancelled by close of the socket
+ * @details
+ */
+TEST_F(xlio_uring_api, ti_3)
+{
+    struct xlio_uring *ring;
+    struct xlio_uring_sqe *sqe;
+    struct xlio_uring_cqe *cqe;
+    char buf[64];
+    int fd;
+
+    fd = m_udp_base_sock.sock_create_fa(m_family, false);
+    ASSERT_LE(0, fd);
+    ASSERT_EQ(0, bind(fd, &server_addr.addr, sizeof(server_addr)));
+
+    ring = xlio_api->uring_setup(4);
+    ASSERT_TRUE(ring != NULL);
+
+    sqe = xlio_uring_get_sqe(ring, 0);
+    memset(sqe, 0, sizeof(*sqe));
+    sqe->opcode = XLIO_URING_OP_RECV;
+    sqe->fd = fd;
+    sqe->addr = (uintptr_t)buf;
+    sqe->len = sizeof(buf);
+    sqe->user_data = 1;
+    xlio_uring_submit(ring, 1);
+
+    EXPECT_EQ(1, xlio_api->uring_enter(ring, 0));
+    EXPECT_TRUE(xlio_uring_peek_cqe(ring) == NULL);
+
+    sqe = xlio_uring_get_sqe(ring, 0);
+    memset(sqe, 0, sizeof(*sqe));
+    sqe->opcode = XLIO_URING_OP_CLOSE;
+    sqe->fd = fd;
+    sqe->user_data = 2;
+    xlio_uring_submit(ring, 1);
+
+    EXPECT_EQ(1, xlio_api->uring_enter(ring, 2));
+
+    cqe = xlio_uring_peek_cqe(ring);
+    ASSERT_TRUE(cqe != NULL);
+    EXPECT_EQ(1U, cqe->user_data);
+    EXPECT_EQ(-ECANCELED, cqe->res);
+    xlio_uring_cqe_seen(ring);
+
+    cqe = xlio_uring_peek_cqe(ring);
+    ASSERT_TRUE(cqe != NULL);
+    EXPECT_EQ(2U, cqe->user_data);
+    EXPECT_EQ(0, cqe->res);
+    xlio_uring_cqe_seen(ring);
+
+    EXPECT_EQ(0, xlio_api->uring_destroy(ring));
+}
+
+#endif /* EXTRA_API_ENABLED */
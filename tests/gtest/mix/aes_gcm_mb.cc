@@ -0,0 +1,325 @@
+/*
+ * Copyright (c) 2001-2023 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ *
+ * This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING in the main directory of this source tree, or the
+ * BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "common/def.h"
+#include "common/log.h"
+#include "common/sys.h"
+#include "common/base.h"
+#include "common/cmn.h"
+
+#include <dlfcn.h>
+
+#include "mix_base.h"
+
+#include "src/core/util/aes_gcm_mb.h"
+
+/* Same as TLS_RX_BATCH_RECORD_MAX of the TLS RX batch. */
+#define AES_GCM_MB_TEST_RECORD_MAX 1024U
+
+/* Test cases 2, 4 and 16 of "The Galois/Counter Mode of Operation (GCM)", McGrew, Viega. */
+static const char *tc_key_128 = "feffe9928665731c6d6a8f9467308308";
+static const char *tc_key_256 = "feffe9928665731c6d6a8f9467308308feffe9928665731c6d6a8f9467308308";
+static const char *tc_iv = "cafebabefacedbaddecaf888";
+static const char *tc_aad = "feedfacedeadbeeffeedfacedeadbeefabaddad2";
+static const char *tc_plain = "d9313225f88406e5a55909c5aff5269a86a7a9531534f7da2e4c303d8a318a72"
+                              "1c3c0c95956809532fcf0e2449a6b525b16aedf5aa0de657ba637b39";
+static const char *tc_cipher_128 = "42831ec2217774244b7221b784d0d49ce3aa212f2c02a4e0"
+                                   "35c17e2329aca12e21d514b25466931c7d8f6a5aac84aa05"
+                                   "1ba30b396a0aac973d58e091";
+static const char *tc_tag_128 = "5bc94fbc3221a5db94fae95ae7121a47";
+static const char *tc_cipher_256 = "522dc1f099567d07f47f37a32a84427d643a8cdcbfe5c0c9"
+                                   "7598a2bd2555d1aa8cb08e48590dbb3da7b08b1056828838"
+                                   "c5f61e6393ba7a0abcc9f662";
+static const char *tc_tag_256 = "76fc6ece0f4e1768cddf8853bb2d551b";
+static const char *tc_zero_cipher = "0388dace60b6a392f328c2b971b2fe78";
+static const char *tc_zero_tag = "ab6e47d42cec13bdf53a67b21257bddf";
+
+class aes_gcm_mb_test : public mix_base {
+protected:
+    std::vector<uint8_t> unhex(const char *str)
+    {
+        std::vector<uint8_t> out;
+
+        for (size_t i = 0; str[i] && str[i + 1]; i += 2) {
+            char byte[3] = {str[i], str[i + 1], 0};
+            out.push_back((uint8_t)strtoul(byte, NULL, 16));
+        }
+        return out;
+    }
+
+    void SetUp()
+    {
+        mix_base::SetUp();
+        SKIP_TRUE(aes_gcm_mb_supported(), "AES-NI is not supported");
+    }
+
+    /* Reference AES-GCM encryption with OpenSSL libcrypto, loaded at runtime. */
+    struct evp_api {
+        void *(*EVP_CIPHER_CTX_new)(void);
+        void (*EVP_CIPHER_CTX_free)(void *);
+        const void *(*EVP_aes_128_gcm)(void);
+        const void *(*EVP_aes_256_gcm)(void);
+        int (*EVP_EncryptInit_ex)(void *, const void *, void *, const uint8_t *, const uint8_t *);
+        int (*EVP_EncryptUpdate)(void *, uint8_t *, int *, const uint8_t *, int);
+        int (*EVP_EncryptFinal_ex)(void *, uint8_t *, int *);
+        int (*EVP_CIPHER_CTX_ctrl)(void *, int, int, void *);
+    };
+
+    template <typename T> void evp_sym(T &ptr, void *handle, const char *name)
+    {
+        ptr = reinterpret_cast<T>(dlsym(handle, name));
+    }
+
+    bool evp_load(struct evp_api &api)
+    {
+        const char *names[] = {"libcrypto.so.3", "libcrypto.so.1.1", "libcrypto.so"};
+        void *handle = NULL;
+
+        for (size_t i = 0; !handle && i < sizeof(names) / sizeof(names[0]); ++i) {
+            handle = dlopen(names[i], RTLD_NOW);
+        }
+        if (!handle) {
+            return false;
+        }
+        evp_sym(api.EVP_CIPHER_CTX_new, handle, "EVP_CIPHER_CTX_new");
+        evp_sym(api.EVP_CIPHER_CTX_free, handle, "EVP_CIPHER_CTX_free");
+        evp_sym(api.EVP_aes_128_gcm, handle, "EVP_aes_128_gcm");
+        evp_sym(api.EVP_aes_256_gcm, handle, "EVP_aes_256_gcm");
+        evp_sym(api.EVP_EncryptInit_ex, handle, "EVP_EncryptInit_ex");
+        evp_sym(api.EVP_EncryptUpdate, handle, "EVP_EncryptUpdate");
+        evp_sym(api.EVP_EncryptFinal_ex, handle, "EVP_EncryptFinal_ex");
+        evp_sym(api.EVP_CIPHER_CTX_ctrl, handle, "EVP_CIPHER_CTX_ctrl");
+        return api.EVP_CIPHER_CTX_new && api.EVP_CIPHER_CTX_free && api.EVP_aes_128_gcm &&
+            api.EVP_aes_256_gcm && api.EVP_EncryptInit_ex && api.EVP_EncryptUpdate &&
+            api.EVP_EncryptFinal_ex && api.EVP_CIPHER_CTX_ctrl;
+    }
+
+    /* Encrypts 'data' in place and returns the tag. */
+    bool evp_encrypt(struct evp_api &api, const std::vector<uint8_t> &key, const uint8_t *iv,
+                     const std::vector<uint8_t> &aad, std::vector<uint8_t> &data, uint8_t *tag)
+    {
+        const int EVP_CTRL_GCM_GET_TAG = 0x10;
+        void *ctx = api.EVP_CIPHER_CTX_new();
+        bool ok;
+        int len;
+
+        const void *cipher = key.size() == 16 ? api.EVP_aes_128_gcm() : api.EVP_aes_256_gcm();
+        uint8_t *buf = data.data();
+
+        ok = ctx && api.EVP_EncryptInit_ex(ctx, cipher, NULL, key.data(), iv) &&
+            (aad.empty() || api.EVP_EncryptUpdate(ctx, NULL, &len, aad.data(), aad.size())) &&
+            (data.empty() || api.EVP_EncryptUpdate(ctx, buf, &len, buf, data.size())) &&
+            api.EVP_EncryptFinal_ex(ctx, data.data() + data.size(), &len) &&
+            api.EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_GCM_GET_TAG, AES_GCM_MB_TAG_LEN, tag);
+        if (ctx) {
+            api.EVP_CIPHER_CTX_free(ctx);
+        }
+        return ok;
+    }
+
+    /* Splits 'data' into up to 'max' segments, mostly of odd lengths. */
+    uint32_t split(std::vector<uint8_t> &data, struct iovec *iov, uint32_t max)
+    {
+        size_t pos = 0;
+        uint32_t nr = 0;
+
+        if (rand() % 4 == 0) {
+            /* Contiguous record, the fast paths see full 64 byte strides. */
+            iov[nr++] = {data.data(), data.size()};
+            return nr;
+        }
+        while (pos < data.size()) {
+            size_t len = (nr == max - 1) ? data.size() - pos : 1 + 2 * (rand() % 100);
+
+            len = std::min(len, data.size() - pos);
+            iov[nr++] = {&data[pos], len};
+            pos += len;
+        }
+        return nr;
+    }
+};
+
+/**
+ * @test aes_gcm_mb_test.ti_1
+ * @brief
+ *    Encrypt a batch of jobs with different key sizes and scattered data
+ * @details
+ */
+TEST_F(aes_gcm_mb_test, ti_1)
+{
+    std::vector<uint8_t> key_128 = unhex(tc_key_128);
+    std::vector<uint8_t> key_256 = unhex(tc_key_256);
+    std::vector<uint8_t> key_zero(16, 0);
+    std::vector<uint8_t> iv = unhex(tc_iv);
+    std::vector<uint8_t> iv_zero(AES_GCM_MB_IV_LEN, 0);
+    std::vector<uint8_t> aad = unhex(tc_aad);
+    std::vector<uint8_t> data_128 = unhex(tc_plain);
+    std::vector<uint8_t> data_256 = unhex(tc_plain);
+    std::vector<uint8_t> data_zero(16, 0);
+    uint8_t tag[3][AES_GCM_MB_TAG_LEN];
+    struct aes_gcm_mb_key keys[3];
+    struct aes_gcm_mb_job jobs[3];
+    struct iovec iov_128[3] = {{&data_128[0], 7}, {&data_128[7], 50}, {&data_128[57], 3}};
+    struct iovec iov_256 = {&data_256[0], data_256.size()};
+    struct iovec iov_zero = {&data_zero[0], data_zero.size()};
+
+    ASSERT_TRUE(aes_gcm_mb_key_init(&keys[0], &key_128[0], key_128.size()));
+    ASSERT_TRUE(aes_gcm_mb_key_init(&keys[1], &key_256[0], key_256.size()));
+    ASSERT_TRUE(aes_gcm_mb_key_init(&keys[2], &key_zero[0], key_zero.size()));
+    ASSERT_FALSE(aes_gcm_mb_key_init(&keys[2], &key_zero[0], 24));
+
+    jobs[0] = {&keys[0], &iv[0], &aad[0], (uint32_t)aad.size(), iov_128, 3, tag[0], false};
+    jobs[1] = {&keys[1], &iv[0], &aad[0], (uint32_t)aad.size(), &iov_256, 1, tag[1], false};
+    jobs[2] = {&keys[2], &iv_zero[0], NULL, 0, &iov_zero, 1, tag[2], false};
+    aes_gcm_mb_process(jobs, 3, false);
+
+    EXPECT_TRUE(unhex(tc_cipher_128) == data_128);
+    EXPECT_EQ(0, memcmp(tag[0], &unhex(tc_tag_128)[0], AES_GCM_MB_TAG_LEN));
+    EXPECT_TRUE(unhex(tc_cipher_256) == data_256);
+    EXPECT_EQ(0, memcmp(tag[1], &unhex(tc_tag_256)[0], AES_GCM_MB_TAG_LEN));
+    EXPECT_TRUE(unhex(tc_zero_cipher) == data_zero);
+    EXPECT_EQ(0, memcmp(tag[2], &unhex(tc_zero_tag)[0], AES_GCM_MB_TAG_LEN));
+}
+
+/**
+ * @test aes_gcm_mb_test.ti_2
+ * @brief
+ *    Decrypt a batch where one job has a corrupted tag
+ * @details
+ */
+TEST_F(aes_gcm_mb_test, ti_2)
+{
+    std::vector<uint8_t> key = unhex(tc_key_256);
+    std::vector<uint8_t> iv = unhex(tc_iv);
+    std::vector<uint8_t> aad = unhex(tc_aad);
+    std::vector<uint8_t> data[2] = {unhex(tc_cipher_256), unhex(tc_cipher_256)};
+    std::vector<uint8_t> tag[2] = {unhex(tc_tag_256), unhex(tc_tag_256)};
+    struct aes_gcm_mb_key aes_key;
+    struct aes_gcm_mb_job jobs[2];
+    struct iovec iov[2] = {{&data[0][0], data[0].size()}, {&data[1][0], data[1].size()}};
+
+    ASSERT_TRUE(aes_gcm_mb_key_init(&aes_key, &key[0], key.size()));
+    tag[1][5] ^= 0x1;
+
+    for (int i = 0; i < 2; ++i) {
+        jobs[i] = {&aes_key, &iv[0], &aad[0], (uint32_t)aad.size(), &iov[i], 1, &tag[i][0], false};
+    }
+    aes_gcm_mb_process(jobs, 2, true);
+
+    EXPECT_TRUE(jobs[0].auth_ok);
+    EXPECT_FALSE(jobs[1].auth_ok);
+    EXPECT_TRUE(unhex(tc_plain) == data[0]);
+    EXPECT_TRUE(unhex(tc_plain) == data[1]);
+}
+
+/**
+ * @test aes_gcm_mb_test.ti_3
+ * @brief
+ *    Cross-check random batches with OpenSSL
+ * @details
+ *    Records up to the TLS RX batch limit are split into odd sized segments and
+ *    processed in batches of up to AES_GCM_MB_LANES_MAX jobs, with and without
+ *    the VAES bulk phase.
+ */
+TEST_F(aes_gcm_mb_test, ti_3)
+{
+    struct evp_api api;
+
+    SKIP_TRUE(evp_load(api), "libcrypto is not available");
+
+    srand(4);
+    for (int pass = 0; pass < 2; ++pass) {
+        aes_gcm_mb_vaes_enable(pass == 0);
+
+        for (int iter = 0; iter < 100; ++iter) {
+            uint32_t nr = (iter % 2) ? AES_GCM_MB_LANES_MAX : 1 + rand() % AES_GCM_MB_LANES_MAX;
+            std::vector<uint8_t> key[AES_GCM_MB_LANES_MAX];
+            std::vector<uint8_t> aad[AES_GCM_MB_LANES_MAX];
+            std::vector<uint8_t> plain[AES_GCM_MB_LANES_MAX];
+            std::vector<uint8_t> data[AES_GCM_MB_LANES_MAX];
+            std::vector<uint8_t> ref[AES_GCM_MB_LANES_MAX];
+            uint8_t iv[AES_GCM_MB_LANES_MAX][AES_GCM_MB_IV_LEN];
+            uint8_t ref_tag[AES_GCM_MB_LANES_MAX][AES_GCM_MB_TAG_LEN];
+            uint8_t tag[AES_GCM_MB_LANES_MAX][AES_GCM_MB_TAG_LEN];
+            struct iovec iov[AES_GCM_MB_LANES_MAX][16];
+            struct aes_gcm_mb_key keys[AES_GCM_MB_LANES_MAX];
+            struct aes_gcm_mb_job jobs[AES_GCM_MB_LANES_MAX];
+
+            for (uint32_t i = 0; i < nr; ++i) {
+                key[i].resize(rand() % 2 ? 16 : 32);
+                aad[i].resize(rand() % 3 ? 13 : rand() % 40);
+                plain[i].resize(rand() % (AES_GCM_MB_TEST_RECORD_MAX + 1));
+                for (auto &b : key[i]) {
+                    b = rand();
+                }
+                for (auto &b : aad[i]) {
+                    b = rand();
+                }
+                for (auto &b : plain[i]) {
+                    b = rand();
+                }
+                for (auto &b : iv[i]) {
+                    b = rand();
+                }
+                ref[i] = plain[i];
+                ASSERT_TRUE(evp_encrypt(api, key[i], iv[i], aad[i], ref[i], ref_tag[i]));
+
+                data[i] = plain[i];
+                ASSERT_TRUE(aes_gcm_mb_key_init(&keys[i], key[i].data(), key[i].size()));
+                jobs[i] = {&keys[i], iv[i], aad[i].data(), (uint32_t)aad[i].size(), iov[i],
+                           split(data[i], iov[i], 16), tag[i], false};
+            }
+
+            aes_gcm_mb_process(jobs, nr, false);
+            for (uint32_t i = 0; i < nr; ++i) {
+                EXPECT_TRUE(ref[i] == data[i])
+                    << "pass=" << pass << " iter=" << iter << " job=" << i;
+                EXPECT_EQ(0, memcmp(ref_tag[i], tag[i], AES_GCM_MB_TAG_LEN))
+                    << "pass=" << pass << " iter=" << iter << " job=" << i;
+            }
+
+            /* Decrypt back with fresh segmentation, the last job has a corrupted tag. */
+            tag[nr - 1][rand() % AES_GCM_MB_TAG_LEN] ^= 0x80;
+            for (uint32_t i = 0; i < nr; ++i) {
+                jobs[i].iov_nr = split(data[i], iov[i], 16);
+            }
+            aes_gcm_mb_process(jobs, nr, true);
+            for (uint32_t i = 0; i < nr; ++i) {
+                EXPECT_EQ(i != nr - 1, jobs[i].auth_ok)
+                    << "pass=" << pass << " iter=" << iter << " job=" << i;
+                EXPECT_TRUE(plain[i] == data[i])
+                    << "pass=" << pass << " iter=" << iter << " job=" << i;
+            }
+        }
+    }
+    aes_gcm_mb_vaes_enable(true);
+}
@@ -0,0 +1,110 @@
+/*
+ * Copyright (c) 2001-2023 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ *
+ * This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING in the main directory of this source tree, or the
+ * BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "common/def.h"
+#include "common/log.h"
+#include "common/sys.h"
+#include "common/base.h"
+#include "common/cmn.h"
+
+#include "mix_base.h"
+
+#include "src/core/util/crc32c.h"
+
+class crc32c_test : public mix_base {
+protected:
+    /* Bitwise reference implementation. */
+    uint32_t crc32c_ref(uint32_t crc, const uint8_t *buf, size_t len)
+    {
+        while (len--) {
+            crc ^= *buf++;
+            for (int k = 0; k < 8; ++k) {
+                crc = (crc & 1) ? (crc >> 1) ^ 0x82f63b78U : crc >> 1;
+            }
+        }
+        return crc;
+    }
+};
+
+/**
+ * @test crc32c_test.ti_1
+ * @brief
+ *    Check known values from RFC 3720 (iSCSI) test vectors
+ * @details
+ */
+TEST_F(crc32c_test, ti_1)
+{
+    uint8_t buf[32];
+
+    EXPECT_EQ(0xe3069283U, crc32c("123456789", 9));
+
+    memset(buf, 0, sizeof(buf));
+    EXPECT_EQ(0x8a9136aaU, crc32c(buf, sizeof(buf)));
+    memset(buf, 0xff, sizeof(buf));
+    EXPECT_EQ(0x62a8ab43U, crc32c(buf, sizeof(buf)));
+    for (size_t i = 0; i < sizeof(buf); ++i) {
+        buf[i] = i;
+    }
+    EXPECT_EQ(0x46dd794eU, crc32c(buf, sizeof(buf)));
+    for (size_t i = 0; i < sizeof(buf); ++i) {
+        buf[i] = sizeof(buf) - 1 - i;
+    }
+    EXPECT_EQ(0x113fdb5cU, crc32c(buf, sizeof(buf)));
+}
+
+/**
+ * @test crc32c_test.ti_2
+ * @brief
+ *    Compare unaligned and chained buffers of different lengths with the reference
+ * @details
+ *    Lengths cover the interleaved stream loops and the tails.
+ */
+TEST_F(crc32c_test, ti_2)
+{
+    std::vector<uint8_t> buf(32768 + 64);
+    const size_t lens[] = {0, 1, 7, 8, 255, 768, 769, 1000, 6143, 6144, 6145, 20000, 32768};
+
+    srand(1);
+    for (auto &b : buf) {
+        b = rand();
+    }
+    for (size_t len : lens) {
+        for (size_t off = 0; off < 8; off += 3) {
+            uint32_t ref = crc32c_ref(~0U, &buf[off], len);
+            uint32_t crc = crc32c_update(~0U, &buf[off], len / 3);
+
+            EXPECT_EQ(ref, crc32c_update(~0U, &buf[off], len)) << "len=" << len;
+            crc = crc32c_update(crc, &buf[off + len / 3], len - len / 3);
+            EXPECT_EQ(ref, crc) << "chained len=" << len;
+        }
+    }
+}
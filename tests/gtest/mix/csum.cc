@@ -0,0 +1,256 @@
+/*
+ * Copyright (c) 2001-2023 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ *
+ * This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING in the main directory of this source tree, or the
+ * BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "common/def.h"
+#include "common/log.h"
+#include "common/sys.h"
+#include "common/base.h"
+#include "common/cmn.h"
+
+#include "mix_base.h"
+
+#include "src/core/util/csum.h"
+
+class csum_test : public mix_base {
+protected:
+    /* Scalar reference: 16-bit words, an odd trailing byte is padded with zero. */
+    uint16_t csum_ref(const uint8_t *buf, size_t len, uint32_t sum)
+    {
+        uint64_t acc = sum;
+        uint16_t word;
+
+        for (size_t i = 0; i + 1 < len; i += 2) {
+            memcpy(&word, &buf[i], sizeof(word));
+            acc += word;
+        }
+        if (len & 1) {
+            uint8_t last[2] = {buf[len - 1], 0};
+            memcpy(&word, last, sizeof(word));
+            acc += word;
+        }
+        while (acc >> 16) {
+            acc = (acc & 0xffff) + (acc >> 16);
+        }
+        return acc;
+    }
+
+    /* Folds the 64-bit accumulator of a kernel to 16 bits. */
+    uint16_t fold(uint64_t acc)
+    {
+        while (acc >> 16) {
+            acc = (acc & 0xffff) + (acc >> 16);
+        }
+        return acc;
+    }
+
+    /* 0 and 0xffff are both zero in one's complement arithmetic. */
+    uint16_t norm(uint16_t sum) { return sum == 0xffff ? 0 : sum; }
+};
+
+/**
+ * @test csum_test.ti_1
+ * @brief
+ *    Check that a valid IPv4 header sums to zero
+ * @details
+ */
+TEST_F(csum_test, ti_1)
+{
+    const uint8_t hdr[] = {0x45, 0x00, 0x00, 0x73, 0x00, 0x00, 0x40, 0x00, 0x40, 0x11,
+                           0xb8, 0x61, 0xc0, 0xa8, 0x00, 0x01, 0xc0, 0xa8, 0x00, 0xc7};
+    uint8_t copy[sizeof(hdr)];
+
+    EXPECT_EQ(0xffff, csum_fold(csum_partial(hdr, sizeof(hdr), 0)));
+    EXPECT_EQ(0xffff, csum_fold(csum_partial_copy(copy, hdr, sizeof(hdr), 0)));
+    EXPECT_EQ(0, memcmp(copy, hdr, sizeof(hdr)));
+}
+
+/**
+ * @test csum_test.ti_2
+ * @brief
+ *    Compare the dispatched and the copy kernels with the scalar reference
+ * @details
+ *    Lengths cover the vector loops and the tails, buffers are unaligned.
+ */
+TEST_F(csum_test, ti_2)
+{
+    std::vector<uint8_t> buf(65536 + 64);
+    std::vector<uint8_t> dst(buf.size());
+    const size_t lens[] = {0, 1, 2, 3, 15, 63, 64, 65, 127, 128, 129, 1471, 1472, 9000, 65536};
+
+    srand(1);
+    for (auto &b : buf) {
+        b = rand();
+    }
+    for (size_t len : lens) {
+        for (size_t off = 0; off < 8; off += 3) {
+            uint32_t init = rand();
+            uint16_t ref = norm(csum_ref(&buf[off], len, init));
+
+            EXPECT_EQ(ref, norm(csum_fold(csum_partial(&buf[off], len, init)))) << "len=" << len;
+
+            memset(dst.data(), 0, dst.size());
+            EXPECT_EQ(ref, norm(csum_fold(csum_partial_copy(&dst[off + 1], &buf[off], len, init))))
+                << "copy len=" << len;
+            EXPECT_EQ(0, memcmp(&dst[off + 1], &buf[off], len)) << "copy len=" << len;
+            EXPECT_EQ(0, dst[off + 1 + len]) << "copy len=" << len;
+        }
+    }
+}
+
+/**
+ * @test csum_test.ti_3
+ * @brief
+ *    Combine partial sums of blocks which start at odd offsets
+ * @details
+ */
+TEST_F(csum_test, ti_3)
+{
+    std::vector<uint8_t> buf(4096);
+
+    srand(2);
+    for (auto &b : buf) {
+        b = rand();
+    }
+    for (int i = 0; i < 100; ++i) {
+        size_t split1 = rand() % buf.size();
+        size_t split2 = split1 + rand() % (buf.size() - split1);
+        uint32_t sum = csum_partial(&buf[0], split1, 0);
+
+        sum = csum_add(sum, (split1 & 1) ? csum_odd(csum_partial(&buf[split1], split2 - split1, 0))
+                                         : csum_partial(&buf[split1], split2 - split1, 0));
+        sum = csum_add(sum, (split2 & 1)
+                           ? csum_odd(csum_partial(&buf[split2], buf.size() - split2, 0))
+                           : csum_partial(&buf[split2], buf.size() - split2, 0));
+        EXPECT_EQ(norm(csum_ref(buf.data(), buf.size(), 0)), norm(csum_fold(sum)))
+            << "split " << split1 << " " << split2;
+    }
+}
+
+/**
+ * @test csum_test.ti_4
+ * @brief
+ *    Copy from odd-length iovecs with memcpy_fromiovec_csum()
+ * @details
+ *    The data is copied in several calls which start at even offsets,
+ *    the way IPv6 fragments are filled.
+ */
+TEST_F(csum_test, ti_4)
+{
+    std::vector<uint8_t> buf(9000);
+    std::vector<uint8_t> dst(buf.size() + 1);
+    struct iovec iov[16];
+
+    srand(3);
+    for (auto &b : buf) {
+        b = rand();
+    }
+    for (int i = 0; i < 200; ++i) {
+        size_t total = 1 + rand() % buf.size();
+        size_t iov_nr = 0;
+        size_t pos = 0;
+
+        while (pos < total) {
+            size_t len = (iov_nr == 15) ? total - pos : 1 + 2 * (rand() % 600);
+
+            len = std::min(len, total - pos);
+            iov[iov_nr].iov_base = &buf[pos];
+            iov[iov_nr++].iov_len = len;
+            pos += len;
+        }
+
+        uint32_t sum = 0;
+        size_t chunk = 2 + 2 * (rand() % 1000);
+
+        memset(dst.data(), 0, dst.size());
+        for (pos = 0; pos < total; pos += chunk) {
+            size_t len = std::min(chunk, total - pos);
+
+            EXPECT_EQ((int)len, memcpy_fromiovec_csum(&dst[pos], iov, iov_nr, pos, len, sum));
+        }
+        EXPECT_EQ(norm(csum_ref(buf.data(), total, 0)), norm(csum_fold(sum)))
+            << "total=" << total << " chunk=" << chunk;
+        EXPECT_EQ(0, memcmp(dst.data(), buf.data(), total)) << "total=" << total;
+        EXPECT_EQ(0, dst[total]) << "total=" << total;
+    }
+}
+
+/**
+ * @test csum_test.ti_5
+ * @brief
+ *    Cross-check every kernel which the CPU supports with csum_sw
+ * @details
+ *    The dispatched kernel is only one of them, so each kernel is called
+ *    directly. Buffers are unaligned and lengths cover the vector loops,
+ *    the tails and blocks which start at odd offsets.
+ */
+TEST_F(csum_test, ti_5)
+{
+    const csum_kernel *kernels;
+    size_t count = csum_get_kernels(&kernels);
+    std::vector<uint8_t> buf(65536 + 64);
+    std::vector<uint8_t> dst(buf.size() + 1);
+    const size_t lens[] = {0,   1,   2,   3,    15,   31,   32,   33,   63,   64,   65,
+                           127, 128, 129, 255,  256,  257,  1471, 1472, 4096, 9000, 65536};
+
+    ASSERT_LE(1U, count);
+    ASSERT_STREQ("csum_sw", kernels[count - 1].name);
+    const csum_kernel &ref = kernels[count - 1];
+
+    srand(5);
+    for (auto &b : buf) {
+        b = rand();
+    }
+    for (size_t k = 0; k < count; ++k) {
+        log_trace("kernel: %s\n", kernels[k].name);
+        for (size_t len : lens) {
+            for (size_t off = 0; off < 8; off += 3) {
+                uint64_t init = rand();
+                uint16_t expected = norm(fold(ref.csum(&buf[off], len, init)));
+
+                EXPECT_EQ(expected, norm(fold(kernels[k].csum(&buf[off], len, init))))
+                    << kernels[k].name << " len=" << len << " off=" << off;
+                EXPECT_EQ(norm(csum_ref(&buf[off], len, 0)),
+                          norm(fold(kernels[k].csum(&buf[off], len, 0))))
+                    << kernels[k].name << " len=" << len << " off=" << off;
+
+                memset(dst.data(), 0, dst.size());
+                EXPECT_EQ(expected,
+                          norm(fold(kernels[k].csum_copy(&dst[off + 1], &buf[off], len, init))))
+                    << kernels[k].name << " copy len=" << len << " off=" << off;
+                EXPECT_EQ(0, memcmp(&dst[off + 1], &buf[off], len))
+                    << kernels[k].name << " copy len=" << len << " off=" << off;
+                EXPECT_EQ(0, dst[off + 1 + len])
+                    << kernels[k].name << " copy len=" << len << " off=" << off;
+            }
+        }
+    }
+}
@@ -0,0 +1,132 @@
+/*
+ * Copyright (c) 2001-2023 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ *
+ * This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING in the main directory of this source tree, or the
+ * BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "common/def.h"
+#include "common/log.h"
+#include "common/sys.h"
+#include "common/base.h"
+#include "common/cmn.h"
+
+#include "mix_base.h"
+
+#include "src/core/dev/ring_allocation_logic.h"
+
+#define OWNER  1
+#define THREAD 2
+#define OTHER  3
+
+class ring_migration : public mix_base {};
+
+/**
+ * @test ring_migration.ti_1_vote
+ * @brief
+ *    Candidate is replaced only when another key outweighs its traffic.
+ * @details
+ */
+TEST_F(ring_migration, ti_1_vote)
+{
+    ring_traffic_vote vote(100);
+
+    vote.account(OWNER, OWNER, 1000);
+    EXPECT_EQ(0U, vote.get_candidate());
+
+    vote.account(THREAD, OWNER, 1000);
+    EXPECT_EQ((uint64_t)THREAD, vote.get_candidate());
+
+    // Votes against the candidate, which keeps 100 bytes
+    vote.account(OTHER, OWNER, 900);
+    EXPECT_EQ((uint64_t)THREAD, vote.get_candidate());
+
+    // Outweighs the candidate by 100 bytes
+    vote.account(OTHER, OWNER, 200);
+    EXPECT_EQ((uint64_t)OTHER, vote.get_candidate());
+}
+
+/**
+ * @test ring_migration.ti_2_owner_share
+ * @brief
+ *    Candidate doesn't win a window with less than twice the owner traffic.
+ * @details
+ */
+TEST_F(ring_migration, ti_2_owner_share)
+{
+    ring_traffic_vote vote(2);
+
+    for (int i = 0; i < 10; i++) {
+        vote.account(OWNER, OWNER, 1000);
+        EXPECT_TRUE(vote.account(THREAD, OWNER, 1999));
+        EXPECT_EQ(0, vote.get_wins());
+    }
+    EXPECT_FALSE(vote.should_migrate(THREAD));
+
+    vote.account(OWNER, OWNER, 1000);
+    EXPECT_TRUE(vote.account(THREAD, OWNER, 2000));
+    EXPECT_EQ(1, vote.get_wins());
+}
+
+/**
+ * @test ring_migration.ti_3_hysteresis
+ * @brief
+ *    Migration is recommended after TRAFFIC_STABILITY_WINDOWS wins in a row,
+ *    a lost window starts over.
+ * @details
+ */
+TEST_F(ring_migration, ti_3_hysteresis)
+{
+    ring_traffic_vote vote(2);
+
+    for (int i = 1; i < TRAFFIC_STABILITY_WINDOWS; i++) {
+        EXPECT_FALSE(vote.account(THREAD, OWNER, 1000));
+        EXPECT_TRUE(vote.account(THREAD, OWNER, 1000));
+        EXPECT_EQ(i, vote.get_wins());
+        EXPECT_FALSE(vote.should_migrate(THREAD));
+    }
+
+    // Owner takes the traffic back
+    vote.account(OWNER, OWNER, 1000);
+    EXPECT_TRUE(vote.account(OWNER, OWNER, 1000));
+    EXPECT_EQ(0, vote.get_wins());
+    EXPECT_FALSE(vote.should_migrate(THREAD));
+
+    for (int i = 1; i <= TRAFFIC_STABILITY_WINDOWS; i++) {
+        vote.account(THREAD, OWNER, 1000);
+        EXPECT_TRUE(vote.account(THREAD, OWNER, 1000));
+        EXPECT_EQ(i, vote.get_wins());
+    }
+
+    // Only the candidate context performs the migration, once
+    EXPECT_FALSE(vote.should_migrate(OWNER));
+    EXPECT_FALSE(vote.should_migrate(OTHER));
+    EXPECT_TRUE(vote.should_migrate(THREAD));
+    EXPECT_FALSE(vote.should_migrate(THREAD));
+    EXPECT_EQ(0, vote.get_wins());
+}
@@ -0,0 +1,170 @@
+/*
+ * Copyright (c) 2001-2023 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ *
+ * This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING in the main directory of this source tree, or the
+ * BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "common/def.h"
+#include "common/log.h"
+#include "common/sys.h"
+#include "common/base.h"
+#include "common/cmn.h"
+
+#include "mix_base.h"
+
+#include "src/core/dev/net_device_table_mgr.h"
+#include "src/core/proto/dst_entry_tcp.h"
+
+class tx_mpw : public mix_base {
+protected:
+    void SetUp()
+    {
+        mix_base::SetUp();
+        memset(&m_tcp_hdr, 0, sizeof(m_tcp_hdr));
+        m_tcp_hdr.doff = sizeof(m_tcp_hdr) / 4;
+        m_tcp_hdr.ack = 1;
+    }
+    void TearDown()
+    {
+        safe_mce_sys().tx_db_defer_max = 0;
+        safe_mce_sys().tx_mpw_inline_max = 0;
+        g_b_tx_db_defer_window = false;
+        g_b_tx_db_pending = false;
+        mix_base::TearDown();
+    }
+
+    struct tcphdr m_tcp_hdr;
+};
+
+/**
+ * @test tx_mpw.ti_1_pure_ack
+ * @brief
+ *    Only ACK segments without payload get the MPW hint.
+ * @details
+ */
+TEST_F(tx_mpw, ti_1_pure_ack)
+{
+    uint32_t hdr_len = sizeof(m_tcp_hdr);
+
+    EXPECT_TRUE(tcp_is_pure_ack(&m_tcp_hdr, hdr_len));
+    EXPECT_FALSE(tcp_is_pure_ack(&m_tcp_hdr, hdr_len + 1));
+
+    // ACK with options, e.g. timestamps
+    m_tcp_hdr.doff = (sizeof(m_tcp_hdr) + 12) / 4;
+    EXPECT_TRUE(tcp_is_pure_ack(&m_tcp_hdr, hdr_len + 12));
+    EXPECT_FALSE(tcp_is_pure_ack(&m_tcp_hdr, hdr_len));
+    m_tcp_hdr.doff = sizeof(m_tcp_hdr) / 4;
+
+    m_tcp_hdr.syn = 1;
+    EXPECT_FALSE(tcp_is_pure_ack(&m_tcp_hdr, hdr_len));
+    m_tcp_hdr.syn = 0;
+
+    m_tcp_hdr.fin = 1;
+    EXPECT_FALSE(tcp_is_pure_ack(&m_tcp_hdr, hdr_len));
+    m_tcp_hdr.fin = 0;
+
+    m_tcp_hdr.rst = 1;
+    EXPECT_FALSE(tcp_is_pure_ack(&m_tcp_hdr, hdr_len));
+    m_tcp_hdr.rst = 0;
+
+    m_tcp_hdr.ack = 0;
+    EXPECT_FALSE(tcp_is_pure_ack(&m_tcp_hdr, hdr_len));
+}
+
+/**
+ * @test tx_mpw.ti_2_db_defer_window
+ * @brief
+ *    XLIO_TX_MPW_INLINE_MAX alone doesn't open the deferred doorbell window.
+ * @details
+ */
+TEST_F(tx_mpw, ti_2_db_defer_window)
+{
+    bool was_open;
+
+    safe_mce_sys().tx_db_defer_max = 0;
+    safe_mce_sys().tx_mpw_inline_max = 256;
+    EXPECT_FALSE(tx_db_defer_enabled());
+    tx_db_defer_window_open();
+    EXPECT_FALSE(g_b_tx_db_defer_window);
+    was_open = tx_db_defer_burst_begin();
+    EXPECT_FALSE(was_open);
+    EXPECT_FALSE(g_b_tx_db_defer_window);
+
+    safe_mce_sys().tx_db_defer_max = 16;
+    EXPECT_TRUE(tx_db_defer_enabled());
+    tx_db_defer_window_open();
+    EXPECT_TRUE(g_b_tx_db_defer_window);
+
+    safe_mce_sys().tx_mpw_inline_max = 0;
+    EXPECT_TRUE(tx_db_defer_enabled());
+}
+
+/**
+ * @test tx_mpw.ti_3_pending_rings
+ * @brief
+ *    Rings with postponed doorbells are collected once per thread, an overflow
+ *    or a destroyed ring makes the list stale.
+ * @details
+ */
+TEST_F(tx_mpw, ti_3_pending_rings)
+{
+    ring *rings[TX_DB_PENDING_RINGS_MAX + 1];
+
+    for (size_t i = 0; i < ARRAY_SIZE(rings); i++) {
+        rings[i] = reinterpret_cast<ring *>(0x1000 * (i + 1));
+    }
+
+    g_tx_db_ring_gen = 7;
+    tx_db_pending_add(rings[0]);
+    tx_db_pending_add(rings[1]);
+    tx_db_pending_add(rings[0]);
+    EXPECT_TRUE(g_b_tx_db_pending);
+    EXPECT_EQ(2U, g_tx_db_pending_rings.nr);
+    EXPECT_EQ(rings[0], g_tx_db_pending_rings.rings[0]);
+    EXPECT_EQ(rings[1], g_tx_db_pending_rings.rings[1]);
+    EXPECT_EQ(7U, g_tx_db_pending_rings.gen);
+
+    // A ring destroyed after the first postponed doorbell
+    g_tx_db_ring_gen = 8;
+    tx_db_pending_add(rings[2]);
+    EXPECT_NE(g_tx_db_ring_gen.load(), g_tx_db_pending_rings.gen);
+
+    // The list starts over after a flush
+    g_b_tx_db_pending = false;
+    tx_db_pending_add(rings[2]);
+    EXPECT_EQ(1U, g_tx_db_pending_rings.nr);
+    EXPECT_EQ(g_tx_db_ring_gen.load(), g_tx_db_pending_rings.gen);
+
+    g_b_tx_db_pending = false;
+    for (size_t i = 0; i < ARRAY_SIZE(rings); i++) {
+        tx_db_pending_add(rings[i]);
+    }
+    EXPECT_EQ((uint32_t)TX_DB_PENDING_RINGS_MAX, g_tx_db_pending_rings.nr);
+    EXPECT_NE(g_tx_db_ring_gen.load(), g_tx_db_pending_rings.gen);
+}
@@ -0,0 +1,189 @@
+/*
+ * Copyright (c) 2001-2023 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ *
+ * This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING in the main directory of this source tree, or the
+ * BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <sys/epoll.h>
+
+#include "common/def.h"
+#include "common/log.h"
+#include "common/sys.h"
+#include "common/base.h"
+#include "common/cmn.h"
+
+#include "mix_base.h"
+
+#include "src/core/util/wakeup_eventfd.h"
+#include "src/core/sock/sock-redirect.h"
+
+static int s_n_signals = 0;
+
+static ssize_t count_write(int fd, const void *buf, size_t count)
+{
+    ++s_n_signals;
+    return write(fd, buf, count);
+}
+
+class test_wakeup : public wakeup_eventfd {
+public:
+    test_wakeup(int epfd) { wakeup_set_epoll_fd(epfd); }
+    int sleepers() const { return m_is_sleeping; }
+};
+
+class wakeup_test : public mix_base {
+protected:
+    void SetUp()
+    {
+        mix_base::SetUp();
+        m_epfd = epoll_create1(EPOLL_CLOEXEC);
+        ASSERT_LE(0, m_epfd);
+        m_orig_write = orig_os_api.write;
+        orig_os_api.write = count_write;
+        s_n_signals = 0;
+    }
+    void TearDown()
+    {
+        orig_os_api.write = m_orig_write;
+        close(m_epfd);
+        mix_base::TearDown();
+    }
+
+    int m_epfd;
+    ssize_t (*m_orig_write)(int, const void *, size_t);
+};
+
+/**
+ * @test wakeup_test.ti_1
+ * @brief
+ *    A wakeup is passed on only to the threads which were sleeping at the wakeup time
+ * @details
+ *    A woken thread which goes back to sleep must not keep the wakeup going.
+ */
+TEST_F(wakeup_test, ti_1_resleep)
+{
+    test_wakeup wkup(m_epfd);
+
+    ASSERT_TRUE(wkup.going_to_sleep());
+    ASSERT_TRUE(wkup.going_to_sleep());
+    wkup.do_wakeup();
+    EXPECT_EQ(1, s_n_signals);
+
+    // The first sleeper returns, passes the wakeup on and goes back to sleep
+    wkup.return_from_sleep();
+    EXPECT_EQ(2, s_n_signals);
+    ASSERT_TRUE(wkup.going_to_sleep());
+
+    for (int i = 0; i < 10; ++i) {
+        wkup.return_from_sleep();
+        ASSERT_TRUE(wkup.going_to_sleep());
+    }
+    EXPECT_EQ(2, s_n_signals);
+    EXPECT_EQ(2, wkup.sleepers());
+}
+
+struct wakeup_waiter {
+    test_wakeup *wkup;
+    pthread_mutex_t *lock;
+    int epfd;
+    volatile bool *stop;
+    int n_events;
+};
+
+static void *wakeup_waiter_func(void *arg)
+{
+    wakeup_waiter *waiter = (wakeup_waiter *)arg;
+    struct epoll_event ev;
+
+    while (!*waiter->stop) {
+        pthread_mutex_lock(waiter->lock);
+        bool sleep = waiter->wkup->going_to_sleep();
+        pthread_mutex_unlock(waiter->lock);
+        if (!sleep) {
+            break;
+        }
+
+        int rc = epoll_wait(waiter->epfd, &ev, 1, 10);
+
+        pthread_mutex_lock(waiter->lock);
+        waiter->wkup->return_from_sleep();
+        pthread_mutex_unlock(waiter->lock);
+        if (rc > 0) {
+            ++waiter->n_events;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @test wakeup_test.ti_2
+ * @brief
+ *    Threads waiting on the same epfd stop waking each other up after a wakeup
+ * @details
+ */
+TEST_F(wakeup_test, ti_2_multi_waiter)
+{
+    const int n_waiters = 4;
+    test_wakeup wkup(m_epfd);
+    pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+    volatile bool stop = false;
+    wakeup_waiter waiters[n_waiters];
+    pthread_t tids[n_waiters];
+    int n_sleepers = 0;
+    int n_events = 0;
+
+    for (int i = 0; i < n_waiters; ++i) {
+        waiters[i] = {&wkup, &lock, m_epfd, &stop, 0};
+        ASSERT_EQ(0, pthread_create(&tids[i], NULL, wakeup_waiter_func, &waiters[i]));
+    }
+
+    // Wake up whoever sleeps once all the threads have started to wait
+    for (int i = 0; i < 1000 && n_sleepers < n_waiters; ++i) {
+        usleep(1000);
+        pthread_mutex_lock(&lock);
+        n_sleepers = wkup.sleepers();
+        if (n_sleepers == n_waiters) {
+            wkup.do_wakeup();
+        }
+        pthread_mutex_unlock(&lock);
+    }
+    EXPECT_EQ(n_waiters, n_sleepers);
+
+    // The waiters loop on short timeouts, long enough for a wakeup storm to show up
+    usleep(200000);
+    stop = true;
+    for (int i = 0; i < n_waiters; ++i) {
+        pthread_join(tids[i], NULL);
+        n_events += waiters[i].n_events;
+    }
+
+    EXPECT_LE(1, s_n_signals);
+    EXPECT_GE(n_waiters, s_n_signals);
+    EXPECT_GE(n_waiters, n_events);
+}
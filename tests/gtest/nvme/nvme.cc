@@ -38,6 +38,8 @@
 #include "common/base.h"
 #include "dev/qp_mgr_eth_mlx5.h"
 #include "proto/nvme_parse_input_args.h"
+#include "proto/nvme_pdu.h"
+#include "util/crc32c.h"
 #include "tcp/tcp_base.h"
 #include "xlio_extra.h"
 #include <sys/uio.h>
@@ -636,3 +638,401 @@ TEST_F(nvme_tx, send_multiple_pdus)
     }
 }
 #endif /* DEFINED_DPCP */
+
+/* Software NVMe/TCP RX parser, the tests don't need a device. */
+class nvme_rx : public testing::Test {
+protected:
+    typedef vector<uint8_t> bytes;
+
+    /* Chain of pbufs which point to the test owned memory. */
+    struct chain {
+        vector<pbuf> bufs;
+        vector<bytes> data;
+        pbuf *head;
+
+        chain(const bytes &stream, const vector<size_t> &splits)
+        {
+            size_t pos = 0U;
+
+            for (size_t i = 0U; i <= splits.size(); ++i) {
+                size_t end = i < splits.size() ? splits[i] : stream.size();
+                if (end > pos) {
+                    data.emplace_back(stream.begin() + pos, stream.begin() + end);
+                }
+                pos = end;
+            }
+            bufs.resize(data.size());
+            head = data.empty() ? nullptr : &bufs[0];
+            for (size_t i = 0U; i < data.size(); ++i) {
+                memset(&bufs[i], 0, sizeof(bufs[i]));
+                bufs[i].payload = data[i].data();
+                bufs[i].len = data[i].size();
+                bufs[i].next = i + 1 < data.size() ? &bufs[i + 1] : nullptr;
+            }
+            for (size_t i = data.size(); i > 0U; --i) {
+                bufs[i - 1].tot_len = bufs[i - 1].len + (i < data.size() ? bufs[i].tot_len : 0U);
+            }
+        }
+    };
+
+    static int s_freed;
+
+    static u8_t free_cb(pbuf *p)
+    {
+        EXPECT_EQ(0U, p->len);
+        ++s_freed;
+        return 1U;
+    }
+
+    void SetUp() override { s_freed = 0; }
+
+    static void put_le32(uint8_t *p, uint32_t v)
+    {
+        v = htole32(v);
+        memcpy(p, &v, sizeof(v));
+    }
+
+    static void put_digest(bytes &b, size_t off, size_t len)
+    {
+        bytes digest(NVME_TCP_DIGEST_LEN);
+
+        put_le32(digest.data(), crc32c(&b[off], len));
+        b.insert(b.end(), digest.begin(), digest.end());
+    }
+
+    /* C2HData PDU, 'pad' bytes of padding are inserted before the payload using PDO. */
+    static bytes c2h_pdu(uint16_t cid, uint32_t datao, const bytes &payload, uint8_t flags,
+                         uint8_t pad)
+    {
+        uint32_t hdgst = (flags & NVME_TCP_F_HDGST) ? NVME_TCP_DIGEST_LEN : 0U;
+        uint32_t ddgst = (flags & NVME_TCP_F_DDGST) ? NVME_TCP_DIGEST_LEN : 0U;
+        uint32_t data_off = NVME_TCP_C2H_HLEN + hdgst + pad;
+        bytes b(NVME_TCP_C2H_HLEN, 0U);
+
+        b[0] = NVME_TCP_PDU_C2H_DATA;
+        b[1] = flags;
+        b[2] = NVME_TCP_C2H_HLEN;
+        b[3] = pad ? data_off : 0U;
+        put_le32(&b[4], data_off + payload.size() + ddgst);
+        b[8] = cid & 0xFFU;
+        b[9] = cid >> 8U;
+        put_le32(&b[12], datao);
+        put_le32(&b[16], payload.size());
+        if (hdgst) {
+            put_digest(b, 0U, NVME_TCP_C2H_HLEN);
+        }
+        b.insert(b.end(), pad, 0xEEU);
+        b.insert(b.end(), payload.begin(), payload.end());
+        if (ddgst) {
+            put_digest(b, data_off, payload.size());
+        }
+        return b;
+    }
+
+    /* CapsuleResp PDU without data. */
+    static bytes resp_pdu(uint8_t flags)
+    {
+        bytes b(NVME_TCP_C2H_HLEN, 0x5AU);
+
+        b[0] = 0x05U;
+        b[1] = flags & NVME_TCP_F_HDGST;
+        b[2] = NVME_TCP_C2H_HLEN;
+        b[3] = 0U;
+        put_le32(&b[4], NVME_TCP_C2H_HLEN + ((flags & NVME_TCP_F_HDGST) ? 4U : 0U));
+        if (flags & NVME_TCP_F_HDGST) {
+            put_digest(b, 0U, NVME_TCP_C2H_HLEN);
+        }
+        return b;
+    }
+
+    static bytes payload(size_t len, uint8_t seed)
+    {
+        bytes b(len);
+
+        for (size_t i = 0U; i < len; ++i) {
+            b[i] = seed + i * 7U;
+        }
+        return b;
+    }
+
+    /* Returns the bytes left in the chain and checks the chain invariants. */
+    static bytes collect(pbuf *p)
+    {
+        bytes out;
+
+        for (; p; p = p->next) {
+            EXPECT_NE(0U, p->len);
+            EXPECT_EQ(p->len + (p->next ? p->next->tot_len : 0U), p->tot_len);
+            out.insert(out.end(), (uint8_t *)p->payload, (uint8_t *)p->payload + p->len);
+        }
+        return out;
+    }
+
+    static void append(bytes &to, const bytes &from)
+    {
+        to.insert(to.end(), from.begin(), from.end());
+    }
+};
+
+int nvme_rx::s_freed;
+
+/**
+ * @test nvme_rx.split_every_position
+ * @brief
+ *    Parse a stream split across pbufs at every position
+ * @details
+ *    The stream has placed C2HData PDUs with digests and PDO padding, a C2HData
+ *    PDU for an unregistered command and a PDU without data. The stream is fed
+ *    both as a single chain and one pbuf per call, so every PDU stage is split.
+ */
+TEST_F(nvme_rx, split_every_position)
+{
+    const uint8_t flags = NVME_TCP_F_HDGST | NVME_TCP_F_DDGST;
+    bytes data1 = payload(37, 1);
+    bytes data2 = payload(64, 2);
+    bytes data3 = payload(9, 3);
+    bytes pdu1 = c2h_pdu(1, 0, data1, flags, 0);
+    bytes pdu2 = c2h_pdu(1, 37, data2, flags, 12);
+    bytes pdu3 = c2h_pdu(7, 0, data3, flags, 0);
+    bytes resp = resp_pdu(flags);
+    bytes stream;
+    bytes expected;
+
+    append(stream, pdu1);
+    append(stream, resp);
+    append(stream, pdu2);
+    append(stream, pdu3);
+    /* Placed PDUs keep the header and the padding only. */
+    expected.insert(expected.end(), pdu1.begin(), pdu1.begin() + NVME_TCP_C2H_HLEN + 4U);
+    append(expected, resp);
+    expected.insert(expected.end(), pdu2.begin(), pdu2.begin() + NVME_TCP_C2H_HLEN + 4U + 12U);
+    append(expected, pdu3);
+    const uint32_t placed = stream.size() - expected.size();
+
+    for (int per_call = 0; per_call < 2; ++per_call) {
+        for (size_t split = 0U; split <= stream.size(); ++split) {
+            nvme_rx_parser parser(free_cb);
+            bytes dest(data1.size() + data2.size() + 5U, 0U);
+            xlio_nvme_rx_buf buf = {dest.data(), (uint32_t)dest.size(), 1U, 0U};
+            vector<size_t> splits;
+            uint32_t dropped = 0U;
+            bytes out;
+
+            /* One split position and 1 byte pbufs around it. */
+            for (size_t i = split > 2U ? split - 2U : 0U; i <= split + 2U && i < stream.size();
+                 ++i) {
+                splits.push_back(i);
+            }
+            parser.reset(flags, true);
+            parser.set_buf(buf);
+            s_freed = 0;
+            chain c(stream, splits);
+
+            if (per_call) {
+                for (size_t i = 0U; i < c.bufs.size(); ++i) {
+                    pbuf *p = &c.bufs[i];
+                    p->next = nullptr;
+                    p->tot_len = p->len;
+                    ASSERT_TRUE(parser.process(p, dropped)) << "split=" << split;
+                    append(out, collect(p));
+                }
+            } else {
+                pbuf *p = c.head;
+                ASSERT_TRUE(parser.process(p, dropped)) << "split=" << split;
+                out = collect(p);
+            }
+
+            EXPECT_EQ(placed, dropped) << "split=" << split;
+            EXPECT_TRUE(expected == out) << "split=" << split;
+            EXPECT_EQ(0, memcmp(dest.data(), data1.data(), data1.size())) << "split=" << split;
+            EXPECT_EQ(0, memcmp(&dest[data1.size()], data2.data(), data2.size()))
+                << "split=" << split;
+            EXPECT_EQ(0U, dest[data1.size() + data2.size()]) << "split=" << split;
+            /* Every pbuf which holds placed bytes only is released. */
+            int empty = 0;
+            for (auto &b : c.bufs) {
+                empty += !b.len;
+            }
+            EXPECT_EQ(empty, s_freed) << "split=" << split;
+        }
+    }
+}
+
+/**
+ * @test nvme_rx.digest_mismatch
+ * @brief
+ *    Corrupted header or data digest fails the stream
+ * @details
+ *    Only digests which are enabled in software are verified.
+ */
+TEST_F(nvme_rx, digest_mismatch)
+{
+    const uint8_t flags = NVME_TCP_F_HDGST | NVME_TCP_F_DDGST;
+    bytes pdu = c2h_pdu(3, 0, payload(100, 4), flags, 0);
+    const size_t hdgst_pos = NVME_TCP_C2H_HLEN + 1U;
+    const size_t data_pos = NVME_TCP_C2H_HLEN + NVME_TCP_DIGEST_LEN + 50U;
+    const size_t ddgst_pos = pdu.size() - 1U;
+    const struct {
+        size_t pos;
+        uint8_t sw_digest;
+        bool ok;
+    } cases[] = {
+        {hdgst_pos, flags, false},           {hdgst_pos, NVME_TCP_F_DDGST, true},
+        {2U + NVME_TCP_CH_LEN, flags, false}, {data_pos, flags, false},
+        {ddgst_pos, flags, false},           {ddgst_pos, NVME_TCP_F_HDGST, true},
+    };
+
+    for (auto &tc : cases) {
+        nvme_rx_parser parser(free_cb);
+        bytes bad = pdu;
+        uint32_t dropped = 0U;
+
+        bad[tc.pos] ^= 0x10U;
+        parser.reset(tc.sw_digest, false);
+        chain c(bad, {tc.pos});
+        pbuf *p = c.head;
+        EXPECT_EQ(tc.ok, parser.process(p, dropped)) << "pos=" << tc.pos;
+        EXPECT_EQ(0U, dropped);
+    }
+}
+
+/**
+ * @test nvme_rx.placement_out_of_bounds
+ * @brief
+ *    C2HData which doesn't fit the registered buffer fails the stream
+ * @details
+ */
+TEST_F(nvme_rx, placement_out_of_bounds)
+{
+    bytes dest(64, 0U);
+    xlio_nvme_rx_buf buf = {dest.data(), (uint32_t)dest.size(), 2U, 0U};
+    nvme_rx_parser parser(free_cb);
+    bytes pdu = c2h_pdu(2, 32, payload(33, 5), NVME_TCP_F_DDGST, 8);
+    uint32_t dropped = 0U;
+
+    parser.reset(NVME_TCP_F_DDGST, true);
+    parser.set_buf(buf);
+    chain c(pdu, {});
+    pbuf *p = c.head;
+    EXPECT_FALSE(parser.process(p, dropped));
+    EXPECT_EQ(bytes(64, 0U), dest);
+}
+
+/**
+ * @test nvme_rx.unregister_mid_pdu
+ * @brief
+ *    Command buffer is unregistered while its payload is being placed
+ * @details
+ *    The rest of the payload is discarded and isn't delivered to the stream.
+ */
+TEST_F(nvme_rx, unregister_mid_pdu)
+{
+    const uint8_t flags = NVME_TCP_F_HDGST | NVME_TCP_F_DDGST;
+    bytes data = payload(80, 6);
+    bytes pdu = c2h_pdu(4, 0, data, flags, 0);
+    const size_t hdr_len = NVME_TCP_C2H_HLEN + NVME_TCP_DIGEST_LEN;
+    bytes dest(data.size(), 0U);
+    xlio_nvme_rx_buf buf = {dest.data(), (uint32_t)dest.size(), 4U, 0U};
+    xlio_nvme_rx_buf unreg = {nullptr, 0U, 4U, 0U};
+    nvme_rx_parser parser(free_cb);
+    uint32_t dropped = 0U;
+
+    parser.reset(flags, true);
+    parser.set_buf(buf);
+    chain c(pdu, {hdr_len + 30U});
+    pbuf *p1 = &c.bufs[0];
+    pbuf *p2 = &c.bufs[1];
+    p1->next = nullptr;
+    p1->tot_len = p1->len;
+
+    ASSERT_TRUE(parser.process(p1, dropped));
+    EXPECT_EQ(bytes(pdu.begin(), pdu.begin() + hdr_len), collect(p1));
+    parser.set_buf(unreg);
+    ASSERT_TRUE(parser.process(p2, dropped));
+    /* The second pbuf has only payload and data digest, it is released. */
+    EXPECT_EQ(nullptr, p2);
+    EXPECT_EQ(1, s_freed);
+    EXPECT_EQ(data.size() + NVME_TCP_DIGEST_LEN, dropped);
+    EXPECT_EQ(0, memcmp(dest.data(), data.data(), 30U));
+    EXPECT_EQ(bytes(data.size() - 30U, 0U), bytes(dest.begin() + 30U, dest.end()));
+
+    /* The next PDU of the command isn't placed anymore. */
+    bytes next = c2h_pdu(4, 0, payload(8, 7), flags, 0);
+    chain c2(next, {});
+    pbuf *p = c2.head;
+    dropped = 0U;
+    ASSERT_TRUE(parser.process(p, dropped));
+    EXPECT_EQ(0U, dropped);
+    EXPECT_TRUE(next == collect(p));
+}
+
+/**
+ * @test nvme_rx.fully_dropped_chain
+ * @brief
+ *    A chain which carries only placed payload is released completely
+ * @details
+ */
+TEST_F(nvme_rx, fully_dropped_chain)
+{
+    bytes data = payload(300, 8);
+    bytes pdu = c2h_pdu(5, 0, data, NVME_TCP_F_DDGST, 0);
+    bytes dest(data.size(), 0U);
+    xlio_nvme_rx_buf buf = {dest.data(), (uint32_t)dest.size(), 5U, 0U};
+    nvme_rx_parser parser(free_cb);
+    uint32_t dropped = 0U;
+
+    parser.reset(NVME_TCP_F_DDGST, true);
+    parser.set_buf(buf);
+
+    bytes hdr(pdu.begin(), pdu.begin() + NVME_TCP_C2H_HLEN);
+    bytes rest(pdu.begin() + NVME_TCP_C2H_HLEN, pdu.end());
+    chain c1(hdr, {});
+    pbuf *p = c1.head;
+    ASSERT_TRUE(parser.process(p, dropped));
+    EXPECT_TRUE(hdr == collect(p));
+
+    chain c2(rest, {100U, 200U, 301U});
+    p = c2.head;
+    ASSERT_TRUE(parser.process(p, dropped));
+    EXPECT_EQ(nullptr, p);
+    EXPECT_EQ(4, s_freed);
+    EXPECT_EQ(rest.size(), dropped);
+    EXPECT_TRUE(data == dest);
+}
+
+/**
+ * @test nvme_rx.tx_sw_digest
+ * @brief
+ *    Digests of a TX PDU are calculated in software
+ * @details
+ *    The PDU is scattered over iovecs which split the header, the digest
+ *    placeholders and the payload. Only the requested digests are filled.
+ */
+TEST_F(nvme_rx, tx_sw_digest)
+{
+    const uint8_t flags = NVME_TCP_F_HDGST | NVME_TCP_F_DDGST;
+    bytes ref = c2h_pdu(9, 0, payload(200, 9), flags, 8);
+    const size_t hdgst_off = NVME_TCP_C2H_HLEN;
+    const size_t ddgst_off = ref.size() - NVME_TCP_DIGEST_LEN;
+
+    for (uint8_t sw_digest = 0U; sw_digest <= flags; ++sw_digest) {
+        bytes pdu = ref;
+        vector<iovec> iov;
+        const size_t splits[] = {3, 26, 40, 41, 150, ddgst_off + 2U, pdu.size()};
+        size_t pos = 0U;
+
+        memset(&pdu[hdgst_off], 0, NVME_TCP_DIGEST_LEN);
+        memset(&pdu[ddgst_off], 0, NVME_TCP_DIGEST_LEN);
+        for (size_t end : splits) {
+            iov.push_back({&pdu[pos], end - pos});
+            pos = end;
+        }
+        ASSERT_TRUE(nvme_pdu_sw_digest(iov.data(), iov.size(), pdu.size(), sw_digest));
+        EXPECT_EQ(!!(sw_digest & NVME_TCP_F_HDGST),
+                  !memcmp(&pdu[hdgst_off], &ref[hdgst_off], NVME_TCP_DIGEST_LEN));
+        EXPECT_EQ(!!(sw_digest & NVME_TCP_F_DDGST),
+                  !memcmp(&pdu[ddgst_off], &ref[ddgst_off], NVME_TCP_DIGEST_LEN));
+        /* PLEN must describe the whole PDU. */
+        EXPECT_FALSE(nvme_pdu_sw_digest(iov.data(), iov.size(), pdu.size() - 1U, sw_digest));
+    }
+}
@@ -0,0 +1,263 @@
+/*
+ * Copyright (c) 2001-2023 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ *
+ * This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING in the main directory of this source tree, or the
+ * BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <pthread.h>
+#include <sys/epoll.h>
+
+#include "common/def.h"
+#include "common/log.h"
+#include "common/sys.h"
+#include "common/base.h"
+#include "common/cmn.h"
+
+#include "tcp_base.h"
+
+class tcp_epoll : public tcp_base {
+protected:
+    int client_connect(int pid)
+    {
+        int fd;
+
+        barrier_fork(pid);
+
+        fd = tcp_base::sock_create();
+        EXPECT_LE(0, fd);
+        if (fd < 0) {
+            return fd;
+        }
+        EXPECT_EQ(0, bind(fd, (struct sockaddr *)&client_addr, sizeof(client_addr)));
+        EXPECT_EQ(0, connect(fd, (struct sockaddr *)&server_addr, sizeof(server_addr)));
+        return fd;
+    }
+
+    int server_accept(int pid)
+    {
+        int l_fd;
+        int fd;
+
+        l_fd = tcp_base::sock_create();
+        EXPECT_LE(0, l_fd);
+        EXPECT_EQ(0, bind(l_fd, (struct sockaddr *)&server_addr, sizeof(server_addr)));
+        EXPECT_EQ(0, listen(l_fd, 5));
+
+        barrier_fork(pid);
+
+        fd = accept(l_fd, NULL, NULL);
+        EXPECT_LE(0, fd);
+        close(l_fd);
+        return fd;
+    }
+
+    // Receive and drop everything until the peer closes the connection
+    void server_drain(int fd)
+    {
+        char buf[4096];
+        int rc;
+
+        do {
+            rc = recv(fd, buf, sizeof(buf), 0);
+        } while (rc > 0);
+        EXPECT_EQ(0, rc);
+    }
+};
+
+/**
+ * @test tcp_epoll.ti_1_level_out
+ * @brief
+ *    Level triggered EPOLLOUT follows the free space of the send buffer.
+ * @details
+ */
+TEST_F(tcp_epoll, ti_1_level_out)
+{
+    int sync_fds[2];
+
+    ASSERT_EQ(0, pipe(sync_fds));
+
+    int pid = fork();
+
+    if (0 == pid) { /* I am the child */
+        char buf[65536] = {0};
+        struct epoll_event event;
+        int epfd;
+        int fd;
+        int rc;
+
+        close(sync_fds[0]);
+
+        fd = client_connect(pid);
+        ASSERT_LE(0, fd);
+        ASSERT_EQ(0, fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK));
+
+        epfd = epoll_create1(0);
+        ASSERT_LE(0, epfd);
+        event.events = EPOLLOUT;
+        event.data.fd = fd;
+        ASSERT_EQ(0, epoll_ctl(epfd, EPOLL_CTL_ADD, fd, &event));
+
+        rc = epoll_wait(epfd, &event, 1, 0);
+        EXPECT_EQ(1, rc);
+        EXPECT_TRUE(EPOLLOUT & event.events);
+
+        /* The peer doesn't read, so the send buffer fills up. ACKs which are in flight can
+         * free some space, the buffer is full once it stays full for a while.
+         */
+        do {
+            while (0 < send(fd, buf, sizeof(buf), 0)) {
+            }
+            EXPECT_EQ(EAGAIN, errno);
+            usleep(100000);
+        } while (0 < send(fd, buf, sizeof(buf), 0));
+
+        rc = epoll_wait(epfd, &event, 1, 0);
+        EXPECT_EQ(0, rc);
+        rc = epoll_wait(epfd, &event, 1, 0);
+        EXPECT_EQ(0, rc);
+
+        // Let the peer read
+        EXPECT_EQ(1, write(sync_fds[1], "s", 1));
+
+        rc = epoll_wait(epfd, &event, 1, 3000);
+        EXPECT_EQ(1, rc);
+        EXPECT_TRUE(EPOLLOUT & event.events);
+        rc = epoll_wait(epfd, &event, 1, 0);
+        EXPECT_EQ(1, rc);
+        EXPECT_TRUE(EPOLLOUT & event.events);
+
+        close(epfd);
+        close(fd);
+        close(sync_fds[1]);
+
+        /* This exit is very important, otherwise the fork
+         * keeps running and may duplicate other tests.
+         */
+        exit(testing::Test::HasFailure());
+    } else { /* I am the parent */
+        char c;
+        int fd;
+
+        close(sync_fds[1]);
+
+        fd = server_accept(pid);
+        ASSERT_LE(0, fd);
+
+        EXPECT_EQ(1, read(sync_fds[0], &c, 1));
+        server_drain(fd);
+
+        close(fd);
+        close(sync_fds[0]);
+
+        ASSERT_EQ(0, wait_fork(pid));
+    }
+}
+
+struct tcp_epoll_sender {
+    int fd;
+    volatile bool stop;
+};
+
+static void *tcp_epoll_send_func(void *arg)
+{
+    tcp_epoll_sender *p_sender = (tcp_epoll_sender *)arg;
+    char buf[1024] = {0};
+
+    while (!p_sender->stop) {
+        if (send(p_sender->fd, buf, sizeof(buf), MSG_NOSIGNAL) < 0) {
+            break;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @test tcp_epoll.ti_2_del_exclusion
+ * @brief
+ *    No event is reported for a socket removed from the epfd while another
+ *    thread keeps generating events on it.
+ * @details
+ */
+TEST_F(tcp_epoll, ti_2_del_exclusion)
+{
+    int pid = fork();
+
+    if (0 == pid) { /* I am the child */
+        tcp_epoll_sender sender;
+        struct epoll_event event;
+        pthread_t tid;
+        int epfd;
+        int fd;
+        int rc;
+        int i;
+
+        fd = client_connect(pid);
+        ASSERT_LE(0, fd);
+
+        epfd = epoll_create1(0);
+        ASSERT_LE(0, epfd);
+
+        // The sender thread gets ACKs, which notify EPOLLOUT
+        sender.fd = fd;
+        sender.stop = false;
+        ASSERT_EQ(0, pthread_create(&tid, NULL, tcp_epoll_send_func, &sender));
+
+        for (i = 0; i < 10000 && !testing::Test::HasFailure(); i++) {
+            event.events = EPOLLOUT;
+            event.data.fd = fd;
+            ASSERT_EQ(0, epoll_ctl(epfd, EPOLL_CTL_ADD, fd, &event));
+            ASSERT_EQ(0, epoll_ctl(epfd, EPOLL_CTL_DEL, fd, NULL));
+            rc = epoll_wait(epfd, &event, 1, 0);
+            EXPECT_EQ(0, rc);
+        }
+
+        sender.stop = true;
+        shutdown(fd, SHUT_WR);
+        pthread_join(tid, NULL);
+
+        close(epfd);
+        close(fd);
+
+        /* This exit is very important, otherwise the fork
+         * keeps running and may duplicate other tests.
+         */
+        exit(testing::Test::HasFailure());
+    } else { /* I am the parent */
+        int fd;
+
+        fd = server_accept(pid);
+        ASSERT_LE(0, fd);
+
+        server_drain(fd);
+
+        close(fd);
+
+        ASSERT_EQ(0, wait_fork(pid));
+    }
+}
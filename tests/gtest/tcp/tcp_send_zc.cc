@@ -787,4 +787,106 @@ TEST_F(tcp_send_zc, ti_6_epoll_notification)
     }
 }
 
+/**
+ * @test tcp_send_zc.ti_7
+ * @brief
+ *    Verify that level triggered EPOLLERR follows the error queue
+ * @details
+ */
+TEST_F(tcp_send_zc, ti_7_epoll_level_err)
+{
+    int rc = EOK;
+    char test_msg[] = "Hello test";
+
+    m_test_buf = (char *)create_tmp_buffer(sizeof(test_msg), &m_test_buf_size);
+    ASSERT_TRUE(m_test_buf);
+
+    memcpy(m_test_buf, test_msg, sizeof(test_msg));
+
+    int pid = fork();
+
+    if (0 == pid) { /* I am the child */
+        int opt_val = 1;
+        int epfd;
+        uint32_t lo, hi;
+        struct epoll_event event;
+
+        barrier_fork(pid);
+
+        m_fd = tcp_base::sock_create();
+        ASSERT_LE(0, m_fd);
+
+        rc = bind(m_fd, (struct sockaddr *)&client_addr, sizeof(client_addr));
+        ASSERT_EQ(0, rc);
+
+        rc = connect(m_fd, (struct sockaddr *)&server_addr, sizeof(server_addr));
+        ASSERT_EQ(0, rc);
+
+        rc = setsockopt(m_fd, SOL_SOCKET, SO_ZEROCOPY, &opt_val, sizeof(opt_val));
+        ASSERT_EQ(0, rc);
+
+        epfd = epoll_create1(0);
+        ASSERT_LE(0, epfd);
+        event.events = EPOLLIN;
+        event.data.fd = m_fd;
+        rc = epoll_ctl(epfd, EPOLL_CTL_ADD, m_fd, &event);
+        ASSERT_EQ(0, rc);
+
+        rc = send(m_fd, (void *)m_test_buf, sizeof(test_msg), MSG_DONTWAIT | MSG_ZEROCOPY);
+        EXPECT_EQ(sizeof(test_msg), static_cast<size_t>(rc));
+
+        // EPOLLERR is reported without request while the completion is queued
+        rc = epoll_wait(epfd, &event, 1, 1000);
+        EXPECT_EQ(1, rc);
+        EXPECT_TRUE(EPOLLERR & event.events);
+        rc = epoll_wait(epfd, &event, 1, 0);
+        EXPECT_EQ(1, rc);
+        EXPECT_TRUE(EPOLLERR & event.events);
+
+        rc = do_recv_expected_completion(m_fd, lo, hi, 1);
+        EXPECT_EQ(1, rc);
+
+        // The error queue is empty and no data is expected
+        rc = epoll_wait(epfd, &event, 1, 0);
+        EXPECT_EQ(0, rc);
+
+        close(epfd);
+        close(m_fd);
+
+        /* This exit is very important, otherwise the fork
+         * keeps running and may duplicate other tests.
+         */
+        exit(testing::Test::HasFailure());
+    } else { /* I am the parent */
+        int l_fd;
+        char buf[sizeof(test_msg)];
+
+        l_fd = tcp_base::sock_create();
+        ASSERT_LE(0, l_fd);
+
+        rc = bind(l_fd, (struct sockaddr *)&server_addr, sizeof(server_addr));
+        ASSERT_EQ(0, rc);
+
+        rc = listen(l_fd, 5);
+        ASSERT_EQ(0, rc);
+
+        barrier_fork(pid);
+
+        m_fd = accept(l_fd, NULL, NULL);
+        ASSERT_LE(0, m_fd);
+        close(l_fd);
+
+        rc = recv(m_fd, (void *)buf, sizeof(buf), MSG_WAITALL);
+        EXPECT_EQ(sizeof(test_msg), static_cast<size_t>(rc));
+
+        // Keep the connection open until the client checks its events
+        rc = recv(m_fd, (void *)buf, sizeof(buf), 0);
+        EXPECT_EQ(0, rc);
+
+        close(m_fd);
+
+        ASSERT_EQ(0, wait_fork(pid));
+    }
+}
+
 #endif /* SO_ZEROCOPY */
@@ -0,0 +1,215 @@
+/*
+ * Copyright (c) 2001-2023 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ *
+ * This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING in the main directory of this source tree, or the
+ * BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <pthread.h>
+#include <time.h>
+
+#include "common/def.h"
+#include "common/log.h"
+#include "common/sys.h"
+#include "common/base.h"
+
+#include "tcp_base.h"
+
+/* The client sends two bytes with Nagle enabled, so the second one leaves only
+ * after the server acknowledges the first one. The server doesn't send data
+ * and doesn't call select/poll/epoll_wait, so the ACK depends on the delayed
+ * ACK timer of the server socket. With XLIO_TCP_TIMERS_PER_THREAD=1 the timer
+ * belongs to a thread collection which must be run by the internal thread
+ * fallback. The gap stays well below the minimal RTO of the client.
+ */
+#define TCP_TIMERS_MAX_GAP_MSEC 150
+
+class tcp_timers : public tcp_base {
+protected:
+    struct accept_arg {
+        const tcp_timers *self;
+        int fd;
+    };
+
+    static void *accept_func(void *arg)
+    {
+        accept_arg *p_arg = (accept_arg *)arg;
+        int l_fd;
+
+        p_arg->fd = -1;
+        l_fd = p_arg->self->sock_create();
+        if (l_fd < 0) {
+            return NULL;
+        }
+        if (0 == bind(l_fd, (struct sockaddr *)&p_arg->self->server_addr,
+                      sizeof(p_arg->self->server_addr)) &&
+            0 == listen(l_fd, 5)) {
+            p_arg->fd = accept(l_fd, NULL, NULL);
+        }
+        close(l_fd);
+        return NULL;
+    }
+
+    void client_run(int pid)
+    {
+        int rc;
+        int fd;
+        char c;
+
+        fd = tcp_base::sock_create();
+        ASSERT_LE(0, fd);
+
+        rc = bind(fd, (struct sockaddr *)&client_addr, sizeof(client_addr));
+        ASSERT_EQ(0, rc);
+
+        barrier_fork(pid);
+
+        rc = connect(fd, (struct sockaddr *)&server_addr, sizeof(server_addr));
+        ASSERT_EQ(0, rc);
+
+        c = 'a';
+        rc = send(fd, &c, sizeof(c), 0);
+        EXPECT_EQ(1, rc);
+        c = 'b';
+        rc = send(fd, &c, sizeof(c), 0);
+        EXPECT_EQ(1, rc);
+
+        peer_wait(fd);
+        close(fd);
+    }
+
+    /* Returns the time in msec between the two bytes of the client */
+    long server_measure(int fd)
+    {
+        struct timespec ts_a, ts_b;
+        char c = 0;
+        int rc;
+
+        rc = recv(fd, &c, sizeof(c), MSG_WAITALL);
+        EXPECT_EQ(1, rc);
+        EXPECT_EQ('a', c);
+        clock_gettime(CLOCK_MONOTONIC, &ts_a);
+
+        rc = recv(fd, &c, sizeof(c), MSG_WAITALL);
+        EXPECT_EQ(1, rc);
+        EXPECT_EQ('b', c);
+        clock_gettime(CLOCK_MONOTONIC, &ts_b);
+
+        return (ts_b.tv_sec - ts_a.tv_sec) * 1000 + (ts_b.tv_nsec - ts_a.tv_nsec) / 1000000;
+    }
+};
+
+/**
+ * @test tcp_timers.ti_1_thread_exit
+ * @brief
+ *    Run the timers of a socket accepted by a thread which exited.
+ * @details
+ */
+TEST_F(tcp_timers, ti_1_thread_exit)
+{
+    int pid = fork();
+
+    if (0 == pid) { /* I am the child */
+        client_run(pid);
+
+        /* This exit is very important, otherwise the fork
+         * keeps running and may duplicate other tests.
+         */
+        exit(testing::Test::HasFailure());
+    } else { /* I am the parent */
+        pthread_t tid;
+        accept_arg arg;
+        long gap;
+
+        arg.self = this;
+        ASSERT_EQ(0, pthread_create(&tid, NULL, accept_func, &arg));
+
+        /* The listen socket is created by the thread, give it time to listen */
+        usleep(100000);
+        barrier_fork(pid);
+
+        pthread_join(tid, NULL);
+        ASSERT_LE(0, arg.fd);
+
+        gap = server_measure(arg.fd);
+        log_trace("Gap after thread exit: %ld msec\n", gap);
+        EXPECT_GT(TCP_TIMERS_MAX_GAP_MSEC, gap);
+
+        close(arg.fd);
+
+        ASSERT_EQ(0, wait_fork(pid));
+    }
+}
+
+/**
+ * @test tcp_timers.ti_2_blocked_owner
+ * @brief
+ *    Run the timers of a socket whose thread is blocked in recv().
+ * @details
+ */
+TEST_F(tcp_timers, ti_2_blocked_owner)
+{
+    int pid = fork();
+
+    if (0 == pid) { /* I am the child */
+        client_run(pid);
+
+        /* This exit is very important, otherwise the fork
+         * keeps running and may duplicate other tests.
+         */
+        exit(testing::Test::HasFailure());
+    } else { /* I am the parent */
+        int l_fd;
+        int fd;
+        int rc;
+        long gap;
+
+        l_fd = tcp_base::sock_create();
+        ASSERT_LE(0, l_fd);
+
+        rc = bind(l_fd, (struct sockaddr *)&server_addr, sizeof(server_addr));
+        ASSERT_EQ(0, rc);
+
+        rc = listen(l_fd, 5);
+        ASSERT_EQ(0, rc);
+
+        barrier_fork(pid);
+
+        fd = accept(l_fd, NULL, NULL);
+        ASSERT_LE(0, fd);
+        close(l_fd);
+
+        gap = server_measure(fd);
+        log_trace("Gap with blocked owner: %ld msec\n", gap);
+        EXPECT_GT(TCP_TIMERS_MAX_GAP_MSEC, gap);
+
+        close(fd);
+
+        ASSERT_EQ(0, wait_fork(pid));
+    }
+}
@@ -1108,4 +1108,148 @@ TEST_F(tcp_tls, DISABLED_ti_10_12_gcm_control_msg)
     }
 }
 
+/**
+ * @test tcp_tls.ti_11
+ * @brief
+ *    Exchange data by sendfile() when the file grows after it was mapped using
+ *     .tls_version = TLS_1_2_VERSION
+ *     .cipher_type = TLS_CIPHER_AES_GCM_128
+ *
+ * @details
+ *    The second sendfile() covers the appended tail, which is not in the
+ *    cached mapping, so the data is read from the file (PBUF_DESC_FD path).
+ *    Receiver compares the plaintext with the file content.
+ */
+TEST_F(tcp_tls, DISABLED_ti_11_12_gcm_sendfile_grown)
+{
+    int rc = EOK;
+    struct tls12_crypto_info_aes_gcm_128 crypto_info;
+    int test_map_size = 0x4000;
+    int test_tail_size = 0x8000 + 100;
+    int test_file_size = test_map_size + test_tail_size;
+    test_file = create_tmp_file(test_map_size);
+
+    EXPECT_GE(test_file, 0);
+
+    memset(&crypto_info, 0, sizeof(crypto_info));
+    crypto_info.info.version = TLS_1_2_VERSION;
+    crypto_info.info.cipher_type = TLS_CIPHER_AES_GCM_128;
+
+    int pid = fork();
+
+    if (0 == pid) { /* I am the child */
+        off_t test_file_offset = 0;
+        int size;
+
+        barrier_fork(pid);
+
+        fd = tcp_base::sock_create();
+        ASSERT_LE(0, fd);
+
+        rc = bind(fd, (struct sockaddr *)&client_addr, sizeof(client_addr));
+        ASSERT_EQ(0, rc);
+
+        rc = connect(fd, (struct sockaddr *)&server_addr, sizeof(server_addr));
+        ASSERT_EQ(0, rc);
+
+        log_trace("Established connection: fd=%d to %s\n", fd,
+                  sys_addr2str((struct sockaddr *)&server_addr));
+
+        rc = setsockopt(fd, SOL_TCP, TCP_ULP, "tls", sizeof("tls"));
+        SKIP_TRUE((0 == rc), "TLS is not supported");
+
+        rc = setsockopt(fd, SOL_TLS, TLS_TX, &crypto_info, sizeof(crypto_info));
+        EXPECT_EQ(0, rc);
+
+        /* The first call maps the file with its current size. */
+        size = test_map_size;
+        while (size > 0) {
+            rc = sendfile(fd, test_file, &test_file_offset, size);
+            ASSERT_GT(rc, 0);
+            size -= rc;
+        }
+
+        /* Grow the file beyond the mapping. */
+        for (size = 0; size < test_tail_size; size++) {
+            char buf = (size * 7) % 251;
+            rc = pwrite(test_file, &buf, sizeof(buf), test_map_size + size);
+            ASSERT_EQ(1, rc);
+        }
+        fsync(test_file);
+
+        size = test_tail_size;
+        while (size > 0) {
+            rc = sendfile(fd, test_file, &test_file_offset, size);
+            ASSERT_GT(rc, 0);
+            size -= rc;
+        }
+        EXPECT_EQ(test_file_size, test_file_offset);
+
+        peer_wait(fd);
+
+        close(fd);
+
+        /* This exit is very important, otherwise the fork
+         * keeps running and may duplicate other tests.
+         */
+        exit(testing::Test::HasFailure());
+    } else { /* I am the parent */
+        int l_fd;
+        struct sockaddr peer_addr;
+        socklen_t socklen;
+        char *file_buf;
+        int size = test_file_size;
+
+        test_buf = (char *)malloc(test_file_size);
+        ASSERT_TRUE(test_buf);
+
+        l_fd = tcp_base::sock_create();
+        ASSERT_LE(0, l_fd);
+
+        rc = bind(l_fd, (struct sockaddr *)&server_addr, sizeof(server_addr));
+        ASSERT_EQ(0, rc);
+
+        rc = listen(l_fd, 5);
+        ASSERT_EQ(0, rc);
+
+        barrier_fork(pid);
+
+        socklen = sizeof(peer_addr);
+        fd = accept(l_fd, &peer_addr, &socklen);
+        ASSERT_LE(0, fd);
+        close(l_fd);
+
+        log_trace("Accepted connection: fd=%d from %s\n", fd,
+                  sys_addr2str((struct sockaddr *)&peer_addr));
+
+        rc = setsockopt(fd, SOL_TCP, TCP_ULP, "tls", sizeof("tls"));
+        SKIP_TRUE((0 == rc), "TLS is not supported");
+
+        rc = setsockopt(fd, SOL_TLS, TLS_RX, &crypto_info, sizeof(crypto_info));
+        EXPECT_EQ(0, rc);
+
+        while (size > 0 && !child_fork_exit()) {
+            rc = recv(fd, (void *)(test_buf + test_file_size - size), size, MSG_WAITALL);
+            EXPECT_GT(rc, 0);
+            if (rc <= 0) {
+                break;
+            }
+            size -= rc;
+        }
+        EXPECT_EQ(0, size);
+
+        close(fd);
+
+        ASSERT_EQ(0, wait_fork(pid));
+
+        /* The child has grown the file through the shared descriptor. */
+        file_buf = (char *)malloc(test_file_size);
+        ASSERT_TRUE(file_buf);
+        rc = pread(test_file, file_buf, test_file_size, 0);
+        EXPECT_EQ(test_file_size, rc);
+        EXPECT_EQ(0, memcmp(test_buf, file_buf, test_file_size));
+        free(file_buf);
+    }
+}
+
 #endif /* HAVE_LINUX_TLS_H */
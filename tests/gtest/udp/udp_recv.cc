@@ -35,6 +35,7 @@
 #include "common/log.h"
 #include "common/sys.h"
 #include "common/base.h"
+#include "common/cmn.h"
 #include "src/core/util/sock_addr.h"
 #include "udp_base.h"
 
@@ -148,3 +149,62 @@ TEST_F(udp_recv, mapped_ipv4_recv)
         EXPECT_EQ(0, wait_fork(pid));
     }
 }
+
+/**
+ * @test udp_recv.poll_reused_fd
+ * @brief
+ *    poll() reports data on a socket that reuses the fd number of a pipe
+ *
+ * @details
+ *    poll() caches the classification of the last pollfd array per thread.
+ *    The fd number first belongs to a pipe, then to a socket, while the
+ *    pollfd array stays the same. The socket must be polled as offloaded.
+ */
+TEST_F(udp_recv, poll_reused_fd)
+{
+    int rc = EOK;
+    int pipefd[2];
+    int fd;
+    int fd_send;
+    struct pollfd pfd;
+    char buf[8] = {0};
+
+    rc = pipe(pipefd);
+    ASSERT_EQ(0, rc);
+
+    pfd.fd = pipefd[0];
+    pfd.events = POLLIN;
+    pfd.revents = 0;
+    rc = poll(&pfd, 1, 0);
+    EXPECT_EQ(0, rc);
+
+    close(pipefd[0]);
+    fd = udp_base::sock_create();
+    ASSERT_LE(0, fd);
+    if (fd != pfd.fd) {
+        close(fd);
+        close(pipefd[1]);
+    }
+    SKIP_TRUE((fd == pfd.fd), "fd number was not reused");
+
+    rc = bind(fd, &server_addr.addr, sizeof(server_addr));
+    EXPECT_EQ_ERRNO(0, rc);
+
+    fd_send = udp_base::sock_create();
+    EXPECT_LE(0, fd_send);
+
+    rc = sendto(fd_send, buf, sizeof(buf), 0, &server_addr.addr, sizeof(server_addr));
+    EXPECT_EQ(static_cast<int>(sizeof(buf)), rc);
+
+    pfd.revents = 0;
+    rc = poll(&pfd, 1, 1000);
+    EXPECT_EQ(1, rc);
+    EXPECT_EQ(POLLIN, pfd.revents);
+
+    rc = recv(fd, buf, sizeof(buf), MSG_DONTWAIT);
+    EXPECT_EQ(static_cast<int>(sizeof(buf)), rc);
+
+    close(fd_send);
+    close(fd);
+    close(pipefd[1]);
+}
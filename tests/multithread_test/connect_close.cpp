@@ -0,0 +1,251 @@
+/*
+ * Copyright © 2013-2023 NVIDIA CORPORATION & AFFILIATES. ALL RIGHTS RESERVED.
+ *
+ * This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING in the main directory of this source tree, or the
+ * BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*
+** Build command: g++ -lpthread connect_close.cpp -o connect_close
+**
+** Multithreaded connect/close benchmark. Every worker thread creates a TCP
+** socket, connects to the server, and closes it in a loop, while lookup
+** threads call getsockopt() on a long-lived socket. Reports the rates of
+** both to show fd collection scalability under socket churn.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/time.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+
+#define DEFAULT_ADDRESS "127.0.0.1"
+#define DEFAULT_PORT 17777
+#define DEFAULT_WORKERS 4
+#define DEFAULT_LOOKUPS 0
+#define DEFAULT_DURATION 10
+
+struct config_t {
+    struct sockaddr_in addr;
+    int workers;
+    int lookups;
+    int duration;
+    int local_server;
+};
+
+static struct config_t g_config;
+static volatile int g_stop = 0;
+static int g_shared_fd = -1;
+
+struct thread_stats_t {
+    pthread_t tid;
+    unsigned long long ops;
+    unsigned long long errors;
+} __attribute__((aligned(64)));
+
+static void usage(const char *prog)
+{
+    printf("Usage: %s [options]\n"
+           "  -a <ip>     server address (default %s, starts a local server)\n"
+           "  -p <port>   server port (default %d)\n"
+           "  -t <num>    connect/close threads (default %d)\n"
+           "  -l <num>    getsockopt() lookup threads (default %d)\n"
+           "  -d <sec>    test duration (default %d)\n",
+           prog, DEFAULT_ADDRESS, DEFAULT_PORT, DEFAULT_WORKERS, DEFAULT_LOOKUPS,
+           DEFAULT_DURATION);
+}
+
+static void *server_loop(void *arg)
+{
+    int listen_fd = *(int *)arg;
+
+    while (!g_stop) {
+        int fd = accept(listen_fd, NULL, NULL);
+        if (fd >= 0) {
+            close(fd);
+        }
+    }
+    return NULL;
+}
+
+static void *connect_close_loop(void *arg)
+{
+    struct thread_stats_t *stats = (struct thread_stats_t *)arg;
+
+    while (!g_stop) {
+        int fd = socket(AF_INET, SOCK_STREAM, 0);
+        if (fd < 0) {
+            stats->errors++;
+            continue;
+        }
+        if (connect(fd, (struct sockaddr *)&g_config.addr, sizeof(g_config.addr)) == 0) {
+            stats->ops++;
+        } else {
+            stats->errors++;
+        }
+        close(fd);
+    }
+    return NULL;
+}
+
+static void *lookup_loop(void *arg)
+{
+    struct thread_stats_t *stats = (struct thread_stats_t *)arg;
+    int val;
+    socklen_t len;
+
+    while (!g_stop) {
+        len = sizeof(val);
+        if (getsockopt(g_shared_fd, IPPROTO_TCP, TCP_NODELAY, &val, &len) == 0) {
+            stats->ops++;
+        } else {
+            stats->errors++;
+        }
+    }
+    return NULL;
+}
+
+static int start_server(pthread_t *tid, int *listen_fd)
+{
+    int opt = 1;
+
+    *listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (*listen_fd < 0) {
+        perror("socket");
+        return -1;
+    }
+    setsockopt(*listen_fd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
+    if (bind(*listen_fd, (struct sockaddr *)&g_config.addr, sizeof(g_config.addr)) < 0 ||
+        listen(*listen_fd, 4096) < 0) {
+        perror("bind/listen");
+        close(*listen_fd);
+        return -1;
+    }
+    return pthread_create(tid, NULL, server_loop, listen_fd);
+}
+
+int main(int argc, char *argv[])
+{
+    struct thread_stats_t *stats;
+    pthread_t server_tid;
+    int listen_fd = -1;
+    int nthreads;
+    int opt;
+    unsigned long long connects = 0, lookups = 0, errors = 0;
+
+    memset(&g_config, 0, sizeof(g_config));
+    g_config.addr.sin_family = AF_INET;
+    g_config.addr.sin_port = htons(DEFAULT_PORT);
+    inet_pton(AF_INET, DEFAULT_ADDRESS, &g_config.addr.sin_addr);
+    g_config.workers = DEFAULT_WORKERS;
+    g_config.lookups = DEFAULT_LOOKUPS;
+    g_config.duration = DEFAULT_DURATION;
+    g_config.local_server = 1;
+
+    while ((opt = getopt(argc, argv, "a:p:t:l:d:h")) != -1) {
+        switch (opt) {
+        case 'a':
+            if (inet_pton(AF_INET, optarg, &g_config.addr.sin_addr) != 1) {
+                usage(argv[0]);
+                return 1;
+            }
+            g_config.local_server = 0;
+            break;
+        case 'p':
+            g_config.addr.sin_port = htons(atoi(optarg));
+            break;
+        case 't':
+            g_config.workers = atoi(optarg);
+            break;
+        case 'l':
+            g_config.lookups = atoi(optarg);
+            break;
+        case 'd':
+            g_config.duration = atoi(optarg);
+            break;
+        default:
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (g_config.local_server && start_server(&server_tid, &listen_fd)) {
+        return 1;
+    }
+
+    g_shared_fd = socket(AF_INET, SOCK_STREAM, 0);
+    nthreads = g_config.workers + g_config.lookups;
+    stats = (struct thread_stats_t *)calloc(nthreads, sizeof(*stats));
+    if (!stats) {
+        return 1;
+    }
+
+    for (int i = 0; i < nthreads; i++) {
+        pthread_create(&stats[i].tid, NULL,
+                       i < g_config.workers ? connect_close_loop : lookup_loop, &stats[i]);
+    }
+
+    sleep(g_config.duration);
+    g_stop = 1;
+
+    for (int i = 0; i < nthreads; i++) {
+        pthread_join(stats[i].tid, NULL);
+        if (i < g_config.workers) {
+            connects += stats[i].ops;
+        } else {
+            lookups += stats[i].ops;
+        }
+        errors += stats[i].errors;
+    }
+
+    printf("threads=%d lookups=%d duration=%ds\n", g_config.workers, g_config.lookups,
+           g_config.duration);
+    printf("connect/close per sec: %llu\n", connects / g_config.duration);
+    printf("lookups per sec:       %llu\n", lookups / g_config.duration);
+    printf("errors:                %llu\n", errors);
+
+    if (g_config.local_server) {
+        // Wake up the server thread blocked in accept()
+        int fd = socket(AF_INET, SOCK_STREAM, 0);
+        connect(fd, (struct sockaddr *)&g_config.addr, sizeof(g_config.addr));
+        close(fd);
+        pthread_join(server_tid, NULL);
+        close(listen_fd);
+    }
+    close(g_shared_fd);
+    free(stats);
+    return 0;
+}